@@ -427,6 +427,9 @@ void Agent::processAgentAvatarAndAudio(float deltaTime) {
             // seek past the sequence number, will be packed when destination node is known
             audioPacket->seek(sizeof(quint16));
 
+            // scripted avatar audio is always sent as raw PCM
+            audioPacket->writeString(AudioCodecs::PCM_CODEC_NAME);
+
             if (silentFrame) {
                 if (!_isListeningToAudioStream) {
                     // if we have a silent frame and we're not listening then just send nothing and break out of here
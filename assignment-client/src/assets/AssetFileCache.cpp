@@ -0,0 +1,103 @@
+//
+//  AssetFileCache.cpp
+//  assignment-client/src/assets
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetFileCache.h"
+
+const qint64 AssetFileCache::DEFAULT_MAX_SIZE = 256 * 1024 * 1024;
+
+AssetFileCache::AssetFileCache(qint64 maxSize) :
+    _maxSize(maxSize)
+{
+
+}
+
+void AssetFileCache::setMaxSize(qint64 maxSize) {
+    QMutexLocker locker(&_mutex);
+    _maxSize = maxSize;
+    evict();
+}
+
+QByteArray AssetFileCache::find(const AssetHash& hash) {
+    QMutexLocker locker(&_mutex);
+
+    auto it = _entries.find(hash);
+    if (it == _entries.end()) {
+        _misses++;
+        return QByteArray();
+    }
+
+    _hits++;
+    _lru.splice(_lru.begin(), _lru, it->lruPosition);
+    return it->data;
+}
+
+void AssetFileCache::insert(const AssetHash& hash, const QByteArray& data, quint64 removals) {
+    if (data.size() > getMaxCachedFileSize()) {
+        return;
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    if (removals != _removals) {
+        // the data may be of an asset deleted since it was read
+        return;
+    }
+
+    auto it = _entries.find(hash);
+    if (it != _entries.end()) {
+        // another request read the same file first
+        _lru.splice(_lru.begin(), _lru, it->lruPosition);
+        return;
+    }
+
+    _lru.push_front(hash);
+    _entries.insert(hash, { data, _lru.begin() });
+    _size += data.size();
+    evict();
+}
+
+void AssetFileCache::remove(const AssetHash& hash) {
+    QMutexLocker locker(&_mutex);
+    ++_removals;
+
+    auto it = _entries.find(hash);
+    if (it != _entries.end()) {
+        _size -= it->data.size();
+        _lru.erase(it->lruPosition);
+        _entries.erase(it);
+    }
+}
+
+void AssetFileCache::trackBytesServed(qint64 bytes, bool fromCache) {
+    if (fromCache) {
+        _bytesServedFromCache += bytes;
+    } else {
+        _bytesServedFromDisk += bytes;
+    }
+}
+
+qint64 AssetFileCache::getSize() const {
+    QMutexLocker locker(&_mutex);
+    return _size;
+}
+
+int AssetFileCache::getCount() const {
+    QMutexLocker locker(&_mutex);
+    return _entries.size();
+}
+
+void AssetFileCache::evict() {
+    while (_size > _maxSize && !_lru.empty()) {
+        auto it = _entries.find(_lru.back());
+        _size -= it->data.size();
+        _entries.erase(it);
+        _lru.pop_back();
+    }
+}
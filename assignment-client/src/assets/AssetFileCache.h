@@ -0,0 +1,80 @@
+//
+//  AssetFileCache.h
+//  assignment-client/src/assets
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetFileCache_h
+#define hifi_AssetFileCache_h
+
+#include <atomic>
+#include <list>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+
+#include "AssetUtils.h"
+
+/// Keeps the contents of recently requested asset files in memory, least recently used first out. Assets are
+/// named by the hash of their contents, so a cached asset never goes stale - it only has to be dropped when its
+/// file is deleted.
+class AssetFileCache {
+public:
+    static const qint64 DEFAULT_MAX_SIZE;
+
+    AssetFileCache(qint64 maxSize = DEFAULT_MAX_SIZE);
+
+    void setMaxSize(qint64 maxSize);
+    qint64 getMaxSize() const { return _maxSize; }
+
+    /// Files larger than this are never cached, so that one of them can't push out everything else
+    qint64 getMaxCachedFileSize() const { return _maxSize / MAX_CACHED_FILE_FRACTION; }
+
+    /// Returns the cached contents of the asset, or a null array if it isn't cached. Counts a hit or a miss.
+    QByteArray find(const AssetHash& hash);
+
+    /// Incremented by every remove. A reader takes it before opening a file and hands it to insert, which drops
+    /// the data if anything was removed in between, so that a deleted asset can't be cached again.
+    quint64 getRemovals() const { return _removals; }
+
+    void insert(const AssetHash& hash, const QByteArray& data, quint64 removals);
+    void remove(const AssetHash& hash);
+
+    void trackBytesServed(qint64 bytes, bool fromCache);
+
+    qint64 getSize() const;
+    int getCount() const;
+    quint64 getHits() const { return _hits; }
+    quint64 getMisses() const { return _misses; }
+    quint64 getBytesServedFromCache() const { return _bytesServedFromCache; }
+    quint64 getBytesServedFromDisk() const { return _bytesServedFromDisk; }
+
+private:
+    static const int MAX_CACHED_FILE_FRACTION = 8;
+
+    struct Entry {
+        QByteArray data;
+        std::list<AssetHash>::iterator lruPosition;
+    };
+
+    void evict(); // must be called with _mutex locked
+
+    mutable QMutex _mutex;
+    QHash<AssetHash, Entry> _entries;
+    std::list<AssetHash> _lru; // most recently used first
+    qint64 _size { 0 };
+    qint64 _maxSize;
+    std::atomic<quint64> _removals { 0 };
+
+    std::atomic<quint64> _hits { 0 };
+    std::atomic<quint64> _misses { 0 };
+    std::atomic<quint64> _bytesServedFromCache { 0 };
+    std::atomic<quint64> _bytesServedFromDisk { 0 };
+};
+
+#endif // hifi_AssetFileCache_h
@@ -28,6 +28,8 @@
 #include "SendAssetTask.h"
 #include "UploadAssetTask.h"
 
+static const int MAX_CONCURRENT_SEND_TASKS_PER_NODE = 8;
+
 const QString ASSET_SERVER_LOGGING_TARGET_NAME = "asset-server";
 
 AssetServer::AssetServer(ReceivedMessage& message) :
@@ -89,6 +91,15 @@ void AssetServer::completeSetup() {
                     " (" << maxBandwidth << "bits/s)";
     }
 
+    static const QString CACHE_SIZE_OPTION = "cache_size";
+    auto cacheSizeFloat = assetServerObject[CACHE_SIZE_OPTION].toDouble(-1);
+
+    if (cacheSizeFloat >= 0.0) {
+        const qint64 BYTES_PER_MEGABYTE = 1024 * 1024;
+        _fileCache.setMaxSize(cacheSizeFloat * BYTES_PER_MEGABYTE);
+    }
+    qInfo() << "Caching up to" << _fileCache.getMaxSize() << "bytes of asset files in memory.";
+
     // get the path to the asset folder from the domain server settings
     static const QString ASSETS_PATH_OPTION = "assets_path";
     auto assetsJSONValue = assetServerObject[ASSETS_PATH_OPTION];
@@ -166,6 +177,9 @@ void AssetServer::cleanupUnmappedFiles() {
                 } else {
                     qDebug() << "\tAttempt to delete unmapped file" << fileInfo.fileName() << "failed";
                 }
+
+                // only once the file is gone, so that a request reading it can't put it back in the cache
+                _fileCache.remove(fileInfo.fileName());
             }
         }
     }
@@ -330,8 +344,42 @@ void AssetServer::handleAssetGet(QSharedPointer<ReceivedMessage> message, Shared
         return;
     }
 
+    NodeSendTasks& nodeTasks = _sendTasks[senderNode->getUUID()];
+    if (nodeTasks.numRunning >= MAX_CONCURRENT_SEND_TASKS_PER_NODE) {
+        // it gets started when one of this node's running tasks is done
+        nodeTasks.pending.enqueue({ message, senderNode });
+        return;
+    }
+
     // Queue task
-    auto task = new SendAssetTask(message, senderNode, _filesDirectory);
+    ++nodeTasks.numRunning;
+    auto task = new SendAssetTask(message, senderNode, _filesDirectory, _fileCache, this);
+    _taskPool.start(task);
+}
+
+void AssetServer::sendAssetTaskFinished(QUuid nodeUUID) {
+    auto it = _sendTasks.find(nodeUUID);
+    if (it == _sendTasks.end()) {
+        return;
+    }
+
+    NodeSendTasks& nodeTasks = it.value();
+
+    if (!nodeTasks.pending.isEmpty() && !DependencyManager::get<NodeList>()->nodeWithUUID(nodeUUID)) {
+        // the node is gone, nobody is listening for the rest of its replies
+        nodeTasks.pending.clear();
+    }
+
+    if (nodeTasks.pending.isEmpty()) {
+        if (--nodeTasks.numRunning <= 0) {
+            _sendTasks.erase(it);
+        }
+        return;
+    }
+
+    // the finished task's slot goes straight to this node's next request
+    PendingAssetGet next = nodeTasks.pending.dequeue();
+    auto task = new SendAssetTask(next.message, next.senderNode, _filesDirectory, _fileCache, this);
     _taskPool.start(task);
 }
 
@@ -427,6 +475,16 @@ void AssetServer::sendStatsPacket() {
         serverStats[uuid] = nodeStats;
     }
 
+    QJsonObject cacheStats;
+    cacheStats["1. Hits"] = (double)_fileCache.getHits();
+    cacheStats["2. Misses"] = (double)_fileCache.getMisses();
+    cacheStats["3. Cached Files"] = _fileCache.getCount();
+    cacheStats["4. Cached (bytes)"] = (double)_fileCache.getSize();
+    cacheStats["5. Max Cached (bytes)"] = (double)_fileCache.getMaxSize();
+    cacheStats["6. Served From Cache (bytes)"] = (double)_fileCache.getBytesServedFromCache();
+    cacheStats["7. Served From Disk (bytes)"] = (double)_fileCache.getBytesServedFromDisk();
+    serverStats["File Cache"] = cacheStats;
+
     // send off the stats packets
     ThreadedAssignment::addPacketStatsAndSendStatsPacket(serverStats);
 }
@@ -619,6 +677,9 @@ bool AssetServer::deleteMappings(AssetPathList& paths) {
             } else {
                 qDebug() << "\tAttempt to delete unmapped file" << hash << "failed";
             }
+
+            // only once the file is gone, see cleanupUnmappedFiles
+            _fileCache.remove(hash);
         }
 
         return true;
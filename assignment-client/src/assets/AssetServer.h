@@ -13,10 +13,14 @@
 #define hifi_AssetServer_h
 
 #include <QtCore/QDir>
+#include <QtCore/QHash>
+#include <QtCore/QQueue>
 #include <QtCore/QThreadPool>
+#include <QtCore/QUuid>
 
 #include <ThreadedAssignment.h>
 
+#include "AssetFileCache.h"
 #include "AssetUtils.h"
 #include "ReceivedMessage.h"
 
@@ -37,10 +41,23 @@ private slots:
     void handleAssetMappingOperation(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
     
     void sendStatsPacket();
+
+    // called by each SendAssetTask once its reply has been sent
+    void sendAssetTaskFinished(QUuid nodeUUID);
     
 private:
     using Mappings = QVariantHash;
 
+    struct PendingAssetGet {
+        QSharedPointer<ReceivedMessage> message;
+        SharedNodePointer senderNode;
+    };
+
+    struct NodeSendTasks {
+        int numRunning { 0 };
+        QQueue<PendingAssetGet> pending;
+    };
+
     void handleGetMappingOperation(ReceivedMessage& message, SharedNodePointer senderNode, NLPacketList& replyPacket);
     void handleGetAllMappingOperation(ReceivedMessage& message, SharedNodePointer senderNode, NLPacketList& replyPacket);
     void handleSetMappingOperation(ReceivedMessage& message, SharedNodePointer senderNode, NLPacketList& replyPacket);
@@ -67,7 +84,13 @@ private:
 
     QDir _resourcesDirectory;
     QDir _filesDirectory;
+
+    // declared before the task pool, so that it outlives the tasks reading from it
+    AssetFileCache _fileCache;
     QThreadPool _taskPool;
+
+    // a client fetching a large asset in chunks gets a few of them sent at once, without using up the whole pool
+    QHash<QUuid, NodeSendTasks> _sendTasks;
 };
 
 #endif
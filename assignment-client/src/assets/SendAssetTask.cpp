@@ -11,6 +11,8 @@
 
 #include "SendAssetTask.h"
 
+#include <limits>
+
 #include <QFile>
 
 #include <DependencyManager.h>
@@ -22,11 +24,14 @@
 
 #include "AssetUtils.h"
 
-SendAssetTask::SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir) :
+SendAssetTask::SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir,
+                             AssetFileCache& fileCache, AssetServer* assetServer) :
     QRunnable(),
     _message(message),
     _senderNode(sendToNode),
-    _resourcesDir(resourcesDir)
+    _resourcesDir(resourcesDir),
+    _fileCache(fileCache),
+    _assetServer(assetServer)
 {
     
 }
@@ -55,24 +60,73 @@ void SendAssetTask::run() {
 
     replyPacketList->writePrimitive(messageID);
 
-    if (end <= start) {
+    // the range is checked against the asset's size below, before anything is read
+    if (!isValidByteRange(start, end, std::numeric_limits<qint64>::max())) {
         replyPacketList->writePrimitive(AssetServerError::InvalidByteRange);
+        qCDebug(networking) << "Bad byte range: " << hexHash << " " << start << ":" << end;
     } else {
         QString filePath = _resourcesDir.filePath(QString(hexHash));
-        
+
+        // taken before the file is opened, so that the cache drops what we read if the asset is deleted meanwhile
+        auto cacheRemovals = _fileCache.getRemovals();
+
+        // popular assets are served from memory, without going back to the disk
+        QByteArray cachedData = _fileCache.find(hexHash);
         QFile file { filePath };
 
-        if (file.open(QIODevice::ReadOnly)) {
-            if (file.size() < end) {
+        if (!cachedData.isNull()) {
+            if (!isValidByteRange(start, end, cachedData.size())) {
                 replyPacketList->writePrimitive(AssetServerError::InvalidByteRange);
                 qCDebug(networking) << "Bad byte range: " << hexHash << " " << start << ":" << end;
             } else {
                 auto size = end - start;
-                file.seek(start);
                 replyPacketList->writePrimitive(AssetServerError::NoError);
                 replyPacketList->writePrimitive(size);
-                replyPacketList->write(file.read(size));
-                qCDebug(networking) << "Sending asset: " << hexHash;
+                replyPacketList->write(cachedData.constData() + start, size);
+                _fileCache.trackBytesServed(size, true);
+                qCDebug(networking) << "Sending cached asset: " << hexHash;
+            }
+        } else if (file.open(QIODevice::ReadOnly)) {
+            if (!isValidByteRange(start, end, file.size())) {
+                replyPacketList->writePrimitive(AssetServerError::InvalidByteRange);
+                qCDebug(networking) << "Bad byte range: " << hexHash << " " << start << ":" << end;
+            } else {
+                auto size = end - start;
+                QByteArray data;
+                uchar* mappedData = nullptr;
+
+                if (file.size() <= _fileCache.getMaxCachedFileSize()) {
+                    data = file.readAll();
+                    if (data.size() == file.size()) {
+                        _fileCache.insert(hexHash, data, cacheRemovals);
+                        data = data.mid(start, size);
+                    } else {
+                        data.clear();
+                    }
+                } else {
+                    // too large to cache - the range is copied from the mapped file into the packets,
+                    // without reading it into a buffer of its own first
+                    mappedData = file.map(start, size);
+                    if (!mappedData && file.seek(start)) {
+                        data = file.read(size);
+                    }
+                }
+
+                if (mappedData || data.size() == size) {
+                    replyPacketList->writePrimitive(AssetServerError::NoError);
+                    replyPacketList->writePrimitive(size);
+                    if (mappedData) {
+                        replyPacketList->write(reinterpret_cast<const char*>(mappedData), size);
+                        file.unmap(mappedData);
+                    } else {
+                        replyPacketList->write(data);
+                    }
+                    _fileCache.trackBytesServed(size, false);
+                    qCDebug(networking) << "Sending asset: " << hexHash;
+                } else {
+                    replyPacketList->writePrimitive(AssetServerError::FileOperationFailed);
+                    qCWarning(networking) << "Could not read" << size << "bytes of asset" << hexHash;
+                }
             }
             file.close();
         } else {
@@ -83,4 +137,7 @@ void SendAssetTask::run() {
 
     auto nodeList = DependencyManager::get<NodeList>();
     nodeList->sendPacketList(std::move(replyPacketList), *_senderNode);
+
+    QMetaObject::invokeMethod(_assetServer, "sendAssetTaskFinished", Qt::QueuedConnection,
+                              Q_ARG(QUuid, _senderNode->getUUID()));
 }
@@ -17,6 +17,7 @@
 #include <QtCore/QString>
 #include <QtCore/QRunnable>
 
+#include "AssetFileCache.h"
 #include "AssetUtils.h"
 #include "AssetServer.h"
 #include "Node.h"
@@ -25,7 +26,8 @@ class NLPacket;
 
 class SendAssetTask : public QRunnable {
 public:
-    SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir);
+    SendAssetTask(QSharedPointer<ReceivedMessage> message, const SharedNodePointer& sendToNode, const QDir& resourcesDir,
+                  AssetFileCache& fileCache, AssetServer* assetServer);
 
     void run();
 
@@ -33,6 +35,8 @@ private:
     QSharedPointer<ReceivedMessage> _message;
     SharedNodePointer _senderNode;
     QDir _resourcesDir;
+    AssetFileCache& _fileCache;
+    AssetServer* _assetServer; // owns the pool we run on, so it outlives us
 };
 
 #endif
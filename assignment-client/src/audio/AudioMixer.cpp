@@ -9,6 +9,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <cmath>
 #include <errno.h>
 #include <fcntl.h>
 #include <fstream>
@@ -30,8 +31,6 @@
 #endif //_WIN32
 
 #include <glm/glm.hpp>
-#include <glm/gtx/norm.hpp>
-#include <glm/gtx/vector_angle.hpp>
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QJsonArray>
@@ -65,6 +64,7 @@ const float DEFAULT_NOISE_MUTING_THRESHOLD = 0.003f;
 const QString AUDIO_MIXER_LOGGING_TARGET_NAME = "audio-mixer";
 const QString AUDIO_ENV_GROUP_KEY = "audio_env";
 const QString AUDIO_BUFFER_GROUP_KEY = "audio_buffer";
+const QString AUDIO_THREADING_GROUP_KEY = "audio_threading";
 
 InboundAudioStream::Settings AudioMixer::_streamSettings;
 
@@ -85,277 +85,16 @@ AudioMixer::AudioMixer(ReceivedMessage& message) :
     auto nodeList = DependencyManager::get<NodeList>();
     auto& packetReceiver = nodeList->getPacketReceiver();
 
-    packetReceiver.registerListenerForTypes({ PacketType::MicrophoneAudioNoEcho, PacketType::MicrophoneAudioWithEcho,
-                                              PacketType::InjectAudio, PacketType::SilentAudioFrame,
-                                              PacketType::AudioStreamStats },
-                                            this, "handleNodeAudioPacket");
+    for (auto type : { PacketType::MicrophoneAudioNoEcho, PacketType::MicrophoneAudioWithEcho,
+                       PacketType::InjectAudio, PacketType::SilentAudioFrame, PacketType::AudioStreamStats }) {
+        packetReceiver.registerListener(type, this, &AudioMixer::handleNodeAudioPacket);
+    }
     packetReceiver.registerListener(PacketType::MuteEnvironment, this, "handleMuteEnvironmentPacket");
+    packetReceiver.registerListener(PacketType::NegotiateAudioFormat, this, "handleNegotiateAudioFormatPacket");
 
     connect(nodeList.data(), &NodeList::nodeKilled, this, &AudioMixer::handleNodeKilled);
 }
 
-const float ATTENUATION_BEGINS_AT_DISTANCE = 1.0f;
-
-float AudioMixer::gainForSource(const PositionalAudioStream& streamToAdd,
-                                const AvatarAudioStream& listeningNodeStream, const glm::vec3& relativePosition, bool isEcho) {
-    float gain = 1.0f;
-
-    float distanceBetween = glm::length(relativePosition);
-
-    if (distanceBetween < EPSILON) {
-        distanceBetween = EPSILON;
-    }
-
-    if (streamToAdd.getType() == PositionalAudioStream::Injector) {
-        gain *= reinterpret_cast<const InjectedAudioStream*>(&streamToAdd)->getAttenuationRatio();
-    }
-
-    if (!isEcho && (streamToAdd.getType() == PositionalAudioStream::Microphone)) {
-        //  source is another avatar, apply fixed off-axis attenuation to make them quieter as they turn away from listener
-        glm::vec3 rotatedListenerPosition = glm::inverse(streamToAdd.getOrientation()) * relativePosition;
-
-        float angleOfDelivery = glm::angle(glm::vec3(0.0f, 0.0f, -1.0f),
-                                           glm::normalize(rotatedListenerPosition));
-
-        const float MAX_OFF_AXIS_ATTENUATION = 0.2f;
-        const float OFF_AXIS_ATTENUATION_FORMULA_STEP = (1 - MAX_OFF_AXIS_ATTENUATION) / 2.0f;
-
-        float offAxisCoefficient = MAX_OFF_AXIS_ATTENUATION +
-        (OFF_AXIS_ATTENUATION_FORMULA_STEP * (angleOfDelivery / PI_OVER_TWO));
-
-        // multiply the current attenuation coefficient by the calculated off axis coefficient
-        gain *= offAxisCoefficient;
-    }
-
-    float attenuationPerDoublingInDistance = _attenuationPerDoublingInDistance;
-    for (int i = 0; i < _zonesSettings.length(); ++i) {
-        if (_audioZones[_zonesSettings[i].source].contains(streamToAdd.getPosition()) &&
-            _audioZones[_zonesSettings[i].listener].contains(listeningNodeStream.getPosition())) {
-            attenuationPerDoublingInDistance = _zonesSettings[i].coefficient;
-            break;
-        }
-    }
-
-    if (distanceBetween >= ATTENUATION_BEGINS_AT_DISTANCE) {
-        // calculate the distance coefficient using the distance to this node
-        float distanceCoefficient = 1.0f - (logf(distanceBetween / ATTENUATION_BEGINS_AT_DISTANCE) / logf(2.0f)
-                                            * attenuationPerDoublingInDistance);
-
-        if (distanceCoefficient < 0) {
-            distanceCoefficient = 0;
-        }
-
-        // multiply the current attenuation coefficient by the distance coefficient
-        gain *= distanceCoefficient;
-    }
-
-    return gain;
-}
-
-float AudioMixer::azimuthForSource(const PositionalAudioStream& streamToAdd, const AvatarAudioStream& listeningNodeStream,
-                                   const glm::vec3& relativePosition) {
-    glm::quat inverseOrientation = glm::inverse(listeningNodeStream.getOrientation());
-
-    //  Compute sample delay for the two ears to create phase panning
-    glm::vec3 rotatedSourcePosition = inverseOrientation * relativePosition;
-
-    // project the rotated source position vector onto the XZ plane
-    rotatedSourcePosition.y = 0.0f;
-
-    static const float SOURCE_DISTANCE_THRESHOLD = 1e-30f;
-
-    if (glm::length2(rotatedSourcePosition) > SOURCE_DISTANCE_THRESHOLD) {
-        // produce an oriented angle about the y-axis
-        return glm::orientedAngle(glm::vec3(0.0f, 0.0f, -1.0f), glm::normalize(rotatedSourcePosition), glm::vec3(0.0f, -1.0f, 0.0f));
-    } else {
-        // there is no distance between listener and source - return no azimuth
-        return 0;
-    }
-}
-
-void AudioMixer::addStreamToMixForListeningNodeWithStream(AudioMixerClientData& listenerNodeData,
-                                                          const PositionalAudioStream& streamToAdd,
-                                                          const QUuid& sourceNodeID,
-                                                          const AvatarAudioStream& listeningNodeStream) {
-
-
-    // to reduce artifacts we calculate the gain and azimuth for every source for this listener
-    // even if we are not going to end up mixing in this source
-
-    ++_totalMixes;
-
-    // this ensures that the tail of any previously mixed audio or the first block of new audio sounds correct
-
-    // check if this is a server echo of a source back to itself
-    bool isEcho = (&streamToAdd == &listeningNodeStream);
-
-    // figure out the gain for this source at the listener
-    glm::vec3 relativePosition = streamToAdd.getPosition() - listeningNodeStream.getPosition();
-    float gain = gainForSource(streamToAdd, listeningNodeStream, relativePosition, isEcho);
-
-    // figure out the azimuth to this source at the listener
-    float azimuth = isEcho ? 0.0f : azimuthForSource(streamToAdd, listeningNodeStream, relativePosition);
-
-    float repeatedFrameFadeFactor = 1.0f;
-
-    static const int HRTF_DATASET_INDEX = 1;
-
-    if (!streamToAdd.lastPopSucceeded()) {
-        bool forceSilentBlock = true;
-
-        if (_streamSettings._repetitionWithFade && !streamToAdd.getLastPopOutput().isNull()) {
-
-            // reptition with fade is enabled, and we do have a valid previous frame to repeat
-            // so we mix the previously-mixed block
-
-            // this is preferable to not mixing it at all to avoid the harsh jump to silence
-
-            // we'll repeat the last block until it has a block to mix
-            // and we'll gradually fade that repeated block into silence.
-
-            // calculate its fade factor, which depends on how many times it's already been repeated.
-
-            repeatedFrameFadeFactor = calculateRepeatedFrameFadeFactor(streamToAdd.getConsecutiveNotMixedCount() - 1);
-            if (repeatedFrameFadeFactor > 0.0f) {
-                // apply the repeatedFrameFadeFactor to the gain
-                gain *= repeatedFrameFadeFactor;
-
-                forceSilentBlock = false;
-            }
-        }
-
-        if (forceSilentBlock) {
-            // we're deciding not to repeat either since we've already done it enough times or repetition with fade is disabled
-            // in this case we will call renderSilent with a forced silent block
-            // this ensures the correct tail from the previously mixed block and the correct spatialization of first block
-            // of any upcoming audio
-
-            if (!streamToAdd.isStereo() && !isEcho) {
-                // get the existing listener-source HRTF object, or create a new one
-                auto& hrtf = listenerNodeData.hrtfForStream(sourceNodeID, streamToAdd.getStreamIdentifier());
-
-                // this is not done for stereo streams since they do not go through the HRTF
-                static int16_t silentMonoBlock[AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL] = {};
-                hrtf.renderSilent(silentMonoBlock, _mixedSamples, HRTF_DATASET_INDEX, azimuth, gain,
-                                  AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-
-                ++_hrtfSilentRenders;;
-            }
-
-            return;
-        }
-    }
-
-    // grab the stream from the ring buffer
-    AudioRingBuffer::ConstIterator streamPopOutput = streamToAdd.getLastPopOutput();
-
-    if (streamToAdd.isStereo() || isEcho) {
-        // this is a stereo source or server echo so we do not pass it through the HRTF
-        // simply apply our calculated gain to each sample
-        if (streamToAdd.isStereo()) {
-            for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_STEREO; ++i) {
-                _mixedSamples[i] += float(streamPopOutput[i] * gain / AudioConstants::MAX_SAMPLE_VALUE);
-            }
-
-            ++_manualStereoMixes;
-        } else {
-            for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_STEREO; i += 2) {
-                auto monoSample = float(streamPopOutput[i / 2] * gain / AudioConstants::MAX_SAMPLE_VALUE);
-                _mixedSamples[i] += monoSample;
-                _mixedSamples[i + 1] += monoSample;
-            }
-
-            ++_manualEchoMixes;
-        }
-
-        return;
-    }
-
-    // get the existing listener-source HRTF object, or create a new one
-    auto& hrtf = listenerNodeData.hrtfForStream(sourceNodeID, streamToAdd.getStreamIdentifier());
-
-    static int16_t streamBlock[AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL];
-
-    streamPopOutput.readSamples(streamBlock, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-
-    // if the frame we're about to mix is silent, simply call render silent and move on
-    if (streamToAdd.getLastPopOutputLoudness() == 0.0f) {
-        // silent frame from source
-
-        // we still need to call renderSilent via the HRTF for mono source
-        hrtf.renderSilent(streamBlock, _mixedSamples, HRTF_DATASET_INDEX, azimuth, gain,
-                          AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-
-        ++_hrtfSilentRenders;
-
-        return;
-    }
-
-    if (_performanceThrottlingRatio > 0.0f
-        && streamToAdd.getLastPopOutputTrailingLoudness() / glm::length(relativePosition) <= _minAudibilityThreshold) {
-        // the mixer is struggling so we're going to drop off some streams
-
-        // we call renderSilent via the HRTF with the actual frame data and a gain of 0.0
-        hrtf.renderSilent(streamBlock, _mixedSamples, HRTF_DATASET_INDEX, azimuth, 0.0f,
-                          AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-
-        ++_hrtfStruggleRenders;
-
-        return;
-    }
-
-    ++_hrtfRenders;
-
-    // mono stream, call the HRTF with our block and calculated azimuth and gain
-    hrtf.render(streamBlock, _mixedSamples, HRTF_DATASET_INDEX, azimuth, gain,
-                AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
-}
-
-bool AudioMixer::prepareMixForListeningNode(Node* node) {
-    AvatarAudioStream* nodeAudioStream = static_cast<AudioMixerClientData*>(node->getLinkedData())->getAvatarAudioStream();
-    AudioMixerClientData* listenerNodeData = static_cast<AudioMixerClientData*>(node->getLinkedData());
-
-    // zero out the client mix for this node
-    memset(_mixedSamples, 0, sizeof(_mixedSamples));
-
-    // loop through all other nodes that have sufficient audio to mix
-
-    DependencyManager::get<NodeList>()->eachNode([&](const SharedNodePointer& otherNode){
-        if (otherNode->getLinkedData()) {
-            AudioMixerClientData* otherNodeClientData = (AudioMixerClientData*) otherNode->getLinkedData();
-
-            // enumerate the ARBs attached to the otherNode and add all that should be added to mix
-            auto streamsCopy = otherNodeClientData->getAudioStreams();
-
-            for (auto& streamPair : streamsCopy) {
-
-                auto otherNodeStream = streamPair.second;
-
-                if (*otherNode != *node || otherNodeStream->shouldLoopbackForNode()) {
-                    addStreamToMixForListeningNodeWithStream(*listenerNodeData, *otherNodeStream, otherNode->getUUID(),
-                                                             *nodeAudioStream);
-                }
-            }
-        }
-    });
-
-    int nonZeroSamples = 0;
-
-    // enumerate the mixed samples and clamp any samples outside the min/max
-    // also check if we ended up with a silent frame
-    for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_STEREO; ++i) {
-
-        _clampedSamples[i] = int16_t(glm::clamp(int(_mixedSamples[i] * AudioConstants::MAX_SAMPLE_VALUE),
-                                                AudioConstants::MIN_SAMPLE_VALUE,
-                                                AudioConstants::MAX_SAMPLE_VALUE));
-        if (_clampedSamples[i] != 0.0f) {
-            ++nonZeroSamples;
-        }
-    }
-
-    return (nonZeroSamples > 0);
-}
-
 void AudioMixer::sendAudioEnvironmentPacket(SharedNodePointer node) {
     // Send stream properties
     bool hasReverb = false;
@@ -423,6 +162,50 @@ void AudioMixer::handleNodeAudioPacket(QSharedPointer<ReceivedMessage> message,
     DependencyManager::get<NodeList>()->updateNodeWithDataFromPacket(message, sendingNode);
 }
 
+void AudioMixer::handleNegotiateAudioFormatPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
+    // the codecs the node supports, in its order of preference
+    quint8 numberOfCodecs = 0;
+    message->readPrimitive(&numberOfCodecs);
+
+    QStringList offeredCodecs;
+    for (quint8 i = 0; i < numberOfCodecs && message->getBytesLeftToRead() > 0; ++i) {
+        offeredCodecs << message->readString();
+    }
+
+    // the domain's preference wins over the node's, and PCM is used if there is nothing we both support
+    QStringList preferredCodecs = _codecPreferenceOrder.isEmpty() ? offeredCodecs : _codecPreferenceOrder;
+    AudioCodecPointer selectedCodec = AudioCodecs::selectCodec(preferredCodecs, offeredCodecs);
+
+    // nodes negotiate as soon as they connect, which can be before they have sent us any audio
+    auto nodeList = DependencyManager::get<NodeList>();
+    {
+        // the same lock LimitedNodeList::updateNodeWithDataFromPacket takes, so the data is only created once
+        QMutexLocker locker(&sendingNode->getMutex());
+        if (!sendingNode->getLinkedData() && nodeList->linkedDataCreateCallback) {
+            nodeList->linkedDataCreateCallback(sendingNode.data());
+        }
+    }
+
+    auto clientData = dynamic_cast<AudioMixerClientData*>(sendingNode->getLinkedData());
+    if (!clientData) {
+        return;
+    }
+
+    {
+        // packets are parsed into the mic stream under this lock, and its decoder is about to be replaced
+        QMutexLocker locker(&clientData->getMutex());
+        clientData->setCodec(selectedCodec);
+    }
+
+    qDebug() << "Selected codec" << clientData->getCodecName() << "for" << sendingNode->getUUID()
+        << "from" << offeredCodecs;
+
+    // this is sent reliably, since the node can't decode our mix until it knows which codec we selected
+    auto replyPacket = NLPacket::create(PacketType::SelectedAudioFormat, -1, true);
+    replyPacket->writeString(clientData->getCodecName());
+    nodeList->sendPacket(std::move(replyPacket), *sendingNode);
+}
+
 void AudioMixer::handleMuteEnvironmentPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
     auto nodeList = DependencyManager::get<NodeList>();
 
@@ -477,8 +260,8 @@ void AudioMixer::removeHRTFsForFinishedInjector(const QUuid& streamID) {
 }
 
 QString AudioMixer::percentageForMixStats(int counter) {
-    if (_totalMixes > 0) {
-        float mixPercentage = (float(counter) / _totalMixes) * 100.0f;
+    if (_stats.totalMixes > 0) {
+        float mixPercentage = (float(counter) / _stats.totalMixes) * 100.0f;
         return QString::number(mixPercentage, 'f', 2);
     } else {
         return QString("0.0");
@@ -492,31 +275,70 @@ void AudioMixer::sendStatsPacket() {
     statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100.0f;
     statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
 
-    statsObject["avg_listeners_per_frame"] = (float) _sumListeners / (float) _numStatFrames;
+    // sum the mix stats from each of our workers, and report how long each of them is taking to mix a frame
+    QJsonObject workerStats;
+    int workerIndex = 0;
 
-    QJsonObject mixStats;
-    mixStats["%_hrtf_mixes"] = percentageForMixStats(_hrtfRenders);
-    mixStats["%_hrtf_silent_mixes"] = percentageForMixStats(_hrtfSilentRenders);
-    mixStats["%_hrtf_struggle_mixes"] = percentageForMixStats(_hrtfStruggleRenders);
-    mixStats["%_manual_stereo_mixes"] = percentageForMixStats(_manualStereoMixes);
-    mixStats["%_manual_echo_mixes"] = percentageForMixStats(_manualEchoMixes);
+    _workerPool.forEachWorker([&](AudioMixerWorker& worker) {
+        _stats.accumulate(worker.stats);
+        worker.stats.reset();
 
-    mixStats["total_mixes"] = _totalMixes;
-    mixStats["avg_mixes_per_block"] = _totalMixes / _numStatFrames;
+        QJsonObject timingStats;
+        timingStats["avg_mix_usecs_per_frame"] = worker.timing.frames > 0
+            ? (double) worker.timing.sumMixUsecs / worker.timing.frames : 0.0;
+        timingStats["max_mix_usecs_per_frame"] = (double) worker.timing.maxMixUsecs;
+        timingStats["frames_over_deadline"] = worker.timing.framesOverDeadline;
+        worker.timing.reset();
+
+        workerStats[QString("worker_%1").arg(workerIndex++)] = timingStats;
+    });
+
+    statsObject["avg_listeners_per_frame"] = (float) _stats.sumListeners / (float) _numStatFrames;
+
+    QJsonObject mixStats;
+    mixStats["%_hrtf_mixes"] = percentageForMixStats(_stats.hrtfRenders);
+    mixStats["%_hrtf_silent_mixes"] = percentageForMixStats(_stats.hrtfSilentRenders);
+    mixStats["%_hrtf_struggle_mixes"] = percentageForMixStats(_stats.hrtfStruggleRenders);
+    mixStats["%_manual_stereo_mixes"] = percentageForMixStats(_stats.manualStereoMixes);
+    mixStats["%_manual_echo_mixes"] = percentageForMixStats(_stats.manualEchoMixes);
+
+    mixStats["total_mixes"] = _stats.totalMixes;
+    mixStats["avg_mixes_per_block"] = _stats.totalMixes / _numStatFrames;
+
+    // each source frame is converted to float once and then shared by every listener that mixes it
+    QJsonObject conversionStats;
+    conversionStats["conversions"] = _sourceList.getNumConversions();
+    conversionStats["conversions_saved"] = std::max(_stats.sourceBlockReads - _sourceList.getNumConversions(), 0);
+    mixStats["source_conversions"] = conversionStats;
+    _sourceList.resetStats();
+
+    mixStats["encoded_mixes"] = _stats.encodedMixes;
+    mixStats["avg_encoded_mix_bytes"] = _stats.encodedMixes > 0
+        ? (float) _stats.encodedMixBytes / _stats.encodedMixes : 0.0f;
+
+    mixStats["avg_sources_culled_per_listener"] = _stats.sumListeners > 0
+        ? (float) _stats.sourcesCulled / _stats.sumListeners : 0.0f;
+    mixStats["avg_sources_dropped_by_priority_per_listener"] = _stats.sumListeners > 0
+        ? (float) _stats.sourcesDroppedByPriority / _stats.sumListeners : 0.0f;
 
     statsObject["mix_stats"] = mixStats;
 
-    _sumListeners = 0;
-    _hrtfRenders = 0;
-    _hrtfSilentRenders = 0;
-    _hrtfStruggleRenders = 0;
-    _manualStereoMixes = 0;
-    _manualEchoMixes = 0;
-    _totalMixes = 0;
+    statsObject["mix_threads"] = _workerPool.numThreads();
+    statsObject["mix_workers"] = workerStats;
+
+    // everything this mixer wrote to its socket, and the system calls it took
+    auto nodeList = DependencyManager::get<NodeList>();
+    auto writeStats = nodeList->sampleSocketWriteStats();
+
+    QJsonObject egressStats;
+    egressStats["avg_datagrams_per_frame"] = _numStatFrames > 0 ? (float) writeStats.datagrams / _numStatFrames : 0.0f;
+    egressStats["avg_send_calls_per_frame"] = _numStatFrames > 0 ? (float) writeStats.systemCalls / _numStatFrames : 0.0f;
+    statsObject["egress"] = egressStats;
+
+    _stats.reset();
     _numStatFrames = 0;
 
     // add stats for each listerner
-    auto nodeList = DependencyManager::get<NodeList>();
     QJsonObject listenerStats;
 
     nodeList->eachNode([&](const SharedNodePointer& node) {
@@ -526,6 +348,7 @@ void AudioMixer::sendStatsPacket() {
             QString uuidString = uuidStringWithoutCurlyBraces(node->getUUID());
 
             nodeStats["outbound_kbps"] = node->getOutboundBandwidth();
+            nodeStats["codec"] = clientData->getCodecName();
             nodeStats[USERNAME_UUID_REPLACEMENT_STATS_KEY] = uuidString;
 
             nodeStats["jitter"] = clientData->getAudioStreamStats();
@@ -640,10 +463,15 @@ void AudioMixer::broadcastMixes() {
             ++framesSinceCutoffEvent;
         }
 
+        // first pop a frame from every stream, so that all of the listeners mix the same frame of each source
+        std::vector<SharedNodePointer> sourceNodes;
+        AudioMixerWorkerPool::ListenerList listeners;
+
         nodeList->eachNode([&](const SharedNodePointer& node) {
 
             if (node->getLinkedData()) {
                 AudioMixerClientData* nodeData = (AudioMixerClientData*)node->getLinkedData();
+                sourceNodes.push_back(node);
 
                 // this function will attempt to pop a frame from each audio stream.
                 // a pointer to the popped data is stored as a member in InboundAudioStream.
@@ -659,54 +487,41 @@ void AudioMixer::broadcastMixes() {
 
                 if (node->getType() == NodeType::Agent && node->getActiveSocket()
                     && nodeData->getAvatarAudioStream()) {
+                    listeners.push_back(node);
+                }
+            }
+        });
 
-                    bool mixHasAudio = prepareMixForListeningNode(node.data());
-
-                    std::unique_ptr<NLPacket> mixPacket;
-
-                    if (mixHasAudio) {
-                        int mixPacketBytes = sizeof(quint16) + AudioConstants::NETWORK_FRAME_BYTES_STEREO;
-                        mixPacket = NLPacket::create(PacketType::MixedAudio, mixPacketBytes);
-
-                        // pack sequence number
-                        quint16 sequence = nodeData->getOutgoingSequenceNumber();
-                        mixPacket->writePrimitive(sequence);
-
-                        // pack mixed audio samples
-                        mixPacket->write(reinterpret_cast<char*>(_clampedSamples),
-                                         AudioConstants::NETWORK_FRAME_BYTES_STEREO);
-                    } else {
-                        int silentPacketBytes = sizeof(quint16) + sizeof(quint16);
-                        mixPacket = NLPacket::create(PacketType::SilentAudioFrame, silentPacketBytes);
-
-                        // pack sequence number
-                        quint16 sequence = nodeData->getOutgoingSequenceNumber();
-                        mixPacket->writePrimitive(sequence);
+        // convert each popped frame once, for every listener to read
+        _sourceList.prepare(sourceNodes);
+        _sourceList.buildIndex(_audibleDistance);
 
-                        // pack number of silent audio samples
-                        quint16 numSilentSamples = AudioConstants::NETWORK_FRAME_SAMPLES_STEREO;
-                        mixPacket->writePrimitive(numSilentSamples);
-                    }
+        // have our workers prepare a mix for each listener
+        AudioMixerWorkerPool::MixPacketList mixPackets;
+        _workerPool.mix(listeners, _sourceList, mixPackets);
 
-                    // Send audio environment
-                    sendAudioEnvironmentPacket(node);
+        // and send the mixes out from here, since the node list and its socket belong to this thread
+        for (size_t i = 0; i < listeners.size(); ++i) {
+            auto& node = listeners[i];
+            AudioMixerClientData* nodeData = (AudioMixerClientData*)node->getLinkedData();
 
-                    // send mixed audio packet
-                    nodeList->sendPacket(std::move(mixPacket), *node);
-                    nodeData->incrementOutgoingMixedAudioSequenceNumber();
+            // Send audio environment
+            sendAudioEnvironmentPacket(node);
 
-                    // send an audio stream stats packet to the client approximately every second
-                    ++currentFrame;
-                    currentFrame %= numFramesPerSecond;
+            // queue the mixed audio packet, so that all of the frame's mixes go out together
+            nodeList->addToPacketBatch(_mixPacketBatch, std::move(mixPackets[i]), *node);
+            nodeData->incrementOutgoingMixedAudioSequenceNumber();
 
-                    if (nodeData->shouldSendStats(currentFrame)) {
-                        nodeData->sendAudioStreamStatsPackets(node);
-                    }
+            // send an audio stream stats packet to the client approximately every second
+            ++currentFrame;
+            currentFrame %= numFramesPerSecond;
 
-                    ++_sumListeners;
-                }
+            if (nodeData->shouldSendStats(currentFrame)) {
+                nodeData->sendAudioStreamStatsPackets(node);
             }
-        });
+        }
+
+        nodeList->sendPacketBatch(_mixPacketBatch);
 
         ++_numStatFrames;
 
@@ -732,6 +547,17 @@ void AudioMixer::broadcastMixes() {
 }
 
 void AudioMixer::parseSettingsObject(const QJsonObject &settingsObject) {
+    if (settingsObject.contains(AUDIO_THREADING_GROUP_KEY)) {
+        QJsonObject audioThreadingGroupObject = settingsObject[AUDIO_THREADING_GROUP_KEY].toObject();
+
+        const QString NUM_MIX_THREADS_JSON_KEY = "num_mix_threads";
+        bool ok;
+        int numMixThreads = audioThreadingGroupObject[NUM_MIX_THREADS_JSON_KEY].toString().toInt(&ok);
+        if (ok && numMixThreads >= 0) {
+            _workerPool.setNumThreads(numMixThreads);
+        }
+    }
+
     if (settingsObject.contains(AUDIO_BUFFER_GROUP_KEY)) {
         QJsonObject audioBufferGroupObject = settingsObject[AUDIO_BUFFER_GROUP_KEY].toObject();
 
@@ -820,6 +646,28 @@ void AudioMixer::parseSettingsObject(const QJsonObject &settingsObject) {
             }
         }
 
+        const QString MAX_SOURCES_PER_LISTENER = "max_sources_per_listener";
+        if (audioEnvGroupObject[MAX_SOURCES_PER_LISTENER].isString()) {
+            bool ok = false;
+            int maxSourcesPerListener = audioEnvGroupObject[MAX_SOURCES_PER_LISTENER].toString().toInt(&ok);
+            if (ok && maxSourcesPerListener >= 0) {
+                _maxSourcesPerListener = maxSourcesPerListener;
+                qDebug() << "Max sources per listener changed to" << _maxSourcesPerListener;
+            }
+        }
+
+        const QString CODEC_PREFERENCE_ORDER = "codec_preference_order";
+        if (audioEnvGroupObject[CODEC_PREFERENCE_ORDER].isString()) {
+            _codecPreferenceOrder.clear();
+
+            QStringList codecs = audioEnvGroupObject[CODEC_PREFERENCE_ORDER].toString().split(",", QString::SkipEmptyParts);
+            for (auto& codec : codecs) {
+                _codecPreferenceOrder << codec.trimmed().toLower();
+            }
+
+            qDebug() << "Codec preference order changed to" << _codecPreferenceOrder;
+        }
+
         const QString FILTER_KEY = "enable_filter";
         if (audioEnvGroupObject[FILTER_KEY].isBool()) {
             _enableFilter = audioEnvGroupObject[FILTER_KEY].toBool();
@@ -934,4 +782,29 @@ void AudioMixer::parseSettingsObject(const QJsonObject &settingsObject) {
             }
         }
     }
+
+    _audibleDistance = calculateAudibleDistance();
+    if (_audibleDistance > 0.0f) {
+        qDebug() << "Sources further than" << _audibleDistance << "from a listener will not be mixed for them";
+    } else {
+        qDebug() << "Sources are audible at any distance, every source will be considered for every listener";
+    }
+}
+
+float AudioMixer::calculateAudibleDistance() const {
+    // the least attenuation used anywhere in the domain is the one that is audible the furthest
+    float minAttenuation = _attenuationPerDoublingInDistance;
+    for (auto& zoneSettings : _zonesSettings) {
+        minAttenuation = std::min(minAttenuation, zoneSettings.coefficient);
+    }
+
+    if (minAttenuation <= 0.0f) {
+        // without any attenuation there is no distance at which a source can't be heard
+        return 0.0f;
+    }
+
+    // the gain of a source reaches 0 once it has doubled in distance 1/attenuation times
+    float audibleDistance = ATTENUATION_BEGINS_AT_DISTANCE * powf(2.0f, 1.0f / minAttenuation);
+
+    return std::isfinite(audibleDistance) ? audibleDistance : 0.0f;
 }
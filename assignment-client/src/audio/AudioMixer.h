@@ -17,6 +17,10 @@
 #include <AudioRingBuffer.h>
 #include <ThreadedAssignment.h>
 #include <UUIDHasher.h>
+#include <udt/Socket.h>
+
+#include "AudioMixerSourceList.h"
+#include "AudioMixerWorkerPool.h"
 
 class PositionalAudioStream;
 class AvatarAudioStream;
@@ -25,6 +29,8 @@ class AudioMixerClientData;
 
 const int SAMPLE_PHASE_DELAY_AT_90 = 20;
 
+const float ATTENUATION_BEGINS_AT_DISTANCE = 1.0f;
+
 const int READ_DATAGRAMS_STATS_WINDOW_SECONDS = 30;
 
 /// Handles assignments of type AudioMixer - mixing streams of audio and re-distributing to various clients.
@@ -45,26 +51,16 @@ private slots:
     void broadcastMixes();
     void handleNodeAudioPacket(QSharedPointer<ReceivedMessage> packet, SharedNodePointer sendingNode);
     void handleMuteEnvironmentPacket(QSharedPointer<ReceivedMessage> packet, SharedNodePointer sendingNode);
+    void handleNegotiateAudioFormatPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
     void handleNodeKilled(SharedNodePointer killedNode);
 
     void removeHRTFsForFinishedInjector(const QUuid& streamID);
 
 private:
-    void domainSettingsRequestComplete();
-    
-    /// adds one stream to the mix for a listening node
-    void addStreamToMixForListeningNodeWithStream(AudioMixerClientData& listenerNodeData,
-                                                  const PositionalAudioStream& streamToAdd,
-                                                  const QUuid& sourceNodeID,
-                                                  const AvatarAudioStream& listeningNodeStream);
+    // workers read the mixer settings while mixing
+    friend class AudioMixerWorker;
 
-    float gainForSource(const PositionalAudioStream& streamToAdd, const AvatarAudioStream& listeningNodeStream,
-                        const glm::vec3& relativePosition, bool isEcho);
-    float azimuthForSource(const PositionalAudioStream& streamToAdd, const AvatarAudioStream& listeningNodeStream,
-                           const glm::vec3& relativePosition);
-
-    /// prepares and sends a mix to one Node
-    bool prepareMixForListeningNode(Node* node);
+    void domainSettingsRequestComplete();
 
     /// Send Audio Environment packet for a single node
     void sendAudioEnvironmentPacket(SharedNodePointer node);
@@ -77,22 +73,19 @@ private:
 
     void parseSettingsObject(const QJsonObject& settingsObject);
 
+    /// the distance past which no source can be heard, given the attenuation of the domain and its zones
+    float calculateAudibleDistance() const;
+
     float _trailingSleepRatio;
     float _minAudibilityThreshold;
     float _performanceThrottlingRatio;
     float _attenuationPerDoublingInDistance;
     float _noiseMutingThreshold;
+    float _audibleDistance { 0.0f };
+    int _maxSourcesPerListener { 0 };
+    QStringList _codecPreferenceOrder; // the codecs this mixer will select, empty for all of them
     int _numStatFrames { 0 };
-    int _sumListeners { 0 };
-    int _hrtfRenders { 0 };
-    int _hrtfSilentRenders { 0 };
-    int _hrtfStruggleRenders { 0 };
-    int _manualStereoMixes { 0 };
-    int _manualEchoMixes { 0 };
-    int _totalMixes { 0 };
-
-    float _mixedSamples[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
-    int16_t _clampedSamples[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    AudioMixerStats _stats;
 
     QHash<QString, AABox> _audioZones;
     struct ZonesSettings {
@@ -108,6 +101,11 @@ private:
     };
     QVector<ReverbSettings> _zoneReverbSettings;
 
+    AudioMixerSourceList _sourceList;
+    AudioMixerWorkerPool _workerPool { *this };
+
+    udt::PacketBatch _mixPacketBatch; // kept between frames so that it keeps its capacity
+
     static InboundAudioStream::Settings _streamSettings;
 
     static bool _enableFilter;
@@ -64,6 +64,25 @@ void AudioMixerClientData::removeHRTFForStream(const QUuid& nodeID, const QUuid&
     }
 }
 
+void AudioMixerClientData::removeHRTFsIf(const HRTFPredicate& shouldRemove) {
+    for (auto nodeIt = _nodeSourcesHRTFMap.begin(); nodeIt != _nodeSourcesHRTFMap.end();) {
+        auto& hrtfMap = nodeIt->second;
+        for (auto streamIt = hrtfMap.begin(); streamIt != hrtfMap.end();) {
+            if (shouldRemove(nodeIt->first, streamIt->first, streamIt->second)) {
+                streamIt = hrtfMap.erase(streamIt);
+            } else {
+                ++streamIt;
+            }
+        }
+
+        if (hrtfMap.empty()) {
+            nodeIt = _nodeSourcesHRTFMap.erase(nodeIt);
+        } else {
+            ++nodeIt;
+        }
+    }
+}
+
 int AudioMixerClientData::parseData(ReceivedMessage& message) {
     PacketType packetType = message.getType();
     
@@ -92,18 +111,22 @@ int AudioMixerClientData::parseData(ReceivedMessage& message) {
             if (micStreamIt == _audioStreams.end()) {
                 // we don't have a mic stream yet, so add it
 
-                // read the channel flag to see if our stream is stereo or not
+                // read the channel flag to see if our stream is stereo or not, it follows the sequence number and codec
                 message.seek(sizeof(quint16));
+                message.readString();
 
                 quint8 channelFlag;
                 message.readPrimitive(&channelFlag);
 
                 bool isStereo = channelFlag == 1;
 
-                auto emplaced = _audioStreams.emplace(
-                    QUuid(),
-                    std::unique_ptr<PositionalAudioStream> { new AvatarAudioStream(isStereo, AudioMixer::getStreamSettings()) }
-                );
+                std::unique_ptr<PositionalAudioStream> micStream { new AvatarAudioStream(isStereo, AudioMixer::getStreamSettings()) };
+
+                if (_codec) {
+                    micStream->setCodec(_codec->getName(), _codec->createDecoder());
+                }
+
+                auto emplaced = _audioStreams.emplace(QUuid(), std::move(micStream));
 
                 micStreamIt = emplaced.first;
             }
@@ -189,6 +212,20 @@ void AudioMixerClientData::checkBuffersBeforeFrameSend() {
     }
 }
 
+void AudioMixerClientData::setCodec(AudioCodecPointer codec) {
+    _codec = codec;
+    _encoder = codec ? codec->createEncoder() : AudioEncoderPointer();
+
+    // this replaces the decoder of the mic stream, so it can't happen while the stream is being read
+    QWriteLocker writeLock { &_streamsLock };
+
+    // every frame names its codec, so frames that were sent before the switch are still read right
+    auto micStreamIt = _audioStreams.find(QUuid());
+    if (micStreamIt != _audioStreams.end()) {
+        micStreamIt->second->setCodec(getCodecName(), codec ? codec->createDecoder() : AudioDecoderPointer());
+    }
+}
+
 bool AudioMixerClientData::shouldSendStats(int frameNumber) {
     return frameNumber == _frameToSendStats;
 }
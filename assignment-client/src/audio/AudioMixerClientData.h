@@ -12,9 +12,12 @@
 #ifndef hifi_AudioMixerClientData_h
 #define hifi_AudioMixerClientData_h
 
+#include <functional>
+
 #include <QtCore/QJsonObject>
 
 #include <AABox.h>
+#include <AudioCodec.h>
 #include <AudioHRTF.h>
 #include <UUIDHasher.h>
 
@@ -44,6 +47,10 @@ public:
 
     // removes an AudioHRTF object for a given stream
     void removeHRTFForStream(const QUuid& nodeID, const QUuid& streamID = QUuid());
+
+    // calls shouldRemove with each HRTF object, and removes those it returns true for
+    using HRTFPredicate = std::function<bool(const QUuid& nodeID, const QUuid& streamID, AudioHRTF& hrtf)>;
+    void removeHRTFsIf(const HRTFPredicate& shouldRemove);
     
     int parseData(ReceivedMessage& message);
 
@@ -61,6 +68,14 @@ public:
     // uses randomization to have the AudioMixer send a stats packet to this node around every second
     bool shouldSendStats(int frameNumber);
 
+    // the codec negotiated with this node for its microphone stream and its mix
+    void setCodec(AudioCodecPointer codec);
+    QString getCodecName() const { return _codec ? _codec->getName() : AudioCodecs::PCM_CODEC_NAME; }
+
+    // encodes the mix sent to this node, nullptr when it is sent as raw PCM
+    // only used by the AudioMixerWorker mixing this node as a listener
+    AudioEncoder* getEncoder() { return _encoder.get(); }
+
 signals:
     void injectorStreamFinished(const QUuid& streamIdentifier);
 
@@ -77,6 +92,9 @@ private:
     AudioStreamStats _downstreamAudioStreamStats;
 
     int _frameToSendStats { 0 };
+
+    AudioCodecPointer _codec;
+    AudioEncoderPointer _encoder;
 };
 
 #endif // hifi_AudioMixerClientData_h
@@ -0,0 +1,183 @@
+//
+//  AudioMixerSourceList.cpp
+//  assignment-client/src/audio
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include <AudioMixKernels.h>
+
+#include "AudioMixer.h"
+
+#include "AudioMixerSourceList.h"
+
+static const size_t CACHE_LINE_BYTES = 64;
+static const size_t CACHE_LINE_FLOATS = CACHE_LINE_BYTES / sizeof(float);
+
+// big enough for a stereo frame, and a whole number of cache lines so that every block stays aligned
+static const size_t SOURCE_BLOCK_FLOATS = ((AudioConstants::NETWORK_FRAME_SAMPLES_STEREO + CACHE_LINE_FLOATS - 1)
+                                           / CACHE_LINE_FLOATS) * CACHE_LINE_FLOATS;
+
+float* AudioMixerSourceList::blockForSource(int sourceIndex) {
+    return _sampleStorage.data() + _sampleStorageOffset + sourceIndex * SOURCE_BLOCK_FLOATS;
+}
+
+void AudioMixerSourceList::prepare(const std::vector<SharedNodePointer>& nodes) {
+    _sources.clear();
+    _sourcesByNode.clear();
+
+    for (auto& node : nodes) {
+        auto clientData = static_cast<AudioMixerClientData*>(node->getLinkedData());
+        int firstSource = (int) _sources.size();
+
+        for (auto& streamPair : clientData->getAudioStreams()) {
+            AudioMixerSource source;
+            source.nodeID = node->getUUID();
+            source.stream = streamPair.second;
+            source.position = streamPair.second->getPosition();
+            _sources.push_back(source);
+        }
+
+        _sourcesByNode[node->getUUID()] = { firstSource, (int) _sources.size() - firstSource };
+    }
+
+    // grow the sample storage if we need to - it is never shrunk, so this is rare once the domain has filled up
+    size_t requiredFloats = _sources.size() * SOURCE_BLOCK_FLOATS + CACHE_LINE_FLOATS;
+    if (_sampleStorage.size() < requiredFloats) {
+        _sampleStorage.resize(requiredFloats);
+
+        auto address = reinterpret_cast<size_t>(_sampleStorage.data());
+        _sampleStorageOffset = ((CACHE_LINE_BYTES - (address % CACHE_LINE_BYTES)) % CACHE_LINE_BYTES) / sizeof(float);
+    }
+
+    const bool repetitionWithFade = AudioMixer::getStreamSettings()._repetitionWithFade;
+
+    int16_t streamBlock[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+
+    for (int i = 0; i < (int) _sources.size(); ++i) {
+        auto& source = _sources[i];
+        auto& stream = *source.stream;
+
+        source.isStereo = stream.isStereo();
+        source.hasFrame = stream.lastPopSucceeded();
+
+        if (!source.hasFrame && repetitionWithFade && !stream.getLastPopOutput().isNull()) {
+            // reptition with fade is enabled, and we do have a valid previous frame to repeat
+            // so we mix the previously-mixed block, gradually fading it into silence
+            // the fade factor depends on how many times it's already been repeated
+            source.repeatedFrameFadeFactor = calculateRepeatedFrameFadeFactor(stream.getConsecutiveNotMixedCount() - 1);
+            source.hasFrame = source.repeatedFrameFadeFactor > 0.0f;
+        }
+
+        if (!source.hasFrame) {
+            continue;
+        }
+
+        source.loudness = stream.getLastPopOutputLoudness();
+        source.trailingLoudness = stream.getLastPopOutputTrailingLoudness();
+        source.isSilent = source.loudness == 0.0f;
+
+        float* samples = blockForSource(i);
+        int numSamples = source.isStereo ? AudioConstants::NETWORK_FRAME_SAMPLES_STEREO
+            : AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL;
+
+        if (source.isSilent) {
+            memset(samples, 0, numSamples * sizeof(float));
+        } else {
+            // grab the frame from the ring buffer and convert it to float, once for every listener
+            AudioRingBuffer::ConstIterator streamPopOutput = stream.getLastPopOutput();
+            streamPopOutput.readSamples(streamBlock, numSamples);
+
+            AudioMixKernels::convertToFloat(streamBlock, samples, numSamples);
+
+            ++_numConversions;
+        }
+
+        source.samples = samples;
+    }
+}
+
+int AudioMixerSourceList::findSource(const QUuid& nodeID, const QUuid& streamID) const {
+    auto it = _sourcesByNode.find(nodeID);
+    if (it == _sourcesByNode.end()) {
+        return -1;
+    }
+
+    for (int i = it->second.first; i < it->second.first + it->second.second; ++i) {
+        if (_sources[i].stream->getStreamIdentifier() == streamID) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// each cell coordinate is packed into 21 bits of the key, which at the smallest audible distance we allow
+// still covers every position in the domain
+static const int CELL_COORDINATE_BITS = 21;
+static const int CELL_COORDINATE_OFFSET = 1 << (CELL_COORDINATE_BITS - 1);
+static const int CELL_COORDINATE_MAX = (1 << CELL_COORDINATE_BITS) - 1;
+
+glm::ivec3 AudioMixerSourceList::cellForPosition(const glm::vec3& position) const {
+    glm::vec3 cell = glm::floor(position / _cellSize) + glm::vec3((float) CELL_COORDINATE_OFFSET);
+    return glm::clamp(glm::ivec3(cell), glm::ivec3(0), glm::ivec3(CELL_COORDINATE_MAX));
+}
+
+AudioMixerSourceList::CellKey AudioMixerSourceList::keyForCell(const glm::ivec3& cell) const {
+    return ((CellKey) cell.x << (2 * CELL_COORDINATE_BITS)) | ((CellKey) cell.y << CELL_COORDINATE_BITS) | (CellKey) cell.z;
+}
+
+void AudioMixerSourceList::buildIndex(float audibleDistance) {
+    _cellIndex.clear();
+
+    if (audibleDistance <= 0.0f || !std::isfinite(audibleDistance)) {
+        _cellSize = 0.0f;
+        return;
+    }
+
+    _cellSize = audibleDistance;
+
+    for (int i = 0; i < (int) _sources.size(); ++i) {
+        _cellIndex.emplace_back(keyForCell(cellForPosition(_sources[i].position)), i);
+    }
+
+    std::sort(_cellIndex.begin(), _cellIndex.end());
+}
+
+void AudioMixerSourceList::findAudibleSources(const glm::vec3& position, std::vector<int>& indices) const {
+    assert(isIndexed());
+
+    indices.clear();
+
+    // with cells as wide as the audible distance, every audible source is in the cell of the position or a neighbour
+    glm::ivec3 centerCell = cellForPosition(position);
+    float audibleDistanceSquared = _cellSize * _cellSize;
+
+    for (int x = -1; x <= 1; ++x) {
+        for (int y = -1; y <= 1; ++y) {
+            for (int z = -1; z <= 1; ++z) {
+                glm::ivec3 cell = centerCell + glm::ivec3(x, y, z);
+
+                if (glm::any(glm::lessThan(cell, glm::ivec3(0)))
+                    || glm::any(glm::greaterThan(cell, glm::ivec3(CELL_COORDINATE_MAX)))) {
+                    continue;
+                }
+
+                CellKey key = keyForCell(cell);
+
+                auto it = std::lower_bound(_cellIndex.begin(), _cellIndex.end(), std::make_pair(key, 0));
+                for (; it != _cellIndex.end() && it->first == key; ++it) {
+                    glm::vec3 offset = _sources[it->second].position - position;
+                    if (glm::dot(offset, offset) <= audibleDistanceSquared) {
+                        indices.push_back(it->second);
+                    }
+                }
+            }
+        }
+    }
+}
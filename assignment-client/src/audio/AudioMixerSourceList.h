@@ -0,0 +1,98 @@
+//
+//  AudioMixerSourceList.h
+//  assignment-client/src/audio
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioMixerSourceList_h
+#define hifi_AudioMixerSourceList_h
+
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <AudioConstants.h>
+#include <Node.h>
+
+#include "AudioMixerClientData.h"
+
+// one source stream's frame, popped and converted to float once and then read (never written) by every listener's mix
+struct AudioMixerSource {
+    QUuid nodeID;
+    AudioMixerClientData::SharedStreamPointer stream; // holds the stream for the rest of the frame
+    glm::vec3 position;
+
+    // NETWORK_FRAME_SAMPLES_PER_CHANNEL for a mono stream or NETWORK_FRAME_SAMPLES_STEREO for a stereo one,
+    // converted from int16 to [-1.0, 1.0) and aligned to a cache line
+    const float* samples { nullptr };
+
+    float loudness { 0.0f };
+    float trailingLoudness { 0.0f };
+
+    // applied to the gain of a repeated frame, when repetition with fade is enabled and the pop failed
+    float repeatedFrameFadeFactor { 1.0f };
+
+    bool hasFrame { false }; // false when there is nothing to mix, listeners only flush their HRTF for this source
+    bool isSilent { false };
+    bool isStereo { false };
+};
+
+/// Prepares each source once per frame so that the AudioMixerWorkers mixing each listener only read the result.
+class AudioMixerSourceList {
+public:
+    using SourceVector = std::vector<AudioMixerSource>;
+
+    AudioMixerSourceList() {}
+
+    /// called from the AudioMixer thread once the frames have been popped, and before any listener is mixed
+    void prepare(const std::vector<SharedNodePointer>& nodes);
+
+    const SourceVector& getSources() const { return _sources; }
+
+    /// returns the index of the given stream of the given node, or -1 if it has no source this frame
+    int findSource(const QUuid& nodeID, const QUuid& streamID) const;
+
+    /// buckets the prepared sources in a grid of cells as wide as the audible distance,
+    /// a non-positive or infinite audible distance leaves the sources unindexed
+    void buildIndex(float audibleDistance);
+    bool isIndexed() const { return _cellSize > 0.0f; }
+
+    /// fills indices with the index of each source within the audible distance of the given position
+    /// must only be called once the index has been built
+    void findAudibleSources(const glm::vec3& position, std::vector<int>& indices) const;
+
+    // conversions of source frames to float since the last reset, for the AudioMixer stats
+    int getNumConversions() const { return _numConversions; }
+    void resetStats() { _numConversions = 0; }
+
+private:
+    AudioMixerSourceList(const AudioMixerSourceList&) = delete;
+    AudioMixerSourceList& operator=(const AudioMixerSourceList&) = delete;
+
+    float* blockForSource(int sourceIndex);
+
+    SourceVector _sources;
+
+    // the sources of a node are next to each other, this is where they start and how many there are
+    std::unordered_map<QUuid, std::pair<int, int>> _sourcesByNode;
+
+    std::vector<float> _sampleStorage; // one block per source, offset to a cache line boundary
+    size_t _sampleStorageOffset { 0 };
+
+    using CellKey = uint64_t;
+    CellKey keyForCell(const glm::ivec3& cell) const;
+    glm::ivec3 cellForPosition(const glm::vec3& position) const;
+
+    // (cell key, source index) pairs, sorted by cell so that the sources in a cell are found with a binary search
+    std::vector<std::pair<CellKey, int>> _cellIndex;
+    float _cellSize { 0.0f };
+
+    int _numConversions { 0 };
+};
+
+#endif // hifi_AudioMixerSourceList_h
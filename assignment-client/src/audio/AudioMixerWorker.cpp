@@ -0,0 +1,416 @@
+//
+//  AudioMixerWorker.cpp
+//  assignment-client/src/audio
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <glm/gtx/norm.hpp>
+#include <glm/gtx/vector_angle.hpp>
+
+#include <AudioMixKernels.h>
+#include <udt/PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "AudioMixer.h"
+#include "AudioMixerClientData.h"
+#include "AvatarAudioStream.h"
+#include "InjectedAudioStream.h"
+
+#include "AudioMixerWorker.h"
+
+void AudioMixerStats::accumulate(const AudioMixerStats& otherStats) {
+    sumListeners += otherStats.sumListeners;
+    totalMixes += otherStats.totalMixes;
+    hrtfRenders += otherStats.hrtfRenders;
+    hrtfSilentRenders += otherStats.hrtfSilentRenders;
+    hrtfStruggleRenders += otherStats.hrtfStruggleRenders;
+    manualStereoMixes += otherStats.manualStereoMixes;
+    manualEchoMixes += otherStats.manualEchoMixes;
+    sourceBlockReads += otherStats.sourceBlockReads;
+    sourcesCulled += otherStats.sourcesCulled;
+    sourcesDroppedByPriority += otherStats.sourcesDroppedByPriority;
+    encodedMixes += otherStats.encodedMixes;
+    encodedMixBytes += otherStats.encodedMixBytes;
+}
+
+void AudioMixerWorkerTiming::addFrame(quint64 mixUsecs) {
+    ++frames;
+    sumMixUsecs += mixUsecs;
+    maxMixUsecs = std::max(maxMixUsecs, mixUsecs);
+
+    if (mixUsecs > (quint64) AudioConstants::NETWORK_FRAME_USECS) {
+        ++framesOverDeadline;
+    }
+}
+
+static const int HRTF_DATASET_INDEX = 1;
+
+// used to flush the HRTF for a source that has nothing to mix
+static const float SILENT_MONO_BLOCK[AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL] = {};
+
+float AudioMixerWorker::gainForSource(const PositionalAudioStream& streamToAdd,
+                                      const AvatarAudioStream& listeningNodeStream, const glm::vec3& relativePosition,
+                                      bool isEcho) {
+    float gain = 1.0f;
+
+    float distanceBetween = glm::length(relativePosition);
+
+    if (distanceBetween < EPSILON) {
+        distanceBetween = EPSILON;
+    }
+
+    if (streamToAdd.getType() == PositionalAudioStream::Injector) {
+        gain *= reinterpret_cast<const InjectedAudioStream*>(&streamToAdd)->getAttenuationRatio();
+    }
+
+    if (!isEcho && (streamToAdd.getType() == PositionalAudioStream::Microphone)) {
+        //  source is another avatar, apply fixed off-axis attenuation to make them quieter as they turn away from listener
+        glm::vec3 rotatedListenerPosition = glm::inverse(streamToAdd.getOrientation()) * relativePosition;
+
+        float angleOfDelivery = glm::angle(glm::vec3(0.0f, 0.0f, -1.0f),
+                                           glm::normalize(rotatedListenerPosition));
+
+        const float MAX_OFF_AXIS_ATTENUATION = 0.2f;
+        const float OFF_AXIS_ATTENUATION_FORMULA_STEP = (1 - MAX_OFF_AXIS_ATTENUATION) / 2.0f;
+
+        float offAxisCoefficient = MAX_OFF_AXIS_ATTENUATION +
+        (OFF_AXIS_ATTENUATION_FORMULA_STEP * (angleOfDelivery / PI_OVER_TWO));
+
+        // multiply the current attenuation coefficient by the calculated off axis coefficient
+        gain *= offAxisCoefficient;
+    }
+
+    // the zones are only read here, so use the const accessors since other workers are reading them at the same time
+    const auto& audioZones = _mixer._audioZones;
+    const auto& zonesSettings = _mixer._zonesSettings;
+
+    float attenuationPerDoublingInDistance = _mixer._attenuationPerDoublingInDistance;
+    for (int i = 0; i < zonesSettings.length(); ++i) {
+        if (audioZones[zonesSettings[i].source].contains(streamToAdd.getPosition()) &&
+            audioZones[zonesSettings[i].listener].contains(listeningNodeStream.getPosition())) {
+            attenuationPerDoublingInDistance = zonesSettings[i].coefficient;
+            break;
+        }
+    }
+
+    if (distanceBetween >= ATTENUATION_BEGINS_AT_DISTANCE) {
+        // calculate the distance coefficient using the distance to this node
+        float distanceCoefficient = 1.0f - (logf(distanceBetween / ATTENUATION_BEGINS_AT_DISTANCE) / logf(2.0f)
+                                            * attenuationPerDoublingInDistance);
+
+        if (distanceCoefficient < 0) {
+            distanceCoefficient = 0;
+        }
+
+        // multiply the current attenuation coefficient by the distance coefficient
+        gain *= distanceCoefficient;
+    }
+
+    return gain;
+}
+
+float AudioMixerWorker::azimuthForSource(const PositionalAudioStream& streamToAdd,
+                                         const AvatarAudioStream& listeningNodeStream,
+                                         const glm::vec3& relativePosition) {
+    glm::quat inverseOrientation = glm::inverse(listeningNodeStream.getOrientation());
+
+    //  Compute sample delay for the two ears to create phase panning
+    glm::vec3 rotatedSourcePosition = inverseOrientation * relativePosition;
+
+    // project the rotated source position vector onto the XZ plane
+    rotatedSourcePosition.y = 0.0f;
+
+    static const float SOURCE_DISTANCE_THRESHOLD = 1e-30f;
+
+    if (glm::length2(rotatedSourcePosition) > SOURCE_DISTANCE_THRESHOLD) {
+        // produce an oriented angle about the y-axis
+        return glm::orientedAngle(glm::vec3(0.0f, 0.0f, -1.0f), glm::normalize(rotatedSourcePosition), glm::vec3(0.0f, -1.0f, 0.0f));
+    } else {
+        // there is no distance between listener and source - return no azimuth
+        return 0;
+    }
+}
+
+void AudioMixerWorker::addSourceToMixForListeningNode(AudioMixerClientData& listenerNodeData,
+                                                      const AudioMixerSource& source,
+                                                      const AvatarAudioStream& listeningNodeStream,
+                                                      bool isDroppedByPriority) {
+
+    const PositionalAudioStream& streamToAdd = *source.stream;
+
+    // to reduce artifacts we calculate the gain and azimuth for every source for this listener
+    // even if we are not going to end up mixing in this source
+
+    ++stats.totalMixes;
+
+    // this ensures that the tail of any previously mixed audio or the first block of new audio sounds correct
+
+    // check if this is a server echo of a source back to itself
+    bool isEcho = (&streamToAdd == &listeningNodeStream);
+
+    // figure out the gain for this source at the listener
+    glm::vec3 relativePosition = streamToAdd.getPosition() - listeningNodeStream.getPosition();
+    float gain = gainForSource(streamToAdd, listeningNodeStream, relativePosition, isEcho);
+
+    // figure out the azimuth to this source at the listener
+    float azimuth = isEcho ? 0.0f : azimuthForSource(streamToAdd, listeningNodeStream, relativePosition);
+
+    if (isDroppedByPriority) {
+        // this listener already has its maximum number of sources to mix, and this is not one of them
+        // we call renderSilent via the HRTF with a gain of 0.0 so that it fades out instead of cutting off
+        if (!source.isStereo && !isEcho) {
+            auto& hrtf = listenerNodeData.hrtfForStream(source.nodeID, streamToAdd.getStreamIdentifier());
+            hrtf.renderSilent(SILENT_MONO_BLOCK, _mixedSamples, HRTF_DATASET_INDEX, azimuth, 0.0f,
+                              AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+        }
+
+        ++stats.sourcesDroppedByPriority;
+
+        return;
+    }
+
+    if (!source.hasFrame) {
+        // the pop failed and we're not repeating the last frame, either since we've already done it enough times
+        // or repetition with fade is disabled
+        // in this case we will call renderSilent with a forced silent block
+        // this ensures the correct tail from the previously mixed block and the correct spatialization of first block
+        // of any upcoming audio
+
+        if (!source.isStereo && !isEcho) {
+            // get the existing listener-source HRTF object, or create a new one
+            auto& hrtf = listenerNodeData.hrtfForStream(source.nodeID, streamToAdd.getStreamIdentifier());
+
+            // this is not done for stereo streams since they do not go through the HRTF
+            hrtf.renderSilent(SILENT_MONO_BLOCK, _mixedSamples, HRTF_DATASET_INDEX, azimuth, gain,
+                              AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+
+            ++stats.hrtfSilentRenders;
+        }
+
+        return;
+    }
+
+    // when repeating the last frame this fades it into silence
+    gain *= source.repeatedFrameFadeFactor;
+
+    // every read of the prepared block below is an int16 to float conversion we didn't have to do for this listener
+    ++stats.sourceBlockReads;
+
+    if (source.isStereo || isEcho) {
+        // this is a stereo source or server echo so we do not pass it through the HRTF
+        // simply apply our calculated gain to each sample
+        if (source.isStereo) {
+            AudioMixKernels::accumulate(source.samples, _mixedSamples, gain, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+
+            ++stats.manualStereoMixes;
+        } else {
+            AudioMixKernels::accumulateMonoToStereo(source.samples, _mixedSamples, gain,
+                                                    AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+
+            ++stats.manualEchoMixes;
+        }
+
+        return;
+    }
+
+    // get the existing listener-source HRTF object, or create a new one
+    auto& hrtf = listenerNodeData.hrtfForStream(source.nodeID, streamToAdd.getStreamIdentifier());
+
+    // if the frame we're about to mix is silent, simply call render silent and move on
+    if (source.isSilent) {
+        // silent frame from source
+
+        // we still need to call renderSilent via the HRTF for mono source
+        hrtf.renderSilent(source.samples, _mixedSamples, HRTF_DATASET_INDEX, azimuth, gain,
+                          AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+
+        ++stats.hrtfSilentRenders;
+
+        return;
+    }
+
+    if (_mixer._performanceThrottlingRatio > 0.0f
+        && source.trailingLoudness / glm::length(relativePosition) <= _mixer._minAudibilityThreshold) {
+        // the mixer is struggling so we're going to drop off some streams
+
+        // we call renderSilent via the HRTF with the actual frame data and a gain of 0.0
+        hrtf.renderSilent(source.samples, _mixedSamples, HRTF_DATASET_INDEX, azimuth, 0.0f,
+                          AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+
+        ++stats.hrtfStruggleRenders;
+
+        return;
+    }
+
+    ++stats.hrtfRenders;
+
+    // mono stream, call the HRTF with our block and calculated azimuth and gain
+    hrtf.render(source.samples, _mixedSamples, HRTF_DATASET_INDEX, azimuth, gain,
+                AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+}
+
+bool AudioMixerWorker::prepareMixForListeningNode(Node* node, const AudioMixerSourceList& sources) {
+    AvatarAudioStream* nodeAudioStream = static_cast<AudioMixerClientData*>(node->getLinkedData())->getAvatarAudioStream();
+    AudioMixerClientData* listenerNodeData = static_cast<AudioMixerClientData*>(node->getLinkedData());
+
+    // zero out the client mix for this node
+    memset(_mixedSamples, 0, sizeof(_mixedSamples));
+
+    const auto& allSources = sources.getSources();
+
+    // find the sources this listener could hear - if they are indexed we only look at those within the audible distance
+    _sourceIndices.clear();
+    if (sources.isIndexed()) {
+        sources.findAudibleSources(nodeAudioStream->getPosition(), _sourceIndices);
+    } else {
+        for (int i = 0; i < (int) allSources.size(); ++i) {
+            _sourceIndices.push_back(i);
+        }
+    }
+
+    stats.sourcesCulled += (int) (allSources.size() - _sourceIndices.size());
+
+    if (sources.isIndexed()) {
+        // a source this listener heard that has gone past the audible distance gets one last silent render
+        // through its HRTF so that it fades out instead of cutting off, and its HRTF is then dropped so that
+        // it starts over without the stale state if it comes back in range
+        if (_audibleSourceMarks.size() < allSources.size()) {
+            _audibleSourceMarks.resize(allSources.size(), 0);
+        }
+        ++_audibleSourceMark;
+        for (int index : _sourceIndices) {
+            _audibleSourceMarks[index] = _audibleSourceMark;
+        }
+
+        listenerNodeData->removeHRTFsIf([&](const QUuid& nodeID, const QUuid& streamID, AudioHRTF& hrtf) {
+            int index = sources.findSource(nodeID, streamID);
+            if (index < 0 || _audibleSourceMarks[index] == _audibleSourceMark) {
+                return false;
+            }
+
+            const auto& stream = *allSources[index].stream;
+            glm::vec3 relativePosition = stream.getPosition() - nodeAudioStream->getPosition();
+            float azimuth = azimuthForSource(stream, *nodeAudioStream, relativePosition);
+            hrtf.renderSilent(SILENT_MONO_BLOCK, _mixedSamples, HRTF_DATASET_INDEX, azimuth, 0.0f,
+                              AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+            return true;
+        });
+    }
+
+    // the listener's own streams are only mixed if they ask to be looped back
+    _sourceIndices.erase(std::remove_if(_sourceIndices.begin(), _sourceIndices.end(), [&](int index) {
+        const auto& source = allSources[index];
+        return source.nodeID == node->getUUID() && !source.stream->shouldLoopbackForNode();
+    }), _sourceIndices.end());
+
+    // if there are more than the max sources per listener, put the highest priority sources at the front
+    int numSourcesToMix = (int) _sourceIndices.size();
+    int maxSourcesPerListener = _mixer._maxSourcesPerListener;
+
+    if (maxSourcesPerListener > 0 && numSourcesToMix > maxSourcesPerListener) {
+        _prioritizedSources.clear();
+
+        for (int index : _sourceIndices) {
+            const auto& source = allSources[index];
+
+            float priority;
+            if (source.stream.get() == nodeAudioStream) {
+                // always keep the listener's own echo
+                priority = std::numeric_limits<float>::max();
+            } else if (source.hasFrame) {
+                // louder and closer sources first
+                float distance = glm::distance(source.position, nodeAudioStream->getPosition());
+                priority = source.trailingLoudness / std::max(distance, ATTENUATION_BEGINS_AT_DISTANCE);
+            } else {
+                priority = 0.0f;
+            }
+
+            _prioritizedSources.emplace_back(priority, index);
+        }
+
+        std::nth_element(_prioritizedSources.begin(), _prioritizedSources.begin() + maxSourcesPerListener,
+                         _prioritizedSources.end(), std::greater<std::pair<float, int>>());
+
+        for (int i = 0; i < numSourcesToMix; ++i) {
+            _sourceIndices[i] = _prioritizedSources[i].second;
+        }
+
+        numSourcesToMix = maxSourcesPerListener;
+    }
+
+    // add each of the sources to the mix, the ones past the max still go through the HRTF so they fade out
+    for (int i = 0; i < (int) _sourceIndices.size(); ++i) {
+        addSourceToMixForListeningNode(*listenerNodeData, allSources[_sourceIndices[i]], *nodeAudioStream,
+                                       i >= numSourcesToMix);
+    }
+
+    // clamp the mixed samples to int16, which also tells us if we ended up with a silent frame
+    return AudioMixKernels::saturateToInt16(_mixedSamples, _clampedSamples, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+}
+
+std::unique_ptr<NLPacket> AudioMixerWorker::mixListener(const SharedNodePointer& node,
+                                                        const AudioMixerSourceList& sources) {
+    AudioMixerClientData* nodeData = static_cast<AudioMixerClientData*>(node->getLinkedData());
+
+    bool mixHasAudio = prepareMixForListeningNode(node.data(), sources);
+
+    std::unique_ptr<NLPacket> mixPacket;
+
+    if (mixHasAudio) {
+        const char* mixedAudio = reinterpret_cast<char*>(_clampedSamples);
+        int mixedAudioBytes = AudioConstants::NETWORK_FRAME_BYTES_STEREO;
+
+        // encode the mix if this listener negotiated a codec, each listener is only mixed by one worker at a time
+        AudioEncoder* encoder = nodeData->getEncoder();
+        QString codecName = encoder ? nodeData->getCodecName() : AudioCodecs::PCM_CODEC_NAME;
+        QByteArray codecNameBytes = codecName.toUtf8();
+        if (encoder) {
+            encoder->encode(QByteArray::fromRawData(mixedAudio, mixedAudioBytes), 2, _encodedSamples);
+            mixedAudio = _encodedSamples.constData();
+            mixedAudioBytes = _encodedSamples.size();
+
+            ++stats.encodedMixes;
+            stats.encodedMixBytes += mixedAudioBytes;
+        }
+
+        int mixPacketBytes = sizeof(quint16) + sizeof(quint32) + codecNameBytes.size() + mixedAudioBytes;
+        mixPacket = NLPacket::create(PacketType::MixedAudio, mixPacketBytes);
+
+        // pack sequence number
+        quint16 sequence = nodeData->getOutgoingSequenceNumber();
+        mixPacket->writePrimitive(sequence);
+
+        // pack the codec the mix is encoded with
+        mixPacket->writeString(codecName);
+
+        // pack mixed audio samples
+        mixPacket->write(mixedAudio, mixedAudioBytes);
+    } else {
+        QByteArray codecNameBytes = AudioCodecs::PCM_CODEC_NAME.toUtf8();
+        int silentPacketBytes = sizeof(quint16) + sizeof(quint32) + codecNameBytes.size() + sizeof(quint16);
+        mixPacket = NLPacket::create(PacketType::SilentAudioFrame, silentPacketBytes);
+
+        // pack sequence number
+        quint16 sequence = nodeData->getOutgoingSequenceNumber();
+        mixPacket->writePrimitive(sequence);
+
+        // pack the codec name, which is only there to keep the layout of all audio packets the same
+        mixPacket->writeString(AudioCodecs::PCM_CODEC_NAME);
+
+        // pack number of silent audio samples
+        quint16 numSilentSamples = AudioConstants::NETWORK_FRAME_SAMPLES_STEREO;
+        mixPacket->writePrimitive(numSilentSamples);
+    }
+
+    ++stats.sumListeners;
+
+    return mixPacket;
+}
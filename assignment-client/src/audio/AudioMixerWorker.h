@@ -0,0 +1,99 @@
+//
+//  AudioMixerWorker.h
+//  assignment-client/src/audio
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioMixerWorker_h
+#define hifi_AudioMixerWorker_h
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <AudioConstants.h>
+#include <NLPacket.h>
+#include <Node.h>
+
+#include "AudioMixerSourceList.h"
+
+class AudioMixer;
+class AvatarAudioStream;
+class PositionalAudioStream;
+
+// counters for the kinds of mixes performed, summed by the AudioMixer across all of its workers
+struct AudioMixerStats {
+    int sumListeners { 0 };
+    int totalMixes { 0 };
+    int hrtfRenders { 0 };
+    int hrtfSilentRenders { 0 };
+    int hrtfStruggleRenders { 0 };
+    int manualStereoMixes { 0 };
+    int manualEchoMixes { 0 };
+    int sourceBlockReads { 0 };
+    int sourcesCulled { 0 }; // sources outside of a listener's audible distance, never looked at
+    int sourcesDroppedByPriority { 0 }; // sources past the max sources per listener
+    int encodedMixes { 0 }; // mixes sent with a codec other than PCM
+    qint64 encodedMixBytes { 0 };
+
+    void reset() { *this = AudioMixerStats(); }
+    void accumulate(const AudioMixerStats& otherStats);
+};
+
+// per-worker timing, reported by the AudioMixer in its stats packet
+struct AudioMixerWorkerTiming {
+    int frames { 0 };
+    int framesOverDeadline { 0 };
+    quint64 sumMixUsecs { 0 };
+    quint64 maxMixUsecs { 0 };
+
+    void reset() { *this = AudioMixerWorkerTiming(); }
+    void addFrame(quint64 mixUsecs);
+};
+
+/// Mixes listeners for the AudioMixer - each worker owns the scratch buffers it mixes into so that
+/// several workers can mix different listeners of the same frame concurrently.
+class AudioMixerWorker {
+public:
+    AudioMixerWorker(const AudioMixer& mixer) : _mixer(mixer) {}
+
+    /// prepares the mix of the given sources for one listening node and returns the packet to send it
+    std::unique_ptr<NLPacket> mixListener(const SharedNodePointer& node, const AudioMixerSourceList& sources);
+
+    AudioMixerStats stats;
+    AudioMixerWorkerTiming timing;
+
+private:
+    /// prepares a mix for one listening node, returns true if the mix has audio
+    bool prepareMixForListeningNode(Node* node, const AudioMixerSourceList& sources);
+
+    /// adds one prepared source to the mix for a listening node
+    void addSourceToMixForListeningNode(AudioMixerClientData& listenerNodeData, const AudioMixerSource& source,
+                                        const AvatarAudioStream& listeningNodeStream, bool isDroppedByPriority);
+
+    float gainForSource(const PositionalAudioStream& streamToAdd, const AvatarAudioStream& listeningNodeStream,
+                        const glm::vec3& relativePosition, bool isEcho);
+    float azimuthForSource(const PositionalAudioStream& streamToAdd, const AvatarAudioStream& listeningNodeStream,
+                           const glm::vec3& relativePosition);
+
+    const AudioMixer& _mixer;
+
+    float _mixedSamples[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    int16_t _clampedSamples[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    QByteArray _encodedSamples;
+
+    // scratch space for picking the sources of each listener's mix
+    std::vector<int> _sourceIndices;
+    std::vector<std::pair<float, int>> _prioritizedSources;
+
+    // marks the sources within the audible distance of the listener being mixed, with a number new for each listener
+    std::vector<int> _audibleSourceMarks;
+    int _audibleSourceMark { 0 };
+};
+
+#endif // hifi_AudioMixerWorker_h
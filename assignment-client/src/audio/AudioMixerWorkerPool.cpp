@@ -0,0 +1,73 @@
+//
+//  AudioMixerWorkerPool.cpp
+//  assignment-client/src/audio
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDebug>
+
+#include <SharedUtil.h>
+
+#include "AudioMixerWorkerPool.h"
+
+AudioMixerWorkerPool::AudioMixerWorkerPool(const AudioMixer& mixer, int numThreads) :
+    _mixer(mixer)
+{
+    setNumThreads(numThreads);
+}
+
+void AudioMixerWorkerPool::setNumThreads(int numThreads) {
+    numThreads = FrameWorkerPool::resolveNumThreads(numThreads);
+
+    if (numThreads == (int) _workers.size()) {
+        return;
+    }
+
+    // the threads hold on to the workers, so they have to be gone before the workers are replaced
+    _threads.stop();
+
+    _workers.clear();
+    for (int i = 0; i < numThreads; ++i) {
+        _workers.emplace_back(new AudioMixerWorker(_mixer));
+    }
+
+    qDebug() << "AudioMixer is mixing with" << numThreads << (numThreads == 1 ? "thread" : "threads");
+
+    _threads.start(numThreads);
+}
+
+void AudioMixerWorkerPool::mix(const ListenerList& listeners, const AudioMixerSourceList& sources,
+                               MixPacketList& mixPackets) {
+    mixPackets.resize(listeners.size());
+
+    _listeners = &listeners;
+    _sources = &sources;
+    _mixPackets = &mixPackets;
+    _nextListener = 0;
+
+    _threads.runFrame([this](int threadIndex) {
+        mixListeners(*_workers[threadIndex]);
+    });
+
+    _listeners = nullptr;
+    _sources = nullptr;
+    _mixPackets = nullptr;
+}
+
+void AudioMixerWorkerPool::mixListeners(AudioMixerWorker& worker) {
+    auto mixStart = usecTimestampNow();
+
+    // workers grab the next unmixed listener until there are none left, which balances the load between them
+    // even when some listeners are much more expensive to mix than others
+    size_t numListeners = _listeners->size();
+    size_t index;
+    while ((index = _nextListener++) < numListeners) {
+        (*_mixPackets)[index] = worker.mixListener((*_listeners)[index], *_sources);
+    }
+
+    worker.timing.addFrame(usecTimestampNow() - mixStart);
+}
@@ -0,0 +1,60 @@
+//
+//  AudioMixerWorkerPool.h
+//  assignment-client/src/audio
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioMixerWorkerPool_h
+#define hifi_AudioMixerWorkerPool_h
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <FrameWorkerPool.h>
+
+#include "AudioMixerWorker.h"
+
+/// Splits the listeners of each frame across a fixed set of AudioMixerWorkers.
+/// With a single thread the mix happens on the calling (AudioMixer) thread, as it always has.
+class AudioMixerWorkerPool {
+public:
+    using ListenerList = std::vector<SharedNodePointer>;
+    using MixPacketList = std::vector<std::unique_ptr<NLPacket>>;
+
+    AudioMixerWorkerPool(const AudioMixer& mixer, int numThreads = 1);
+
+    /// mixes the prepared sources for every listener, blocking until all of them are done
+    /// mixPackets is filled with the packet for the listener at the same index
+    void mix(const ListenerList& listeners, const AudioMixerSourceList& sources, MixPacketList& mixPackets);
+
+    /// 0 sets one thread per hardware thread
+    void setNumThreads(int numThreads);
+    int numThreads() const { return (int) _workers.size(); }
+
+    template <typename Functor>
+    void forEachWorker(Functor functor) {
+        for (auto& worker : _workers) {
+            functor(*worker);
+        }
+    }
+
+private:
+    void mixListeners(AudioMixerWorker& worker);
+
+    const AudioMixer& _mixer;
+
+    std::vector<std::unique_ptr<AudioMixerWorker>> _workers;
+    FrameWorkerPool _threads;
+
+    const ListenerList* _listeners { nullptr };
+    const AudioMixerSourceList* _sources { nullptr };
+    MixPacketList* _mixPackets { nullptr };
+    std::atomic<size_t> _nextListener { 0 };
+};
+
+#endif // hifi_AudioMixerWorkerPool_h
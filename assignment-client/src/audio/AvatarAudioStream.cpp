@@ -49,9 +49,10 @@ int AvatarAudioStream::parseStreamProperties(PacketType type, const QByteArray&
         // read the positional data
         readBytes += parsePositionalData(packetAfterSeqNum.mid(readBytes));
         
-        // calculate how many samples are in this packet
+        // calculate how many samples are in this packet, which is fewer than its bytes suggest if it is encoded
         int numAudioBytes = packetAfterSeqNum.size() - readBytes;
-        numAudioSamples = numAudioBytes / sizeof(int16_t);
+        numAudioSamples = numSamplesInAudioData(QByteArray::fromRawData(packetAfterSeqNum.constData() + readBytes,
+                                                                        numAudioBytes));
     }
 
     return readBytes;
@@ -10,7 +10,6 @@
 //
 
 #include <cfloat>
-#include <random>
 #include <memory>
 
 #include <QtCore/QCoreApplication>
@@ -31,9 +30,6 @@
 
 const QString AVATAR_MIXER_LOGGING_NAME = "avatar-mixer";
 
-const int AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND = 60;
-const unsigned int AVATAR_DATA_SEND_INTERVAL_MSECS = (1.0f / (float) AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND) * 1000;
-
 AvatarMixer::AvatarMixer(ReceivedMessage& message) :
     ThreadedAssignment(message),
     _broadcastThread()
@@ -42,9 +38,10 @@ AvatarMixer::AvatarMixer(ReceivedMessage& message) :
     connect(DependencyManager::get<NodeList>().data(), &NodeList::nodeKilled, this, &AvatarMixer::nodeKilled);
 
     auto& packetReceiver = DependencyManager::get<NodeList>()->getPacketReceiver();
-    packetReceiver.registerListener(PacketType::AvatarData, this, "handleAvatarDataPacket");
+    packetReceiver.registerListener(PacketType::AvatarData, this, &AvatarMixer::handleAvatarDataPacket);
     packetReceiver.registerListener(PacketType::AvatarIdentity, this, "handleAvatarIdentityPacket");
     packetReceiver.registerListener(PacketType::KillAvatar, this, "handleKillAvatarPacket");
+    packetReceiver.registerListener(PacketType::ViewFrustum, this, "handleViewFrustumPacket");
 }
 
 AvatarMixer::~AvatarMixer() {
@@ -56,13 +53,6 @@ AvatarMixer::~AvatarMixer() {
     _broadcastThread.wait();
 }
 
-// An 80% chance of sending a identity packet within a 5 second interval.
-// assuming 60 htz update rate.
-const float IDENTITY_SEND_PROBABILITY = 1.0f / 187.0f;
-
-// NOTE: some additional optimizations to consider.
-//    1) use the view frustum to cull those avatars that are out of view. Since avatar data doesn't need to be present
-//       if the avatar is not in view or in the keyhole.
 void AvatarMixer::broadcastAvatarData() {
     int idleTime = AVATAR_DATA_SEND_INTERVAL_MSECS;
 
@@ -72,6 +62,7 @@ void AvatarMixer::broadcastAvatarData() {
     }
 
     ++_numStatFrames;
+    ++_broadcastFrame;
 
     const float STRUGGLE_TRIGGER_SLEEP_PERCENTAGE_THRESHOLD = 0.10f;
     const float BACK_OFF_TRIGGER_SLEEP_PERCENTAGE_THRESHOLD = 0.20f;
@@ -127,243 +118,121 @@ void AvatarMixer::broadcastAvatarData() {
 
     auto nodeList = DependencyManager::get<NodeList>();
 
-    // setup for distributed random floating point values
-    std::random_device randomDevice;
-    std::mt19937 generator(randomDevice());
-    std::uniform_real_distribution<float> distribution;
-
-    nodeList->eachMatchingNode(
-        [&](const SharedNodePointer& node)->bool {
-            if (!node->getLinkedData()) {
-                return false;
-            }
-            if (node->getType() != NodeType::Agent) {
-                return false;
-            }
-            if (!node->getActiveSocket()) {
-                return false;
-            }
-            return true;
-        },
-        [&](const SharedNodePointer& node) {
-            AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData());
-            MutexTryLocker lock(nodeData->getMutex());
-            if (!lock.isLocked()) {
-                return;
-            }
-            ++_sumListeners;
-
-            AvatarData& avatar = nodeData->getAvatar();
-            glm::vec3 myPosition = avatar.getClientGlobalPosition();
-
-            // reset the internal state for correct random number distribution
-            distribution.reset();
+    // copy out what the workers need from every avatar, so they never lock another avatar while they broadcast
+    takeAvatarSnapshots();
 
-            // reset the max distance for this frame
-            float maxAvatarDistanceThisFrame = 0.0f;
+    // prepare the packets for every receiver across the workers, and send them from here once they are all done
+    _workerPool.broadcast(_frameReceivers, _frameAvatars, _frameBroadcasts);
 
-            // reset the number of sent avatars
-            nodeData->resetNumAvatarsSentLastFrame();
+    for (size_t i = 0; i < _frameReceivers.size(); ++i) {
+        const SharedNodePointer& node = _frameReceivers[i]->node;
+        AvatarMixerBroadcast& broadcast = _frameBroadcasts[i];
 
-            // keep a counter of the number of considered avatars
-            int numOtherAvatars = 0;
-
-            // keep track of outbound data rate specifically for avatar data
-            int numAvatarDataBytes = 0;
+        for (auto& identityPacket : broadcast.identityPackets) {
+            nodeList->addToPacketBatch(_framePacketBatch, std::move(identityPacket), *node);
+        }
+        broadcast.identityPackets.clear();
 
-            // keep track of the number of other avatars held back in this frame
-            int numAvatarsHeldBack = 0;
+        // queue the avatar data PacketList
+        nodeList->addToPacketBatch(_framePacketBatch, *broadcast.avatarPacketList, *node);
+        broadcast.avatarPacketList.reset();
+    }
 
-            // keep track of the number of other avatar frames skipped
-            int numAvatarsWithSkippedFrames = 0;
+    // and send every receiver's packets for the frame together
+    nodeList->sendPacketBatch(_framePacketBatch);
 
-            // use the data rate specifically for avatar data for FRD adjustment checks
-            float avatarDataRateLastSecond = nodeData->getOutboundAvatarDataKbps();
+    // We're done encoding this version of the otherAvatars.  Update their "lastSent" joint-states so
+    // that we can notice differences, next time around.
+    for (const AvatarSnapshot* snapshot : _frameAvatars) {
+        if (snapshot->frame != _broadcastFrame || snapshot->node->getType() != NodeType::Agent
+            || !snapshot->node->getActiveSocket()) {
+            continue;
+        }
 
-            // Check if it is time to adjust what we send this client based on the observed
-            // bandwidth to this node. We do this once a second, which is also the window for
-            // the bandwidth reported by node->getOutboundBandwidth();
-            if (nodeData->getNumFramesSinceFRDAdjustment() > AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND) {
+        MutexTryLocker lock(snapshot->nodeData->getMutex());
+        if (!lock.isLocked()) {
+            continue;
+        }
+        snapshot->nodeData->getAvatar().doneEncoding(false);
+    }
 
-                const float FRD_ADJUSTMENT_ACCEPTABLE_RATIO = 0.8f;
-                const float HYSTERISIS_GAP = (1 - FRD_ADJUSTMENT_ACCEPTABLE_RATIO);
-                const float HYSTERISIS_MIDDLE_PERCENTAGE =  (1 - (HYSTERISIS_GAP * 0.5f));
+    _lastFrameTimestamp = p_high_resolution_clock::now();
+}
 
-                // get the current full rate distance so we can work with it
-                float currentFullRateDistance = nodeData->getFullRateDistance();
+void AvatarMixer::takeAvatarSnapshots() {
+    auto nodeList = DependencyManager::get<NodeList>();
 
-                if (avatarDataRateLastSecond > _maxKbpsPerNode) {
+    _frameAvatars.clear();
+    _frameReceivers.clear();
 
-                    // is the FRD greater than the farthest avatar?
-                    // if so, before we calculate anything, set it to that distance
-                    currentFullRateDistance = std::min(currentFullRateDistance, nodeData->getMaxAvatarDistance());
+    nodeList->eachNode([&](const SharedNodePointer& node) {
+        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData());
+        if (!nodeData) {
+            return;
+        }
 
-                    // we're adjusting the full rate distance to target a bandwidth in the middle
-                    // of the hysterisis gap
-                    currentFullRateDistance *= (_maxKbpsPerNode * HYSTERISIS_MIDDLE_PERCENTAGE) / avatarDataRateLastSecond;
+        AvatarSnapshot& snapshot = _avatarSnapshots[node->getUUID()];
 
-                    nodeData->setFullRateDistance(currentFullRateDistance);
-                    nodeData->resetNumFramesSinceFRDAdjustment();
-                } else if (currentFullRateDistance < nodeData->getMaxAvatarDistance()
-                           && avatarDataRateLastSecond < _maxKbpsPerNode * FRD_ADJUSTMENT_ACCEPTABLE_RATIO) {
-                    // we are constrained AND we've recovered to below the acceptable ratio
-                    // lets adjust the full rate distance to target a bandwidth in the middle of the hyterisis gap
-                    currentFullRateDistance *= (_maxKbpsPerNode * HYSTERISIS_MIDDLE_PERCENTAGE) / avatarDataRateLastSecond;
+        {
+            MutexTryLocker lock(nodeData->getMutex());
+            if (lock.isLocked()) {
+                AvatarData& avatar = nodeData->getAvatar();
+                glm::vec3 position = avatar.getClientGlobalPosition();
 
-                    nodeData->setFullRateDistance(currentFullRateDistance);
-                    nodeData->resetNumFramesSinceFRDAdjustment();
+                // a new snapshot counts as having moved, so that new arrivals aren't held back
+                const float MIN_MOVED_DISTANCE = 0.01f;
+                if (snapshot.nodeData != nodeData || glm::distance(position, snapshot.position) > MIN_MOVED_DISTANCE) {
+                    snapshot.lastMovedFrame = _broadcastFrame;
                 }
-            } else {
-                nodeData->incrementNumFramesSinceFRDAdjustment();
-            }
-
-            // setup a PacketList for the avatarPackets
-            auto avatarPacketList = NLPacketList::create(PacketType::BulkAvatarData);
-
-            // this is an AGENT we have received head data from
-            // send back a packet with other active node data to this node
-            nodeList->eachMatchingNode(
-                [&](const SharedNodePointer& otherNode)->bool {
-                    if (!otherNode->getLinkedData()) {
-                        return false;
-                    }
-                    if (otherNode->getUUID() == node->getUUID()) {
-                        return false;
-                    }
-
-                    return true;
-                },
-                [&](const SharedNodePointer& otherNode) {
-                    ++numOtherAvatars;
-
-                    AvatarMixerClientData* otherNodeData = reinterpret_cast<AvatarMixerClientData*>(otherNode->getLinkedData());
-                    MutexTryLocker lock(otherNodeData->getMutex());
-                    if (!lock.isLocked()) {
-                        return;
-                    }
-
-                    // make sure we send out identity packets to and from new arrivals.
-                    bool forceSend = !otherNodeData->checkAndSetHasReceivedFirstPacketsFrom(node->getUUID());
-
-                    if (otherNodeData->getIdentityChangeTimestamp().time_since_epoch().count() > 0
-                        && (forceSend
-                            || otherNodeData->getIdentityChangeTimestamp() > _lastFrameTimestamp
-                            || distribution(generator) < IDENTITY_SEND_PROBABILITY)) {
-
-                        QByteArray individualData = otherNodeData->getAvatar().identityByteArray();
-
-                        auto identityPacket = NLPacket::create(PacketType::AvatarIdentity, individualData.size());
-
-                        individualData.replace(0, NUM_BYTES_RFC4122_UUID, otherNode->getUUID().toRfc4122());
-
-                        identityPacket->write(individualData);
-
-                        nodeList->sendPacket(std::move(identityPacket), *node);
-
-                        ++_sumIdentityPackets;
-                    }
-
-                    AvatarData& otherAvatar = otherNodeData->getAvatar();
-                    //  Decide whether to send this avatar's data based on it's distance from us
-
-                    //  The full rate distance is the distance at which EVERY update will be sent for this avatar
-                    //  at twice the full rate distance, there will be a 50% chance of sending this avatar's update
-                    glm::vec3 otherPosition = otherAvatar.getClientGlobalPosition();
-                    float distanceToAvatar = glm::length(myPosition - otherPosition);
-
-                    // potentially update the max full rate distance for this frame
-                    maxAvatarDistanceThisFrame = std::max(maxAvatarDistanceThisFrame, distanceToAvatar);
-
-                    if (distanceToAvatar != 0.0f
-                        && distribution(generator) > (nodeData->getFullRateDistance() / distanceToAvatar)) {
-                        return;
-                    }
 
-                    AvatarDataSequenceNumber lastSeqToReceiver = nodeData->getLastBroadcastSequenceNumber(otherNode->getUUID());
-                    AvatarDataSequenceNumber lastSeqFromSender = otherNodeData->getLastReceivedSequenceNumber();
+                snapshot.node = node;
+                snapshot.nodeData = nodeData;
+                snapshot.position = position;
+                snapshot.lastReceivedSequenceNumber = nodeData->getLastReceivedSequenceNumber();
+                snapshot.identityChangeTimestamp = nodeData->getIdentityChangeTimestamp();
 
-                    if (lastSeqToReceiver > lastSeqFromSender && lastSeqToReceiver != UINT16_MAX) {
-                        // we got out out of order packets from the sender, track it
-                        otherNodeData->incrementNumOutOfOrderSends();
-                    }
-
-                    // make sure we haven't already sent this data from this sender to this receiver
-                    // or that somehow we haven't sent
-                    if (lastSeqToReceiver == lastSeqFromSender && lastSeqToReceiver != 0) {
-                        ++numAvatarsHeldBack;
-                        return;
-                    } else if (lastSeqFromSender - lastSeqToReceiver > 1) {
-                        // this is a skip - we still send the packet but capture the presence of the skip so we see it happening
-                        ++numAvatarsWithSkippedFrames;
-                    }
-
-                    // we're going to send this avatar
-
-                    // increment the number of avatars sent to this reciever
-                    nodeData->incrementNumAvatarsSentLastFrame();
-
-                    // set the last sent sequence number for this sender on the receiver
-                    nodeData->setLastBroadcastSequenceNumber(otherNode->getUUID(),
-                                                             otherNodeData->getLastReceivedSequenceNumber());
-
-                    // start a new segment in the PacketList for this avatar
-                    avatarPacketList->startSegment();
-
-                    numAvatarDataBytes += avatarPacketList->write(otherNode->getUUID().toRfc4122());
-                    numAvatarDataBytes +=
-                        avatarPacketList->write(otherAvatar.toByteArray(false, distribution(generator) < AVATAR_SEND_FULL_UPDATE_RATIO));
-
-                    avatarPacketList->endSegment();
-            });
-
-            // close the current packet so that we're always sending something
-            avatarPacketList->closeCurrentPacket(true);
-
-            // send the avatar data PacketList
-            nodeList->sendPacketList(std::move(avatarPacketList), *node);
+                if (snapshot.identityChangeTimestamp.time_since_epoch().count() > 0) {
+                    snapshot.identityData = nodeData->getIdentityData();
+                    snapshot.identityData.replace(0, NUM_BYTES_RFC4122_UUID, node->getUUID().toRfc4122());
+                }
 
-            // record the bytes sent for other avatar data in the AvatarMixerClientData
-            nodeData->recordSentAvatarData(numAvatarDataBytes);
+                // the snapshot shares the encoded data with the client data, rather than copying it
+                snapshot.deltaAvatarData = nodeData->getAvatarDataForFrame(_broadcastFrame, false);
+                snapshot.fullAvatarData = nodeData->getAvatarDataForFrame(_broadcastFrame, true);
+                _sumAvatarDataEncodes += nodeData->takeNumAvatarDataEncodes();
 
-            // record the number of avatars held back this frame
-            nodeData->recordNumOtherAvatarStarves(numAvatarsHeldBack);
-            nodeData->recordNumOtherAvatarSkips(numAvatarsWithSkippedFrames);
+                snapshot.hasViewFrustum = nodeData->hasViewFrustum();
+                if (snapshot.hasViewFrustum) {
+                    snapshot.viewFrustum = nodeData->getViewFrustum();
+                }
 
-            if (numOtherAvatars == 0) {
-                // update the full rate distance to FLOAT_MAX since we didn't have any other avatars to send
-                nodeData->setMaxAvatarDistance(FLT_MAX);
+                snapshot.frame = _broadcastFrame;
+            } else if (snapshot.nodeData == nodeData) {
+                // the node is busy parsing a packet - rather than skip it for this frame, we use its last snapshot
+                ++_sumStaleSnapshots;
             } else {
-                nodeData->setMaxAvatarDistance(maxAvatarDistanceThisFrame);
+                // we've never had a look at this node, so there's nothing to send for it yet
+                _avatarSnapshots.erase(node->getUUID());
+                return;
             }
         }
-    );
 
-    // We're done encoding this version of the otherAvatars.  Update their "lastSent" joint-states so
-    // that we can notice differences, next time around.
-    nodeList->eachMatchingNode(
-        [&](const SharedNodePointer& otherNode)->bool {
-            if (!otherNode->getLinkedData()) {
-                return false;
-            }
-            if (otherNode->getType() != NodeType::Agent) {
-                return false;
-            }
-            if (!otherNode->getActiveSocket()) {
-                return false;
-            }
-            return true;
-        },
-        [&](const SharedNodePointer& otherNode) {
-            AvatarMixerClientData* otherNodeData = reinterpret_cast<AvatarMixerClientData*>(otherNode->getLinkedData());
-            MutexTryLocker lock(otherNodeData->getMutex());
-            if (!lock.isLocked()) {
-                return;
-            }
-            AvatarData& otherAvatar = otherNodeData->getAvatar();
-            otherAvatar.doneEncoding(false);
-        });
+        snapshot.isReceiver = node->getType() == NodeType::Agent && node->getActiveSocket();
 
-    _lastFrameTimestamp = p_high_resolution_clock::now();
+        _frameAvatars.push_back(&snapshot);
+        if (snapshot.isReceiver) {
+            _frameReceivers.push_back(&snapshot);
+        }
+    });
+
+    // forget the snapshots of the nodes that have gone away
+    for (auto it = _avatarSnapshots.begin(); it != _avatarSnapshots.end();) {
+        if (it->second.frame != _broadcastFrame && !nodeList->nodeWithUUID(it->first)) {
+            it = _avatarSnapshots.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
@@ -422,22 +291,76 @@ void AvatarMixer::handleAvatarIdentityPacket(QSharedPointer<ReceivedMessage> mes
     }
 }
 
+void AvatarMixer::handleViewFrustumPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
+    AvatarMixerClientData* nodeData = dynamic_cast<AvatarMixerClientData*>(senderNode->getLinkedData());
+    if (nodeData) {
+        QMutexLocker nodeDataLocker(&nodeData->getMutex());
+        nodeData->readViewFrustumPacket(message->getMessage());
+    }
+}
+
 void AvatarMixer::handleKillAvatarPacket(QSharedPointer<ReceivedMessage> message) {
     DependencyManager::get<NodeList>()->processKillNode(*message);
 }
 
 void AvatarMixer::sendStatsPacket() {
     QJsonObject statsObject;
-    statsObject["average_listeners_last_second"] = (float) _sumListeners / (float) _numStatFrames;
 
-    statsObject["average_identity_packets_per_frame"] = (float) _sumIdentityPackets / (float) _numStatFrames;
+    // sum the stats from each of our workers, and report how long each of them is taking to broadcast a frame
+    QJsonObject workerStats;
+    int workerIndex = 0;
+
+    _workerPool.forEachWorker([&](AvatarMixerWorker& worker) {
+        _stats.accumulate(worker.stats);
+
+        QJsonObject timingStats;
+        timingStats["avg_broadcast_usecs_per_frame"] = worker.timing.frames > 0
+            ? (double) worker.timing.sumBroadcastUsecs / worker.timing.frames : 0.0;
+        timingStats["max_broadcast_usecs_per_frame"] = (double) worker.timing.maxBroadcastUsecs;
+        timingStats["frames_over_deadline"] = worker.timing.framesOverDeadline;
+        timingStats["contended_locks"] = worker.stats.contendedLocks;
+        worker.timing.reset();
+        worker.stats.reset();
+
+        workerStats[QString("worker_%1").arg(workerIndex++)] = timingStats;
+    });
+
+    statsObject["average_listeners_last_second"] = (float) _stats.sumListeners / (float) _numStatFrames;
+
+    statsObject["average_identity_packets_per_frame"] = (float) _stats.identityPackets / (float) _numStatFrames;
+
+    // how many times avatar data was written to receivers, and how many times it had to be encoded for that
+    statsObject["average_avatar_data_sends_per_frame"] = (float) _stats.avatarDataSends / (float) _numStatFrames;
+    statsObject["average_avatar_data_encodes_per_frame"] = (float) _sumAvatarDataEncodes / (float) _numStatFrames;
+
+    // avatars that were busy when the frame started, and were sent as they were the last time we could lock them
+    statsObject["average_stale_avatars_per_frame"] = (float) _sumStaleSnapshots / (float) _numStatFrames;
+    statsObject["contended_locks"] = _stats.contendedLocks;
+
+    // how many of the avatars with new data were in view of their receivers, and how many didn't fit in their bandwidth
+    statsObject["average_avatars_in_view_per_listener"] = _stats.sumListeners > 0
+        ? (float) _stats.avatarsInView / (float) _stats.sumListeners : 0.0f;
+    statsObject["average_avatars_over_budget_per_listener"] = _stats.sumListeners > 0
+        ? (float) _stats.avatarsOverBudget / (float) _stats.sumListeners : 0.0f;
+
+    statsObject["broadcast_threads"] = _workerPool.numThreads();
+    statsObject["broadcast_workers"] = workerStats;
 
     statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100;
     statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
 
+    auto nodeList = DependencyManager::get<NodeList>();
+
+    // everything this mixer wrote to its socket, and the system calls it took
+    auto writeStats = nodeList->sampleSocketWriteStats();
+
+    QJsonObject egressStats;
+    egressStats["avg_datagrams_per_frame"] = _numStatFrames > 0 ? (float) writeStats.datagrams / _numStatFrames : 0.0f;
+    egressStats["avg_send_calls_per_frame"] = _numStatFrames > 0 ? (float) writeStats.systemCalls / _numStatFrames : 0.0f;
+    statsObject["egress"] = egressStats;
+
     QJsonObject avatarsObject;
 
-    auto nodeList = DependencyManager::get<NodeList>();
     // add stats for each listerner
     nodeList->eachNode([&](const SharedNodePointer& node) {
         QJsonObject avatarStats;
@@ -469,8 +392,9 @@ void AvatarMixer::sendStatsPacket() {
     statsObject["avatars"] = avatarsObject;
     ThreadedAssignment::addPacketStatsAndSendStatsPacket(statsObject);
 
-    _sumListeners = 0;
-    _sumIdentityPackets = 0;
+    _stats.reset();
+    _sumAvatarDataEncodes = 0;
+    _sumStaleSnapshots = 0;
     _numStatFrames = 0;
 }
 
@@ -522,4 +446,11 @@ void AvatarMixer::parseDomainServerSettings(const QJsonObject& domainSettings) {
 
     _maxKbpsPerNode = nodeBandwidthValue.toDouble(DEFAULT_NODE_SEND_BANDWIDTH) * KILO_PER_MEGA;
     qDebug() << "The maximum send bandwidth per node is" << _maxKbpsPerNode << "kbps.";
+
+    const QString NUM_BROADCAST_THREADS_KEY = "num_broadcast_threads";
+    bool ok;
+    int numBroadcastThreads = domainSettings[AVATAR_MIXER_SETTINGS_KEY].toObject()[NUM_BROADCAST_THREADS_KEY].toString().toInt(&ok);
+    if (ok && numBroadcastThreads >= 0) {
+        _workerPool.setNumThreads(numBroadcastThreads);
+    }
 }
@@ -15,9 +15,18 @@
 #ifndef hifi_AvatarMixer_h
 #define hifi_AvatarMixer_h
 
-#include <PortableHighResolutionClock.h>
+#include <unordered_map>
 
+#include <PortableHighResolutionClock.h>
 #include <ThreadedAssignment.h>
+#include <UUIDHasher.h>
+#include <udt/Socket.h>
+
+#include "AvatarMixerWorker.h"
+#include "AvatarMixerWorkerPool.h"
+
+const int AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND = 60;
+const unsigned int AVATAR_DATA_SEND_INTERVAL_MSECS = (1.0f / (float) AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND) * 1000;
 
 /// Handles assignments of type AvatarMixer - distribution of avatar data to various clients
 class AvatarMixer : public ThreadedAssignment {
@@ -36,11 +45,16 @@ public slots:
 private slots:
     void handleAvatarDataPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
     void handleAvatarIdentityPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
+    void handleViewFrustumPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
     void handleKillAvatarPacket(QSharedPointer<ReceivedMessage> message);
     void domainSettingsRequestComplete();
     
 private:
+    // workers read the mixer settings while broadcasting
+    friend class AvatarMixerWorker;
+
     void broadcastAvatarData();
+    void takeAvatarSnapshots();
     void parseDomainServerSettings(const QJsonObject& domainSettings);
     
     QThread _broadcastThread;
@@ -50,9 +64,21 @@ private:
     float _trailingSleepRatio { 1.0f };
     float _performanceThrottlingRatio { 0.0f };
     
-    int _sumListeners { 0 };
     int _numStatFrames { 0 };
-    int _sumIdentityPackets { 0 };
+    int _sumAvatarDataEncodes { 0 };
+    int _sumStaleSnapshots { 0 };
+    AvatarMixerStats _stats;
+
+    uint32_t _broadcastFrame { 0 };
+
+    // the state of every avatar as of the last frame it could be locked in, which the workers broadcast from
+    std::unordered_map<QUuid, AvatarSnapshot> _avatarSnapshots;
+    AvatarSnapshotList _frameAvatars;
+    AvatarSnapshotList _frameReceivers;
+    AvatarMixerWorkerPool::BroadcastList _frameBroadcasts;
+    udt::PacketBatch _framePacketBatch;
+
+    AvatarMixerWorkerPool _workerPool { *this };
 
     float _maxKbpsPerNode = 0.0f;
 
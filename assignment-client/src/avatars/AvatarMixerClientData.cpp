@@ -16,7 +16,11 @@
 int AvatarMixerClientData::parseData(ReceivedMessage& message) {
     // pull the sequence number from the data first
     message.readPrimitive(&_lastReceivedSequenceNumber);
-    
+
+    // the avatar is about to change, so what we encoded for this frame is stale
+    _fullAvatarData.isValid = false;
+    _deltaAvatarData.isValid = false;
+
     // compute the offset to the data payload
     return _avatar->parseDataFromBuffer(message.readWithoutCopy(message.getBytesLeftToRead()));
 }
@@ -29,6 +33,24 @@ bool AvatarMixerClientData::checkAndSetHasReceivedFirstPacketsFrom(const QUuid&
     return true;
 }
 
+void AvatarMixerClientData::removeLastBroadcastSequenceNumber(const QUuid& nodeUUID) {
+    // this is invoked on the main thread, while the AvatarMixer's workers read and write the sequence numbers with the lock held
+    QMutexLocker lock(&getMutex());
+    _lastBroadcastSequenceNumbers.erase(nodeUUID);
+    _lastBroadcastFrames.erase(nodeUUID);
+}
+
+uint32_t AvatarMixerClientData::getLastBroadcastFrame(const QUuid& nodeUUID) const {
+    auto nodeMatch = _lastBroadcastFrames.find(nodeUUID);
+    return nodeMatch != _lastBroadcastFrames.end() ? nodeMatch->second : 0;
+}
+
+void AvatarMixerClientData::readViewFrustumPacket(const QByteArray& message) {
+    if (_viewFrustum.fromByteArray(message) > 0) {
+        _hasViewFrustum = true;
+    }
+}
+
 uint16_t AvatarMixerClientData::getLastBroadcastSequenceNumber(const QUuid& nodeUUID) const {
     // return the matching PacketSequenceNumber, or the default if we don't have it
     auto nodeMatch = _lastBroadcastSequenceNumbers.find(nodeUUID);
@@ -39,14 +61,40 @@ uint16_t AvatarMixerClientData::getLastBroadcastSequenceNumber(const QUuid& node
     }
 }
 
+const QByteArray& AvatarMixerClientData::getIdentityData() {
+    if (_identityData.isEmpty() || _identityDataTimestamp != _identityChangeTimestamp) {
+        _identityData = _avatar->identityByteArray();
+        _identityDataTimestamp = _identityChangeTimestamp;
+    }
+
+    return _identityData;
+}
+
+const QByteArray& AvatarMixerClientData::getAvatarDataForFrame(uint32_t frame, bool sendAll) {
+    EncodedAvatarData& encoded = sendAll ? _fullAvatarData : _deltaAvatarData;
+
+    // the mixer never culls small changes, and only moves the last sent joint data on between frames,
+    // so within a frame the encoding depends on nothing but the avatar
+    if (!encoded.isValid || encoded.frame != frame) {
+        encoded.data = _avatar->toByteArray(false, sendAll);
+        encoded.frame = frame;
+        encoded.isValid = true;
+        ++_numAvatarDataEncodes;
+    }
+
+    return encoded.data;
+}
+
 void AvatarMixerClientData::loadJSONStats(QJsonObject& jsonObject) const {
     jsonObject["display_name"] = _avatar->getDisplayName();
     jsonObject["full_rate_distance"] = _fullRateDistance;
     jsonObject["max_av_distance"] = _maxAvatarDistance;
     jsonObject["num_avs_sent_last_frame"] = _numAvatarsSentLastFrame;
+    jsonObject["num_avs_in_view_last_frame"] = _numAvatarsInViewLastFrame;
+    jsonObject["avg_other_av_over_budget_per_second"] = getAvgNumOtherAvatarsOverBudgetPerSecond();
     jsonObject["avg_other_av_starves_per_second"] = getAvgNumOtherAvatarStarvesPerSecond();
     jsonObject["avg_other_av_skips_per_second"] = getAvgNumOtherAvatarSkipsPerSecond();
-    jsonObject["total_num_out_of_order_sends"] = _numOutOfOrderSends;
+    jsonObject["total_num_out_of_order_sends"] = _numOutOfOrderSends.load();
 
     jsonObject[OUTBOUND_AVATAR_DATA_STATS_KEY] = getOutboundAvatarDataKbps();
     jsonObject[INBOUND_AVATAR_DATA_STATS_KEY] = _avatar->getAverageBytesReceivedPerSecond() / (float) BYTES_PER_KILOBIT;
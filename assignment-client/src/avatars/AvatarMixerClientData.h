@@ -13,6 +13,7 @@
 #define hifi_AvatarMixerClientData_h
 
 #include <algorithm>
+#include <atomic>
 #include <cfloat>
 #include <unordered_map>
 #include <unordered_set>
@@ -27,6 +28,7 @@
 #include <PortableHighResolutionClock.h>
 #include <SimpleMovingAverage.h>
 #include <UUIDHasher.h>
+#include <ViewFrustum.h>
 
 const QString OUTBOUND_AVATAR_DATA_STATS_KEY = "outbound_av_data_kbps";
 const QString INBOUND_AVATAR_DATA_STATS_KEY = "inbound_av_data_kbps";
@@ -44,22 +46,47 @@ public:
     uint16_t getLastBroadcastSequenceNumber(const QUuid& nodeUUID) const;
     void setLastBroadcastSequenceNumber(const QUuid& nodeUUID, uint16_t sequenceNumber)
         { _lastBroadcastSequenceNumbers[nodeUUID] = sequenceNumber; }
-    Q_INVOKABLE void removeLastBroadcastSequenceNumber(const QUuid& nodeUUID) { _lastBroadcastSequenceNumbers.erase(nodeUUID); }
+    Q_INVOKABLE void removeLastBroadcastSequenceNumber(const QUuid& nodeUUID);
+
+    // the broadcast frame in which the given avatar was last sent to this node, 0 if it never was
+    uint32_t getLastBroadcastFrame(const QUuid& nodeUUID) const;
+    void setLastBroadcastFrame(const QUuid& nodeUUID, uint32_t frame) { _lastBroadcastFrames[nodeUUID] = frame; }
 
     uint16_t getLastReceivedSequenceNumber() const { return _lastReceivedSequenceNumber; }
 
     HRCTime getIdentityChangeTimestamp() const { return _identityChangeTimestamp; }
     void flagIdentityChange() { _identityChangeTimestamp = p_high_resolution_clock::now(); }
 
+    // the serialized identity of this avatar, which is only serialized again once the identity has changed
+    const QByteArray& getIdentityData();
+
+    // what the client can see, from the ViewFrustum packets it sends - until it sends one, it can see every avatar
+    void readViewFrustumPacket(const QByteArray& message);
+    bool hasViewFrustum() const { return _hasViewFrustum; }
+    const ViewFrustum& getViewFrustum() const { return _viewFrustum; }
+
+    // the bytes of avatar data that can still be sent to this node, topped up every frame to stay within its bandwidth
+    float getAvatarDataBudget() const { return _avatarDataBudget; }
+    void setAvatarDataBudget(float budget) { _avatarDataBudget = budget; }
+
+    void resetNumAvatarsSentLastFrame() { _numAvatarsSentLastFrame = 0; }
+    void incrementNumAvatarsSentLastFrame() { ++_numAvatarsSentLastFrame; }
+    int getNumAvatarsSentLastFrame() const { return _numAvatarsSentLastFrame; }
+
+    // the distance within which every avatar with new data was sent last frame, and the farthest other avatar,
+    // FLT_MAX when no avatar was held over budget and when there are no other avatars
     void setFullRateDistance(float fullRateDistance) { _fullRateDistance = fullRateDistance; }
     float getFullRateDistance() const { return _fullRateDistance; }
 
     void setMaxAvatarDistance(float maxAvatarDistance) { _maxAvatarDistance = maxAvatarDistance; }
     float getMaxAvatarDistance() const { return _maxAvatarDistance; }
 
-    void resetNumAvatarsSentLastFrame() { _numAvatarsSentLastFrame = 0; }
-    void incrementNumAvatarsSentLastFrame() { ++_numAvatarsSentLastFrame; }
-    int getNumAvatarsSentLastFrame() const { return _numAvatarsSentLastFrame; }
+    void setNumAvatarsInViewLastFrame(int numAvatarsInView) { _numAvatarsInViewLastFrame = numAvatarsInView; }
+    int getNumAvatarsInViewLastFrame() const { return _numAvatarsInViewLastFrame; }
+
+    void recordNumOtherAvatarsOverBudget(int numAvatarsOverBudget)
+        { _otherAvatarsOverBudget.updateAverage((float) numAvatarsOverBudget); }
+    float getAvgNumOtherAvatarsOverBudgetPerSecond() const { return _otherAvatarsOverBudget.getAverageSampleValuePerSecond(); }
 
     void recordNumOtherAvatarStarves(int numAvatarsHeldBack) { _otherAvatarStarves.updateAverage((float) numAvatarsHeldBack); }
     float getAvgNumOtherAvatarStarvesPerSecond() const { return _otherAvatarStarves.getAverageSampleValuePerSecond(); }
@@ -67,38 +94,62 @@ public:
     void recordNumOtherAvatarSkips(int numOtherAvatarSkips) { _otherAvatarSkips.updateAverage((float) numOtherAvatarSkips); }
     float getAvgNumOtherAvatarSkipsPerSecond() const { return _otherAvatarSkips.getAverageSampleValuePerSecond(); }
 
+    // can be called by any of the AvatarMixer's workers, without the mutex
     void incrementNumOutOfOrderSends() { ++_numOutOfOrderSends; }
 
-    int getNumFramesSinceFRDAdjustment() const { return _numFramesSinceAdjustment; }
-    void incrementNumFramesSinceFRDAdjustment() { ++_numFramesSinceAdjustment; }
-    void resetNumFramesSinceFRDAdjustment() { _numFramesSinceAdjustment = 0; }
-
     void recordSentAvatarData(int numBytes) { _avgOtherAvatarDataRate.updateAverage((float) numBytes); }
 
     float getOutboundAvatarDataKbps() const
         { return _avgOtherAvatarDataRate.getAverageSampleValuePerSecond() / (float) BYTES_PER_KILOBIT; }
 
+    // the avatar data for this avatar as it is sent to every receiver in a broadcast frame, full or as a delta
+    // it is encoded on the first request in a frame and re-used for the rest, so the caller must hold the mutex
+    const QByteArray& getAvatarDataForFrame(uint32_t frame, bool sendAll);
+
+    // returns the number of encodes done by getAvatarDataForFrame since the last call
+    int takeNumAvatarDataEncodes() { int numEncodes = _numAvatarDataEncodes; _numAvatarDataEncodes = 0; return numEncodes; }
+
     void loadJSONStats(QJsonObject& jsonObject) const;
 private:
+    struct EncodedAvatarData {
+        QByteArray data;
+        uint32_t frame { 0 };
+        bool isValid { false };
+    };
+
     AvatarSharedPointer _avatar { new AvatarData() };
 
     uint16_t _lastReceivedSequenceNumber { 0 };
     std::unordered_map<QUuid, uint16_t> _lastBroadcastSequenceNumbers;
+    std::unordered_map<QUuid, uint32_t> _lastBroadcastFrames;
     std::unordered_set<QUuid> _hasReceivedFirstPacketsFrom;
 
     HRCTime _identityChangeTimestamp;
 
+    QByteArray _identityData;
+    HRCTime _identityDataTimestamp;
+
+    ViewFrustum _viewFrustum;
+    bool _hasViewFrustum = false;
+
+    float _avatarDataBudget = 0.0f;
+
     float _fullRateDistance = FLT_MAX;
     float _maxAvatarDistance = FLT_MAX;
 
     int _numAvatarsSentLastFrame = 0;
-    int _numFramesSinceAdjustment = 0;
+    int _numAvatarsInViewLastFrame = 0;
 
     SimpleMovingAverage _otherAvatarStarves;
+    SimpleMovingAverage _otherAvatarsOverBudget;
     SimpleMovingAverage _otherAvatarSkips;
-    int _numOutOfOrderSends = 0;
+    std::atomic<int> _numOutOfOrderSends { 0 };
 
     SimpleMovingAverage _avgOtherAvatarDataRate;
+
+    EncodedAvatarData _fullAvatarData;
+    EncodedAvatarData _deltaAvatarData;
+    int _numAvatarDataEncodes = 0;
 };
 
 #endif // hifi_AvatarMixerClientData_h
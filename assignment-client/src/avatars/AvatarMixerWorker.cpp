@@ -0,0 +1,257 @@
+//
+//  AvatarMixerWorker.cpp
+//  assignment-client/src/avatars
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cfloat>
+
+#include <udt/PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "AvatarMixer.h"
+#include "AvatarMixerClientData.h"
+
+#include "AvatarMixerWorker.h"
+
+// An 80% chance of sending a identity packet within a 5 second interval.
+// assuming 60 htz update rate.
+const float IDENTITY_SEND_PROBABILITY = 1.0f / 187.0f;
+
+// avatars are sent in priority order until the receiver's bandwidth budget for the frame is spent:
+// the nearer an avatar is the higher it starts, it is lowered if it is out of view or hasn't moved in a while,
+// and it is raised for every frame it has had to wait, so every avatar eventually gets through
+const float MIN_PRIORITY_DISTANCE = 1.0f;
+const float OUT_OF_VIEW_PRIORITY_SCALE = 0.25f;
+const float NOT_MOVING_PRIORITY_SCALE = 0.5f;
+const uint32_t RECENTLY_MOVED_FRAMES = AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+
+// the radius around an avatar's position used to test it against the receiver's view
+const float AVATAR_VIEW_RADIUS = 1.0f;
+
+// a receiver that hasn't been sent an avatar for this long may have missed joint changes in the deltas, so it gets it in full
+const uint32_t FULL_UPDATE_AFTER_FRAMES = AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+
+void AvatarMixerStats::accumulate(const AvatarMixerStats& otherStats) {
+    sumListeners += otherStats.sumListeners;
+    identityPackets += otherStats.identityPackets;
+    avatarDataSends += otherStats.avatarDataSends;
+    avatarsInView += otherStats.avatarsInView;
+    avatarsOverBudget += otherStats.avatarsOverBudget;
+    contendedLocks += otherStats.contendedLocks;
+}
+
+void AvatarMixerWorkerTiming::addFrame(quint64 broadcastUsecs) {
+    ++frames;
+    sumBroadcastUsecs += broadcastUsecs;
+    maxBroadcastUsecs = std::max(maxBroadcastUsecs, broadcastUsecs);
+
+    if (broadcastUsecs > (quint64) AVATAR_DATA_SEND_INTERVAL_MSECS * USECS_PER_MSEC) {
+        ++framesOverDeadline;
+    }
+}
+
+AvatarMixerWorker::AvatarMixerWorker(const AvatarMixer& mixer) :
+    _mixer(mixer)
+{
+    std::random_device randomDevice;
+    _generator.seed(randomDevice());
+}
+
+void AvatarMixerWorker::broadcastToReceiver(const AvatarSnapshot& receiver, const AvatarSnapshotList& avatars,
+                                            AvatarMixerBroadcast& broadcast) {
+    // the state of the receiver is only ever held briefly by the packet handlers, so rather than skip it for
+    // the frame we wait for it, and count how often that happens
+    QMutex& mutex = receiver.nodeData->getMutex();
+    if (!mutex.tryLock()) {
+        ++stats.contendedLocks;
+        mutex.lock();
+    }
+
+    broadcastToLockedReceiver(receiver, avatars, broadcast);
+
+    mutex.unlock();
+}
+
+void AvatarMixerWorker::broadcastToLockedReceiver(const AvatarSnapshot& receiver, const AvatarSnapshotList& avatars,
+                                                  AvatarMixerBroadcast& broadcast) {
+    AvatarMixerClientData* nodeData = receiver.nodeData;
+    const QUuid& receiverID = receiver.node->getUUID();
+    uint32_t frame = _mixer._broadcastFrame;
+
+    ++stats.sumListeners;
+
+    // reset the number of sent avatars
+    nodeData->resetNumAvatarsSentLastFrame();
+
+    // keep track of outbound data rate specifically for avatar data
+    int numAvatarDataBytes = 0;
+
+    // keep track of the number of other avatars held back in this frame
+    int numAvatarsHeldBack = 0;
+
+    // keep track of the number of other avatar frames skipped
+    int numAvatarsWithSkippedFrames = 0;
+
+    int numAvatarsInView = 0;
+
+    // reset the max distance for this frame
+    float maxAvatarDistanceThisFrame = 0.0f;
+    bool hasOtherAvatars = false;
+
+    broadcast.identityPackets.clear();
+    _prioritizedAvatars.clear();
+
+    for (const AvatarSnapshot* other : avatars) {
+        const QUuid& otherID = other->node->getUUID();
+        if (otherID == receiverID) {
+            continue;
+        }
+
+        hasOtherAvatars = true;
+
+        // potentially update the max distance for this frame
+        float distanceToAvatar = glm::length(receiver.position - other->position);
+        maxAvatarDistanceThisFrame = std::max(maxAvatarDistanceThisFrame, distanceToAvatar);
+
+        // make sure we send out identity packets to and from new arrivals.
+        bool forceSend = !nodeData->checkAndSetHasReceivedFirstPacketsFrom(otherID);
+
+        if (other->identityChangeTimestamp.time_since_epoch().count() > 0
+            && (forceSend
+                || other->identityChangeTimestamp > _mixer._lastFrameTimestamp
+                || _distribution(_generator) < IDENTITY_SEND_PROBABILITY)) {
+
+            auto identityPacket = NLPacket::create(PacketType::AvatarIdentity, other->identityData.size());
+            identityPacket->write(other->identityData);
+
+            broadcast.identityPackets.push_back(std::move(identityPacket));
+
+            ++stats.identityPackets;
+        }
+
+        AvatarDataSequenceNumber lastSeqToReceiver = nodeData->getLastBroadcastSequenceNumber(otherID);
+        AvatarDataSequenceNumber lastSeqFromSender = other->lastReceivedSequenceNumber;
+
+        if (lastSeqToReceiver > lastSeqFromSender && lastSeqToReceiver != UINT16_MAX) {
+            // we got out out of order packets from the sender, track it
+            other->nodeData->incrementNumOutOfOrderSends();
+        }
+
+        // make sure we haven't already sent this data from this sender to this receiver
+        // or that somehow we haven't sent
+        if (lastSeqToReceiver == lastSeqFromSender && lastSeqToReceiver != 0) {
+            ++numAvatarsHeldBack;
+            continue;
+        }
+
+        bool isInView = !receiver.hasViewFrustum
+            || receiver.viewFrustum.sphereIntersectsKeyhole(other->position, AVATAR_VIEW_RADIUS);
+        if (isInView) {
+            ++numAvatarsInView;
+        }
+
+        uint32_t framesSinceSent = frame - nodeData->getLastBroadcastFrame(otherID);
+
+        float priority = 1.0f / std::max(distanceToAvatar, MIN_PRIORITY_DISTANCE);
+        if (!isInView) {
+            priority *= OUT_OF_VIEW_PRIORITY_SCALE;
+        }
+        if (frame - other->lastMovedFrame > RECENTLY_MOVED_FRAMES) {
+            priority *= NOT_MOVING_PRIORITY_SCALE;
+        }
+        priority *= (float) framesSinceSent;
+
+        _prioritizedAvatars.emplace_back(priority, other);
+    }
+
+    std::sort(_prioritizedAvatars.begin(), _prioritizedAvatars.end(),
+              [](const std::pair<float, const AvatarSnapshot*>& a, const std::pair<float, const AvatarSnapshot*>& b) {
+        return a.first > b.first;
+    });
+
+    // top up what we can send this frame - an avatar that overshot the budget last frame is paid back from this one
+    // with no bandwidth limit set, every avatar with new data is sent
+    float maxBytesPerFrame = _mixer._maxKbpsPerNode * BYTES_PER_KILOBIT / AVATAR_MIXER_BROADCAST_FRAMES_PER_SECOND;
+    float budget = maxBytesPerFrame > 0.0f
+        ? std::min(nodeData->getAvatarDataBudget() + maxBytesPerFrame, maxBytesPerFrame) : FLT_MAX;
+
+    // setup a PacketList for the avatarPackets
+    broadcast.avatarPacketList = NLPacketList::create(PacketType::BulkAvatarData);
+    auto& avatarPacketList = broadcast.avatarPacketList;
+
+    int numAvatarsOverBudget = 0;
+
+    // the nearest avatar held over budget - every avatar with new data nearer than it was sent
+    float fullRateDistance = FLT_MAX;
+
+    for (const auto& prioritizedAvatar : _prioritizedAvatars) {
+        const AvatarSnapshot* other = prioritizedAvatar.second;
+
+        if (budget <= 0.0f) {
+            ++numAvatarsOverBudget;
+            fullRateDistance = std::min(fullRateDistance, glm::length(receiver.position - other->position));
+            continue;
+        }
+
+        const QUuid& otherID = other->node->getUUID();
+
+        AvatarDataSequenceNumber lastSeqToReceiver = nodeData->getLastBroadcastSequenceNumber(otherID);
+        AvatarDataSequenceNumber lastSeqFromSender = other->lastReceivedSequenceNumber;
+
+        if (lastSeqFromSender - lastSeqToReceiver > 1) {
+            // this is a skip - we still send the packet but capture the presence of the skip so we see it happening
+            ++numAvatarsWithSkippedFrames;
+        }
+
+        // we're going to send this avatar
+        bool sendAll = frame - nodeData->getLastBroadcastFrame(otherID) > FULL_UPDATE_AFTER_FRAMES
+            || _distribution(_generator) < AVATAR_SEND_FULL_UPDATE_RATIO;
+
+        // increment the number of avatars sent to this reciever
+        nodeData->incrementNumAvatarsSentLastFrame();
+
+        // set the last sent sequence number for this sender on the receiver
+        nodeData->setLastBroadcastSequenceNumber(otherID, lastSeqFromSender);
+        nodeData->setLastBroadcastFrame(otherID, frame);
+
+        // start a new segment in the PacketList for this avatar
+        avatarPacketList->startSegment();
+
+        // every receiver this frame shares the one encoding of this avatar
+        int numBytes = avatarPacketList->write(otherID.toRfc4122());
+        numBytes += avatarPacketList->write(sendAll ? other->fullAvatarData : other->deltaAvatarData);
+        ++stats.avatarDataSends;
+
+        avatarPacketList->endSegment();
+
+        numAvatarDataBytes += numBytes;
+        budget -= numBytes;
+    }
+
+    nodeData->setAvatarDataBudget(budget);
+
+    // close the current packet so that we're always sending something
+    avatarPacketList->closeCurrentPacket(true);
+
+    // record the bytes sent for other avatar data in the AvatarMixerClientData
+    nodeData->recordSentAvatarData(numAvatarDataBytes);
+
+    // record the number of avatars held back this frame
+    nodeData->recordNumOtherAvatarStarves(numAvatarsHeldBack);
+    nodeData->recordNumOtherAvatarSkips(numAvatarsWithSkippedFrames);
+    nodeData->recordNumOtherAvatarsOverBudget(numAvatarsOverBudget);
+    nodeData->setNumAvatarsInViewLastFrame(numAvatarsInView);
+
+    nodeData->setFullRateDistance(fullRateDistance);
+    // with no other avatars there is nothing to be far from
+    nodeData->setMaxAvatarDistance(hasOtherAvatars ? maxAvatarDistanceThisFrame : FLT_MAX);
+
+    stats.avatarsInView += numAvatarsInView;
+    stats.avatarsOverBudget += numAvatarsOverBudget;
+}
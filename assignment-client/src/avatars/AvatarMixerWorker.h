@@ -0,0 +1,111 @@
+//
+//  AvatarMixerWorker.h
+//  assignment-client/src/avatars
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AvatarMixerWorker_h
+#define hifi_AvatarMixerWorker_h
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <AvatarData.h>
+#include <NLPacket.h>
+#include <NLPacketList.h>
+#include <Node.h>
+#include <PortableHighResolutionClock.h>
+#include <ViewFrustum.h>
+
+class AvatarMixer;
+class AvatarMixerClientData;
+
+// what the workers need to know about an avatar to send it, copied out under its lock once per frame
+// so that the workers never lock the other avatars while they broadcast
+struct AvatarSnapshot {
+    SharedNodePointer node;
+    AvatarMixerClientData* nodeData { nullptr };
+    bool isReceiver { false }; // an agent with an active socket, that this frame is broadcast to
+
+    glm::vec3 position;
+    uint32_t lastMovedFrame { 0 };
+    AvatarDataSequenceNumber lastReceivedSequenceNumber { 0 };
+    p_high_resolution_clock::time_point identityChangeTimestamp;
+
+    QByteArray identityData; // with the UUID of the node in place
+    QByteArray deltaAvatarData;
+    QByteArray fullAvatarData;
+
+    // what the node can see, if it is a receiver that has told us
+    ViewFrustum viewFrustum;
+    bool hasViewFrustum { false };
+
+    uint32_t frame { 0 }; // the frame this was taken in, which is older than the current one if the node was locked
+};
+
+using AvatarSnapshotList = std::vector<const AvatarSnapshot*>;
+
+// the packets for one receiver in a frame, which the AvatarMixer sends once every worker is done
+struct AvatarMixerBroadcast {
+    std::unique_ptr<NLPacketList> avatarPacketList;
+    std::vector<std::unique_ptr<NLPacket>> identityPackets;
+};
+
+// counters for what was sent, summed by the AvatarMixer across all of its workers
+struct AvatarMixerStats {
+    int sumListeners { 0 };
+    int identityPackets { 0 };
+    int avatarDataSends { 0 };
+    int avatarsInView { 0 };
+    int avatarsOverBudget { 0 }; // avatars with new data that didn't fit in what a receiver could be sent
+    int contendedLocks { 0 }; // receivers that were locked by another thread, and had to be waited for
+
+    void reset() { *this = AvatarMixerStats(); }
+    void accumulate(const AvatarMixerStats& otherStats);
+};
+
+// per-worker timing, reported by the AvatarMixer in its stats packet
+struct AvatarMixerWorkerTiming {
+    int frames { 0 };
+    int framesOverDeadline { 0 };
+    quint64 sumBroadcastUsecs { 0 };
+    quint64 maxBroadcastUsecs { 0 };
+
+    void reset() { *this = AvatarMixerWorkerTiming(); }
+    void addFrame(quint64 broadcastUsecs);
+};
+
+/// Prepares the avatar data sent to receivers for the AvatarMixer - each worker keeps its own random numbers and
+/// counters so that several workers can handle different receivers of the same frame concurrently.
+class AvatarMixerWorker {
+public:
+    AvatarMixerWorker(const AvatarMixer& mixer);
+
+    /// prepares the packets with the other avatars in the snapshot for one receiver
+    void broadcastToReceiver(const AvatarSnapshot& receiver, const AvatarSnapshotList& avatars,
+                             AvatarMixerBroadcast& broadcast);
+
+    AvatarMixerStats stats;
+    AvatarMixerWorkerTiming timing;
+
+private:
+    void broadcastToLockedReceiver(const AvatarSnapshot& receiver, const AvatarSnapshotList& avatars,
+                                   AvatarMixerBroadcast& broadcast);
+
+    const AvatarMixer& _mixer;
+
+    // scratch space for putting the avatars sent to each receiver in order
+    std::vector<std::pair<float, const AvatarSnapshot*>> _prioritizedAvatars;
+
+    std::mt19937 _generator;
+    std::uniform_real_distribution<float> _distribution;
+};
+
+#endif // hifi_AvatarMixerWorker_h
@@ -0,0 +1,72 @@
+//
+//  AvatarMixerWorkerPool.cpp
+//  assignment-client/src/avatars
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDebug>
+
+#include <SharedUtil.h>
+
+#include "AvatarMixerWorkerPool.h"
+
+AvatarMixerWorkerPool::AvatarMixerWorkerPool(const AvatarMixer& mixer, int numThreads) :
+    _mixer(mixer)
+{
+    setNumThreads(numThreads);
+}
+
+void AvatarMixerWorkerPool::setNumThreads(int numThreads) {
+    numThreads = FrameWorkerPool::resolveNumThreads(numThreads);
+
+    if (numThreads == (int) _workers.size()) {
+        return;
+    }
+
+    // the threads hold on to the workers, so they have to be gone before the workers are replaced
+    _threads.stop();
+
+    _workers.clear();
+    for (int i = 0; i < numThreads; ++i) {
+        _workers.emplace_back(new AvatarMixerWorker(_mixer));
+    }
+
+    qDebug() << "AvatarMixer is broadcasting with" << numThreads << (numThreads == 1 ? "thread" : "threads");
+
+    _threads.start(numThreads);
+}
+
+void AvatarMixerWorkerPool::broadcast(const AvatarSnapshotList& receivers, const AvatarSnapshotList& avatars,
+                                      BroadcastList& broadcasts) {
+    broadcasts.resize(receivers.size());
+
+    _receivers = &receivers;
+    _avatars = &avatars;
+    _broadcasts = &broadcasts;
+    _nextReceiver = 0;
+
+    _threads.runFrame([this](int threadIndex) {
+        broadcastToReceivers(*_workers[threadIndex]);
+    });
+
+    _receivers = nullptr;
+    _avatars = nullptr;
+    _broadcasts = nullptr;
+}
+
+void AvatarMixerWorkerPool::broadcastToReceivers(AvatarMixerWorker& worker) {
+    auto broadcastStart = usecTimestampNow();
+
+    // workers grab the next receiver until there are none left, which balances the load between them
+    size_t numReceivers = _receivers->size();
+    size_t index;
+    while ((index = _nextReceiver++) < numReceivers) {
+        worker.broadcastToReceiver(*(*_receivers)[index], *_avatars, (*_broadcasts)[index]);
+    }
+
+    worker.timing.addFrame(usecTimestampNow() - broadcastStart);
+}
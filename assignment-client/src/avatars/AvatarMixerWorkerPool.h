@@ -0,0 +1,59 @@
+//
+//  AvatarMixerWorkerPool.h
+//  assignment-client/src/avatars
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AvatarMixerWorkerPool_h
+#define hifi_AvatarMixerWorkerPool_h
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <FrameWorkerPool.h>
+
+#include "AvatarMixerWorker.h"
+
+/// Splits the receivers of each frame across a fixed set of AvatarMixerWorkers.
+/// With a single thread the broadcast happens on the calling (AvatarMixer broadcast) thread, as it always has.
+class AvatarMixerWorkerPool {
+public:
+    using BroadcastList = std::vector<AvatarMixerBroadcast>;
+
+    AvatarMixerWorkerPool(const AvatarMixer& mixer, int numThreads = 1);
+
+    /// prepares the packets of the avatars in the snapshot for every receiver, blocking until all of them are done
+    /// broadcasts is filled with the packets for the receiver at the same index
+    void broadcast(const AvatarSnapshotList& receivers, const AvatarSnapshotList& avatars, BroadcastList& broadcasts);
+
+    /// 0 sets one thread per hardware thread
+    void setNumThreads(int numThreads);
+    int numThreads() const { return (int) _workers.size(); }
+
+    template <typename Functor>
+    void forEachWorker(Functor functor) {
+        for (auto& worker : _workers) {
+            functor(*worker);
+        }
+    }
+
+private:
+    void broadcastToReceivers(AvatarMixerWorker& worker);
+
+    const AvatarMixer& _mixer;
+
+    std::vector<std::unique_ptr<AvatarMixerWorker>> _workers;
+    FrameWorkerPool _threads;
+
+    const AvatarSnapshotList* _receivers { nullptr };
+    const AvatarSnapshotList* _avatars { nullptr };
+    BroadcastList* _broadcasts { nullptr };
+    std::atomic<size_t> _nextReceiver { 0 };
+};
+
+#endif // hifi_AvatarMixerWorkerPool_h
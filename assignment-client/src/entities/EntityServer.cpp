@@ -54,6 +54,7 @@ std::unique_ptr<OctreeQueryNode> EntityServer::createOctreeQueryNode() {
 OctreePointer EntityServer::createTree() {
     EntityTreePointer tree = EntityTreePointer(new EntityTree(true));
     tree->createRootElement();
+    tree->setTrackElementChanges(true);
     tree->addNewlyCreatedHook(this);
     if (!_entitySimulation) {
         SimpleEntitySimulationPointer simpleSimulation { new SimpleEntitySimulation() };
@@ -312,6 +313,18 @@ QString EntityServer::serverSubclassStats() {
     statsString += QString().sprintf("       EntityItem size... %ld bytes\r\n", sizeof(EntityItem));
     statsString += "\r\n\r\n";
 
+    // entities sent from an already encoded copy vs. encoded from scratch
+    quint64 encodeCacheHits = EntityItem::getEncodeCacheHits();
+    quint64 encodeCacheMisses = EntityItem::getEncodeCacheMisses();
+    quint64 encodeCacheLookups = encodeCacheHits + encodeCacheMisses;
+    statsString += "<b>Entity Server Encode Cache Statistics</b>\r\n";
+    statsString += QString("    Hits: %1 (%2%)\r\n")
+        .arg(locale.toString(encodeCacheHits).rightJustified(16, ' '))
+        .arg(encodeCacheLookups > 0 ? (double)encodeCacheHits * 100.0 / (double)encodeCacheLookups : 0.0, 0, 'f', 2);
+    statsString += QString("  Misses: %1\r\n")
+        .arg(locale.toString(encodeCacheMisses).rightJustified(16, ' '));
+    statsString += "\r\n\r\n";
+
     statsString += "<b>Entity Server Sending to Viewer Statistics</b>\r\n";
     statsString += "----- Viewer Node ID -----------------    ----- Entity ID ----------------------    "
                    "---------- Last Sent To ----------    ---------- Last Edited -----------\r\n";
@@ -243,6 +243,20 @@ void OctreeQueryNode::updateLastKnownViewFrustum() {
 
     // save that we know the view has been sent.
     setLastTimeBagEmpty();
+    _lastChangeSequence = _sceneChangeSequence;
+}
+
+void OctreeQueryNode::setSceneChangeSequence(quint64 sequence, bool isIncrementalScene) {
+    _sceneChangeSequence = sequence;
+    _isIncrementalScene = isIncrementalScene;
+}
+
+void OctreeQueryNode::trackSceneTraversal(bool isIncrementalScene, quint64 elementsTraversed) {
+    if (isIncrementalScene) {
+        _averageIncrementalSceneTraversal.updateAverage((float)elementsTraversed);
+    } else {
+        _averageFullSceneTraversal.updateAverage((float)elementsTraversed);
+    }
 }
 
 
@@ -20,6 +20,7 @@
 #include <OctreePacketData.h>
 #include <OctreeQuery.h>
 #include <OctreeSceneStats.h>
+#include <SimpleMovingAverage.h>
 #include "SentPacketHistory.h"
 #include <qqueue.h>
 
@@ -75,6 +76,16 @@ public:
     quint64 getLastTimeBagEmpty() const { return _lastTimeBagEmpty; }
     void setLastTimeBagEmpty() { _lastTimeBagEmpty = _sceneSendStartTime; }
 
+    // octree change sequence this viewer has received every edit up to, and the one the current scene will bring it to
+    quint64 getLastChangeSequence() const { return _lastChangeSequence; }
+    void setSceneChangeSequence(quint64 sequence, bool isIncrementalScene);
+    bool isIncrementalScene() const { return _isIncrementalScene; }
+
+    // elements visited per completed scene for this viewer, shown on the server's status page
+    void trackSceneTraversal(bool isIncrementalScene, quint64 elementsTraversed);
+    const SimpleMovingAverage& getFullSceneTraversal() const { return _averageFullSceneTraversal; }
+    const SimpleMovingAverage& getIncrementalSceneTraversal() const { return _averageIncrementalSceneTraversal; }
+
     bool hasLodChanged() const { return _lodChanged; }
 
     OctreeSceneStats stats;
@@ -119,6 +130,11 @@ private:
     ViewFrustum _currentViewFrustum;
     ViewFrustum _lastKnownViewFrustum;
     quint64 _lastTimeBagEmpty { 0 };
+    quint64 _lastChangeSequence { 0 };
+    quint64 _sceneChangeSequence { 0 };
+    bool _isIncrementalScene { false };
+    SimpleMovingAverage _averageFullSceneTraversal;
+    SimpleMovingAverage _averageIncrementalSceneTraversal;
     bool _viewFrustumChanging { false };
     bool _viewFrustumJustStoppedChanging { true };
 
@@ -9,13 +9,9 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
-#include <chrono>
-#include <thread>
-
 #include <NodeList.h>
 #include <NumericalConstants.h>
 #include <udt/PacketHeaders.h>
-#include <PerfStat.h>
 
 #include "OctreeQueryNode.h"
 #include "OctreeSendThread.h"
@@ -26,14 +22,19 @@
 quint64 startSceneSleepTime = 0;
 quint64 endSceneSleepTime = 0;
 
-OctreeSendThread::OctreeSendThread(OctreeServer* myServer, const SharedNodePointer& node) :
+static const auto SEND_INTERVAL = std::chrono::duration_cast<DeadlineScheduler::Clock::duration>(
+    std::chrono::microseconds(OCTREE_SEND_INTERVAL_USECS));
+
+OctreeSendThread::OctreeSendThread(OctreeServer* myServer, DeadlineScheduler* scheduler,
+                                   const SharedNodePointer& node) :
     _myServer(myServer),
+    _scheduler(scheduler),
     _node(node),
     _nodeUuid(node->getUUID())
 {
     QString safeServerName("Octree");
 
-    // set our QThread object name so we can identify this thread while debugging
+    // set our object name so we can identify this client's sender while debugging
     setObjectName(QString("Octree Send Thread (%1)").arg(uuidStringWithoutCurlyBraces(_nodeUuid)));
 
     if (_myServer) {
@@ -46,8 +47,15 @@ OctreeSendThread::OctreeSendThread(OctreeServer* myServer, const SharedNodePoint
     OctreeServer::clientConnected();
 }
 
+void OctreeSendThread::start() {
+    _scheduler->add(this, DeadlineScheduler::Clock::now());
+}
+
 OctreeSendThread::~OctreeSendThread() {
     setIsShuttingDown();
+
+    // waits for a slice that is running right now
+    _scheduler->remove(this);
     
     QString safeServerName("Octree");
     if (_myServer) {
@@ -73,8 +81,6 @@ bool OctreeSendThread::process() {
 
     OctreeServer::didProcess(this);
 
-    quint64  start = usecTimestampNow();
-
     // we'd better have a server at this point, or we're in trouble
     assert(_myServer);
 
@@ -98,29 +104,21 @@ bool OctreeSendThread::process() {
         return false; // exit early if we're shutting down
     }
 
-    // Only sleep if we're still running and we got the lock last time we tried, otherwise try to get the lock asap
-    if (isStillRunning()) {
-        // dynamically sleep until we need to fire off the next set of octree elements
-        int elapsed = (usecTimestampNow() - start);
-        int usecToSleep =  OCTREE_SEND_INTERVAL_USECS - elapsed;
-
-        if (usecToSleep <= 0) {
-            const int MIN_USEC_TO_SLEEP = 1;
-            usecToSleep = MIN_USEC_TO_SLEEP;
-        }
-
-        {
-            PerformanceWarning warn(false,"OctreeSendThread... usleep()",false,&_usleepTime,&_usleepCalls);
-            std::this_thread::sleep_for(std::chrono::microseconds(usecToSleep));
-        }
+    return true;  // keep running till the server shuts us down
+}
 
+DeadlineScheduler::TimePoint OctreeSendThread::runScheduledTask(DeadlineScheduler::TimePoint deadline,
+                                                               DeadlineScheduler::TimePoint now) {
+    if (!process()) {
+        // the server deletes us when it hears this, which waits for this slice to be over
+        emit finished();
+        return DeadlineScheduler::NEVER;
     }
 
-    return isStillRunning();  // keep running till they terminate us
+    // a client whose slices run late goes behind everyone else that is due, rather than catching up
+    return std::max(deadline + SEND_INTERVAL, DeadlineScheduler::Clock::now());
 }
 
-AtomicUIntStat OctreeSendThread::_usleepTime { 0 };
-AtomicUIntStat OctreeSendThread::_usleepCalls { 0 };
 AtomicUIntStat OctreeSendThread::_totalBytes { 0 };
 AtomicUIntStat OctreeSendThread::_totalWastedBytes { 0 };
 AtomicUIntStat OctreeSendThread::_totalPackets { 0 };
@@ -376,14 +374,38 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
         nodeData->stats.sceneStarted(isFullScene, viewFrustumChanged,
                                      _myServer->getOctree()->getRoot(), _myServer->getJurisdiction());
 
-        // This is the start of "resending" the scene.
-        bool dontRestartSceneOnMove = false; // this is experimental
-        if (dontRestartSceneOnMove) {
-            if (nodeData->elementBag.isEmpty()) {
-                nodeData->elementBag.insert(_myServer->getOctree()->getRoot());
+        // A viewer that already has everything in its unchanged view only needs the subtrees holding elements
+        // edited since then. Moving viewers, full scenes and gaps in the change log get a traversal from the root.
+        OctreePointer octree = _myServer->getOctree();
+        std::vector<OctreeElementPointer> changedSubtrees;
+        quint64 changeSequence = 0;
+        bool isIncrementalScene = false;
+        octree->withReadLock([&]{
+            changeSequence = octree->getChangeSequence();
+            if (!viewFrustumChanged && !isFullScene && nodeData->getViewSent()) {
+                isIncrementalScene = octree->getChangedSubtreesSince(nodeData->getLastChangeSequence(), changedSubtrees);
+            }
+        });
+        nodeData->setSceneChangeSequence(changeSequence, isIncrementalScene);
+
+        if (isIncrementalScene) {
+            for (auto& subtree : changedSubtrees) {
+                nodeData->elementBag.insert(subtree);
+            }
+            if (changedSubtrees.empty()) {
+                // nothing this viewer can see was edited, so it is already caught up
+                nodeData->updateLastKnownViewFrustum();
             }
         } else {
-            nodeData->elementBag.insert(_myServer->getOctree()->getRoot());
+            // This is the start of "resending" the scene.
+            bool dontRestartSceneOnMove = false; // this is experimental
+            if (dontRestartSceneOnMove) {
+                if (nodeData->elementBag.isEmpty()) {
+                    nodeData->elementBag.insert(octree->getRoot());
+                }
+            } else {
+                nodeData->elementBag.insert(octree->getRoot());
+            }
         }
     }
 
@@ -588,6 +610,9 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
         // if after sending packets we've emptied our bag, then we want to remember that we've sent all
         // the octree elements from the current view frustum
         if (nodeData->elementBag.isEmpty()) {
+            OctreeServer::trackSceneTraversal(nodeData->isIncrementalScene(), nodeData->stats.getTraversed());
+            nodeData->trackSceneTraversal(nodeData->isIncrementalScene(), nodeData->stats.getTraversed());
+
             nodeData->updateLastKnownViewFrustum();
             nodeData->setViewSent(true);
 
@@ -5,7 +5,7 @@
 //  Created by Brad Hefta-Gaub on 8/21/13.
 //  Copyright 2013 High Fidelity, Inc.
 //
-//  Threaded or non-threaded object for sending octree data packets to a client
+//  Object for sending octree data packets to a client, run in slices by the server's send scheduler
 //
 //  Distributed under the Apache License, Version 2.0.
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
@@ -16,20 +16,28 @@
 
 #include <atomic>
 
-#include <GenericThread.h>
+#include <QtCore/QObject>
+
+#include <DeadlineScheduler.h>
 
 class OctreeQueryNode;
 class OctreeServer;
 
 using AtomicUIntStat = std::atomic<uintmax_t>;
 
-/// Threaded processor for sending octree packets to a single client
-class OctreeSendThread : public GenericThread {
+/// Processor for sending octree packets to a single client. It has no thread of its own, despite the name - each call
+/// to process() is one send interval's slice, run on one of the threads of the server's send scheduler. Each client
+/// gets one slice per send interval, and a busy server falls behind evenly since the client whose slice has been due
+/// the longest always goes next.
+class OctreeSendThread : public QObject, public DeadlineScheduler::Task {
     Q_OBJECT
 public:
-    OctreeSendThread(OctreeServer* myServer, const SharedNodePointer& node);
+    OctreeSendThread(OctreeServer* myServer, DeadlineScheduler* scheduler, const SharedNodePointer& node);
     virtual ~OctreeSendThread();
 
+    /// Starts running slices on the scheduler - the first one can finish, and emit finished(), before this returns
+    void start();
+
     void setIsShuttingDown();
     bool isShuttingDown() { return _isShuttingDown; }
     
@@ -42,12 +50,17 @@ public:
     static AtomicUIntStat _totalSpecialBytes;
     static AtomicUIntStat _totalSpecialPackets;
 
-    static AtomicUIntStat _usleepTime;
-    static AtomicUIntStat _usleepCalls;
+signals:
+    /// Emitted from a scheduler thread once there is no one left to send to, the server then deletes us
+    void finished();
 
 protected:
-    /// Implements generic processing behavior for this thread.
-    virtual bool process();
+    /// Sends this client's packets for one interval, returns false once there is no one left to send to.
+    bool process();
+
+    /// Runs one slice, and returns when the next one is due
+    DeadlineScheduler::TimePoint runScheduledTask(DeadlineScheduler::TimePoint deadline,
+                                                  DeadlineScheduler::TimePoint now) override;
 
 private:
     int handlePacketSend(SharedNodePointer node, OctreeQueryNode* nodeData, int& trueBytesSent, int& truePacketsSent, bool dontSuppressDuplicate = false);
@@ -55,6 +68,7 @@ private:
     
     
     OctreeServer* _myServer { nullptr };
+    DeadlineScheduler* _scheduler { nullptr };
     QWeakPointer<Node> _node;
     QUuid _nodeUuid;
 
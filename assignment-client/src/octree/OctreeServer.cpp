@@ -15,6 +15,7 @@
 #include <QTimer>
 
 #include <time.h>
+#include <thread>
 
 #include <AccountManager.h>
 #include <HTTPConnection.h>
@@ -33,6 +34,7 @@
 
 int OctreeServer::_clientCount = 0;
 const int MOVING_AVERAGE_SAMPLE_COUNTS = 1000000;
+static const int MIN_SEND_THREADS = 2;
 
 float OctreeServer::SKIP_TIME = -1.0f; // use this for trackXXXTime() calls for non-times
 
@@ -71,6 +73,9 @@ int OctreeServer::_noCompress = 0;
 SimpleMovingAverage OctreeServer::_averagePacketSendingTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 int OctreeServer::_noSend = 0;
 
+SimpleMovingAverage OctreeServer::_averageFullSceneTraversal(MOVING_AVERAGE_SAMPLE_COUNTS);
+SimpleMovingAverage OctreeServer::_averageIncrementalSceneTraversal(MOVING_AVERAGE_SAMPLE_COUNTS);
+
 SimpleMovingAverage OctreeServer::_averageProcessWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 SimpleMovingAverage OctreeServer::_averageProcessShortWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
 SimpleMovingAverage OctreeServer::_averageProcessLongWaitTime(MOVING_AVERAGE_SAMPLE_COUNTS);
@@ -82,6 +87,10 @@ int OctreeServer::_noProcessWait = 0;
 
 
 void OctreeServer::resetSendingStats() {
+    if (_sendScheduler) {
+        _sendScheduler->resetStats();
+    }
+
     _averageLoopTime.reset();
 
     _averageEncodeTime.reset();
@@ -117,6 +126,9 @@ void OctreeServer::resetSendingStats() {
     _averagePacketSendingTime.reset();
     _noSend = 0;
 
+    _averageFullSceneTraversal.reset();
+    _averageIncrementalSceneTraversal.reset();
+
     _averageProcessWaitTime.reset();
     _averageProcessShortWaitTime.reset();
     _averageProcessLongWaitTime.reset();
@@ -147,6 +159,14 @@ void OctreeServer::trackEncodeTime(float time) {
     _averageEncodeTime.updateAverage(time);
 }
 
+void OctreeServer::trackSceneTraversal(bool isIncrementalScene, quint64 elementsTraversed) {
+    if (isIncrementalScene) {
+        _averageIncrementalSceneTraversal.updateAverage((float)elementsTraversed);
+    } else {
+        _averageFullSceneTraversal.updateAverage((float)elementsTraversed);
+    }
+}
+
 void OctreeServer::trackTreeWaitTime(float time) {
     const float MAX_SHORT_TIME = 10.0f;
     const float MAX_LONG_TIME = 100.0f;
@@ -441,6 +461,17 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("      writeDatagram() last second: %1 clients\r\n\r\n")
             .arg(locale.toString((uint)howManyThreadsDidCallWriteDatagram(oneSecondAgo)).rightJustified(COLUMN_WIDTH, ' '));
 
+        if (_sendScheduler) {
+            statsString += QString("              Send worker threads: %1 threads\r\n")
+                .arg(locale.toString(_sendScheduler->getNumThreads()).rightJustified(COLUMN_WIDTH, ' '));
+            statsString += QString().sprintf("         Send worker utilization:      %7.2f%%"
+                                             "                       slices: %12llu \r\n",
+                                             (double)(_sendScheduler->getUtilization() * AS_PERCENT),
+                                             (unsigned long long)_sendScheduler->getRuns());
+            statsString += QString().sprintf("          Average send slice time:    %9.2f usecs\r\n\r\n",
+                                             (double)_sendScheduler->getAverageRunUsecs());
+        }
+
         float averageLoopTime = getAverageLoopTime();
         statsString += QString().sprintf("           Average packetLoop() time:      %7.2f msecs"
                                          "                 samples: %12d \r\n",
@@ -451,6 +482,33 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
                                          "                 samples: %12d \r\n\r\n",
                                          (double)averageInsideTime, _averageInsideTime.getSampleCount());
 
+        // elements visited per completed scene, full traversals from the root vs. only the edited subtrees
+        statsString += QString().sprintf("  Avg elements traversed, full scene:  %9.2f elements"
+                                         "              samples: %12d \r\n",
+                                         (double)_averageFullSceneTraversal.getAverage(),
+                                         _averageFullSceneTraversal.getSampleCount());
+        statsString += QString().sprintf("  Avg elements traversed, edits only:  %9.2f elements"
+                                         "              samples: %12d \r\n\r\n",
+                                         (double)_averageIncrementalSceneTraversal.getAverage(),
+                                         _averageIncrementalSceneTraversal.getSampleCount());
+
+        // and the same per client, so a viewer that keeps needing full traversals stands out
+        DependencyManager::get<NodeList>()->eachNode([&](const SharedNodePointer& node) {
+            OctreeQueryNode* nodeData = dynamic_cast<OctreeQueryNode*>(node->getLinkedData());
+            if (!nodeData) {
+                return;
+            }
+            auto& fullScene = nodeData->getFullSceneTraversal();
+            auto& incrementalScene = nodeData->getIncrementalSceneTraversal();
+            statsString += QString("  Client %1:\r\n").arg(uuidStringWithoutCurlyBraces(node->getUUID()));
+            statsString += QString().sprintf("      elements traversed, full scene:  %9.2f elements"
+                                             "              samples: %12d \r\n",
+                                             (double)fullScene.getAverage(), fullScene.getSampleCount());
+            statsString += QString().sprintf("      elements traversed, edits only:  %9.2f elements"
+                                             "              samples: %12d \r\n",
+                                             (double)incrementalScene.getAverage(), incrementalScene.getSampleCount());
+        });
+        statsString += "\r\n";
 
         // Process Wait
         {
@@ -869,11 +927,18 @@ void OctreeServer::parsePayload() {
 }
 
 OctreeServer::UniqueSendThread OctreeServer::createSendThread(const SharedNodePointer& node) {
-    auto sendThread = std::unique_ptr<OctreeSendThread>(new OctreeSendThread(this, node));
+    if (!_sendScheduler) {
+        // encoding is CPU bound, so there is one send thread per core
+        int numThreads = std::max(MIN_SEND_THREADS, (int) std::thread::hardware_concurrency());
+        qDebug() << "Octree server is sending with" << numThreads << "threads";
+        _sendScheduler.reset(new DeadlineScheduler(numThreads));
+    }
+
+    auto sendThread = std::unique_ptr<OctreeSendThread>(new OctreeSendThread(this, _sendScheduler.get(), node));
     
-    // we want to be notified when the thread finishes
-    connect(sendThread.get(), &GenericThread::finished, this, &OctreeServer::removeSendThread);
-    sendThread->initialize(true);
+    // we want to be notified when the client's sending finishes, which can happen on the first slice
+    connect(sendThread.get(), &OctreeSendThread::finished, this, &OctreeServer::removeSendThread);
+    sendThread->start();
 
     return sendThread;
 }
@@ -1053,6 +1118,12 @@ void OctreeServer::readConfiguration() {
         qDebug() << "persistFilePath=" << _persistFilePath;
 
         _persistAsFileType = "json.gz";
+        if (readOptionString("persistFileType", settingsSectionObject, _persistAsFileType)
+            && _persistAsFileType != "json" && _persistAsFileType != "json.gz" && _persistAsFileType != "bin") {
+            qDebug() << "Unknown persistFileType" << _persistAsFileType << "- saving as json.gz";
+            _persistAsFileType = "json.gz";
+        }
+        qDebug() << "persistFileType=" << _persistAsFileType;
 
         _persistInterval = OctreePersistThread::DEFAULT_PERSIST_INTERVAL;
         readOptionInt(QString("persistInterval"), settingsSectionObject, _persistInterval);
@@ -1312,9 +1383,10 @@ void OctreeServer::aboutToFinish() {
         sendThread.setIsShuttingDown();
     }
     
-    // Clear will destruct all the unique_ptr to OctreeSendThreads which will call the GenericThread's dtor
-    // which waits on the thread to be done before returning
+    // Clear will destruct all the unique_ptr to OctreeSendThreads, each of which waits for a slice
+    // of its that is still running on the scheduler before returning
     _sendThreads.clear(); // Cleans up all the send threads.
+    _sendScheduler.reset();
 
     if (_persistThread) {
         _persistThread->aboutToFinish();
@@ -108,6 +108,8 @@ public:
     static void trackProcessWaitTime(float time);
     static float getAverageProcessWaitTime() { return _averageProcessWaitTime.getAverage(); }
 
+    static void trackSceneTraversal(bool isIncrementalScene, quint64 elementsTraversed);
+
     // these methods allow us to track which threads got to various states
     static void didProcess(OctreeSendThread* thread);
     static void didPacketDistributor(OctreeSendThread* thread);
@@ -196,6 +198,8 @@ protected:
     quint64 _startedUSecs;
     QString _safeServerName;
     
+    // declared ahead of the clients it runs, so that it outlives them
+    std::unique_ptr<DeadlineScheduler> _sendScheduler;
     SendThreads _sendThreads;
 
     static int _clientCount;
@@ -235,6 +239,9 @@ protected:
     static SimpleMovingAverage _averagePacketSendingTime;
     static int _noSend;
 
+    static SimpleMovingAverage _averageFullSceneTraversal;
+    static SimpleMovingAverage _averageIncrementalSceneTraversal;
+
     static SimpleMovingAverage _averageProcessWaitTime;
     static SimpleMovingAverage _averageProcessShortWaitTime;
     static SimpleMovingAverage _averageProcessLongWaitTime;
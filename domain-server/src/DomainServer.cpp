@@ -97,6 +97,11 @@ DomainServer::DomainServer(int argc, char* argv[]) :
     // make sure we hear about newly connected nodes from our gatekeeper
     connect(&_gatekeeper, &DomainGatekeeper::connectedNode, this, &DomainServer::handleConnectedNode);
 
+    // start the versions of the node list somewhere random, so that a node holding a list from before
+    // a restart of the domain-server is very unlikely to be sent a delta against it
+    std::random_device randomDevice;
+    _domainListVersion = std::max((quint32) randomDevice(), (quint32) 1);
+
     if (optionallyReadX509KeyAndCertificate() && optionallySetupOAuth()) {
         // we either read a certificate and private key or were not passed one
         // and completed login or did not need to
@@ -670,18 +675,31 @@ void DomainServer::processListRequestPacket(QSharedPointer<ReceivedMessage> mess
     QDataStream packetStream(message->getMessage());
     NodeConnectionData nodeRequestData = NodeConnectionData::fromDataStream(packetStream, message->getSenderSockAddr(), false);
 
-    // update this node's sockets in case they have changed
-    sendingNode->setPublicSocket(nodeRequestData.publicSockAddr);
-    sendingNode->setLocalSocket(nodeRequestData.localSockAddr);
+    // the node tells us the version of the list it already has, after what NodeConnectionData reads
+    quint32 knownListVersion = 0;
+    packetStream >> knownListVersion;
+
+    // update this node's sockets in case they have changed, and let the nodes that know it hear about that
+    if (sendingNode->getPublicSocket() != nodeRequestData.publicSockAddr
+        || sendingNode->getLocalSocket() != nodeRequestData.localSockAddr) {
+        sendingNode->setPublicSocket(nodeRequestData.publicSockAddr);
+        sendingNode->setLocalSocket(nodeRequestData.localSockAddr);
+        recordDomainListChange(sendingNode, false);
+    }
     
     // update the NodeInterestSet in case there have been any changes
     DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(sendingNode->getLinkedData());
-    nodeData->setNodeInterestSet(nodeRequestData.interestList.toSet());
+    NodeSet nodeInterestSet = nodeRequestData.interestList.toSet();
+    if (nodeInterestSet != nodeData->getNodeInterestSet()) {
+        // the node is now interested in nodes it doesn't know about yet, so send it the whole list
+        nodeData->setNodeInterestSet(nodeInterestSet);
+        knownListVersion = 0;
+    }
 
     // update the connecting hostname in case it has changed
     nodeData->setPlaceName(nodeRequestData.placeName);
 
-    sendDomainListToNode(sendingNode, message->getSenderSockAddr());
+    sendDomainListToNode(sendingNode, message->getSenderSockAddr(), knownListVersion);
 }
 
 unsigned int DomainServer::countConnectedUsers() {
@@ -737,6 +755,8 @@ QUrl DomainServer::oauthAuthorizationURL(const QUuid& stateUUID) {
 void DomainServer::handleConnectedNode(SharedNodePointer newNode) {
     
     DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(newNode->getLinkedData());
+
+    recordDomainListChange(newNode, false);
     
     // reply back to the user with a PacketType::DomainList
     sendDomainListToNode(newNode, nodeData->getSendingSockAddr());
@@ -745,66 +765,197 @@ void DomainServer::handleConnectedNode(SharedNodePointer newNode) {
     broadcastNewNode(newNode);
 }
 
-void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr &senderSockAddr) {
-    const int NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES = NUM_BYTES_RFC4122_UUID + NUM_BYTES_RFC4122_UUID + 2;
+void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr &senderSockAddr,
+                                        quint32 knownListVersion) {
+    auto limitedNodeList = DependencyManager::get<LimitedNodeList>();
+
+    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+    auto& nodeInterestSet = nodeData->getNodeInterestSet();
+
+    // only an authenticated node with interest types is sent other nodes
+    bool isSentNodes = nodeInterestSet.size() > 0 && nodeData->isAuthenticated();
+
+    if (isSentNodes && knownListVersion != 0) {
+        // send only what has changed since the list the node has, if we still know what that is
+        auto deltaPackets = createDomainListDelta(node, knownListVersion);
+        if (deltaPackets) {
+            limitedNodeList->sendPacketList(std::move(deltaPackets), *node);
+            return;
+        }
+    }
+
+    std::vector<SharedNodePointer> listedNodes;
+    if (isSentNodes) {
+        limitedNodeList->eachNode([&](const SharedNodePointer& otherNode){
+            if (otherNode->getUUID() != node->getUUID() && nodeInterestSet.contains(otherNode->getType())) {
+                listedNodes.push_back(otherNode);
+            }
+        });
+    }
+
+    // the number of nodes goes in each packet, so the node can tell when it has all of the list
+    auto domainListPackets = NLPacketList::create(PacketType::DomainList,
+                                                  domainListHeaderForNode(node, false, 0, (quint32) listedNodes.size()));
+    QDataStream domainListStream(domainListPackets.get());
+
+    for (const auto& otherNode : listedNodes) {
+        // since we're about to add a node to the packet we start a segment
+        domainListPackets->startSegment();
+
+        // don't send avatar nodes to other avatars, that will come from avatar mixer
+        domainListStream << DomainListEntry::AddedNode << *otherNode.data();
+
+        // pack the secret that these two nodes will use to communicate with each other
+        domainListStream << connectionSecretForNodes(node, otherNode);
+
+        // we've added the node we wanted so end the segment now
+        domainListPackets->endSegment();
+    }
     
+    // send an empty list to the node, in case there were no other nodes
+    domainListPackets->closeCurrentPacket(true);
+
+    // write the PacketList to this node
+    limitedNodeList->sendPacketList(std::move(domainListPackets), *node);
+}
+
+QByteArray DomainServer::domainListHeaderForNode(const SharedNodePointer& node, bool isDelta,
+                                                 quint32 knownListVersion, quint32 numEntries) {
+    const int NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES = NUM_BYTES_RFC4122_UUID + NUM_BYTES_RFC4122_UUID + 3
+        + 3 * sizeof(quint32);
+
     // setup the extended header for the domain list packets
     // this data is at the beginning of each of the domain list packets
     QByteArray extendedHeader(NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES, 0);
     QDataStream extendedHeaderStream(&extendedHeader, QIODevice::WriteOnly);
-   
+
     auto limitedNodeList = DependencyManager::get<LimitedNodeList>();
-    
+
+    // always send the node their own UUID back
     extendedHeaderStream << limitedNodeList->getSessionUUID();
     extendedHeaderStream << node->getUUID();
     extendedHeaderStream << (quint8) node->isAllowedEditor();
     extendedHeaderStream << (quint8) node->getCanRez();
 
-    auto domainListPackets = NLPacketList::create(PacketType::DomainList, extendedHeader);
+    // then which list this is - a delta applies to knownListVersion only, and brings the node up to
+    // _domainListVersion once it has all numEntries entries
+    extendedHeaderStream << (quint8) isDelta;
+    extendedHeaderStream << knownListVersion;
+    extendedHeaderStream << _domainListVersion;
+    extendedHeaderStream << numEntries;
 
-    // always send the node their own UUID back
-    QDataStream domainListStream(domainListPackets.get());
+    return extendedHeader;
+}
 
-    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+std::unique_ptr<NLPacketList> DomainServer::createDomainListDelta(const SharedNodePointer& node,
+                                                                  quint32 knownListVersion) {
+    // there is a change for each version, so the node is missing the last few of _domainListChanges -
+    // unless it is so far behind that we have forgotten some of them
+    quint32 numMissedChanges = _domainListVersion - knownListVersion;
+    if (numMissedChanges > _domainListChanges.size()) {
+        return nullptr;
+    }
 
-    // store the nodeInterestSet on this DomainServerNodeData, in case it has changed
+    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
     auto& nodeInterestSet = nodeData->getNodeInterestSet();
 
-    if (nodeInterestSet.size() > 0) {
+    // only the last change to each node matters
+    std::vector<DomainListChange> changes;
+    QHash<QUuid, size_t> changeIndexes;
 
-        // DTLSServerSession* dtlsSession = _isUsingDTLS ? _dtlsSessions[senderSockAddr] : NULL;
-        if (nodeData->isAuthenticated()) {
-            // if this authenticated node has any interest types, send back those nodes as well
-            limitedNodeList->eachNode([&](const SharedNodePointer& otherNode){
-                if (otherNode->getUUID() != node->getUUID() && nodeInterestSet.contains(otherNode->getType())) {
-                    
-                    // since we're about to add a node to the packet we start a segment
-                    domainListPackets->startSegment();
+    for (auto it = _domainListChanges.end() - numMissedChanges; it != _domainListChanges.end(); ++it) {
+        if (it->nodeUUID == node->getUUID() || !nodeInterestSet.contains(it->nodeType)) {
+            continue;
+        }
 
-                    // don't send avatar nodes to other avatars, that will come from avatar mixer
-                    domainListStream << *otherNode.data();
+        auto indexIt = changeIndexes.find(it->nodeUUID);
+        if (indexIt != changeIndexes.end()) {
+            changes[indexIt.value()] = *it;
+        } else {
+            changeIndexes.insert(it->nodeUUID, changes.size());
+            changes.push_back(*it);
+        }
+    }
 
-                    // pack the secret that these two nodes will use to communicate with each other
-                    domainListStream << connectionSecretForNodes(node, otherNode);
+    auto limitedNodeList = DependencyManager::get<LimitedNodeList>();
 
-                    // we've added the node we wanted so end the segment now
-                    domainListPackets->endSegment();
-                }
-            });
+    std::vector<SharedNodePointer> addedNodes;
+    std::vector<QUuid> removedNodeUUIDs;
+    for (const auto& change : changes) {
+        if (change.isRemoval) {
+            removedNodeUUIDs.push_back(change.nodeUUID);
+        } else if (auto addedNode = limitedNodeList->nodeWithUUID(change.nodeUUID)) {
+            addedNodes.push_back(addedNode);
         }
     }
-    
-    // send an empty list to the node, in case there were no other nodes
-    domainListPackets->closeCurrentPacket(true);
 
-    // write the PacketList to this node
-    limitedNodeList->sendPacketList(std::move(domainListPackets), *node);
+    quint32 numEntries = (quint32) (addedNodes.size() + removedNodeUUIDs.size());
+    auto deltaPackets = NLPacketList::create(PacketType::DomainList,
+                                             domainListHeaderForNode(node, true, knownListVersion, numEntries));
+    QDataStream deltaStream(deltaPackets.get());
+
+    for (const auto& removedNodeUUID : removedNodeUUIDs) {
+        deltaPackets->startSegment();
+        deltaStream << DomainListEntry::RemovedNode << removedNodeUUID;
+        deltaPackets->endSegment();
+    }
+
+    for (const auto& addedNode : addedNodes) {
+        deltaPackets->startSegment();
+        deltaStream << DomainListEntry::AddedNode << *addedNode.data() << connectionSecretForNodes(node, addedNode);
+        deltaPackets->endSegment();
+    }
+
+    deltaPackets->closeCurrentPacket(true);
+
+    // the node can only apply a delta it has all of, so one that takes more than a packet is sent as a whole list
+    if (deltaPackets->getNumPackets() > 1) {
+        return nullptr;
+    }
+
+    return deltaPackets;
+}
+
+void DomainServer::recordDomainListChange(const SharedNodePointer& node, bool isRemoval) {
+    static const size_t MAX_DOMAIN_LIST_CHANGES = 1000;
+
+    if (++_domainListVersion == 0) {
+        // 0 stands for no list, so skip it - and forget the changes before, which would now look like the wrong versions
+        _domainListVersion = 1;
+        _domainListChanges.clear();
+    }
+
+    _domainListChanges.push_back({ node->getUUID(), node->getType(), isRemoval });
+
+    // a node that missed more changes than we keep is sent the whole list
+    if (_domainListChanges.size() > MAX_DOMAIN_LIST_CHANGES) {
+        _domainListChanges.pop_front();
+    }
+}
+
+bool DomainServer::isTrustedOnLocalNetwork(const SharedNodePointer& node) {
+    static const QString TRUSTED_LAN_ASSIGNMENT_CLIENTS_KEYPATH = "security.trusted_lan_assignment_clients";
+
+    DomainServerNodeData* nodeData = dynamic_cast<DomainServerNodeData*>(node->getLinkedData());
+
+    // only assignment clients are trusted, and only when we heard them from a loopback or private address
+    if (!nodeData || nodeData->getAssignmentUUID().isNull()) {
+        return false;
+    }
+
+    return isLocalNetworkAddress(nodeData->getSendingSockAddr().getAddress())
+        && _settingsManager.valueOrDefaultValueForKeyPath(TRUSTED_LAN_ASSIGNMENT_CLIENTS_KEYPATH).toBool();
 }
 
 QUuid DomainServer::connectionSecretForNodes(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB) {
     DomainServerNodeData* nodeAData = dynamic_cast<DomainServerNodeData*>(nodeA->getLinkedData());
     DomainServerNodeData* nodeBData = dynamic_cast<DomainServerNodeData*>(nodeB->getLinkedData());
 
+    if (isTrustedOnLocalNetwork(nodeA) && isTrustedOnLocalNetwork(nodeB)) {
+        // a null secret tells both nodes to neither sign nor verify the packets between them
+        return QUuid();
+    }
+
     if (nodeAData && nodeBData) {
         QUuid& secretUUID = nodeAData->getSessionSecretHash()[nodeB->getUUID()];
 
@@ -1887,6 +2038,8 @@ void DomainServer::nodeAdded(SharedNodePointer node) {
 
 void DomainServer::nodeKilled(SharedNodePointer node) {
 
+    recordDomainListChange(node, true);
+
     // if this peer connected via ICE then remove them from our ICE peers hash
     _gatekeeper.removeICEPeer(node->getUUID());
 
@@ -12,6 +12,8 @@
 #ifndef hifi_DomainServer_h
 #define hifi_DomainServer_h
 
+#include <deque>
+
 #include <QtCore/QCoreApplication>
 #include <QtCore/QHash>
 #include <QtCore/QJsonObject>
@@ -109,9 +111,16 @@ private:
 
     unsigned int countConnectedUsers();
 
-    void sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr& senderSockAddr);
+    // knownListVersion is the version of the list the node already has, or 0 to send it the whole list
+    void sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr& senderSockAddr,
+                              quint32 knownListVersion = 0);
+    QByteArray domainListHeaderForNode(const SharedNodePointer& node, bool isDelta, quint32 knownListVersion,
+                                       quint32 numEntries);
+    std::unique_ptr<NLPacketList> createDomainListDelta(const SharedNodePointer& node, quint32 knownListVersion);
+    void recordDomainListChange(const SharedNodePointer& node, bool isRemoval);
 
     QUuid connectionSecretForNodes(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB);
+    bool isTrustedOnLocalNetwork(const SharedNodePointer& node);
     void broadcastNewNode(const SharedNodePointer& node);
 
     void parseAssignmentConfigs(QSet<Assignment::Type>& excludedTypes);
@@ -179,6 +188,16 @@ private:
 
     bool _hasAccessToken { false };
 
+    struct DomainListChange {
+        QUuid nodeUUID;
+        NodeType_t nodeType;
+        bool isRemoval;
+    };
+
+    // every node added, updated or removed, one version each - the last is _domainListVersion
+    quint32 _domainListVersion;
+    std::deque<DomainListChange> _domainListChanges;
+
     friend class DomainGatekeeper;
 };
 
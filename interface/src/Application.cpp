@@ -3552,6 +3552,8 @@ void Application::update(float deltaTime) {
             if (DependencyManager::get<SceneScriptingInterface>()->shouldRenderEntities()) {
                 queryOctree(NodeType::EntityServer, PacketType::EntityQuery, _entityServerJurisdictions);
             }
+            // this also resends it every few seconds, in case the avatar mixer has restarted and lost it
+            sendAvatarViewFrustum();
             _lastQueriedViewFrustum = _viewFrustum;
         }
     }
@@ -3643,6 +3645,15 @@ int Application::sendNackPackets() {
     return packetsSent;
 }
 
+void Application::sendAvatarViewFrustum() {
+    // the avatar mixer sends the avatars we can see before the ones we can't
+    QByteArray viewFrustumByteArray = _viewFrustum.toByteArray();
+    auto viewFrustumPacket = NLPacket::create(PacketType::ViewFrustum, viewFrustumByteArray.size());
+    viewFrustumPacket->write(viewFrustumByteArray);
+
+    DependencyManager::get<NodeList>()->broadcastToNodes(std::move(viewFrustumPacket), NodeSet() << NodeType::AvatarMixer);
+}
+
 void Application::queryOctree(NodeType_t serverType, PacketType packetType, NodeToJurisdictionMap& jurisdictions, bool forceResend) {
 
     if (!_settingsLoaded) {
@@ -4263,6 +4274,11 @@ void Application::nodeActivated(SharedNodePointer node) {
         }
     }
 
+    if (node->getType() == NodeType::AvatarMixer) {
+        // a new avatar mixer doesn't know what we can see, so tell it now rather than at our next query
+        QMutexLocker viewLocker(&_viewMutex);
+        sendAvatarViewFrustum();
+    }
 }
 
 void Application::nodeKilled(SharedNodePointer node) {
@@ -238,6 +238,9 @@ protected:
 
     virtual void updateJointMappings() override;
 
+    // simulate() and parseDataFromBuffer() call locationChanged() when the joints move
+    virtual bool locationChangedTracksJoints() const override { return true; }
+
     virtual void updatePalms();
 
     render::ItemID _renderItemID{ render::Item::INVALID_ITEM_ID };
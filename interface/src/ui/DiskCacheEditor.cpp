@@ -70,6 +70,16 @@ void DiskCacheEditor::makeDialog() {
     maxSize->setAlignment(Qt::AlignRight);
     layout->addWidget(maxSize, 2, 0);
     
+    QLabel* assetSize = new QLabel("Asset Cache Size : ", _dialog);
+    Q_CHECK_PTR(assetSize);
+    assetSize->setAlignment(Qt::AlignRight);
+    layout->addWidget(assetSize, 3, 0);
+    
+    QLabel* assetHitRate = new QLabel("Asset Cache Hit Rate : ", _dialog);
+    Q_CHECK_PTR(assetHitRate);
+    assetHitRate->setAlignment(Qt::AlignRight);
+    layout->addWidget(assetHitRate, 4, 0);
+    
     
     _path = new QLabel(_dialog);
     Q_CHECK_PTR(_path);
@@ -86,6 +96,16 @@ void DiskCacheEditor::makeDialog() {
     _maxSize->setAlignment(Qt::AlignLeft);
     layout->addWidget(_maxSize, 2, 1, 1, 3);
 
+    _assetSize = new QLabel(_dialog);
+    Q_CHECK_PTR(_assetSize);
+    _assetSize->setAlignment(Qt::AlignLeft);
+    layout->addWidget(_assetSize, 3, 1, 1, 3);
+
+    _assetHitRate = new QLabel(_dialog);
+    Q_CHECK_PTR(_assetHitRate);
+    _assetHitRate->setAlignment(Qt::AlignLeft);
+    layout->addWidget(_assetHitRate, 4, 1, 1, 3);
+
     refresh();
 
 
@@ -101,37 +121,50 @@ void DiskCacheEditor::makeDialog() {
     clearCacheButton->setText("Clear");
     clearCacheButton->setToolTip("Erases the entire content of the disk cache.");
     connect(clearCacheButton, SIGNAL(clicked()), SLOT(clear()));
-    layout->addWidget(clearCacheButton, 3, 3);
+    layout->addWidget(clearCacheButton, 5, 3);
 }
 
 void DiskCacheEditor::refresh() {
-    DependencyManager::get<AssetClient>()->cacheInfoRequest(this, "cacheInfoCallback");
+    auto assetClient = DependencyManager::get<AssetClient>();
+    assetClient->cacheInfoRequest(this, "cacheInfoCallback");
+    assetClient->assetCacheInfoRequest(this, "assetCacheInfoCallback");
 }
 
-void DiskCacheEditor::cacheInfoCallback(QString cacheDirectory, qint64 cacheSize, qint64 maximumCacheSize) {
-    static const auto stringify = [](qint64 number) {
-        static const QStringList UNITS = QStringList() << "B" << "KB" << "MB" << "GB";
-        static const qint64 CHUNK = 1024;
-        QString unit;
-        int i = 0;
-        for (i = 0; i < 4; ++i) {
-            if (number / CHUNK > 0) {
-                number /= CHUNK;
-            } else {
-                break;
-            }
+static QString stringifySize(qint64 number) {
+    static const QStringList UNITS = QStringList() << "B" << "KB" << "MB" << "GB";
+    static const qint64 CHUNK = 1024;
+    QString unit;
+    int i = 0;
+    for (i = 0; i < 4; ++i) {
+        if (number / CHUNK > 0) {
+            number /= CHUNK;
+        } else {
+            break;
         }
-        return QString("%0 %1").arg(number).arg(UNITS[i]);
-    };
-    
+    }
+    return QString("%0 %1").arg(number).arg(UNITS[i]);
+}
+
+void DiskCacheEditor::cacheInfoCallback(QString cacheDirectory, qint64 cacheSize, qint64 maximumCacheSize) {
     if (_path) {
         _path->setText(cacheDirectory);
     }
     if (_size) {
-        _size->setText(stringify(cacheSize));
+        _size->setText(stringifySize(cacheSize));
     }
     if (_maxSize) {
-        _maxSize->setText(stringify(maximumCacheSize));
+        _maxSize->setText(stringifySize(maximumCacheSize));
+    }
+}
+
+void DiskCacheEditor::assetCacheInfoCallback(QString cacheDirectory, qint64 cacheSize, qint64 maximumCacheSize,
+                                             quint64 hits, quint64 misses, float hitRate) {
+    if (_assetSize) {
+        _assetSize->setText(QString("%1 of %2").arg(stringifySize(cacheSize), stringifySize(maximumCacheSize)));
+    }
+    if (_assetHitRate) {
+        _assetHitRate->setText(QString("%1% (%2 hits, %3 misses)")
+            .arg(hitRate * 100.0f, 0, 'f', 1).arg(hits).arg(misses));
     }
 }
 
@@ -34,6 +34,8 @@ public slots:
 private slots:
     void refresh();
     void cacheInfoCallback(QString cacheDirectory, qint64 cacheSize, qint64 maximumCacheSize);
+    void assetCacheInfoCallback(QString cacheDirectory, qint64 cacheSize, qint64 maximumCacheSize,
+                                quint64 hits, quint64 misses, float hitRate);
     void clear();
 
 private:
@@ -43,6 +45,8 @@ private:
     QPointer<QLabel> _path;
     QPointer<QLabel> _size;
     QPointer<QLabel> _maxSize;
+    QPointer<QLabel> _assetSize;
+    QPointer<QLabel> _assetHitRate;
     QPointer<QTimer> _refreshTimer;
 };
 
@@ -134,6 +134,10 @@ AudioClient::AudioClient() :
     packetReceiver.registerListener(PacketType::MixedAudio, this, "handleAudioDataPacket");
     packetReceiver.registerListener(PacketType::NoisyMute, this, "handleNoisyMutePacket");
     packetReceiver.registerListener(PacketType::MuteEnvironment, this, "handleMuteEnvironmentPacket");
+    packetReceiver.registerListener(PacketType::SelectedAudioFormat, this, "handleSelectedAudioFormat");
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    connect(nodeList.data(), &LimitedNodeList::nodeActivated, this, &AudioClient::handleNodeActivated);
 }
 
 AudioClient::~AudioClient() {
@@ -151,9 +155,57 @@ void AudioClient::audioMixerKilled() {
     _hasReceivedFirstPacket = false;
     _outgoingAvatarAudioSequenceNumber = 0;
     _stats.reset();
+
+    // the next audio mixer starts out with raw PCM until we have negotiated with it
+    _codec.reset();
+    _encoder.reset();
+    _receivedAudioStream.setCodec(AudioCodecs::PCM_CODEC_NAME, AudioDecoderPointer());
+
     emit disconnected();
 }
 
+void AudioClient::handleNodeActivated(SharedNodePointer node) {
+    if (node->getType() == NodeType::AudioMixer) {
+        negotiateAudioFormat();
+    }
+}
+
+void AudioClient::negotiateAudioFormat() {
+    auto nodeList = DependencyManager::get<NodeList>();
+    SharedNodePointer audioMixer = nodeList->soloNodeOfType(NodeType::AudioMixer);
+    if (!audioMixer) {
+        return;
+    }
+
+    // offer every codec we have, in our order of preference
+    QStringList codecNames = AudioCodecs::getCodecNames();
+    quint8 numberOfCodecs = (quint8)codecNames.size();
+
+    auto negotiateFormatPacket = NLPacket::create(PacketType::NegotiateAudioFormat, -1, true);
+    negotiateFormatPacket->writePrimitive(numberOfCodecs);
+    for (auto& codecName : codecNames) {
+        negotiateFormatPacket->writeString(codecName);
+    }
+
+    nodeList->sendPacket(std::move(negotiateFormatPacket), *audioMixer);
+}
+
+void AudioClient::handleSelectedAudioFormat(QSharedPointer<ReceivedMessage> message) {
+    QString selectedCodecName = message->readString();
+
+    _codec = AudioCodecs::getCodec(selectedCodecName);
+    if (!_codec) {
+        // we only offered codecs we have, so this should never happen - stick to raw PCM
+        qCDebug(audioclient) << "Audio mixer selected unknown codec" << selectedCodecName;
+        _codec = AudioCodecs::getCodec(AudioCodecs::PCM_CODEC_NAME);
+    }
+
+    qCDebug(audioclient) << "Audio mixer selected codec" << _codec->getName();
+
+    _encoder = _codec->createEncoder();
+    _receivedAudioStream.setCodec(_codec->getName(), _codec->createDecoder());
+}
+
 
 QAudioDeviceInfo getNamedAudioDeviceForMode(QAudio::Mode mode, const QString& deviceName) {
     QAudioDeviceInfo result;
@@ -800,7 +852,8 @@ void AudioClient::handleAudioInput() {
         audioTransform.setTranslation(_positionGetter());
         audioTransform.setRotation(_orientationGetter());
         // FIXME find a way to properly handle both playback audio and user audio concurrently
-        emitAudioPacket(networkAudioSamples, numNetworkBytes, _outgoingAvatarAudioSequenceNumber, audioTransform, packetType);
+        emitAudioPacket(networkAudioSamples, numNetworkBytes, _outgoingAvatarAudioSequenceNumber, audioTransform, packetType,
+                        getCodecName(), _encoder.get());
         _stats.sentPacket();
     }
 }
@@ -810,7 +863,8 @@ void AudioClient::handleRecordedAudioInput(const QByteArray& audio) {
     audioTransform.setTranslation(_positionGetter());
     audioTransform.setRotation(_orientationGetter());
     // FIXME check a flag to see if we should echo audio?
-    emitAudioPacket(audio.data(), audio.size(), _outgoingAvatarAudioSequenceNumber, audioTransform, PacketType::MicrophoneAudioWithEcho);
+    emitAudioPacket(audio.data(), audio.size(), _outgoingAvatarAudioSequenceNumber, audioTransform, PacketType::MicrophoneAudioWithEcho,
+                    getCodecName(), _encoder.get());
 }
 
 void AudioClient::processReceivedSamples(const QByteArray& inputBuffer, QByteArray& outputBuffer) {
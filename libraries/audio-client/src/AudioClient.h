@@ -26,12 +26,14 @@
 #include <QtMultimedia/QAudioInput>
 
 #include <AbstractAudioInterface.h>
+#include <AudioCodec.h>
 #include <AudioEffectOptions.h>
 #include <AudioStreamStats.h>
 
 #include <DependencyManager.h>
 #include <HifiSockAddr.h>
 #include <NLPacket.h>
+#include <Node.h>
 #include <MixedProcessedAudioStream.h>
 #include <RingBufferHistory.h>
 #include <SettingHandle.h>
@@ -139,6 +141,7 @@ public slots:
     void handleAudioDataPacket(QSharedPointer<ReceivedMessage> message);
     void handleNoisyMutePacket(QSharedPointer<ReceivedMessage> message);
     void handleMuteEnvironmentPacket(QSharedPointer<ReceivedMessage> message);
+    void handleSelectedAudioFormat(QSharedPointer<ReceivedMessage> message);
 
     void sendDownstreamAudioStatsPacket() { _stats.sendDownstreamAudioStatsPacket(); }
     void handleAudioInput();
@@ -203,8 +206,12 @@ protected:
         deleteLater();
     }
 
+private slots:
+    void handleNodeActivated(SharedNodePointer node);
+
 private:
     void outputFormatChanged();
+    void negotiateAudioFormat();
 
     QByteArray firstInputFrame;
     QAudioInput* _audioInput;
@@ -278,6 +285,11 @@ private:
 
     quint16 _outgoingAvatarAudioSequenceNumber;
 
+    // the codec the audio mixer selected, our mic frames are sent as raw PCM until it has selected one
+    QString getCodecName() const { return _codec ? _codec->getName() : AudioCodecs::PCM_CODEC_NAME; }
+    AudioCodecPointer _codec;
+    AudioEncoderPointer _encoder;
+
     AudioOutputIODevice _audioOutputIODevice;
 
     AudioIOStats _stats;
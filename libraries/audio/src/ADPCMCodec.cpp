@@ -0,0 +1,208 @@
+//
+//  ADPCMCodec.cpp
+//  libraries/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <string.h>
+
+#include "AudioConstants.h"
+
+#include "ADPCMCodec.h"
+
+const QString ADPCMCodec::NAME = "adpcm";
+
+static const int STEP_TABLE_SIZE = 89;
+
+static const int16_t STEP_TABLE[STEP_TABLE_SIZE] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int FRAME_HEADER_BYTES = sizeof(uint8_t) + sizeof(uint16_t);
+static const int CHANNEL_HEADER_BYTES = sizeof(int16_t) + sizeof(uint8_t);
+
+static inline int clampStepIndex(int index) {
+    return index < 0 ? 0 : (index >= STEP_TABLE_SIZE ? STEP_TABLE_SIZE - 1 : index);
+}
+
+static inline int clampSample(int sample) {
+    return sample < AudioConstants::MIN_SAMPLE_VALUE ? AudioConstants::MIN_SAMPLE_VALUE :
+        (sample > AudioConstants::MAX_SAMPLE_VALUE ? AudioConstants::MAX_SAMPLE_VALUE : sample);
+}
+
+// the difference the decoder reconstructs from a code, which the encoder tracks so that both predict the same samples
+static inline int deltaForCode(int code, int step) {
+    int delta = step >> 3;
+    if (code & 4) {
+        delta += step;
+    }
+    if (code & 2) {
+        delta += step >> 1;
+    }
+    if (code & 1) {
+        delta += step >> 2;
+    }
+    return (code & 8) ? -delta : delta;
+}
+
+AudioEncoderPointer ADPCMCodec::createEncoder() const {
+    return AudioEncoderPointer(new ADPCMEncoder());
+}
+
+AudioDecoderPointer ADPCMCodec::createDecoder() const {
+    return AudioDecoderPointer(new ADPCMDecoder());
+}
+
+int ADPCMCodec::encodedSize(int numChannels, int samplesPerChannel) {
+    // the first sample of each channel is in its header, which leaves samplesPerChannel - 1 codes
+    return FRAME_HEADER_BYTES + numChannels * (CHANNEL_HEADER_BYTES + samplesPerChannel / 2);
+}
+
+void ADPCMEncoder::encode(const QByteArray& decodedBuffer, int numChannels, QByteArray& encodedBuffer) {
+    numChannels = numChannels == ADPCMCodec::MAX_CHANNELS ? ADPCMCodec::MAX_CHANNELS : 1;
+
+    int samplesPerChannel = decodedBuffer.size() / (int)sizeof(int16_t) / numChannels;
+    const int16_t* samples = reinterpret_cast<const int16_t*>(decodedBuffer.constData());
+
+    if (samplesPerChannel == 0) {
+        encodedBuffer.clear();
+        return;
+    }
+
+    encodedBuffer.resize(ADPCMCodec::encodedSize(numChannels, samplesPerChannel));
+    uint8_t* output = reinterpret_cast<uint8_t*>(encodedBuffer.data());
+
+    uint8_t channels = (uint8_t)numChannels;
+    uint16_t numSamples = (uint16_t)samplesPerChannel;
+    memcpy(output, &channels, sizeof(channels));
+    memcpy(output + sizeof(channels), &numSamples, sizeof(numSamples));
+
+    uint8_t* channelHeader = output + FRAME_HEADER_BYTES;
+    uint8_t* codes = channelHeader + numChannels * CHANNEL_HEADER_BYTES;
+    int codeBytesPerChannel = samplesPerChannel / 2;
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        int predictor = samples[channel];
+        int index = _stepIndex[channel];
+
+        int16_t firstSample = (int16_t)predictor;
+        memcpy(channelHeader, &firstSample, sizeof(firstSample));
+        channelHeader[sizeof(firstSample)] = (uint8_t)index;
+        channelHeader += CHANNEL_HEADER_BYTES;
+
+        memset(codes, 0, codeBytesPerChannel);
+
+        for (int i = 1; i < samplesPerChannel; ++i) {
+            int step = STEP_TABLE[index];
+            int diff = samples[i * numChannels + channel] - predictor;
+
+            // quantize the difference to the step size in 3 bits plus a sign bit
+            int code = 0;
+            if (diff < 0) {
+                code = 8;
+                diff = -diff;
+            }
+            if (diff >= step) {
+                code |= 4;
+                diff -= step;
+            }
+            if (diff >= (step >> 1)) {
+                code |= 2;
+                diff -= step >> 1;
+            }
+            if (diff >= (step >> 2)) {
+                code |= 1;
+            }
+
+            predictor = clampSample(predictor + deltaForCode(code, step));
+            index = clampStepIndex(index + INDEX_TABLE[code]);
+
+            int codeIndex = i - 1;
+            codes[codeIndex >> 1] |= (uint8_t)(code << ((codeIndex & 1) << 2));
+        }
+
+        _stepIndex[channel] = (uint8_t)index;
+        codes += codeBytesPerChannel;
+    }
+}
+
+int ADPCMDecoder::getNumDecodedSamples(const QByteArray& encodedBuffer) const {
+    if (encodedBuffer.size() < FRAME_HEADER_BYTES) {
+        return 0;
+    }
+
+    uint8_t numChannels;
+    uint16_t samplesPerChannel;
+    memcpy(&numChannels, encodedBuffer.constData(), sizeof(numChannels));
+    memcpy(&samplesPerChannel, encodedBuffer.constData() + sizeof(numChannels), sizeof(samplesPerChannel));
+
+    int numSamples = numChannels * samplesPerChannel;
+
+    // an encoded frame is never larger than a network frame, which keeps it from ever matching the size of a raw one
+    if (numChannels < 1 || numChannels > ADPCMCodec::MAX_CHANNELS
+        || samplesPerChannel == 0 || numSamples > AudioConstants::NETWORK_FRAME_SAMPLES_STEREO
+        || encodedBuffer.size() != ADPCMCodec::encodedSize(numChannels, samplesPerChannel)) {
+        return 0;
+    }
+
+    return numSamples;
+}
+
+bool ADPCMDecoder::decode(const QByteArray& encodedBuffer, QByteArray& decodedBuffer) {
+    int numSamples = getNumDecodedSamples(encodedBuffer);
+    if (numSamples == 0) {
+        return false;
+    }
+
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(encodedBuffer.constData());
+    int numChannels = input[0];
+    int samplesPerChannel = numSamples / numChannels;
+
+    decodedBuffer.resize(numSamples * sizeof(int16_t));
+    int16_t* samples = reinterpret_cast<int16_t*>(decodedBuffer.data());
+
+    const uint8_t* channelHeader = input + FRAME_HEADER_BYTES;
+    const uint8_t* codes = channelHeader + numChannels * CHANNEL_HEADER_BYTES;
+    int codeBytesPerChannel = samplesPerChannel / 2;
+
+    for (int channel = 0; channel < numChannels; ++channel) {
+        int16_t firstSample;
+        memcpy(&firstSample, channelHeader, sizeof(firstSample));
+        int predictor = firstSample;
+        int index = clampStepIndex(channelHeader[sizeof(firstSample)]);
+        channelHeader += CHANNEL_HEADER_BYTES;
+
+        samples[channel] = firstSample;
+
+        for (int i = 1; i < samplesPerChannel; ++i) {
+            int codeIndex = i - 1;
+            int code = (codes[codeIndex >> 1] >> ((codeIndex & 1) << 2)) & 0xf;
+
+            predictor = clampSample(predictor + deltaForCode(code, STEP_TABLE[index]));
+            index = clampStepIndex(index + INDEX_TABLE[code]);
+
+            samples[i * numChannels + channel] = (int16_t)predictor;
+        }
+
+        codes += codeBytesPerChannel;
+    }
+
+    return true;
+}
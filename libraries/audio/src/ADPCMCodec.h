@@ -0,0 +1,59 @@
+//
+//  ADPCMCodec.h
+//  libraries/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ADPCMCodec_h
+#define hifi_ADPCMCodec_h
+
+#include <stdint.h>
+
+#include "AudioCodec.h"
+
+// IMA ADPCM, 4 bits per sample with no lookahead, so it adds no latency and costs a few operations per sample.
+//
+// Each frame stands alone so that a lost packet does not corrupt the frames after it:
+//
+//  uint8   number of channels
+//  uint16  samples per channel
+//  per channel:
+//      int16   first sample, sent as is
+//      uint8   step index for the second sample
+//  per channel:
+//      the 4-bit codes for the remaining samples of that channel, two per byte low nibble first
+//
+class ADPCMCodec : public AudioCodec {
+public:
+    static const QString NAME;
+    static const int MAX_CHANNELS = 2;
+
+    QString getName() const override { return NAME; }
+
+    AudioEncoderPointer createEncoder() const override;
+    AudioDecoderPointer createDecoder() const override;
+
+    /// the size of an encoded frame
+    static int encodedSize(int numChannels, int samplesPerChannel);
+};
+
+class ADPCMEncoder : public AudioEncoder {
+public:
+    void encode(const QByteArray& decodedBuffer, int numChannels, QByteArray& encodedBuffer) override;
+
+private:
+    // carried over from the end of the previous frame, which keeps the step size adapted to the signal
+    uint8_t _stepIndex[ADPCMCodec::MAX_CHANNELS] {};
+};
+
+class ADPCMDecoder : public AudioDecoder {
+public:
+    int getNumDecodedSamples(const QByteArray& encodedBuffer) const override;
+    bool decode(const QByteArray& encodedBuffer, QByteArray& decodedBuffer) override;
+};
+
+#endif // hifi_ADPCMCodec_h
@@ -19,7 +19,8 @@
 
 #include "AudioConstants.h"
 
-void AbstractAudioInterface::emitAudioPacket(const void* audioData, size_t bytes, quint16& sequenceNumber, const Transform& transform, PacketType packetType) {
+void AbstractAudioInterface::emitAudioPacket(const void* audioData, size_t bytes, quint16& sequenceNumber, const Transform& transform,
+                                             PacketType packetType, const QString& codecName, AudioEncoder* encoder) {
     static std::mutex _mutex;
     using Locker = std::unique_lock<std::mutex>;
     auto nodeList = DependencyManager::get<NodeList>();
@@ -31,6 +32,9 @@ void AbstractAudioInterface::emitAudioPacket(const void* audioData, size_t bytes
 
         // write sequence number
         audioPacket->writePrimitive(sequenceNumber++);
+
+        // the mixer reads the audio with the codec named here, which is PCM when there is no encoder
+        audioPacket->writeString(encoder ? codecName : AudioCodecs::PCM_CODEC_NAME);
         if (packetType == PacketType::SilentAudioFrame) {
             // pack num silent samples
             quint16 numSilentSamples = isStereo ?
@@ -48,10 +52,17 @@ void AbstractAudioInterface::emitAudioPacket(const void* audioData, size_t bytes
         audioPacket->writePrimitive(transform.getRotation());
 
         if (audioPacket->getType() != PacketType::SilentAudioFrame) {
+            QByteArray encodedBuffer;
+            if (encoder) {
+                // encode with the codec negotiated with the mixer
+                QByteArray decodedBuffer = QByteArray::fromRawData(static_cast<const char*>(audioData), (int)bytes);
+                encoder->encode(decodedBuffer, isStereo ? 2 : 1, encodedBuffer);
+                audioData = encodedBuffer.constData();
+                bytes = encodedBuffer.size();
+            }
+
             // audio samples have already been packed (written to networkAudioSamples)
-            audioPacket->setPayloadSize(audioPacket->getPayloadSize() + bytes);
-            static const int leadingBytes = sizeof(quint16) + sizeof(glm::vec3) + sizeof(glm::quat) + sizeof(quint8);
-            memcpy(audioPacket->getPayload() + leadingBytes, audioData, bytes);
+            audioPacket->write(static_cast<const char*>(audioData), bytes);
         }
         nodeList->flagTimeForConnectionStep(LimitedNodeList::ConnectionStep::SendAudioPacket);
         nodeList->sendUnreliablePacket(*audioPacket, *audioMixer);
@@ -17,6 +17,7 @@
 
 #include <udt/PacketHeaders.h>
 
+#include "AudioCodec.h"
 #include "AudioInjectorOptions.h"
 
 class AudioInjector;
@@ -28,7 +29,10 @@ class AbstractAudioInterface : public QObject {
 public:
     AbstractAudioInterface(QObject* parent = 0) : QObject(parent) {};
     
-    static void emitAudioPacket(const void* audioData, size_t bytes, quint16& sequenceNumber, const Transform& transform, PacketType packetType);
+    /// encoder is for the codec negotiated with the audio mixer, or nullptr to send raw PCM
+    static void emitAudioPacket(const void* audioData, size_t bytes, quint16& sequenceNumber, const Transform& transform,
+                                PacketType packetType, const QString& codecName = AudioCodecs::PCM_CODEC_NAME,
+                                AudioEncoder* encoder = nullptr);
 
 public slots:
     virtual bool outputLocalInjector(bool isStereo, AudioInjector* injector) = 0;
@@ -0,0 +1,99 @@
+//
+//  AudioCodec.cpp
+//  libraries/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "ADPCMCodec.h"
+
+#include "AudioCodec.h"
+
+class PCMCodec : public AudioCodec {
+public:
+    QString getName() const override { return AudioCodecs::PCM_CODEC_NAME; }
+
+    AudioEncoderPointer createEncoder() const override { return AudioEncoderPointer(); }
+    AudioDecoderPointer createDecoder() const override { return AudioDecoderPointer(); }
+};
+
+namespace {
+    class CodecRegistry {
+    public:
+        CodecRegistry() {
+            // the in-tree codecs, in order of preference
+            codecs.push_back(std::make_shared<ADPCMCodec>());
+            codecs.push_back(std::make_shared<PCMCodec>());
+        }
+
+        std::mutex mutex;
+        std::vector<AudioCodecPointer> codecs;
+    };
+
+    CodecRegistry& registry() {
+        static CodecRegistry codecRegistry;
+        return codecRegistry;
+    }
+}
+
+void AudioCodecs::registerCodec(AudioCodecPointer codec) {
+    if (!codec || codec->getName() == PCM_CODEC_NAME) {
+        return;
+    }
+
+    auto& codecRegistry = registry();
+    std::lock_guard<std::mutex> lock(codecRegistry.mutex);
+
+    auto& codecs = codecRegistry.codecs;
+    codecs.erase(std::remove_if(codecs.begin(), codecs.end(), [&](const AudioCodecPointer& existingCodec) {
+        return existingCodec->getName() == codec->getName();
+    }), codecs.end());
+
+    // keep PCM as the last resort
+    codecs.insert(codecs.end() - 1, codec);
+}
+
+AudioCodecPointer AudioCodecs::getCodec(const QString& name) {
+    auto& codecRegistry = registry();
+    std::lock_guard<std::mutex> lock(codecRegistry.mutex);
+
+    for (auto& codec : codecRegistry.codecs) {
+        if (codec->getName() == name) {
+            return codec;
+        }
+    }
+
+    return AudioCodecPointer();
+}
+
+QStringList AudioCodecs::getCodecNames() {
+    auto& codecRegistry = registry();
+    std::lock_guard<std::mutex> lock(codecRegistry.mutex);
+
+    QStringList names;
+    for (auto& codec : codecRegistry.codecs) {
+        names << codec->getName();
+    }
+
+    return names;
+}
+
+AudioCodecPointer AudioCodecs::selectCodec(const QStringList& preferredCodecs, const QStringList& offeredCodecs) {
+    for (auto& name : preferredCodecs) {
+        if (offeredCodecs.contains(name)) {
+            auto codec = getCodec(name);
+            if (codec) {
+                return codec;
+            }
+        }
+    }
+
+    return getCodec(PCM_CODEC_NAME);
+}
@@ -0,0 +1,78 @@
+//
+//  AudioCodec.h
+//  libraries/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioCodec_h
+#define hifi_AudioCodec_h
+
+#include <memory>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+// Audio in MixedAudio and MicrophoneAudio packets is raw int16 PCM unless the node and the AudioMixer have negotiated
+// a codec for it (NegotiateAudioFormat / SelectedAudioFormat). Those packets and SilentAudioFrame packets name the codec
+// of their audio right after their sequence number, so frames sent around a switch are never read with the wrong one.
+// Each frame is encoded independently of the frames around it, so that a lost packet costs a single frame.
+
+class AudioEncoder {
+public:
+    virtual ~AudioEncoder() {}
+
+    /// encodes one frame of interleaved int16 samples with the given number of channels
+    virtual void encode(const QByteArray& decodedBuffer, int numChannels, QByteArray& encodedBuffer) = 0;
+};
+
+class AudioDecoder {
+public:
+    virtual ~AudioDecoder() {}
+
+    /// returns the number of int16 samples the buffer decodes to, or 0 if it is not a frame this decoder can decode
+    virtual int getNumDecodedSamples(const QByteArray& encodedBuffer) const = 0;
+
+    /// decodes one frame of interleaved int16 samples, returns false if the buffer could not be decoded
+    virtual bool decode(const QByteArray& encodedBuffer, QByteArray& decodedBuffer) = 0;
+};
+
+using AudioEncoderPointer = std::unique_ptr<AudioEncoder>;
+using AudioDecoderPointer = std::unique_ptr<AudioDecoder>;
+
+class AudioCodec {
+public:
+    virtual ~AudioCodec() {}
+
+    /// the name sent in the negotiation packets
+    virtual QString getName() const = 0;
+
+    /// a new encoder or decoder for a single stream, these may keep state between the frames of that stream
+    /// the PCM codec returns nullptr for both, since its frames are sent as they are
+    virtual AudioEncoderPointer createEncoder() const = 0;
+    virtual AudioDecoderPointer createDecoder() const = 0;
+};
+
+using AudioCodecPointer = std::shared_ptr<const AudioCodec>;
+
+namespace AudioCodecs {
+    const QString PCM_CODEC_NAME = "pcm";
+
+    /// adds a codec that can then be negotiated, replacing any codec with the same name
+    void registerCodec(AudioCodecPointer codec);
+
+    /// returns the codec with the given name, or nullptr if there is no such codec
+    AudioCodecPointer getCodec(const QString& name);
+
+    /// the names of the registered codecs, in order of preference - PCM is always registered and always last
+    QStringList getCodecNames();
+
+    /// picks the first codec of the preferred codecs that has been offered and is registered, or PCM if there is none
+    AudioCodecPointer selectCodec(const QStringList& preferredCodecs, const QStringList& offeredCodecs);
+}
+
+#endif // hifi_AudioCodec_h
@@ -14,6 +14,8 @@
 #include <string.h>
 #include <assert.h>
 
+#include <CPUDetect.h>
+
 #include "AudioHRTF.h"
 #include "AudioHRTFData.h"
 
@@ -119,57 +121,6 @@ static void FIR_1x4_SSE(float* src, float* dst0, float* dst1, float* dst2, float
     }
 }
 
-//
-// Detect AVX/AVX2 support
-//
-
-#if defined(_MSC_VER)
-
-#include <intrin.h>
-
-static bool cpuSupportsAVX() {
-    int info[4];
-    int mask = (1 << 27) | (1 << 28);   // OSXSAVE and AVX
-
-    __cpuidex(info, 0x1, 0);
-
-    bool result = false;
-    if ((info[2] & mask) == mask) {
-
-        if ((_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6) {
-            result = true;
-        }
-    }
-    return result;
-}
-
-#elif defined(__GNUC__)
-
-#include <cpuid.h>
-
-static bool cpuSupportsAVX() {
-    unsigned int eax, ebx, ecx, edx;
-    unsigned int mask = (1 << 27) | (1 << 28);   // OSXSAVE and AVX
-
-    bool result = false;
-    if (__get_cpuid(0x1, &eax, &ebx, &ecx, &edx) && ((ecx & mask) == mask)) {
-
-        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
-        if ((eax & 0x6) == 0x6) {
-            result = true;
-        }
-    }
-    return result;    
-}
-
-#else
-
-static bool cpuSupportsAVX() {
-    return false;
-}
-
-#endif
-
 //
 // Runtime CPU dispatch
 //
@@ -606,6 +557,20 @@ static void setAzimuthAndGain(float firCoef[4][HRTF_TAPS], float bqCoef[5][4], i
 
 void AudioHRTF::render(int16_t* input, float* output, int index, float azimuth, float gain, int numFrames) {
 
+    assert(numFrames == HRTF_BLOCK);
+
+    float in[HRTF_BLOCK];
+
+    // convert mono input to float
+    for (int i = 0; i < HRTF_BLOCK; i++) {
+        in[i] = (float)input[i] * (1/32768.0f);
+    }
+
+    render(in, output, index, azimuth, gain, numFrames);
+}
+
+void AudioHRTF::render(const float* input, float* output, int index, float azimuth, float gain, int numFrames) {
+
     assert(index >= 0);
     assert(index < HRTF_TABLES);
     assert(numFrames == HRTF_BLOCK);
@@ -627,10 +592,8 @@ void AudioHRTF::render(int16_t* input, float* output, int index, float azimuth,
     _azimuthState = azimuth;
     _gainState = gain;
 
-    // convert mono input to float
-    for (int i = 0; i < HRTF_BLOCK; i++) {
-        in[HRTF_TAPS+i] = (float)input[i] * (1/32768.0f);
-    }
+    // copy mono input after the FIR history
+    memcpy(&in[HRTF_TAPS], input, HRTF_BLOCK * sizeof(float));
 
     // FIR state update
     memcpy(in, _firState, HRTF_TAPS * sizeof(float));
@@ -690,3 +653,17 @@ void AudioHRTF::renderSilent(int16_t* input, float* output, int index, float azi
 
     _silentState = true;
 }
+
+void AudioHRTF::renderSilent(const float* input, float* output, int index, float azimuth, float gain, int numFrames) {
+
+    // process the first silent block, to flush internal state
+    if (!_silentState) {
+        render(input, output, index, azimuth, gain, numFrames);
+    }
+
+    // new parameters become old
+    _azimuthState = azimuth;
+    _gainState = gain;
+
+    _silentState = true;
+}
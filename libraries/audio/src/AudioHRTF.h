@@ -38,10 +38,16 @@ public:
     //
     void render(int16_t* input, float* output, int index, float azimuth, float gain, int numFrames);
 
+    //
+    // input: mono source, already converted to float in [-1.0, 1.0)
+    //
+    void render(const float* input, float* output, int index, float azimuth, float gain, int numFrames);
+
     //
     // Fast path when input is known to be silent
     //
     void renderSilent(int16_t* input, float* output, int index, float azimuth, float gain, int numFrames);
+    void renderSilent(const float* input, float* output, int index, float azimuth, float gain, int numFrames);
 
 private:
     AudioHRTF(const AudioHRTF&) = delete;
@@ -0,0 +1,255 @@
+//
+//  AudioMixKernels.cpp
+//  libraries/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <CPUDetect.h>
+
+#include "AudioMixKernels.h"
+
+static const float INT16_TO_FLOAT_SCALE = 1.0f / 32768.0f;
+static const float FLOAT_TO_INT16_SCALE = 32767.0f;
+static const float INT16_MIN_FLOAT = -32768.0f;
+static const float INT16_MAX_FLOAT = 32767.0f;
+
+typedef void accumulate_t(const float* src, float* dst, float gain, int numSamples);
+typedef void accumulateMonoToStereo_t(const float* src, float* dst, float gain, int numFrames);
+typedef void convertToFloat_t(const int16_t* src, float* dst, int numSamples);
+typedef bool saturateToInt16_t(const float* src, int16_t* dst, int numSamples);
+
+//
+// Portable reference code
+//
+
+static void accumulate_C(const float* src, float* dst, float gain, int numSamples) {
+    for (int i = 0; i < numSamples; i++) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void accumulateMonoToStereo_C(const float* src, float* dst, float gain, int numFrames) {
+    for (int i = 0; i < numFrames; i++) {
+        float x = src[i] * gain;
+        dst[2*i+0] += x;
+        dst[2*i+1] += x;
+    }
+}
+
+static void convertToFloat_C(const int16_t* src, float* dst, int numSamples) {
+    for (int i = 0; i < numSamples; i++) {
+        dst[i] = src[i] * INT16_TO_FLOAT_SCALE;
+    }
+}
+
+static bool saturateToInt16_C(const float* src, int16_t* dst, int numSamples) {
+    int nonZero = 0;
+    for (int i = 0; i < numSamples; i++) {
+        float x = src[i] * FLOAT_TO_INT16_SCALE;
+
+        // saturate before the conversion, since a float outside of the int range has no defined conversion
+        x = (x < INT16_MIN_FLOAT) ? INT16_MIN_FLOAT : ((x > INT16_MAX_FLOAT) ? INT16_MAX_FLOAT : x);
+
+        dst[i] = (int16_t)x;
+        nonZero |= dst[i];
+    }
+    return nonZero != 0;
+}
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+
+#include <emmintrin.h>
+
+//
+// SSE2, which every x86 CPU we run on has
+//
+
+static void accumulate_SSE2(const float* src, float* dst, float gain, int numSamples) {
+
+    __m128 g = _mm_set1_ps(gain);
+
+    int i = 0;
+    for (; i <= numSamples - 8; i += 8) {
+
+        __m128 x0 = _mm_loadu_ps(&src[i+0]);
+        __m128 x1 = _mm_loadu_ps(&src[i+4]);
+
+        x0 = _mm_add_ps(_mm_loadu_ps(&dst[i+0]), _mm_mul_ps(x0, g));
+        x1 = _mm_add_ps(_mm_loadu_ps(&dst[i+4]), _mm_mul_ps(x1, g));
+
+        _mm_storeu_ps(&dst[i+0], x0);
+        _mm_storeu_ps(&dst[i+4], x1);
+    }
+
+    accumulate_C(&src[i], &dst[i], gain, numSamples - i);
+}
+
+static void accumulateMonoToStereo_SSE2(const float* src, float* dst, float gain, int numFrames) {
+
+    __m128 g = _mm_set1_ps(gain);
+
+    int i = 0;
+    for (; i <= numFrames - 4; i += 4) {
+
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(&src[i]), g);
+
+        // duplicate each mono sample into left and right
+        __m128 x0 = _mm_unpacklo_ps(x, x);
+        __m128 x1 = _mm_unpackhi_ps(x, x);
+
+        _mm_storeu_ps(&dst[2*i+0], _mm_add_ps(_mm_loadu_ps(&dst[2*i+0]), x0));
+        _mm_storeu_ps(&dst[2*i+4], _mm_add_ps(_mm_loadu_ps(&dst[2*i+4]), x1));
+    }
+
+    accumulateMonoToStereo_C(&src[i], &dst[2*i], gain, numFrames - i);
+}
+
+static void convertToFloat_SSE2(const int16_t* src, float* dst, int numSamples) {
+
+    __m128 scale = _mm_set1_ps(INT16_TO_FLOAT_SCALE);
+
+    int i = 0;
+    for (; i <= numSamples - 8; i += 8) {
+
+        __m128i x = _mm_loadu_si128((const __m128i*)&src[i]);
+
+        // sign-extend to int32
+        __m128i x0 = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i x1 = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+        _mm_storeu_ps(&dst[i+0], _mm_mul_ps(_mm_cvtepi32_ps(x0), scale));
+        _mm_storeu_ps(&dst[i+4], _mm_mul_ps(_mm_cvtepi32_ps(x1), scale));
+    }
+
+    convertToFloat_C(&src[i], &dst[i], numSamples - i);
+}
+
+static bool saturateToInt16_SSE2(const float* src, int16_t* dst, int numSamples) {
+
+    __m128 scale = _mm_set1_ps(FLOAT_TO_INT16_SCALE);
+    __m128 lo = _mm_set1_ps(INT16_MIN_FLOAT);
+    __m128 hi = _mm_set1_ps(INT16_MAX_FLOAT);
+    __m128i nonZero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i <= numSamples - 8; i += 8) {
+
+        __m128 x0 = _mm_mul_ps(_mm_loadu_ps(&src[i+0]), scale);
+        __m128 x1 = _mm_mul_ps(_mm_loadu_ps(&src[i+4]), scale);
+
+        x0 = _mm_min_ps(_mm_max_ps(x0, lo), hi);
+        x1 = _mm_min_ps(_mm_max_ps(x1, lo), hi);
+
+        // truncate, and pack with saturation
+        __m128i y = _mm_packs_epi32(_mm_cvttps_epi32(x0), _mm_cvttps_epi32(x1));
+
+        _mm_storeu_si128((__m128i*)&dst[i], y);
+        nonZero = _mm_or_si128(nonZero, y);
+    }
+
+    bool result = _mm_movemask_epi8(_mm_cmpeq_epi8(nonZero, _mm_setzero_si128())) != 0xffff;
+    return saturateToInt16_C(&src[i], &dst[i], numSamples - i) || result;
+}
+
+// separate compilation with AVX2 enabled
+accumulate_t accumulate_AVX2;
+accumulateMonoToStereo_t accumulateMonoToStereo_AVX2;
+convertToFloat_t convertToFloat_AVX2;
+saturateToInt16_t saturateToInt16_AVX2;
+
+#define HAVE_SSE2_KERNELS
+
+#endif
+
+//
+// Runtime CPU dispatch
+//
+
+struct KernelTable {
+    AudioMixKernels::Implementation implementation;
+    accumulate_t* accumulate;
+    accumulateMonoToStereo_t* accumulateMonoToStereo;
+    convertToFloat_t* convertToFloat;
+    saturateToInt16_t* saturateToInt16;
+};
+
+static const KernelTable PORTABLE_KERNELS = {
+    AudioMixKernels::Implementation::Portable,
+    accumulate_C, accumulateMonoToStereo_C, convertToFloat_C, saturateToInt16_C
+};
+
+#ifdef HAVE_SSE2_KERNELS
+
+static const KernelTable SSE2_KERNELS = {
+    AudioMixKernels::Implementation::SSE2,
+    accumulate_SSE2, accumulateMonoToStereo_SSE2, convertToFloat_SSE2, saturateToInt16_SSE2
+};
+
+static const KernelTable AVX2_KERNELS = {
+    AudioMixKernels::Implementation::AVX2,
+    accumulate_AVX2, accumulateMonoToStereo_AVX2, convertToFloat_AVX2, saturateToInt16_AVX2
+};
+
+#endif
+
+static const KernelTable* kernelsFor(AudioMixKernels::Implementation implementation) {
+#ifdef HAVE_SSE2_KERNELS
+    if (implementation == AudioMixKernels::Implementation::AVX2 && cpuSupportsAVX2()) {
+        return &AVX2_KERNELS;
+    }
+    if (implementation == AudioMixKernels::Implementation::SSE2) {
+        return &SSE2_KERNELS;
+    }
+#endif
+    if (implementation == AudioMixKernels::Implementation::Portable) {
+        return &PORTABLE_KERNELS;
+    }
+    return nullptr;
+}
+
+static const KernelTable*& kernels() {
+    static const KernelTable* table = kernelsFor(AudioMixKernels::getBestImplementation()); // init on first call
+    return table;
+}
+
+void AudioMixKernels::accumulate(const float* src, float* dst, float gain, int numSamples) {
+    (*kernels()->accumulate)(src, dst, gain, numSamples);
+}
+
+void AudioMixKernels::accumulateMonoToStereo(const float* src, float* dst, float gain, int numFrames) {
+    (*kernels()->accumulateMonoToStereo)(src, dst, gain, numFrames);
+}
+
+void AudioMixKernels::convertToFloat(const int16_t* src, float* dst, int numSamples) {
+    (*kernels()->convertToFloat)(src, dst, numSamples);
+}
+
+bool AudioMixKernels::saturateToInt16(const float* src, int16_t* dst, int numSamples) {
+    return (*kernels()->saturateToInt16)(src, dst, numSamples);
+}
+
+AudioMixKernels::Implementation AudioMixKernels::getImplementation() {
+    return kernels()->implementation;
+}
+
+bool AudioMixKernels::setImplementation(Implementation implementation) {
+    const KernelTable* table = kernelsFor(implementation);
+    if (!table) {
+        return false;
+    }
+
+    kernels() = table;
+    return true;
+}
+
+AudioMixKernels::Implementation AudioMixKernels::getBestImplementation() {
+#ifdef HAVE_SSE2_KERNELS
+    return cpuSupportsAVX2() ? Implementation::AVX2 : Implementation::SSE2;
+#else
+    return Implementation::Portable;
+#endif
+}
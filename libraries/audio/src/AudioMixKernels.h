@@ -0,0 +1,53 @@
+//
+//  AudioMixKernels.h
+//  libraries/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioMixKernels_h
+#define hifi_AudioMixKernels_h
+
+#include <stdint.h>
+
+//
+// The inner loops of a mix, on float samples in [-1.0, 1.0).
+// Each call dispatches at runtime to the widest implementation the CPU supports (AVX2, SSE2 or portable C).
+// The counts are in samples and need not be a multiple of the vector width.
+//
+namespace AudioMixKernels {
+
+    // dst[i] += src[i] * gain
+    void accumulate(const float* src, float* dst, float gain, int numSamples);
+
+    // dst[2*i] += src[i] * gain, dst[2*i+1] += src[i] * gain - numFrames mono samples into interleaved stereo
+    void accumulateMonoToStereo(const float* src, float* dst, float gain, int numFrames);
+
+    // dst[i] = src[i] / 32768
+    void convertToFloat(const int16_t* src, float* dst, int numSamples);
+
+    // dst[i] = src[i] * 32767, truncated and saturated to int16
+    // returns true if any of the output samples is not zero
+    bool saturateToInt16(const float* src, int16_t* dst, int numSamples);
+
+    enum class Implementation {
+        Portable,
+        SSE2,
+        AVX2
+    };
+
+    Implementation getImplementation();
+
+    // forces the kernels to one implementation, to compare them in benchmarks and tests
+    // returns false, leaving the implementation as it was, if this CPU or build can't run it
+    // this is not thread-safe and must not be called while anything is mixing
+    bool setImplementation(Implementation implementation);
+
+    // the best implementation for this CPU, which is the one used unless another is set
+    Implementation getBestImplementation();
+}
+
+#endif // hifi_AudioMixKernels_h
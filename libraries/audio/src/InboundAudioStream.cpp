@@ -108,6 +108,18 @@ int InboundAudioStream::parseData(ReceivedMessage& message) {
 
     packetReceivedUpdateTimingStats();
 
+    _packetAudioFormat = PacketAudioFormat::PCM;
+    if (packetHasCodecName(message.getType())) {
+        QString codecInPacket = message.readString();
+        if (codecInPacket == AudioCodecs::PCM_CODEC_NAME) {
+            _packetAudioFormat = PacketAudioFormat::PCM;
+        } else if (_decoder && codecInPacket == _codecName) {
+            _packetAudioFormat = PacketAudioFormat::Encoded;
+        } else {
+            _packetAudioFormat = PacketAudioFormat::Unreadable;
+        }
+    }
+
     int networkSamples;
     
     // parse the info after the seq number and before the audio data (the stream properties)
@@ -172,13 +184,53 @@ int InboundAudioStream::parseStreamProperties(PacketType type, const QByteArray&
         return sizeof(quint16);
     } else {
         // mixed audio packets do not have any info between the seq num and the audio data.
-        numAudioSamples = packetAfterSeqNum.size() / sizeof(int16_t);
+        numAudioSamples = numSamplesInAudioData(packetAfterSeqNum);
         return 0;
     }
 }
 
 int InboundAudioStream::parseAudioData(PacketType type, const QByteArray& packetAfterStreamProperties, int numAudioSamples) {
-    return _ringBuffer.writeData(packetAfterStreamProperties.data(), numAudioSamples * sizeof(int16_t));
+    QByteArray decodedAudioData = decodeAudioData(packetAfterStreamProperties);
+    return _ringBuffer.writeData(decodedAudioData.data(), std::min(decodedAudioData.size(), numAudioSamples * (int)sizeof(int16_t)));
+}
+
+void InboundAudioStream::setCodec(const QString& codecName, AudioDecoderPointer decoder) {
+    _codecName = codecName;
+    _decoder = std::move(decoder);
+}
+
+bool InboundAudioStream::packetHasCodecName(PacketType type) {
+    return type == PacketType::MicrophoneAudioNoEcho || type == PacketType::MicrophoneAudioWithEcho
+        || type == PacketType::SilentAudioFrame || type == PacketType::MixedAudio;
+}
+
+int InboundAudioStream::numSamplesInAudioData(const QByteArray& audioData) const {
+    if (_packetAudioFormat == PacketAudioFormat::PCM) {
+        return audioData.size() / sizeof(int16_t);
+    }
+
+    if (_packetAudioFormat == PacketAudioFormat::Encoded) {
+        int numDecodedSamples = _decoder->getNumDecodedSamples(audioData);
+        if (numDecodedSamples > 0) {
+            return numDecodedSamples;
+        }
+    }
+
+    // audio we can't decode stands in for a frame of silence
+    return _ringBuffer.getNumFrameSamples();
+}
+
+QByteArray InboundAudioStream::decodeAudioData(const QByteArray& audioData) {
+    if (_packetAudioFormat == PacketAudioFormat::PCM) {
+        return audioData;
+    }
+
+    QByteArray decodedAudioData;
+    if (_packetAudioFormat == PacketAudioFormat::Encoded && _decoder->decode(audioData, decodedAudioData)) {
+        return decodedAudioData;
+    }
+
+    return QByteArray(_ringBuffer.getNumFrameSamples() * sizeof(int16_t), 0);
 }
 
 int InboundAudioStream::writeDroppableSilentSamples(int silentSamples) {
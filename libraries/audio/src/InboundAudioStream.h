@@ -18,6 +18,7 @@
 #include <ReceivedMessage.h>
 #include <StDev.h>
 
+#include "AudioCodec.h"
 #include "AudioRingBuffer.h"
 #include "MovingMinMaxAvg.h"
 #include "SequenceNumberStats.h"
@@ -174,6 +175,13 @@ public:
     void setReverb(float reverbTime, float wetLevel);
     void clearReverb() { _hasReverb = false; }
 
+    /// sets the codec negotiated for this stream, and its decoder - nullptr for the PCM codec
+    /// packets that name PCM are always read as raw PCM, and packets that name any other codec are read as silence
+    void setCodec(const QString& codecName, AudioDecoderPointer decoder);
+
+    /// whether packets of this type name the codec of their audio after their sequence number
+    static bool packetHasCodecName(PacketType type);
+
 public slots:
     /// This function should be called every second for all the stats to function properly. If dynamic jitter buffers
     /// is enabled, those stats are used to calculate _desiredJitterBufferFrames.
@@ -209,6 +217,12 @@ protected:
     /// writes the last written frame repeatedly, gradually fading to silence.
     /// used for writing samples for dropped packets.
     virtual int writeLastFrameRepeatedWithFade(int samples);
+
+    /// returns the number of samples the audio data in the current packet holds once decoded
+    int numSamplesInAudioData(const QByteArray& audioData) const;
+
+    /// returns the audio data in the current packet as raw PCM, decoding it with the codec the packet names
+    QByteArray decodeAudioData(const QByteArray& audioData);
     
 protected:
 
@@ -267,6 +281,13 @@ protected:
     bool _hasReverb;
     float _reverbTime;
     float _wetLevel;
+
+    QString _codecName { AudioCodecs::PCM_CODEC_NAME };
+    AudioDecoderPointer _decoder;
+
+    // how the audio in the packet being parsed is to be read, from the codec it names
+    enum class PacketAudioFormat { PCM, Encoded, Unreadable };
+    PacketAudioFormat _packetAudioFormat { PacketAudioFormat::PCM };
 };
 
 float calculateRepeatedFrameFadeFactor(int indexOfRepeat);
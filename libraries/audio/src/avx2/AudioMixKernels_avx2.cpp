@@ -0,0 +1,139 @@
+//
+//  AudioMixKernels_avx2.cpp
+//  libraries/audio/src/avx2
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#ifndef __AVX2__
+#error Must be compiled with /arch:AVX2 or -mavx2.
+#endif
+
+static const float INT16_TO_FLOAT_SCALE = 1.0f / 32768.0f;
+static const float FLOAT_TO_INT16_SCALE = 32767.0f;
+static const float INT16_MIN_FLOAT = -32768.0f;
+static const float INT16_MAX_FLOAT = 32767.0f;
+
+void accumulate_AVX2(const float* src, float* dst, float gain, int numSamples) {
+
+    __m256 g = _mm256_set1_ps(gain);
+
+    int i = 0;
+    for (; i <= numSamples - 16; i += 16) {
+
+        __m256 x0 = _mm256_loadu_ps(&src[i+0]);
+        __m256 x1 = _mm256_loadu_ps(&src[i+8]);
+
+        x0 = _mm256_add_ps(_mm256_loadu_ps(&dst[i+0]), _mm256_mul_ps(x0, g));
+        x1 = _mm256_add_ps(_mm256_loadu_ps(&dst[i+8]), _mm256_mul_ps(x1, g));
+
+        _mm256_storeu_ps(&dst[i+0], x0);
+        _mm256_storeu_ps(&dst[i+8], x1);
+    }
+
+    for (; i < numSamples; i++) {
+        dst[i] += src[i] * gain;
+    }
+
+    _mm256_zeroupper();
+}
+
+void accumulateMonoToStereo_AVX2(const float* src, float* dst, float gain, int numFrames) {
+
+    __m256 g = _mm256_set1_ps(gain);
+
+    int i = 0;
+    for (; i <= numFrames - 8; i += 8) {
+
+        __m256 x = _mm256_mul_ps(_mm256_loadu_ps(&src[i]), g);
+
+        // duplicate each mono sample into left and right, within each 128-bit lane
+        __m256 t0 = _mm256_unpacklo_ps(x, x);   // 0 0 1 1 | 4 4 5 5
+        __m256 t1 = _mm256_unpackhi_ps(x, x);   // 2 2 3 3 | 6 6 7 7
+
+        // and put the lanes back in order
+        __m256 x0 = _mm256_permute2f128_ps(t0, t1, 0x20);
+        __m256 x1 = _mm256_permute2f128_ps(t0, t1, 0x31);
+
+        _mm256_storeu_ps(&dst[2*i+0], _mm256_add_ps(_mm256_loadu_ps(&dst[2*i+0]), x0));
+        _mm256_storeu_ps(&dst[2*i+8], _mm256_add_ps(_mm256_loadu_ps(&dst[2*i+8]), x1));
+    }
+
+    for (; i < numFrames; i++) {
+        float x = src[i] * gain;
+        dst[2*i+0] += x;
+        dst[2*i+1] += x;
+    }
+
+    _mm256_zeroupper();
+}
+
+void convertToFloat_AVX2(const int16_t* src, float* dst, int numSamples) {
+
+    __m256 scale = _mm256_set1_ps(INT16_TO_FLOAT_SCALE);
+
+    int i = 0;
+    for (; i <= numSamples - 16; i += 16) {
+
+        __m256i x0 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&src[i+0]));
+        __m256i x1 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)&src[i+8]));
+
+        _mm256_storeu_ps(&dst[i+0], _mm256_mul_ps(_mm256_cvtepi32_ps(x0), scale));
+        _mm256_storeu_ps(&dst[i+8], _mm256_mul_ps(_mm256_cvtepi32_ps(x1), scale));
+    }
+
+    for (; i < numSamples; i++) {
+        dst[i] = src[i] * INT16_TO_FLOAT_SCALE;
+    }
+
+    _mm256_zeroupper();
+}
+
+bool saturateToInt16_AVX2(const float* src, int16_t* dst, int numSamples) {
+
+    __m256 scale = _mm256_set1_ps(FLOAT_TO_INT16_SCALE);
+    __m256 lo = _mm256_set1_ps(INT16_MIN_FLOAT);
+    __m256 hi = _mm256_set1_ps(INT16_MAX_FLOAT);
+    __m256i nonZero = _mm256_setzero_si256();
+
+    int i = 0;
+    for (; i <= numSamples - 16; i += 16) {
+
+        __m256 x0 = _mm256_mul_ps(_mm256_loadu_ps(&src[i+0]), scale);
+        __m256 x1 = _mm256_mul_ps(_mm256_loadu_ps(&src[i+8]), scale);
+
+        x0 = _mm256_min_ps(_mm256_max_ps(x0, lo), hi);
+        x1 = _mm256_min_ps(_mm256_max_ps(x1, lo), hi);
+
+        // truncate, pack with saturation, and put the 64-bit quarters the pack interleaved back in order
+        __m256i y = _mm256_packs_epi32(_mm256_cvttps_epi32(x0), _mm256_cvttps_epi32(x1));
+        y = _mm256_permute4x64_epi64(y, 0xd8);
+
+        _mm256_storeu_si256((__m256i*)&dst[i], y);
+        nonZero = _mm256_or_si256(nonZero, y);
+    }
+
+    int result = !_mm256_testz_si256(nonZero, nonZero);
+
+    for (; i < numSamples; i++) {
+        float x = src[i] * FLOAT_TO_INT16_SCALE;
+        x = (x < INT16_MIN_FLOAT) ? INT16_MIN_FLOAT : ((x > INT16_MAX_FLOAT) ? INT16_MAX_FLOAT : x);
+
+        dst[i] = (int16_t)x;
+        result |= dst[i];
+    }
+
+    _mm256_zeroupper();
+
+    return result != 0;
+}
+
+#endif
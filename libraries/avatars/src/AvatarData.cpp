@@ -519,6 +519,8 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
         _headData->_isFaceTrackerConnected = oneAtBit(bitItems, IS_FACESHIFT_CONNECTED);
         _headData->_isEyeTrackerConnected = oneAtBit(bitItems, IS_EYE_TRACKER_CONNECTED);
         bool hasReferential = oneAtBit(bitItems, HAS_REFERENTIAL);
+        QUuid oldParentID = _parentID;
+        quint16 oldParentJointIndex = _parentJointIndex;
 
         if (hasReferential) {
             const int sizeOfPackedUuid = 16;
@@ -531,6 +533,10 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
             _parentID = QUuid();
         }
 
+        if (_parentID != oldParentID || _parentJointIndex != oldParentJointIndex) {
+            markWorldTransformsDirty();
+        }
+
         if (_headData->_isFaceTrackerConnected) {
             float leftEyeBlink, rightEyeBlink, averageLoudness, browAudioLift;
             minPossibleSize += sizeof(leftEyeBlink) + sizeof(rightEyeBlink) + sizeof(averageLoudness) + sizeof(browAudioLift);
@@ -41,12 +41,10 @@ public:
         float lifespan;
         glm::vec3 spare;
     };
-    
-    struct ParticlePrimitive {
-        ParticlePrimitive(glm::vec3 xyzIn, glm::vec2 uvIn) : xyz(xyzIn), uv(uvIn) {}
-        glm::vec3 xyz; // Position
-        glm::vec2 uv; // Lifetime + seed
-    };
+
+    // positions and lifetime + seed pairs come in separate buffers, laid out as the entity simulates them
+    static const gpu::Stream::Slot POSITION_CHANNEL = 0;
+    static const gpu::Stream::Slot LIFETIME_AND_SEED_CHANNEL = 1;
     
     using Payload = render::Payload<ParticlePayloadData>;
     using Pointer = Payload::DataPointer;
@@ -57,16 +55,15 @@ public:
     using Format = gpu::Stream::Format;
     using Buffer = gpu::Buffer;
     using BufferView = gpu::BufferView;
-    using ParticlePrimitives = std::vector<ParticlePrimitive>;
     
     ParticlePayloadData() {
         ParticleUniforms uniforms;
         _uniformBuffer = std::make_shared<Buffer>(sizeof(ParticleUniforms), (const gpu::Byte*) &uniforms);
         
-        _vertexFormat->setAttribute(gpu::Stream::POSITION, 0, gpu::Element::VEC3F_XYZ,
-                                    offsetof(ParticlePrimitive, xyz), gpu::Stream::PER_INSTANCE);
-        _vertexFormat->setAttribute(gpu::Stream::COLOR, 0, gpu::Element::VEC2F_UV,
-                                    offsetof(ParticlePrimitive, uv), gpu::Stream::PER_INSTANCE);
+        _vertexFormat->setAttribute(gpu::Stream::POSITION, POSITION_CHANNEL, gpu::Element::VEC3F_XYZ,
+                                    0, gpu::Stream::PER_INSTANCE);
+        _vertexFormat->setAttribute(gpu::Stream::COLOR, LIFETIME_AND_SEED_CHANNEL, gpu::Element::VEC2F_UV,
+                                    0, gpu::Stream::PER_INSTANCE);
     }
 
     void setPipeline(PipelinePointer pipeline) { _pipeline = pipeline; }
@@ -78,8 +75,12 @@ public:
     const AABox& getBound() const { return _bound; }
     void setBound(const AABox& bound) { _bound = bound; }
 
-    BufferPointer getParticleBuffer() { return _particleBuffer; }
-    const BufferPointer& getParticleBuffer() const { return _particleBuffer; }
+    // the buffers are filled by the entity, which alternates between two sets of them
+    void setParticles(BufferPointer positionBuffer, BufferPointer lifetimeAndSeedBuffer, size_t numParticles) {
+        _positionBuffer = positionBuffer;
+        _lifetimeAndSeedBuffer = lifetimeAndSeedBuffer;
+        _numParticles = numParticles;
+    }
     
     const ParticleUniforms& getParticleUniforms() const { return _uniformBuffer.get<ParticleUniforms>(); }
     ParticleUniforms& editParticleUniforms() { return _uniformBuffer.edit<ParticleUniforms>(); }
@@ -103,10 +104,10 @@ public:
         batch.setModelTransform(_modelTransform);
         batch.setUniformBuffer(0, _uniformBuffer);
         batch.setInputFormat(_vertexFormat);
-        batch.setInputBuffer(0, _particleBuffer, 0, sizeof(ParticlePrimitive));
+        batch.setInputBuffer(POSITION_CHANNEL, _positionBuffer, 0, sizeof(glm::vec3));
+        batch.setInputBuffer(LIFETIME_AND_SEED_CHANNEL, _lifetimeAndSeedBuffer, 0, sizeof(glm::vec2));
 
-        auto numParticles = _particleBuffer->getSize() / sizeof(ParticlePrimitive);
-        batch.drawInstanced((gpu::uint32)numParticles, gpu::TRIANGLE_STRIP, (gpu::uint32)VERTEX_PER_PARTICLE);
+        batch.drawInstanced((gpu::uint32)_numParticles, gpu::TRIANGLE_STRIP, (gpu::uint32)VERTEX_PER_PARTICLE);
     }
 
 protected:
@@ -114,7 +115,9 @@ protected:
     AABox _bound;
     PipelinePointer _pipeline;
     FormatPointer _vertexFormat { std::make_shared<Format>() };
-    BufferPointer _particleBuffer { std::make_shared<Buffer>() };
+    BufferPointer _positionBuffer { std::make_shared<Buffer>() };
+    BufferPointer _lifetimeAndSeedBuffer { std::make_shared<Buffer>() };
+    size_t _numParticles { 0 };
     BufferView _uniformBuffer;
     TexturePointer _texture;
     bool _visibleFlag = true;
@@ -216,8 +219,6 @@ void RenderableParticleEffectEntityItem::updateRenderItem() {
     }
     
     using ParticleUniforms = ParticlePayloadData::ParticleUniforms;
-    using ParticlePrimitive = ParticlePayloadData::ParticlePrimitive;
-    using ParticlePrimitives = ParticlePayloadData::ParticlePrimitives;
 
     // Fill in Uniforms structure
     ParticleUniforms particleUniforms;
@@ -231,13 +232,6 @@ void RenderableParticleEffectEntityItem::updateRenderItem() {
     particleUniforms.color.spread = glm::vec4(getColorSpreadRGB(), getAlphaSpread());
     particleUniforms.lifespan = getLifespan();
     
-    // Build particle primitives
-    auto particlePrimitives = std::make_shared<ParticlePrimitives>();
-    particlePrimitives->reserve(_particles.size()); // Reserve space
-    for (auto& particle : _particles) {
-        particlePrimitives->emplace_back(particle.position, glm::vec2(particle.lifetime, particle.seed));
-    }
-
     bool successb, successp, successr;
     auto bounds = getAABox(successb);
     auto position = getPosition(successp);
@@ -246,6 +240,35 @@ void RenderableParticleEffectEntityItem::updateRenderItem() {
     if (!success) {
         return;
     }
+
+    // Write the spans of the simulation's ring, in order, straight into the set of buffers the payload isn't using.
+    // A buffer the payload or a batch in flight still holds is never written, it is replaced instead.
+    _particleBufferIndex = (_particleBufferIndex + 1) % NUM_PARTICLE_BUFFERS;
+    auto& positionBuffer = _positionBuffers[_particleBufferIndex];
+    auto& lifetimeAndSeedBuffer = _lifetimeAndSeedBuffers[_particleBufferIndex];
+    if (!positionBuffer || !positionBuffer.unique()) {
+        positionBuffer = std::make_shared<gpu::Buffer>();
+    }
+    if (!lifetimeAndSeedBuffer || !lifetimeAndSeedBuffer.unique()) {
+        lifetimeAndSeedBuffer = std::make_shared<gpu::Buffer>();
+    }
+
+    size_t numParticles = _particles.size();
+    positionBuffer->resize(numParticles * sizeof(glm::vec3));
+    lifetimeAndSeedBuffer->resize(numParticles * sizeof(glm::vec2));
+    auto spans = _particles.getSpans();
+    size_t index = 0;
+    for (auto& span : { spans.first, spans.second }) {
+        if (span.count == 0) {
+            continue;
+        }
+        positionBuffer->setSubData(index * sizeof(glm::vec3), span.count * sizeof(glm::vec3),
+                                   reinterpret_cast<const gpu::Byte*>(&_particles.positions[span.start]));
+        lifetimeAndSeedBuffer->setSubData(index * sizeof(glm::vec2), span.count * sizeof(glm::vec2),
+                                          reinterpret_cast<const gpu::Byte*>(&_particles.lifetimesAndSeeds[span.start]));
+        index += span.count;
+    }
+
     Transform transform;
     if (!getEmitterShouldTrail()) {
         transform.setTranslation(position);
@@ -254,20 +277,19 @@ void RenderableParticleEffectEntityItem::updateRenderItem() {
 
 
     render::PendingChanges pendingChanges;
+    gpu::BufferPointer positions = positionBuffer;
+    gpu::BufferPointer lifetimesAndSeeds = lifetimeAndSeedBuffer;
     pendingChanges.updateItem<ParticlePayloadData>(_renderItemId, [=](ParticlePayloadData& payload) {
         payload.setVisibleFlag(true);
         
         // Update particle uniforms
         memcpy(&payload.editParticleUniforms(), &particleUniforms, sizeof(ParticleUniforms));
         
-        // Update particle buffer
-        auto particleBuffer = payload.getParticleBuffer();
-        size_t numBytes = sizeof(ParticlePrimitive) * particlePrimitives->size();
-        particleBuffer->resize(numBytes);
-        if (numBytes == 0) {
+        // Update particle buffers
+        payload.setParticles(positions, lifetimesAndSeeds, numParticles);
+        if (numParticles == 0) {
             return;
         }
-        particleBuffer->setData(numBytes, (const gpu::Byte*)particlePrimitives->data());
 
         // Update transform and bounds
         payload.setModelTransform(transform);
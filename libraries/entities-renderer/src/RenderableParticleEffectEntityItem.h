@@ -42,6 +42,12 @@ protected:
     NetworkTexturePointer _texture;
     gpu::PipelinePointer _untexturedPipeline;
     gpu::PipelinePointer _texturedPipeline;
+
+    // the particles are written into one set of buffers while the render item draws from the other
+    static const int NUM_PARTICLE_BUFFERS = 2;
+    gpu::BufferPointer _positionBuffers[NUM_PARTICLE_BUFFERS];
+    gpu::BufferPointer _lifetimeAndSeedBuffers[NUM_PARTICLE_BUFFERS];
+    int _particleBufferIndex { 0 };
 };
 
 
@@ -11,6 +11,8 @@
 
 #include "EntityItem.h"
 
+#include <algorithm>
+
 #include <QtCore/QObject>
 #include <QtEndian>
 
@@ -143,9 +145,66 @@ EntityPropertyFlags EntityItem::getEntityProperties(EncodeBitstreamParams& param
     return requestedProperties;
 }
 
+std::atomic<quint64> EntityItem::_encodeCacheHits { 0 };
+std::atomic<quint64> EntityItem::_encodeCacheMisses { 0 };
+
+// viewers rarely ask for more than one set of properties, so only the most recent few encodings are kept
+const size_t MAX_ENCODE_CACHE_ENTRIES = 2;
+
+QByteArray EntityItem::findEncodedData(const EntityPropertyFlags& requestedProperties) const {
+    QMutexLocker locker(&_encodeCacheMutex);
+    for (auto& entry : _encodeCache) {
+        if (entry.lastEdited == _lastEdited && entry.lastUpdated == _lastUpdated &&
+            entry.lastSimulated == _lastSimulated && entry.changedOnServer == _changedOnServer &&
+            entry.requestedProperties == requestedProperties) {
+            return entry.data;
+        }
+    }
+    return QByteArray();
+}
+
+void EntityItem::storeEncodedData(const EntityPropertyFlags& requestedProperties, QByteArray data) const {
+    QMutexLocker locker(&_encodeCacheMutex);
+
+    // anything encoded from an older version of this entity can never be used again
+    _encodeCache.erase(std::remove_if(_encodeCache.begin(), _encodeCache.end(), [&](const EncodedEntityData& entry) {
+        return entry.lastEdited != _lastEdited || entry.lastUpdated != _lastUpdated ||
+            entry.lastSimulated != _lastSimulated || entry.changedOnServer != _changedOnServer ||
+            entry.requestedProperties == requestedProperties;
+    }), _encodeCache.end());
+
+    if (_encodeCache.size() >= MAX_ENCODE_CACHE_ENTRIES) {
+        _encodeCache.erase(_encodeCache.begin());
+    }
+    _encodeCache.push_back({ _lastEdited, _lastUpdated, _lastSimulated, _changedOnServer, requestedProperties, data });
+}
+
 OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packetData, EncodeBitstreamParams& params,
                                             EntityTreeElementExtraEncodeData* entityTreeElementExtraEncodeData) const {
 
+    // A pass that continues a partially sent entity asks for whatever didn't fit last time, which isn't worth
+    // caching. Otherwise, if another viewer was already sent this version of the entity, reuse those bytes.
+    bool isContinuation = entityTreeElementExtraEncodeData &&
+        entityTreeElementExtraEncodeData->entities.contains(getEntityItemID());
+    EntityPropertyFlags cacheKeyProperties;
+    if (!isContinuation) {
+        cacheKeyProperties = getEntityProperties(params);
+        QByteArray encodedData = findEncodedData(cacheKeyProperties);
+        if (!encodedData.isEmpty()) {
+            LevelDetails cachedLevel = packetData->startLevel();
+            if (packetData->appendRawData(encodedData)) {
+                packetData->endLevel(cachedLevel);
+                _encodeCacheHits++;
+                params.trackSend(getID(), getLastEdited());
+                return OctreeElement::COMPLETED;
+            }
+            // it may still partially fit, which the full encode below knows how to handle
+            packetData->discardLevel(cachedLevel);
+        } else {
+            _encodeCacheMisses++;
+        }
+    }
+
     // ALL this fits...
     //    object ID [16 bytes]
     //    ByteCountCoded(type code) [~1 byte]
@@ -185,6 +244,7 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
     }
 
     LevelDetails entityLevel = packetData->startLevel();
+    int startOfEntity = packetData->getUncompressedByteOffset();
 
     quint64 lastEdited = getLastEdited();
 
@@ -308,6 +368,11 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
             assert(newPropertyFlagsLength == oldPropertyFlagsLength); // should not have grown
         }
 
+        if (!isContinuation && appendState == OctreeElement::COMPLETED) {
+            int endOfEntity = packetData->getUncompressedByteOffset();
+            storeEncodedData(cacheKeyProperties, QByteArray((const char*)packetData->getUncompressedData(startOfEntity),
+                                                            endOfEntity - startOfEntity));
+        }
         packetData->endLevel(entityLevel);
     } else {
         packetData->discardLevel(entityLevel);
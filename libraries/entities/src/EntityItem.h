@@ -12,11 +12,15 @@
 #ifndef hifi_EntityItem_h
 #define hifi_EntityItem_h
 
+#include <atomic>
 #include <memory>
 #include <stdint.h>
+#include <vector>
 
 #include <glm/glm.hpp>
 
+#include <QtCore/QMutex>
+
 #include <AnimationCache.h> // for Animation, AnimationCache, and AnimationPointer classes
 #include <Octree.h> // for EncodeBitstreamParams class
 #include <OctreeElement.h> // for OctreeElement::AppendState
@@ -118,6 +122,9 @@ public:
     virtual OctreeElement::AppendState appendEntityData(OctreePacketData* packetData, EncodeBitstreamParams& params,
                                                 EntityTreeElementExtraEncodeData* entityTreeElementExtraEncodeData) const;
 
+    static quint64 getEncodeCacheHits() { return _encodeCacheHits; }
+    static quint64 getEncodeCacheMisses() { return _encodeCacheMisses; }
+
     virtual void appendSubclassData(OctreePacketData* packetData, EncodeBitstreamParams& params,
                                     EntityTreeElementExtraEncodeData* entityTreeElementExtraEncodeData,
                                     EntityPropertyFlags& requestedProperties,
@@ -465,6 +472,24 @@ protected:
     mutable bool _recalcMinAACube = true;
     mutable bool _recalcMaxAACube = true;
 
+    // Copies of this entity as last encoded by appendEntityData(), so that every viewer asking for the same
+    // properties of the same edit is sent those bytes without the properties being encoded again.
+    struct EncodedEntityData {
+        quint64 lastEdited;
+        quint64 lastUpdated;
+        quint64 lastSimulated;
+        quint64 changedOnServer;
+        EntityPropertyFlags requestedProperties;
+        QByteArray data;
+    };
+    QByteArray findEncodedData(const EntityPropertyFlags& requestedProperties) const;
+    void storeEncodedData(const EntityPropertyFlags& requestedProperties, QByteArray data) const;
+
+    mutable QMutex _encodeCacheMutex;
+    mutable std::vector<EncodedEntityData> _encodeCache;
+    static std::atomic<quint64> _encodeCacheHits;
+    static std::atomic<quint64> _encodeCacheMisses;
+
     float _localRenderAlpha;
     float _density = ENTITY_ITEM_DEFAULT_DENSITY; // kg/m^3
     // NOTE: _volumeMultiplier is used to allow some mass properties code exist in the EntityItem base class
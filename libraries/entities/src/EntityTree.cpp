@@ -67,6 +67,13 @@ void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
 
     resetClientEditStats();
     clearDeletedEntities();
+
+    {
+        QWriteLocker locker(&_journalLock);
+        if (_journalChanges) {
+            _journalLost = true;
+        }
+    }
 }
 
 bool EntityTree::handlesEditPacketType(PacketType packetType) const {
@@ -95,6 +102,7 @@ void EntityTree::postAddEntity(EntityItemPointer entity) {
     }
 
     _isDirty = true;
+    journalChange(entity->getEntityItemID(), false);
     emit addingEntity(entity->getEntityItemID());
 
     // find and hook up any entities with this entity as a (previously) missing parent
@@ -161,6 +169,7 @@ bool EntityTree::updateEntityWithElement(EntityItemPointer entity, const EntityI
                 recurseTreeWithOperator(&theOperator);
                 entity->setProperties(tempProperties);
                 _isDirty = true;
+                journalChange(entity->getEntityItemID(), false);
             }
         }
     } else {
@@ -276,6 +285,7 @@ bool EntityTree::updateEntityWithElement(EntityItemPointer entity, const EntityI
         }
 
         _isDirty = true;
+        journalChange(entity->getEntityItemID(), false);
 
         uint32_t newFlags = entity->getDirtyFlags() & ~preFlags;
         if (newFlags) {
@@ -473,6 +483,7 @@ void EntityTree::processRemovedEntities(const DeleteEntityOperator& theOperator)
         }
 
         theEntity->die();
+        journalChange(theEntity->getEntityItemID(), true);
 
         if (getIsServer()) {
             // set up the deleted entities ID
@@ -1261,12 +1272,22 @@ EntityTreeElementPointer EntityTree::getContainingElement(const EntityItemID& en
 }
 
 void EntityTree::setContainingElement(const EntityItemID& entityItemID, EntityTreeElementPointer element) {
-    QWriteLocker locker(&_entityToElementLock);
-    if (element) {
-        _entityToElementMap[entityItemID] = element;
-    } else {
-        _entityToElementMap.remove(entityItemID);
+    EntityTreeElementPointer oldElement;
+    {
+        QWriteLocker locker(&_entityToElementLock);
+        oldElement = _entityToElementMap.value(entityItemID);
+        if (element) {
+            _entityToElementMap[entityItemID] = element;
+        } else {
+            _entityToElementMap.remove(entityItemID);
+        }
     }
+
+    // both the element the entity left and the one it joined have new contents
+    if (oldElement != element) {
+        recordElementChange(oldElement);
+    }
+    recordElementChange(element);
 }
 
 void EntityTree::debugDumpMap() {
@@ -1417,15 +1438,27 @@ bool EntityTree::writeToMap(QVariantMap& entityDescription, OctreeElementPointer
 
 bool EntityTree::readFromMap(QVariantMap& map) {
     // map will have a top-level list keyed as "Entities".  This will be extracted
-    // and iterated over.  Each member of this list is converted to a QVariantMap, then
-    // to a QScriptValue, and then to EntityItemProperties.  These properties are used
-    // to add the new entity to the EnitytTree.
+    // and iterated over.
     QVariantList entitiesQList = map["Entities"].toList();
+    int nextEntity = 0;
+
+    return readFromItems([&](QVariantMap& entityMap) {
+        if (nextEntity >= entitiesQList.size()) {
+            return false;
+        }
+        entityMap = entitiesQList[nextEntity++].toMap();
+        return true;
+    });
+}
+
+bool EntityTree::readFromItems(const std::function<bool(QVariantMap&)>& readNextItem) {
+    // Each entity is converted from a QVariantMap to a QScriptValue, and then to EntityItemProperties.
+    // These properties are used to add the new entity to the EntityTree.
     QScriptEngine scriptEngine;
+    QVariantMap entityMap;
 
-    foreach (QVariant entityVariant, entitiesQList) {
+    while (readNextItem(entityMap)) {
         // QVariantMap --> QScriptValue --> EntityItemProperties --> Entity
-        QVariantMap entityMap = entityVariant.toMap();
         QScriptValue entityScriptValue = variantMapToScriptValue(entityMap, scriptEngine);
         EntityItemProperties properties;
         EntityItemPropertiesFromScriptValueIgnoreReadOnly(entityScriptValue, properties);
@@ -1445,6 +1478,112 @@ bool EntityTree::readFromMap(QVariantMap& map) {
     return true;
 }
 
+void EntityTree::setJournalChanges(bool journalChanges) {
+    QWriteLocker locker(&_journalLock);
+    _journalChanges = journalChanges;
+    _journalLost = false;
+    _journalEdits.clear();
+    _journalDeletes.clear();
+}
+
+void EntityTree::journalChange(const EntityItemID& entityID, bool deleted) {
+    QWriteLocker locker(&_journalLock);
+    if (!_journalChanges) {
+        return;
+    }
+    // only the latest state of each entity is journaled
+    if (deleted) {
+        _journalEdits.remove(entityID);
+        _journalDeletes.insert(entityID);
+    } else {
+        _journalDeletes.remove(entityID);
+        _journalEdits.insert(entityID);
+    }
+}
+
+bool EntityTree::writeJournalChanges(QVariantList& changes) {
+    QSet<EntityItemID> edits;
+    QSet<EntityItemID> deletes;
+    {
+        QWriteLocker locker(&_journalLock);
+        if (!_journalChanges) {
+            return false;
+        }
+        edits.swap(_journalEdits);
+        deletes.swap(_journalDeletes);
+        if (_journalLost) {
+            _journalLost = false;
+            return false;
+        }
+    }
+
+    // every property is journaled, not just those that differ from the defaults, so that replaying an edit
+    // also resets the properties it put back to their defaults
+    QScriptEngine scriptEngine;
+    foreach (const EntityItemID& entityID, edits) {
+        EntityItemPointer entity = findEntityByEntityItemID(entityID);
+        if (!entity || !entity->isParentIDValid()) {
+            continue; // the same entities are left out of a full save
+        }
+        changes << EntityItemPropertiesToScriptValue(&scriptEngine, entity->getProperties()).toVariant();
+    }
+
+    foreach (const EntityItemID& entityID, deletes) {
+        QVariantMap deleteMap;
+        deleteMap["id"] = entityID.toString();
+        deleteMap["deleted"] = true;
+        changes << deleteMap;
+    }
+    return true;
+}
+
+bool EntityTree::readJournalChanges(const QVariantList& changes) {
+    QScriptEngine scriptEngine;
+
+    foreach (const QVariant& changeVariant, changes) {
+        QVariantMap changeMap = changeVariant.toMap();
+        EntityItemID entityItemID = EntityItemID(QUuid(changeMap["id"].toString()));
+        if (entityItemID.isNull()) {
+            continue;
+        }
+
+        if (changeMap["deleted"].toBool()) {
+            deleteEntity(entityItemID, true, true);
+            continue;
+        }
+
+        QScriptValue entityScriptValue = variantMapToScriptValue(changeMap, scriptEngine);
+        EntityItemProperties properties;
+        EntityItemPropertiesFromScriptValueIgnoreReadOnly(entityScriptValue, properties);
+
+        EntityItemPointer existingEntity = findEntityByEntityItemID(entityItemID);
+        if (!existingEntity) {
+            if (!addEntity(entityItemID, properties)) {
+                qCDebug(entities) << "replaying journaled Entity failed:" << entityItemID << properties.getType();
+            }
+            continue;
+        }
+
+        // a journaled edit was accepted when it was made, so it is applied the way a load would apply it rather
+        // than going back through the lock and simulation ownership checks of updateEntity()
+        AACube newQueryAACube = properties.queryAACubeChanged() ? properties.getQueryAACube()
+                                                                : existingEntity->getQueryAACube();
+        UpdateEntityOperator theOperator(getThisPointer(), existingEntity->getElement(), existingEntity, newQueryAACube);
+        recurseTreeWithOperator(&theOperator);
+        existingEntity->setProperties(properties);
+        _isDirty = true;
+
+        if (_simulation) {
+            if (existingEntity->getDirtyFlags() & DIRTY_SIMULATION_FLAGS) {
+                _simulation->changeEntity(existingEntity);
+            }
+        } else {
+            existingEntity->clearDirtyFlags();
+        }
+    }
+    return true;
+}
+
 void EntityTree::resetClientEditStats() {
     _treeResetTime = usecTimestampNow();
     _maxEditDelta = 0;
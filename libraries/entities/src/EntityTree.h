@@ -206,6 +206,11 @@ public:
     virtual bool writeToMap(QVariantMap& entityDescription, OctreeElementPointer element, bool skipDefaultValues,
                             bool skipThoseWithBadParents) override;
     virtual bool readFromMap(QVariantMap& entityDescription) override;
+    virtual bool readFromItems(const std::function<bool(QVariantMap&)>& readNextItem) override;
+
+    virtual void setJournalChanges(bool journalChanges) override;
+    virtual bool writeJournalChanges(QVariantList& changes) override;
+    virtual bool readJournalChanges(const QVariantList& changes) override;
 
     float getContentsLargestDimension();
 
@@ -294,6 +299,14 @@ protected:
         _deletedEntityItemIDs << id;
     }
 
+    void journalChange(const EntityItemID& entityID, bool deleted);
+
+    mutable QReadWriteLock _journalLock;
+    bool _journalChanges { false };
+    bool _journalLost { false }; // the tree was cleared, which the journal can't express
+    QSet<EntityItemID> _journalEdits; // added or edited since the last writeJournalChanges()
+    QSet<EntityItemID> _journalDeletes;
+
     EntityItemFBXService* _fbxService;
 
     mutable QReadWriteLock _entityToElementLock;
@@ -202,6 +202,8 @@ bool MovingEntitiesOperator::preRecursion(OctreeElementPointer element) {
                     }
                     entityTreeElement->addEntityItem(details.entity);
                     _tree->setContainingElement(entityItemID, entityTreeElement);
+                } else {
+                    _tree->recordElementChange(entityTreeElement);
                 }
                 _foundNewCount++;
                 //details.newFound = true; // TODO: would be nice to add this optimization
@@ -27,6 +27,14 @@
 //
 
 
+#include <algorithm>
+#include <cassert>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define HAVE_SSE2_PARTICLE_KERNELS
+#endif
+
 #include <glm/gtx/transform.hpp>
 #include <QtCore/QJsonDocument>
 
@@ -591,50 +599,146 @@ void ParticleEffectEntityItem::updateShapeType(ShapeType type) {
     }
 }
 
-void ParticleEffectEntityItem::integrateParticle(Particle& particle, float deltaTime) {
-    glm::vec3 atSquared = (0.5f * deltaTime * deltaTime) * particle.acceleration;
-    glm::vec3 at = particle.acceleration * deltaTime;
-    particle.position += particle.velocity * deltaTime + atSquared;
-    particle.velocity += at;
+// Each kernel runs over one span of the ring.  The vec3 and vec2 arrays are tightly packed, so they are stepped
+// through as flat arrays of floats, four at a time.
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(glm::vec2) == 2 * sizeof(float),
+              "particle kernels need tightly packed vectors");
+
+static void ageParticles(glm::vec2* lifetimesAndSeeds, quint32 count, float deltaTime) {
+    float* values = &lifetimesAndSeeds[0].x;
+    quint32 numValues = 2 * count;
+    quint32 i = 0;
+#ifdef HAVE_SSE2_PARTICLE_KERNELS
+    // lifetimes are the even values, seeds are left alone
+    __m128 step = _mm_set_ps(0.0f, deltaTime, 0.0f, deltaTime);
+    for (; i + 4 <= numValues; i += 4) {
+        _mm_storeu_ps(&values[i], _mm_add_ps(_mm_loadu_ps(&values[i]), step));
+    }
+#endif
+    for (; i < numValues; i += 2) {
+        values[i] += deltaTime;
+    }
+}
+
+static void integrateParticles(glm::vec3* positions, glm::vec3* velocities, const glm::vec3* accelerations,
+                               quint32 count, float deltaTime) {
+    float* p = &positions[0].x;
+    float* v = &velocities[0].x;
+    const float* a = &accelerations[0].x;
+    float halfDeltaTimeSquared = 0.5f * deltaTime * deltaTime;
+    quint32 numValues = 3 * count;
+    quint32 i = 0;
+#ifdef HAVE_SSE2_PARTICLE_KERNELS
+    __m128 t = _mm_set1_ps(deltaTime);
+    __m128 halfTSquared = _mm_set1_ps(halfDeltaTimeSquared);
+    for (; i + 4 <= numValues; i += 4) {
+        __m128 acceleration = _mm_loadu_ps(&a[i]);
+        __m128 velocity = _mm_loadu_ps(&v[i]);
+        __m128 position = _mm_loadu_ps(&p[i]);
+        position = _mm_add_ps(position, _mm_add_ps(_mm_mul_ps(velocity, t), _mm_mul_ps(acceleration, halfTSquared)));
+        velocity = _mm_add_ps(velocity, _mm_mul_ps(acceleration, t));
+        _mm_storeu_ps(&p[i], position);
+        _mm_storeu_ps(&v[i], velocity);
+    }
+#endif
+    for (; i < numValues; ++i) {
+        p[i] += v[i] * deltaTime + a[i] * halfDeltaTimeSquared;
+        v[i] += a[i] * deltaTime;
+    }
+}
+
+void ParticleEffectEntityItem::ParticleRing::setCapacity(quint32 capacity) {
+    if (capacity == _capacity) {
+        return;
+    }
+
+    quint32 numKept = std::min(_size, capacity);
+    std::vector<glm::vec3> newPositions(capacity);
+    std::vector<glm::vec3> newVelocities(capacity);
+    std::vector<glm::vec3> newAccelerations(capacity);
+    std::vector<glm::vec2> newLifetimesAndSeeds(capacity);
+
+    // the kept particles start the new ring, oldest first
+    quint32 slot = (_head + (_size - numKept)) % std::max(_capacity, 1u);
+    for (quint32 i = 0; i < numKept; ++i) {
+        newPositions[i] = positions[slot];
+        newVelocities[i] = velocities[slot];
+        newAccelerations[i] = accelerations[slot];
+        newLifetimesAndSeeds[i] = lifetimesAndSeeds[slot];
+        slot = next(slot);
+    }
+
+    positions.swap(newPositions);
+    velocities.swap(newVelocities);
+    accelerations.swap(newAccelerations);
+    lifetimesAndSeeds.swap(newLifetimesAndSeeds);
+    _capacity = capacity;
+    _head = 0;
+    _size = numKept;
+}
+
+quint32 ParticleEffectEntityItem::ParticleRing::pushBack() {
+    assert(_capacity > 0);
+    if (_size == _capacity) {
+        popFront(1);
+    }
+    quint32 slot = (_head + _size) % _capacity;
+    _size++;
+    return slot;
+}
+
+void ParticleEffectEntityItem::ParticleRing::popFront(quint32 count) {
+    count = std::min(count, _size);
+    if (count > 0) {
+        _head = (_head + count) % _capacity;
+        _size -= count;
+    }
+}
+
+std::pair<ParticleEffectEntityItem::ParticleRing::Span, ParticleEffectEntityItem::ParticleRing::Span>
+        ParticleEffectEntityItem::ParticleRing::getSpans() const {
+    quint32 firstCount = std::min(_size, _capacity - _head);
+    return { { _head, firstCount }, { 0, _size - firstCount } };
 }
 
 void ParticleEffectEntityItem::stepSimulation(float deltaTime) {
-    // update particles between head and tail
-    int popCount = 0;
-    for (Particle& particle : _particles) {
-        particle.lifetime += deltaTime;
-
-        // if particle has died.
-        if (particle.lifetime >= _lifespan) {
-            // move head forward
-            popCount++;
-        } else {
-            // Otherwise update it
-            integrateParticle(particle, deltaTime);
+    auto spans = _particles.getSpans();
+    for (auto& span : { spans.first, spans.second }) {
+        if (span.count > 0) {
+            ageParticles(&_particles.lifetimesAndSeeds[span.start], span.count, deltaTime);
+        }
+    }
+
+    // particles are born in order and age together, so the dead ones are all at the head
+    quint32 popCount = 0;
+    for (quint32 i = 0, slot = _particles.front(); i < _particles.size(); ++i, slot = _particles.next(slot)) {
+        if (_particles.lifetimesAndSeeds[slot].x < _lifespan) {
+            break;
+        }
+        popCount++;
+    }
+    _particles.popFront(popCount);
+
+    // update the particles that are still alive
+    spans = _particles.getSpans();
+    for (auto& span : { spans.first, spans.second }) {
+        if (span.count > 0) {
+            integrateParticles(&_particles.positions[span.start], &_particles.velocities[span.start],
+                               &_particles.accelerations[span.start], span.count, deltaTime);
         }
     }
-    _particles.erase(_particles.begin(), _particles.begin() + popCount);
 
     // emit new particles, but only if we are emmitting
     if (getIsEmitting() && _emitRate > 0.0f && _lifespan > 0.0f && _polarStart <= _polarFinish) {
+        if (_particles.getCapacity() != _maxParticles) {
+            _particles.setCapacity(_maxParticles);
+        }
 
         float timeLeftInFrame = deltaTime;
         while (_timeUntilNextEmit < timeLeftInFrame) {
-            // overflow! move head forward by one.
-            // because the case of head == tail indicates an empty array, not a full one.
+            // a full ring drops its oldest particle to make room.
             // This can drop an existing older particle, but this is by design, newer particles are a higher priority.
-            if (_particles.size() >= _maxParticles) {
-                _particles.pop_front();
-            }
-            
-            // emit a new particle at tail index.
-            _particles.push_back(createParticle(glm::mix(_previousPosition, getPosition(),
-                (deltaTime - timeLeftInFrame) / deltaTime)));
-            auto particle = _particles.back();
-            particle.lifetime += timeLeftInFrame;
-            
-            // Initialize it
-            integrateParticle(particle, deltaTime);
+            emitParticle(glm::mix(_previousPosition, getPosition(), (deltaTime - timeLeftInFrame) / deltaTime));
             
             // Advance in frame
             timeLeftInFrame -= _timeUntilNextEmit;
@@ -646,20 +750,21 @@ void ParticleEffectEntityItem::stepSimulation(float deltaTime) {
     _previousPosition = getPosition();
 }
 
-ParticleEffectEntityItem::Particle ParticleEffectEntityItem::createParticle(const glm::vec3& position) {
-    Particle particle;
+void ParticleEffectEntityItem::emitParticle(const glm::vec3& position) {
+    glm::vec3 particlePosition;
+    glm::vec3 velocity;
+    glm::vec3 acceleration;
 
- 
-    particle.seed = randFloatInRange(-1.0f, 1.0f);
+    float seed = randFloatInRange(-1.0f, 1.0f);
     if (getEmitterShouldTrail()) {
-        particle.position = position;
+        particlePosition = position;
     }
     // Position, velocity, and acceleration
     if (_polarStart == 0.0f && _polarFinish == 0.0f && _emitDimensions.z == 0.0f) {
         // Emit along z-axis from position
 
-        particle.velocity = (_emitSpeed + 0.2f * _speedSpread) * (_emitOrientation * Vectors::UNIT_Z);
-        particle.acceleration = _emitAcceleration + randFloatInRange(-1.0f, 1.0f) * _accelerationSpread;
+        velocity = (_emitSpeed + 0.2f * _speedSpread) * (_emitOrientation * Vectors::UNIT_Z);
+        acceleration = _emitAcceleration + randFloatInRange(-1.0f, 1.0f) * _accelerationSpread;
         
     } else {
         // Emit around point or from ellipsoid
@@ -706,18 +811,22 @@ ParticleEffectEntityItem::Particle ParticleEffectEntityItem::createParticle(cons
             ));
             
             if (getEmitterShouldTrail()) {
-                particle.position += _emitOrientation * emitPosition;
+                particlePosition += _emitOrientation * emitPosition;
             }
             else {
-                particle.position = _emitOrientation * emitPosition;
+                particlePosition = _emitOrientation * emitPosition;
             }
         }
         
-        particle.velocity = (_emitSpeed + randFloatInRange(-1.0f, 1.0f) * _speedSpread) * (_emitOrientation * emitDirection);
-        particle.acceleration = _emitAcceleration + randFloatInRange(-1.0f, 1.0f) * _accelerationSpread;
+        velocity = (_emitSpeed + randFloatInRange(-1.0f, 1.0f) * _speedSpread) * (_emitOrientation * emitDirection);
+        acceleration = _emitAcceleration + randFloatInRange(-1.0f, 1.0f) * _accelerationSpread;
     }
-    
-    return particle;
+
+    quint32 slot = _particles.pushBack();
+    _particles.positions[slot] = particlePosition;
+    _particles.velocities[slot] = velocity;
+    _particles.accelerations[slot] = acceleration;
+    _particles.lifetimesAndSeeds[slot] = glm::vec2(0.0f, seed);
 }
 
 void ParticleEffectEntityItem::setMaxParticles(quint32 maxParticles) {
@@ -725,8 +834,8 @@ void ParticleEffectEntityItem::setMaxParticles(quint32 maxParticles) {
         _maxParticles = maxParticles;
 
         // Pop all the overflowing oldest particles
-        while (_particles.size() > _maxParticles) {
-            _particles.pop_front();
+        if (_particles.getCapacity() > 0) {
+            _particles.setCapacity(_maxParticles);
         }
 
         // effectively clear all particles and start emitting new ones from scratch.
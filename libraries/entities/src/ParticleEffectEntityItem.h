@@ -11,7 +11,8 @@
 #ifndef hifi_ParticleEffectEntityItem_h
 #define hifi_ParticleEffectEntityItem_h
 
-#include <deque>
+#include <utility>
+#include <vector>
 
 #include "EntityItem.h"
 
@@ -101,6 +102,7 @@ public:
     virtual void debugDump() const;
 
     bool isEmittingParticles() const; /// emitting enabled, and there are particles alive
+    quint32 getNumParticles() const { return _particles.size(); }
     bool getIsEmitting() const { return _isEmitting; }
     void setIsEmitting(bool isEmitting) { _isEmitting = isEmitting; }
 
@@ -222,25 +224,50 @@ public:
     virtual bool supportsDetailedRayIntersection() const { return false; }
 
 protected:
-    struct Particle;
-    using Particles = std::deque<Particle>;
+    // The live particles, oldest first, in a ring of _maxParticles slots.  Each property has an array of its own,
+    // so that a simulation step runs over plain arrays of floats, and the renderer uploads positions and
+    // lifetimes straight from the arrays they are simulated in.
+    class ParticleRing {
+    public:
+        struct Span {
+            quint32 start;
+            quint32 count;
+        };
+
+        quint32 getCapacity() const { return _capacity; }
+        quint32 size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        // keeps the newest particles that fit
+        void setCapacity(quint32 capacity);
+
+        // makes room after the newest particle, dropping the oldest one if the ring is full, and returns its slot
+        quint32 pushBack();
+        void popFront(quint32 count);
+        quint32 front() const { return _head; }
+        quint32 next(quint32 slot) const { return slot + 1 < _capacity ? slot + 1 : 0; }
+
+        // the live particles are in the slots of the first span, then those of the second if the ring wraps
+        std::pair<Span, Span> getSpans() const;
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> velocities;
+        std::vector<glm::vec3> accelerations;
+        std::vector<glm::vec2> lifetimesAndSeeds; // x = lifetime, y = seed
+
+    private:
+        quint32 _capacity { 0 };
+        quint32 _head { 0 };
+        quint32 _size { 0 };
+    };
 
     bool isAnimatingSomething() const;
     
-    Particle createParticle(const glm::vec3& position);
     void stepSimulation(float deltaTime);
-    void integrateParticle(Particle& particle, float deltaTime);
-    
-    struct Particle {
-        float seed { 0.0f };
-        float lifetime { 0.0f };
-        glm::vec3 position { Vectors::ZERO };
-        glm::vec3 velocity { Vectors::ZERO };
-        glm::vec3 acceleration { Vectors::ZERO };
-    };
+    void emitParticle(const glm::vec3& position);
     
     // Particles container
-    Particles _particles;
+    ParticleRing _particles;
     
     // Particles properties
     rgbColor _color;
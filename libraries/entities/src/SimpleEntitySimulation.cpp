@@ -44,6 +44,7 @@ void SimpleEntitySimulation::clearOwnership(const QUuid& ownerID) {
             entity->markAsChangedOnServer();
             DirtyOctreeElementOperator op(entity->getElement());
             getEntityTree()->recurseTreeWithOperator(&op);
+            getEntityTree()->recordElementChange(entity->getElement());
         } else {
             ++itemItr;
         }
@@ -73,6 +74,7 @@ void SimpleEntitySimulation::updateEntitiesInternal(const quint64& now) {
                     entity->markAsChangedOnServer();
                     DirtyOctreeElementOperator op(entity->getElement());
                     getEntityTree()->recurseTreeWithOperator(&op);
+                    getEntityTree()->recordElementChange(entity->getElement());
                 }
             } else {
                 ++itemItr;
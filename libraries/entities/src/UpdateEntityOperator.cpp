@@ -212,6 +212,7 @@ bool UpdateEntityOperator::preRecursion(OctreeElementPointer element) {
                 if (_wantDebug) {
                     qCDebug(entities) << "    *** This is the same OLD ELEMENT ***";
                 }
+                _tree->recordElementChange(entityTreeElement);
             } else {
                 // otherwise, this is an add case.
                 if (oldElement) {
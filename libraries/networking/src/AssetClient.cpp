@@ -14,6 +14,7 @@
 #include <cstdint>
 
 #include <QtCore/QBuffer>
+#include <QtCore/QDir>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QThread>
 #include <QtScript/QScriptEngine>
@@ -42,6 +43,21 @@ AssetClient::AssetClient() {
     packetReceiver.registerListener(PacketType::AssetMappingOperationReply, this, "handleAssetMappingOperationReply");
     packetReceiver.registerListener(PacketType::AssetGetInfoReply, this, "handleAssetGetInfoReply");
     packetReceiver.registerListener(PacketType::AssetGetReply, this, "handleAssetGetReply", true);
+    packetReceiver.setMessageSizeHint(PacketType::AssetGetReply, [](const ReceivedMessage& firstPart) -> qint64 {
+        // the reply starts with the hash, the message ID, the error, and if there is no error the length of the data
+        static const qint64 HEADER_SIZE = SHA256_HASH_LENGTH + sizeof(MessageID) + sizeof(AssetServerError);
+        if (firstPart.getSize() < HEADER_SIZE + (qint64) sizeof(DataOffset)
+            || firstPart.getRawMessage()[HEADER_SIZE - sizeof(AssetServerError)] != AssetServerError::NoError) {
+            return 0;
+        }
+
+        DataOffset length;
+        memcpy(&length, firstPart.getRawMessage() + HEADER_SIZE, sizeof(DataOffset));
+        if (length <= 0 || (uint64_t) length > MAX_UPLOAD_SIZE) {
+            return 0;
+        }
+        return HEADER_SIZE + sizeof(DataOffset) + length;
+    });
     packetReceiver.registerListener(PacketType::AssetUploadReply, this, "handleAssetUploadReply");
 
     connect(nodeList.data(), &LimitedNodeList::nodeKilled, this, &AssetClient::handleNodeKilled);
@@ -63,6 +79,37 @@ void AssetClient::init() {
         qDebug() << "ResourceManager disk cache setup at" << cachePath
                  << "(size:" << MAXIMUM_CACHE_SIZE / BYTES_PER_GIGABYTES << "GB)";
     }
+
+    // atp: assets are immutable, so they get a cache of their own that is keyed by hash and never revalidated
+    if (!_diskCache) {
+        QString cachePath = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
+        cachePath = !cachePath.isEmpty() ? cachePath : "interfaceCache";
+
+        _diskCache.reset(new AssetDiskCache(QDir(cachePath).filePath("assets")));
+        qDebug() << "AssetClient disk cache setup at" << _diskCache->getDirectory()
+                 << "(size:" << _diskCache->getMaxSize() / BYTES_PER_GIGABYTES << "GB)";
+    }
+}
+
+bool AssetClient::loadFromDiskCache(const AssetHash& hash, AssetDiskCache::LoadCallback callback) {
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (!_diskCache) {
+        return false;
+    }
+
+    _diskCache->load(hash, callback);
+    return true;
+}
+
+void AssetClient::saveToDiskCache(const AssetHash& hash, const QByteArray& data) {
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (_diskCache) {
+        _diskCache->store(hash, data);
+    } else {
+        qCWarning(asset_client) << "No disk cache to save assets to.";
+    }
 }
 
 
@@ -84,6 +131,26 @@ void AssetClient::cacheInfoRequest(QObject* reciever, QString slot) {
     }
 }
 
+void AssetClient::assetCacheInfoRequest(QObject* reciever, QString slot) {
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, "assetCacheInfoRequest", Qt::QueuedConnection,
+                                  Q_ARG(QObject*, reciever), Q_ARG(QString, slot));
+        return;
+    }
+
+    if (_diskCache) {
+        QMetaObject::invokeMethod(reciever, slot.toStdString().data(), Qt::QueuedConnection,
+                                  Q_ARG(QString, _diskCache->getDirectory()),
+                                  Q_ARG(qint64, _diskCache->getSize()),
+                                  Q_ARG(qint64, _diskCache->getMaxSize()),
+                                  Q_ARG(quint64, _diskCache->getHits()),
+                                  Q_ARG(quint64, _diskCache->getMisses()),
+                                  Q_ARG(float, _diskCache->getHitRate()));
+    } else {
+        qCWarning(asset_client) << "No asset disk cache to get info from.";
+    }
+}
+
 void AssetClient::clearCache() {
     if (QThread::currentThread() != thread()) {
         QMetaObject::invokeMethod(this, "clearCache", Qt::QueuedConnection);
@@ -96,6 +163,10 @@ void AssetClient::clearCache() {
     } else {
         qCWarning(asset_client) << "No disk cache to clear.";
     }
+
+    if (_diskCache) {
+        _diskCache->clear();
+    }
 }
 
 void AssetClient::handleAssetMappingOperationReply(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
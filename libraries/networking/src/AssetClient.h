@@ -17,9 +17,11 @@
 #include <QString>
 
 #include <map>
+#include <memory>
 
 #include <DependencyManager.h>
 
+#include "AssetDiskCache.h"
 #include "AssetUtils.h"
 #include "LimitedNodeList.h"
 #include "NLPacket.h"
@@ -66,6 +68,9 @@ public slots:
     void init();
 
     void cacheInfoRequest(QObject* reciever, QString slot);
+
+    /// Calls the slot with the atp: disk cache's directory, size, max size, and the number of hits and misses, and the hit rate
+    void assetCacheInfoRequest(QObject* reciever, QString slot);
     void clearCache();
 
 private slots:
@@ -93,6 +98,10 @@ private:
     bool cancelGetAssetRequest(MessageID id);
     bool cancelUploadAssetRequest(MessageID id);
 
+    /// Looks the asset up in the disk cache, calling back on this thread. Returns false if there is no disk cache.
+    bool loadFromDiskCache(const AssetHash& hash, AssetDiskCache::LoadCallback callback);
+    void saveToDiskCache(const AssetHash& hash, const QByteArray& data);
+
     void handleProgressCallback(const QWeakPointer<Node>& node, MessageID messageID, DataOffset length);
     void handleCompleteCallback(const QWeakPointer<Node>& node, MessageID messageID);
 
@@ -108,6 +117,8 @@ private:
     std::unordered_map<SharedNodePointer, std::unordered_map<MessageID, GetInfoCallback>> _pendingInfoRequests;
     std::unordered_map<SharedNodePointer, std::unordered_map<MessageID, UploadResultCallback>> _pendingUploads;
 
+    std::unique_ptr<AssetDiskCache> _diskCache;
+
     friend class AssetRequest;
     friend class AssetUpload;
     friend class MappingRequest;
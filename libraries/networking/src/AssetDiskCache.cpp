@@ -0,0 +1,224 @@
+//
+//  AssetDiskCache.cpp
+//  libraries/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetDiskCache.h"
+
+#include <algorithm>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+#include <QtCore/QSaveFile>
+
+#include "NetworkLogging.h"
+#include "ResourceCache.h"
+
+const qint64 AssetDiskCache::DEFAULT_MAX_SIZE = 2 * BYTES_PER_GIGABYTES;
+
+// eviction frees a little more than it has to, so that not every store past the cap has to sort the index
+static const float EVICTION_TARGET_FRACTION = 0.9f;
+
+class AssetDiskCacheTask : public QRunnable {
+public:
+    AssetDiskCacheTask(std::function<void()> work) : _work(work) { }
+    void run() override { _work(); }
+
+private:
+    std::function<void()> _work;
+};
+
+AssetDiskCache::AssetDiskCache(const QString& directory, qint64 maxSize) :
+    _directory(directory),
+    _maxSize(maxSize)
+{
+    // a single thread keeps the file operations in order, so a load queued after a store sees the stored file
+    _ioPool.setMaxThreadCount(1);
+    _ioPool.setExpiryTimeout(-1);
+
+    if (!_directory.mkpath(".")) {
+        qCWarning(asset_client) << "Could not create asset disk cache at" << _directory.absolutePath();
+    }
+
+    runInBackground([this] {
+        scanDirectory();
+    });
+}
+
+AssetDiskCache::~AssetDiskCache() {
+    _ioPool.waitForDone();
+
+    qCDebug(asset_client) << "Asset disk cache hits:" << _hits << "misses:" << _misses
+                          << "hit rate:" << getHitRate();
+}
+
+float AssetDiskCache::getHitRate() const {
+    uint64_t hits = _hits;
+    uint64_t lookups = hits + _misses;
+    return lookups > 0 ? (float)hits / (float)lookups : 0.0f;
+}
+
+void AssetDiskCache::load(const AssetHash& hash, LoadCallback callback) {
+    auto& callbacks = _pendingLoads[hash];
+    callbacks.push_back(callback);
+    if (callbacks.size() > 1) {
+        // the asset is already being read for someone else
+        return;
+    }
+
+    runInBackground([this, hash] {
+        QByteArray data = readAsset(hash);
+        QMetaObject::invokeMethod(this, "handleLoaded", Qt::QueuedConnection,
+                                  Q_ARG(QString, hash), Q_ARG(QByteArray, data));
+    });
+}
+
+void AssetDiskCache::handleLoaded(QString hash, QByteArray data) {
+    if (data.isNull()) {
+        ++_misses;
+    } else {
+        ++_hits;
+    }
+
+    auto callbacks = _pendingLoads.take(hash);
+    for (auto& callback : callbacks) {
+        callback(data);
+    }
+}
+
+void AssetDiskCache::store(const AssetHash& hash, const QByteArray& data) {
+    if (data.size() > _maxSize) {
+        return;
+    }
+
+    runInBackground([this, hash, data] {
+        writeAsset(hash, data);
+    });
+}
+
+void AssetDiskCache::clear() {
+    runInBackground([this] {
+        QList<AssetHash> hashes;
+        {
+            QMutexLocker locker(&_indexMutex);
+            hashes = _index.keys();
+        }
+        for (auto& hash : hashes) {
+            removeAsset(hash);
+        }
+    });
+}
+
+void AssetDiskCache::scanDirectory() {
+    // files left over from an interrupted write, or that are not assets, are skipped and left alone
+    auto files = _directory.entryInfoList(QDir::Files);
+
+    QMutexLocker locker(&_indexMutex);
+    for (auto& fileInfo : files) {
+        AssetHash hash = fileInfo.fileName();
+        if (!isValidHash(hash)) {
+            continue;
+        }
+
+        QDateTime lastUsed = fileInfo.lastRead().isValid() ? fileInfo.lastRead() : fileInfo.lastModified();
+        _index[hash] = { fileInfo.size(), lastUsed.toMSecsSinceEpoch() };
+        _size += fileInfo.size();
+    }
+
+    qCDebug(asset_client) << "Asset disk cache at" << _directory.absolutePath() << "holds" << _index.size()
+                          << "assets (" << _size / BYTES_PER_MEGABYTES << "MB)";
+}
+
+QByteArray AssetDiskCache::readAsset(const AssetHash& hash) {
+    {
+        QMutexLocker locker(&_indexMutex);
+        auto it = _index.find(hash);
+        if (it == _index.end()) {
+            return QByteArray();
+        }
+        it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    }
+
+    QFile file { _directory.filePath(hash) };
+    QByteArray data;
+    if (file.open(QIODevice::ReadOnly)) {
+        data = file.readAll();
+    }
+
+    if (data.isNull() || hashData(data).toHex() != hash) {
+        qCWarning(asset_client) << "Dropping unreadable or corrupt asset" << hash << "from disk cache";
+        removeAsset(hash);
+        return QByteArray();
+    }
+
+    return data;
+}
+
+void AssetDiskCache::writeAsset(const AssetHash& hash, const QByteArray& data) {
+    {
+        QMutexLocker locker(&_indexMutex);
+        if (_index.contains(hash)) {
+            return;
+        }
+    }
+
+    // the file only shows up under the asset's name once it is complete
+    QSaveFile file { _directory.filePath(hash) };
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qCWarning(asset_client) << "Could not save" << hash << "to disk cache:" << file.errorString();
+        return;
+    }
+
+    {
+        QMutexLocker locker(&_indexMutex);
+        _index[hash] = { data.size(), QDateTime::currentMSecsSinceEpoch() };
+        _size += data.size();
+    }
+
+    if (_size > _maxSize) {
+        evict();
+    }
+}
+
+void AssetDiskCache::removeAsset(const AssetHash& hash) {
+    QFile::remove(_directory.filePath(hash));
+
+    QMutexLocker locker(&_indexMutex);
+    auto it = _index.find(hash);
+    if (it != _index.end()) {
+        _size -= it->size;
+        _index.erase(it);
+    }
+}
+
+void AssetDiskCache::evict() {
+    std::vector<std::pair<qint64, AssetHash>> byLastUse;
+    {
+        QMutexLocker locker(&_indexMutex);
+        byLastUse.reserve(_index.size());
+        for (auto it = _index.begin(); it != _index.end(); ++it) {
+            byLastUse.emplace_back(it->lastUsed, it.key());
+        }
+    }
+    std::sort(byLastUse.begin(), byLastUse.end());
+
+    qint64 targetSize = (qint64)(_maxSize * EVICTION_TARGET_FRACTION);
+    for (auto& entry : byLastUse) {
+        if (_size <= targetSize) {
+            break;
+        }
+        removeAsset(entry.second);
+    }
+}
+
+void AssetDiskCache::runInBackground(std::function<void()> work) {
+    _ioPool.start(new AssetDiskCacheTask(work));
+}
@@ -0,0 +1,91 @@
+//
+//  AssetDiskCache.h
+//  libraries/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetDiskCache_h
+#define hifi_AssetDiskCache_h
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDir>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+
+#include "AssetUtils.h"
+
+/// Keeps downloaded atp: assets on disk between sessions, one file per asset named by its hash. An asset never
+/// changes under its hash, so entries never expire - they are only evicted, least recently used first, to stay
+/// under the size cap, and dropped if their contents no longer hash to their name.
+///
+/// All file access happens on a single worker thread, in the order it was asked for. Load callbacks are called on
+/// the thread the cache lives in.
+class AssetDiskCache : public QObject {
+    Q_OBJECT
+public:
+    /// Called with the asset's contents, or a null array if the asset is not in the cache
+    using LoadCallback = std::function<void(const QByteArray& data)>;
+
+    static const qint64 DEFAULT_MAX_SIZE;
+
+    AssetDiskCache(const QString& directory, qint64 maxSize = DEFAULT_MAX_SIZE);
+
+    // waits for pending writes to be done
+    ~AssetDiskCache();
+
+    void load(const AssetHash& hash, LoadCallback callback);
+    void store(const AssetHash& hash, const QByteArray& data);
+    void clear();
+
+    QString getDirectory() const { return _directory.absolutePath(); }
+    qint64 getSize() const { return _size; }
+    qint64 getMaxSize() const { return _maxSize; }
+
+    uint64_t getHits() const { return _hits; }
+    uint64_t getMisses() const { return _misses; }
+    float getHitRate() const;
+
+private slots:
+    void handleLoaded(QString hash, QByteArray data);
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 lastUsed; // msecs since epoch
+    };
+
+    void scanDirectory();
+    QByteArray readAsset(const AssetHash& hash);
+    void writeAsset(const AssetHash& hash, const QByteArray& data);
+    void removeAsset(const AssetHash& hash);
+    void evict();
+
+    void runInBackground(std::function<void()> work);
+
+    QDir _directory;
+    const qint64 _maxSize;
+
+    // only touched from the cache's thread
+    QHash<AssetHash, std::vector<LoadCallback>> _pendingLoads;
+
+    QMutex _indexMutex;
+    QHash<AssetHash, Entry> _index;
+    std::atomic<qint64> _size { 0 };
+
+    std::atomic<uint64_t> _hits { 0 };
+    std::atomic<uint64_t> _misses { 0 };
+
+    QThreadPool _ioPool;
+};
+
+#endif // hifi_AssetDiskCache_h
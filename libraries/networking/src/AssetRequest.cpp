@@ -20,17 +20,21 @@
 #include "NodeList.h"
 #include "ResourceCache.h"
 
+// Assets larger than a chunk are requested as several byte ranges at once, so that the asset-server can send them
+// in parallel and each one completes, and shows progress, without waiting behind the whole asset.
+static const DataOffset CHUNK_SIZE = 1024 * 1024;
+static const size_t MAX_CHUNKS_IN_FLIGHT = 4;
+
 AssetRequest::AssetRequest(const QString& hash) :
     _hash(hash)
 {
 }
 
 AssetRequest::~AssetRequest() {
-    auto assetClient = DependencyManager::get<AssetClient>();
-    if (_assetRequestID) {
-        assetClient->cancelGetAssetRequest(_assetRequestID);
-    }
+    cancelChunkRequests();
+
     if (_assetInfoRequestID) {
+        auto assetClient = DependencyManager::get<AssetClient>();
         assetClient->cancelGetAssetInfoRequest(_assetInfoRequestID);
     }
 }
@@ -55,20 +59,38 @@ void AssetRequest::start() {
         return;
     }
     
+    _state = WaitingForInfo;
+
     // Try to load from cache
-    _data = loadFromCache(getUrl());
-    if (!_data.isNull()) {
+    auto assetClient = DependencyManager::get<AssetClient>();
+    auto that = QPointer<AssetRequest>(this); // Used to track the request's lifetime
+    bool hasDiskCache = assetClient->loadFromDiskCache(_hash, [this, that](const QByteArray& data) {
+        if (!that) {
+            // If the request is dead, return
+            return;
+        }
+
+        if (data.isNull()) {
+            requestInfo();
+            return;
+        }
+
+        _data = data;
         _info.hash = _hash;
         _info.size = _data.size();
+        _totalReceived = _data.size();
         _error = NoError;
-        
+
         _state = Finished;
         emit finished(this);
-        return;
+    });
+
+    if (!hasDiskCache) {
+        requestInfo();
     }
-    
-    _state = WaitingForInfo;
-    
+}
+
+void AssetRequest::requestInfo() {
     auto assetClient = DependencyManager::get<AssetClient>();
     _assetInfoRequestID = assetClient->getAssetInfo(_hash,
             [this](bool responseReceived, AssetServerError serverError, AssetInfo info) {
@@ -102,62 +124,134 @@ void AssetRequest::start() {
         _data.resize(info.size);
         
         qCDebug(asset_client) << "Got size of " << _hash << " : " << info.size << " bytes";
-        
-        int start = 0, end = _info.size;
-        
-        auto assetClient = DependencyManager::get<AssetClient>();
-        auto that = QPointer<AssetRequest>(this); // Used to track the request's lifetime
-        _assetRequestID = assetClient->getAsset(_hash, start, end,
+
+        requestNextChunks();
+    });
+}
+
+void AssetRequest::requestNextChunks() {
+    auto assetClient = DependencyManager::get<AssetClient>();
+    auto that = QPointer<AssetRequest>(this); // Used to track the request's lifetime
+
+    if (_info.size == 0) {
+        // there is nothing to fetch, but the hash still has to match
+        handleChunk(0, 0, true, AssetServerError::NoError, QByteArray());
+        return;
+    }
+
+    // a failed chunk finishes the request from inside getAsset() when there is no asset-server
+    while (_state == WaitingForData && _chunkRequestIDs.size() < MAX_CHUNKS_IN_FLIGHT && _nextChunkStart < _info.size) {
+        DataOffset start = _nextChunkStart;
+        DataOffset end = std::min(start + CHUNK_SIZE, (DataOffset)_info.size);
+        _nextChunkStart = end;
+
+        auto requestID = assetClient->getAsset(_hash, start, end,
                 [this, that, start, end](bool responseReceived, AssetServerError serverError, const QByteArray& data) {
             if (!that) {
                 // If the request is dead, return
                 return;
             }
-            _assetRequestID = AssetClient::INVALID_MESSAGE_ID;
-
-            if (!responseReceived) {
-                _error = NetworkError;
-            } else if (serverError != AssetServerError::NoError) {
-                switch (serverError) {
-                    case AssetServerError::AssetNotFound:
-                        _error = NotFound;
-                        break;
-                    case AssetServerError::InvalidByteRange:
-                        _error = InvalidByteRange;
-                        break;
-                    default:
-                        _error = UnknownError;
-                        break;
-                }
-            } else {
-                Q_ASSERT(data.size() == (end - start));
-                
-                // we need to check the hash of the received data to make sure it matches what we expect
-                if (hashData(data).toHex() == _hash) {
-                    memcpy(_data.data() + start, data.constData(), data.size());
-                    _totalReceived += data.size();
-                    emit progress(_totalReceived, _info.size);
-                    
-                    saveToCache(getUrl(), data);
-                } else {
-                    // hash doesn't match - we have an error
-                    _error = HashVerificationFailed;
-                }
-                
-            }
-            
-            if (_error != NoError) {
-                qCWarning(asset_client) << "Got error retrieving asset" << _hash << "- error code" << _error;
-            }
-            
-            _state = Finished;
-            emit finished(this);
-        }, [this, that](qint64 totalReceived, qint64 total) {
+            handleChunk(start, end, responseReceived, serverError, data);
+        }, [this, that, start](qint64 totalReceived, qint64 total) {
             if (!that) {
                 // If the request is dead, return
                 return;
             }
-            emit progress(totalReceived, total);
+            _chunkProgress[start] = totalReceived;
+
+            qint64 received = _totalReceived;
+            for (auto& chunkProgress : _chunkProgress) {
+                received += chunkProgress.second;
+            }
+            emit progress(std::min(received, (qint64)_info.size), _info.size);
         });
-    });
+
+        if (requestID != AssetClient::INVALID_MESSAGE_ID) {
+            _chunkRequestIDs[start] = requestID;
+        }
+    }
+}
+
+void AssetRequest::handleChunk(DataOffset start, DataOffset end, bool responseReceived, AssetServerError serverError,
+                               const QByteArray& data) {
+    _chunkRequestIDs.erase(start);
+    _chunkProgress.erase(start);
+
+    if (_state != WaitingForData) {
+        return;
+    }
+
+    if (!responseReceived) {
+        _error = NetworkError;
+    } else if (serverError != AssetServerError::NoError) {
+        switch (serverError) {
+            case AssetServerError::AssetNotFound:
+                _error = NotFound;
+                break;
+            case AssetServerError::InvalidByteRange:
+                _error = InvalidByteRange;
+                break;
+            default:
+                _error = UnknownError;
+                break;
+        }
+    } else if (data.size() != (end - start)) {
+        _error = InvalidByteRange;
+    }
+
+    if (_error != NoError) {
+        qCWarning(asset_client) << "Got error retrieving asset" << _hash << "- error code" << _error;
+
+        cancelChunkRequests();
+        _state = Finished;
+        emit finished(this);
+        return;
+    }
+
+    memcpy(_data.data() + start, data.constData(), data.size());
+    _totalReceived += data.size();
+    _unhashedChunks[start] = end;
+
+    DataOffset previouslyHashed = _hashedBytes;
+    auto it = _unhashedChunks.begin();
+    while (it != _unhashedChunks.end() && it->first == _hashedBytes) {
+        _hasher.addData(_data.constData() + it->first, it->second - it->first);
+        _hashedBytes = it->second;
+        it = _unhashedChunks.erase(it);
+    }
+
+    emit progress(_totalReceived, _info.size);
+    if (_hashedBytes > previouslyHashed) {
+        emit dataAvailable(_hashedBytes);
+    }
+
+    if (_hashedBytes < _info.size) {
+        requestNextChunks();
+        return;
+    }
+
+    // we need to check the hash of the received data to make sure it matches what we expect
+    if (_hasher.result().toHex() == _hash) {
+        DependencyManager::get<AssetClient>()->saveToDiskCache(_hash, _data);
+    } else {
+        // hash doesn't match - we have an error
+        _error = HashVerificationFailed;
+        qCWarning(asset_client) << "Got error retrieving asset" << _hash << "- error code" << _error;
+    }
+
+    _state = Finished;
+    emit finished(this);
+}
+
+void AssetRequest::cancelChunkRequests() {
+    if (_chunkRequestIDs.empty()) {
+        return;
+    }
+
+    auto assetClient = DependencyManager::get<AssetClient>();
+    for (auto& chunkRequest : _chunkRequestIDs) {
+        assetClient->cancelGetAssetRequest(chunkRequest.second);
+    }
+    _chunkRequestIDs.clear();
+    _chunkProgress.clear();
 }
@@ -12,7 +12,10 @@
 #ifndef hifi_AssetRequest_h
 #define hifi_AssetRequest_h
 
+#include <map>
+
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QObject>
 #include <QString>
 
@@ -54,16 +57,34 @@ signals:
     void finished(AssetRequest* thisRequest);
     void progress(qint64 totalReceived, qint64 total);
 
+    /// The first `received` bytes of getData() have arrived. The hash covers the whole asset, so they are only known
+    /// to be intact once the request finishes without an error.
+    void dataAvailable(qint64 received);
+
 private:
+    void requestInfo();
+    void requestNextChunks();
+    void handleChunk(DataOffset start, DataOffset end, bool responseReceived, AssetServerError serverError,
+                     const QByteArray& data);
+    void cancelChunkRequests();
+
     State _state = NotStarted;
     Error _error = NoError;
     AssetInfo _info;
     uint64_t _totalReceived { 0 };
     QString _hash;
     QByteArray _data;
-    int _numPendingRequests { 0 };
-    MessageID _assetRequestID { AssetClient::INVALID_MESSAGE_ID };
     MessageID _assetInfoRequestID { AssetClient::INVALID_MESSAGE_ID };
+
+    // large assets are fetched as several byte ranges at once, keyed here by where their range starts
+    DataOffset _nextChunkStart { 0 };
+    std::map<DataOffset, MessageID> _chunkRequestIDs;
+    std::map<DataOffset, qint64> _chunkProgress;
+
+    // chunks are hashed in order as they join the prefix of the asset that has arrived
+    std::map<DataOffset, DataOffset> _unhashedChunks; // start to end
+    DataOffset _hashedBytes { 0 };
+    QCryptographicHash _hasher { QCryptographicHash::Sha256 };
 };
 
 #endif
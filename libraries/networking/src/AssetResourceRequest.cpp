@@ -108,6 +108,10 @@ void AssetResourceRequest::requestHash(const AssetHash& hash) {
     _assetRequest = assetClient->createRequest(hash);
 
     connect(_assetRequest, &AssetRequest::progress, this, &AssetResourceRequest::progress);
+    connect(_assetRequest, &AssetRequest::dataAvailable, this, [this](qint64 received) {
+        _bytesAvailable = received;
+        emit dataAvailable(received);
+    });
     connect(_assetRequest, &AssetRequest::finished, this, [this](AssetRequest* req) {
         Q_ASSERT(_state == InProgress);
         Q_ASSERT(req == _assetRequest);
@@ -142,6 +146,15 @@ void AssetResourceRequest::requestHash(const AssetHash& hash) {
     _assetRequest->start();
 }
 
+QByteArray AssetResourceRequest::getAvailableData() const {
+    if (_state == Finished || !_assetRequest) {
+        return ResourceRequest::getAvailableData();
+    }
+
+    // the asset request fills a buffer the size of the whole asset, and the prefix that has arrived never changes
+    return QByteArray::fromRawData(_assetRequest->getData().constData(), _bytesAvailable);
+}
+
 void AssetResourceRequest::onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
     emit progress(bytesReceived, bytesTotal);
 }
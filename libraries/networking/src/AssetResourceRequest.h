@@ -23,6 +23,8 @@ public:
     AssetResourceRequest(const QUrl& url) : ResourceRequest(url) { }
     virtual ~AssetResourceRequest() override;
 
+    virtual QByteArray getAvailableData() const override;
+
 protected:
     virtual void doSend() override;
 
@@ -37,6 +39,7 @@ private:
 
     GetMappingRequest* _assetMappingRequest { nullptr };
     AssetRequest* _assetRequest { nullptr };
+    qint64 _bytesAvailable { 0 };
 };
 
 #endif
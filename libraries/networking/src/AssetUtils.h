@@ -56,10 +56,10 @@ QUrl getATPUrl(const QString& hash);
 
 QByteArray hashData(const QByteArray& data);
 
-QByteArray loadFromCache(const QUrl& url);
-bool saveToCache(const QUrl& url, const QByteArray& file);
-
 bool isValidPath(const AssetPath& path);
 bool isValidHash(const QString& hashString);
 
+// `start` is inclusive and `end` exclusive, both come from the requesting client
+bool isValidByteRange(DataOffset start, DataOffset end, qint64 assetSize);
+
 #endif
@@ -154,6 +154,26 @@ QHostAddress getGuessedLocalAddress() {
     return localAddress;
 }
 
+bool isLocalNetworkAddress(const QHostAddress& address) {
+    static const QPair<QHostAddress, int> PRIVATE_SUBNETS[] = {
+        QHostAddress::parseSubnet("10.0.0.0/8"),
+        QHostAddress::parseSubnet("172.16.0.0/12"),
+        QHostAddress::parseSubnet("192.168.0.0/16")
+    };
+
+    if (address.isLoopback()) {
+        return true;
+    }
+
+    for (const auto& subnet : PRIVATE_SUBNETS) {
+        if (address.isInSubnet(subnet)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 uint qHash(const HifiSockAddr& key, uint seed) {
     // use the existing QHostAddress and quint16 hash functions to get our hash
     return qHash(key.getAddress(), seed) ^ qHash(key.getPort(), seed);
@@ -94,6 +94,9 @@ namespace std {
 
 QHostAddress getGuessedLocalAddress();
 
+// true for loopback and RFC1918 private addresses
+bool isLocalNetworkAddress(const QHostAddress& address);
+
 Q_DECLARE_METATYPE(HifiSockAddr);
 
 #endif // hifi_HifiSockAddr_h
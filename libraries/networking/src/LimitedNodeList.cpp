@@ -223,13 +223,36 @@ bool LimitedNodeList::packetSourceAndHashMatch(const udt::Packet& packet) {
         SharedNodePointer matchingNode = nodeWithUUID(sourceID);
 
         if (matchingNode) {
-            if (!NON_VERIFIED_PACKETS.contains(headerType)) {
+            // the domain-server hands out no secret for a pair of nodes it trusts on its local network,
+            // and packets between them are sent without a hash
+            const QUuid& connectionSecret = matchingNode->getConnectionSecret();
 
-                QByteArray packetHeaderHash = NLPacket::verificationHashInHeader(packet);
-                QByteArray expectedHash = NLPacket::hashForPacketAndSecret(packet, matchingNode->getConnectionSecret());
+            if (!NON_VERIFIED_PACKETS.contains(headerType) && connectionSecret.isNull()) {
+                // without a hash the source UUID proves nothing, since every node's UUID is in the DomainList,
+                // so the packet has to come from the node's own socket on the local network
+                const HifiSockAddr& senderSockAddr = packet.getSenderSockAddr();
+                bool isFromNodeSocket = (matchingNode->getActiveSocket() && senderSockAddr == *matchingNode->getActiveSocket())
+                    || senderSockAddr == matchingNode->getLocalSocket();
 
-                // check if the md5 hash in the header matches the hash we would expect
-                if (packetHeaderHash != expectedHash) {
+                if (!isFromNodeSocket || !isLocalNetworkAddress(senderSockAddr.getAddress())) {
+                    static QMultiMap<QUuid, PacketType> unsignedDebugSuppressMap;
+
+                    if (!unsignedDebugSuppressMap.contains(sourceID, headerType)) {
+                        qCDebug(networking) << "Unsigned packet" << headerType << "claiming to be from" << sourceID
+                            << "came from" << senderSockAddr << "- ignoring it";
+
+                        unsignedDebugSuppressMap.insert(sourceID, headerType);
+                    }
+
+                    return false;
+                }
+            } else if (!NON_VERIFIED_PACKETS.contains(headerType)) {
+
+                char expectedHash[NUM_BYTES_VERIFICATION_HASH];
+                NLPacket::hashForPacketAndSecret(packet, connectionSecret, expectedHash);
+
+                // check if the hash in the header matches the hash we would expect
+                if (memcmp(NLPacket::verificationHashInHeader(packet), expectedHash, NUM_BYTES_VERIFICATION_HASH) != 0) {
                     static QMultiMap<QUuid, PacketType> hashDebugSuppressMap;
 
                     if (!hashDebugSuppressMap.contains(sourceID, headerType)) {
@@ -404,6 +427,34 @@ qint64 LimitedNodeList::sendPacketList(std::unique_ptr<NLPacketList> packetList,
     }
 }
 
+void LimitedNodeList::addToPacketBatch(udt::PacketBatch& batch, std::unique_ptr<NLPacket> packet,
+                                       const Node& destinationNode) {
+    Q_ASSERT(!packet->isPartOfMessage());
+    Q_ASSERT_X(!packet->isReliable(), "LimitedNodeList::addToPacketBatch", "Trying to batch a reliable packet.");
+
+    auto activeSocket = destinationNode.getActiveSocket();
+    if (!activeSocket) {
+        return;
+    }
+
+    emit dataSent(destinationNode.getType(), packet->getDataSize());
+    destinationNode.recordBytesSent(packet->getDataSize());
+
+    collectPacketStats(*packet);
+    fillPacketHeader(*packet, destinationNode.getConnectionSecret());
+
+    batch.push_back({ std::move(packet), *activeSocket });
+}
+
+void LimitedNodeList::addToPacketBatch(udt::PacketBatch& batch, NLPacketList& packetList, const Node& destinationNode) {
+    // close the last packet in the list
+    packetList.closeCurrentPacket();
+
+    while (!packetList._packets.empty()) {
+        addToPacketBatch(batch, packetList.takeFront<NLPacket>(), destinationNode);
+    }
+}
+
 qint64 LimitedNodeList::sendPacket(std::unique_ptr<NLPacket> packet, const Node& destinationNode,
                                    const HifiSockAddr& overridenSockAddr) {
     if (overridenSockAddr.isNull() && !destinationNode.getActiveSocket()) {
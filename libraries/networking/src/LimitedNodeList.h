@@ -73,6 +73,13 @@ namespace PingType {
     const PingType_t Symmetric = 3;
 }
 
+// each entry in a DomainList packet starts with one of these, and a delta list can have both
+typedef quint8 DomainListEntry_t;
+namespace DomainListEntry {
+    const DomainListEntry_t AddedNode = 0; // followed by the node and its connection secret
+    const DomainListEntry_t RemovedNode = 1; // followed by the node's UUID
+}
+
 class LimitedNodeList : public QObject, public Dependency {
     Q_OBJECT
     SINGLETON_DEPENDENCY
@@ -129,6 +136,12 @@ public:
     qint64 sendPacketList(std::unique_ptr<NLPacketList> packetList, const HifiSockAddr& sockAddr);
     qint64 sendPacketList(std::unique_ptr<NLPacketList> packetList, const Node& destinationNode);
 
+    // unreliable packets for any number of nodes can be collected in a batch, and then sent with as few system calls
+    // as the platform allows - a mixer collects its packets for a frame this way
+    void addToPacketBatch(udt::PacketBatch& batch, std::unique_ptr<NLPacket> packet, const Node& destinationNode);
+    void addToPacketBatch(udt::PacketBatch& batch, NLPacketList& packetList, const Node& destinationNode);
+    qint64 sendPacketBatch(udt::PacketBatch& batch) { return _nodeSocket.writePacketBatch(batch); }
+
     std::function<void(Node*)> linkedDataCreateCallback;
 
     size_t size() const { return _nodeHash.size(); }
@@ -218,6 +231,7 @@ public:
     void flagTimeForConnectionStep(ConnectionStep connectionStep);
 
     udt::Socket::StatsVector sampleStatsForAllConnections() { return _nodeSocket.sampleStatsForAllConnections(); }
+    udt::Socket::WriteStats sampleSocketWriteStats() { return _nodeSocket.sampleWriteStats(); }
 
     void setConnectionMaxBandwidth(int maxBandwidth) { _nodeSocket.setConnectionMaxBandwidth(maxBandwidth); }
 
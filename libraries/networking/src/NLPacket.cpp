@@ -11,10 +11,12 @@
 
 #include "NLPacket.h"
 
+#include "SipHash.h"
+
 int NLPacket::localHeaderSize(PacketType type) {
     bool nonSourced = NON_SOURCED_PACKETS.contains(type);
     bool nonVerified = NON_VERIFIED_PACKETS.contains(type);
-    qint64 optionalSize = (nonSourced ? 0 : NUM_BYTES_RFC4122_UUID) + ((nonSourced || nonVerified) ? 0 : NUM_BYTES_MD5_HASH);
+    qint64 optionalSize = (nonSourced ? 0 : NUM_BYTES_RFC4122_UUID) + ((nonSourced || nonVerified) ? 0 : NUM_BYTES_VERIFICATION_HASH);
     return sizeof(PacketType) + sizeof(PacketVersion) + optionalSize;
 }
 int NLPacket::totalHeaderSize(PacketType type, bool isPartOfMessage) {
@@ -144,23 +146,27 @@ QUuid NLPacket::sourceIDInHeader(const udt::Packet& packet) {
     return QUuid::fromRfc4122(QByteArray::fromRawData(packet.getData() + offset, NUM_BYTES_RFC4122_UUID));
 }
 
-QByteArray NLPacket::verificationHashInHeader(const udt::Packet& packet) {
+const char* NLPacket::verificationHashInHeader(const udt::Packet& packet) {
     int offset = Packet::totalHeaderSize(packet.isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion) + NUM_BYTES_RFC4122_UUID;
-    return QByteArray(packet.getData() + offset, NUM_BYTES_MD5_HASH);
+    return packet.getData() + offset;
 }
 
-QByteArray NLPacket::hashForPacketAndSecret(const udt::Packet& packet, const QUuid& connectionSecret) {
-    QCryptographicHash hash(QCryptographicHash::Md5);
-    
+void NLPacket::hashForPacketAndSecret(const udt::Packet& packet, const QUuid& connectionSecret, char* hash) {
+    static_assert(NUM_BYTES_VERIFICATION_HASH == NUM_BYTES_SIPHASH_128, "The verification hash is a 128-bit SipHash");
+
     int offset = Packet::totalHeaderSize(packet.isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion)
-        + NUM_BYTES_RFC4122_UUID + NUM_BYTES_MD5_HASH;
-    
-    // add the packet payload and the connection UUID
-    hash.addData(packet.getData() + offset, packet.getDataSize() - offset);
-    hash.addData(connectionSecret.toRfc4122());
-    
-    // return the hash
-    return hash.result();
+        + NUM_BYTES_RFC4122_UUID + NUM_BYTES_VERIFICATION_HASH;
+
+    // the connection secret is the key, taken from the UUID fields in their RFC 4122 order
+    uint64_t k0 = ((uint64_t) connectionSecret.data1 << 32) | ((uint64_t) connectionSecret.data2 << 16)
+        | (uint64_t) connectionSecret.data3;
+    uint64_t k1 = 0;
+    for (int i = 0; i < 8; i++) {
+        k1 = (k1 << 8) | connectionSecret.data4[i];
+    }
+
+    // hash the packet payload
+    sipHash128(k0, k1, packet.getData() + offset, packet.getDataSize() - offset, hash);
 }
 
 void NLPacket::writeTypeAndVersion() {
@@ -212,7 +218,5 @@ void NLPacket::writeVerificationHashGivenSecret(const QUuid& connectionSecret) c
     
     auto offset = Packet::totalHeaderSize(isPartOfMessage()) + sizeof(PacketType) + sizeof(PacketVersion)
                 + NUM_BYTES_RFC4122_UUID;
-    QByteArray verificationHash = hashForPacketAndSecret(*this, connectionSecret);
-    
-    memcpy(_packet.get() + offset, verificationHash.data(), verificationHash.size());
+    hashForPacketAndSecret(*this, connectionSecret, _packet.get() + offset);
 }
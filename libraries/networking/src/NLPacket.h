@@ -35,7 +35,7 @@ public:
     // this is used by the Octree classes - must be known at compile time
     static const int MAX_PACKET_HEADER_SIZE =
         sizeof(udt::Packet::SequenceNumberAndBitField) + sizeof(udt::Packet::MessageNumberAndBitField) +
-        sizeof(PacketType) + sizeof(PacketVersion) + NUM_BYTES_RFC4122_UUID + NUM_BYTES_MD5_HASH;
+        sizeof(PacketType) + sizeof(PacketVersion) + NUM_BYTES_RFC4122_UUID + NUM_BYTES_VERIFICATION_HASH;
     
     static std::unique_ptr<NLPacket> create(PacketType type, qint64 size = -1,
                                             bool isReliable = false, bool isPartOfMessage = false);
@@ -58,8 +58,10 @@ public:
     static PacketVersion versionInHeader(const udt::Packet& packet);
     
     static QUuid sourceIDInHeader(const udt::Packet& packet);
-    static QByteArray verificationHashInHeader(const udt::Packet& packet);
-    static QByteArray hashForPacketAndSecret(const udt::Packet& packet, const QUuid& connectionSecret);
+    static const char* verificationHashInHeader(const udt::Packet& packet);
+
+    // writes the NUM_BYTES_VERIFICATION_HASH bytes of the hash to hash, without allocating
+    static void hashForPacketAndSecret(const udt::Packet& packet, const QUuid& connectionSecret, char* hash);
     
     PacketType getType() const { return _type; }
     void setType(PacketType type);
@@ -93,6 +93,9 @@ NodeList::NodeList(char newOwnerType, unsigned short socketListenPort, unsigned
 
     // anytime we get a new node we will want to attempt to punch to it
     connect(this, &LimitedNodeList::nodeAdded, this, &NodeList::startNodeHolePunch);
+
+    // if we drop a node ourselves the domain-server doesn't know we have, so we need its whole list again
+    connect(this, &LimitedNodeList::nodeKilled, this, &NodeList::handleNodeKilled);
     
     // setup our timer to send keepalive pings (it's started and stopped on domain connect/disconnect)
     _keepAlivePingTimer.setInterval(KEEPALIVE_PING_INTERVAL_MS);
@@ -215,6 +218,10 @@ void NodeList::reset() {
 
     _numNoReplyDomainCheckIns = 0;
 
+    _domainListVersion = 0;
+    _pendingDomainListVersion = 0;
+    _pendingDomainListNodes.clear();
+
     // refresh the owner UUID to the NULL UUID
     setSessionUUID(QUuid());
 
@@ -319,6 +326,11 @@ void NodeList::sendDomainServerCheckIn() {
         packetStream << _ownerType << _publicSockAddr << _localSockAddr << _nodeTypesOfInterest.toList()
             << DependencyManager::get<AddressManager>()->getPlaceName();
 
+        if (domainPacketType == PacketType::DomainListRequest) {
+            // let the domain-server know which list we have, so it only sends us what has changed since
+            packetStream << _domainListVersion;
+        }
+
         if (!_domainHandler.isConnected()) {
             DataServerAccountInfo& accountInfo = accountManager->getAccountInfo();
             packetStream << accountInfo.getUsername();
@@ -541,10 +553,42 @@ void NodeList::processDomainServerList(QSharedPointer<ReceivedMessage> message)
     quint8 thisNodeCanRez;
     packetStream >> thisNodeCanRez;
     setThisNodeCanRez((bool) thisNodeCanRez);
-    
-    // pull each node in the packet
+
+    quint8 isDelta;
+    quint32 knownListVersion, listVersion, numEntries;
+    packetStream >> isDelta >> knownListVersion >> listVersion >> numEntries;
+
+    if (isDelta && knownListVersion != _domainListVersion) {
+        // this is what changed since a list we no longer have - our next check in will sort that out
+        return;
+    }
+
+    if (isDelta || listVersion != _pendingDomainListVersion) {
+        _pendingDomainListVersion = listVersion;
+        _pendingDomainListNodes.clear();
+    }
+
+    // pull each node in the packet, or the UUID of each node to remove in a delta
+    _isApplyingDomainList = true;
+
     while (packetStream.device()->pos() < message->getSize()) {
-        parseNodeFromPacketStream(packetStream);
+        DomainListEntry_t entryType;
+        packetStream >> entryType;
+
+        if (entryType == DomainListEntry::RemovedNode) {
+            QUuid nodeUUID;
+            packetStream >> nodeUUID;
+            killNodeWithUUID(nodeUUID);
+            _pendingDomainListNodes.insert(nodeUUID);
+        } else {
+            _pendingDomainListNodes.insert(parseNodeFromPacketStream(packetStream));
+        }
+    }
+
+    _isApplyingDomainList = false;
+
+    if ((quint32) _pendingDomainListNodes.size() >= numEntries) {
+        _domainListVersion = listVersion;
     }
 }
 
@@ -560,10 +604,12 @@ void NodeList::processDomainServerRemovedNode(QSharedPointer<ReceivedMessage> me
     // read the UUID from the packet, remove it if it exists
     QUuid nodeUUID = QUuid::fromRfc4122(message->readWithoutCopy(NUM_BYTES_RFC4122_UUID));
     qDebug() << "Received packet from domain-server to remove node with UUID" << uuidStringWithoutCurlyBraces(nodeUUID);
+    _isApplyingDomainList = true;
     killNodeWithUUID(nodeUUID);
+    _isApplyingDomainList = false;
 }
 
-void NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
+QUuid NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
     // setup variables to read into from QDataStream
     qint8 nodeType;
     QUuid nodeUUID, connectionUUID;
@@ -584,6 +630,15 @@ void NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
     SharedNodePointer node = addOrUpdateNode(nodeUUID, nodeType, nodePublicSocket,
                                              nodeLocalSocket, isAllowedEditor, canRez,
                                              connectionUUID);
+
+    return nodeUUID;
+}
+
+void NodeList::handleNodeKilled(SharedNodePointer node) {
+    if (!_isApplyingDomainList) {
+        // we dropped this node without the domain-server telling us to, so it may still list it
+        _domainListVersion = 0;
+    }
 }
 
 void NodeList::sendAssignment(Assignment& assignment) {
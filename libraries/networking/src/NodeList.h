@@ -99,6 +99,8 @@ private slots:
     void pingPunchForDomainServer();
     
     void sendKeepAlivePings();
+
+    void handleNodeKilled(SharedNodePointer node);
 private:
     NodeList() : LimitedNodeList(0, 0) { assert(false); } // Not implemented, needed for DependencyManager templates compile
     NodeList(char ownerType, unsigned short socketListenPort = 0, unsigned short dtlsListenPort = 0);
@@ -112,7 +114,7 @@ private:
 
     void sendDSPathQuery(const QString& newPath);
  
-    void parseNodeFromPacketStream(QDataStream& packetStream);
+    QUuid parseNodeFromPacketStream(QDataStream& packetStream);
 
     void pingPunchForInactiveNode(const SharedNodePointer& node);
 
@@ -123,6 +125,16 @@ private:
     HifiSockAddr _assignmentServerSocket;
     bool _isShuttingDown { false };
     QTimer _keepAlivePingTimer;
+
+    // the version of the domain-server's list of nodes that we have all of, which we send when checking in so that
+    // it only replies with what has changed since - 0 until we have a whole list
+    quint32 _domainListVersion { 0 };
+
+    // a whole list can take several packets, and its version is ours once we have had each node in it
+    quint32 _pendingDomainListVersion { 0 };
+    QSet<QUuid> _pendingDomainListNodes;
+
+    bool _isApplyingDomainList { false };
 };
 
 #endif // hifi_NodeList_h
@@ -12,7 +12,10 @@
 
 #include "PacketReceiver.h"
 
+#include <algorithm>
+
 #include <QMutexLocker>
+#include <QThread>
 
 #include "DependencyManager.h"
 #include "NetworkLogging.h"
@@ -23,9 +26,21 @@ PacketReceiver::PacketReceiver(QObject* parent) : QObject(parent) {
     qRegisterMetaType<QSharedPointer<NLPacket>>();
     qRegisterMetaType<QSharedPointer<NLPacketList>>();
     qRegisterMetaType<QSharedPointer<ReceivedMessage>>();
+
+    for (auto& listener : _listeners) {
+        listener.store(nullptr);
+    }
+    for (auto& hint : _messageSizeHints) {
+        hint.store(nullptr);
+    }
 }
 
 bool PacketReceiver::registerListenerForTypes(PacketTypeList types, QObject* listener, const char* slot) {
+    return registerListenerForTypes(std::move(types), listener, slot, false);
+}
+
+bool PacketReceiver::registerListenerForTypes(PacketTypeList types, QObject* listener, const char* slot,
+                                              bool isDirect) {
     Q_ASSERT_X(!types.empty(), "PacketReceiver::registerListenerForTypes", "No types to register");
     Q_ASSERT_X(listener, "PacketReceiver::registerListenerForTypes", "No object to register");
     Q_ASSERT_X(slot, "PacketReceiver::registerListenerForTypes", "No slot to register");
@@ -54,13 +69,13 @@ bool PacketReceiver::registerListenerForTypes(PacketTypeList types, QObject* lis
     }
     
     // Register non sourced types
-    std::for_each(std::begin(types), middle, [this, &listener, &nonSourcedMethod](PacketType type) {
-        registerVerifiedListener(type, listener, nonSourcedMethod);
+    std::for_each(std::begin(types), middle, [this, &listener, &nonSourcedMethod, isDirect](PacketType type) {
+        registerVerifiedListener(type, listener, nonSourcedMethod, false, isDirect);
     });
     
     // Register sourced types
-    std::for_each(middle, std::end(types), [this, &listener, &sourcedMethod](PacketType type) {
-        registerVerifiedListener(type, listener, sourcedMethod);
+    std::for_each(middle, std::end(types), [this, &listener, &sourcedMethod, isDirect](PacketType type) {
+        registerVerifiedListener(type, listener, sourcedMethod, false, isDirect);
     });
     
     return true;
@@ -70,13 +85,7 @@ void PacketReceiver::registerDirectListener(PacketType type, QObject* listener,
     Q_ASSERT_X(listener, "PacketReceiver::registerDirectListener", "No object to register");
     Q_ASSERT_X(slot, "PacketReceiver::registerDirectListener", "No slot to register");
     
-    bool success = registerListener(type, listener, slot);
-    if (success) {
-        QMutexLocker locker(&_directConnectSetMutex);
-        
-        // if we successfully registered, add this object to the set of objects that are directly connected
-        _directlyConnectedObjects.insert(listener);
-    }
+    registerListener(type, listener, slot, false, true);
 }
 
 void PacketReceiver::registerDirectListenerForTypes(PacketTypeList types,
@@ -84,18 +93,16 @@ void PacketReceiver::registerDirectListenerForTypes(PacketTypeList types,
     Q_ASSERT_X(listener, "PacketReceiver::registerDirectListenerForTypes", "No object to register");
     Q_ASSERT_X(slot, "PacketReceiver::registerDirectListenerForTypes", "No slot to register");
     
-    // just call register listener for types to start
-    bool success = registerListenerForTypes(std::move(types), listener, slot);
-    if (success) {
-        QMutexLocker locker(&_directConnectSetMutex);
-        
-        // if we successfully registered, add this object to the set of objects that are directly connected
-        _directlyConnectedObjects.insert(listener);
-    }
+    registerListenerForTypes(std::move(types), listener, slot, true);
 }
 
 bool PacketReceiver::registerListener(PacketType type, QObject* listener, const char* slot,
                                              bool deliverPending) {
+    return registerListener(type, listener, slot, deliverPending, false);
+}
+
+bool PacketReceiver::registerListener(PacketType type, QObject* listener, const char* slot,
+                                      bool deliverPending, bool isDirect) {
     Q_ASSERT_X(listener, "PacketReceiver::registerListener", "No object to register");
     Q_ASSERT_X(slot, "PacketReceiver::registerListener", "No slot to register");
 
@@ -103,7 +110,7 @@ bool PacketReceiver::registerListener(PacketType type, QObject* listener, const
 
     if (matchingMethod.isValid()) {
         qCDebug(networking) << "Registering a packet listener for packet list type" << type;
-        registerVerifiedListener(type, listener, matchingMethod, deliverPending);
+        registerVerifiedListener(type, listener, matchingMethod, deliverPending, isDirect);
         return true;
     } else {
         qCWarning(networking) << "FAILED to Register a packet listener for packet list type" << type;
@@ -165,39 +172,152 @@ QMetaMethod PacketReceiver::matchingMethodForListener(PacketType type, QObject*
     }
 }
 
-void PacketReceiver::registerVerifiedListener(PacketType type, QObject* object, const QMetaMethod& slot, bool deliverPending) {
+void PacketReceiver::registerVerifiedListener(PacketType type, QObject* object, const QMetaMethod& slot,
+                                              bool deliverPending, bool isDirect) {
     Q_ASSERT_X(object, "PacketReceiver::registerVerifiedListener", "No object to register");
-    QMutexLocker locker(&_packetListenerLock);
 
-    if (_messageListenerMap.contains(type)) {
+    static const QByteArray QSHAREDPOINTER_NODE_NORMALIZED = QMetaObject::normalizedType("QSharedPointer<Node>");
+    static const QByteArray SHARED_NODE_NORMALIZED = QMetaObject::normalizedType("SharedNodePointer");
+
+    // work out which arguments the slot takes now, so that delivering a message is only the call itself
+    ListenerFunction function;
+    bool takesNode = true;
+
+    if (slot.parameterTypes().contains(SHARED_NODE_NORMALIZED)) {
+        function = [slot](QObject* object, const QSharedPointer<ReceivedMessage>& message,
+                          const SharedNodePointer& node) {
+            slot.invoke(object, Qt::DirectConnection,
+                        Q_ARG(QSharedPointer<ReceivedMessage>, message), Q_ARG(SharedNodePointer, node));
+        };
+    } else if (slot.parameterTypes().contains(QSHAREDPOINTER_NODE_NORMALIZED)) {
+        function = [slot](QObject* object, const QSharedPointer<ReceivedMessage>& message,
+                          const SharedNodePointer& node) {
+            slot.invoke(object, Qt::DirectConnection,
+                        Q_ARG(QSharedPointer<ReceivedMessage>, message), Q_ARG(QSharedPointer<Node>, node));
+        };
+    } else {
+        takesNode = false;
+        function = [slot](QObject* object, const QSharedPointer<ReceivedMessage>& message,
+                          const SharedNodePointer& node) {
+            slot.invoke(object, Qt::DirectConnection, Q_ARG(QSharedPointer<ReceivedMessage>, message));
+        };
+    }
+
+    registerListenerFunction(type, object, std::move(function), slot.methodSignature(),
+                             takesNode, deliverPending, isDirect);
+}
+
+bool PacketReceiver::registerListenerFunction(PacketType type, QObject* object, ListenerFunction function,
+                                              QByteArray name, bool takesNode, bool deliverPending, bool isDirect) {
+    Q_ASSERT_X(object, "PacketReceiver::registerListenerFunction", "No object to register");
+    Q_ASSERT_X(function, "PacketReceiver::registerListenerFunction", "No function to register");
+
+    std::unique_ptr<Listener> listener { new Listener };
+    listener->object = object;
+    listener->function = function;
+    listener->name = name;
+    listener->takesNode = takesNode;
+    listener->deliverPending = deliverPending;
+    listener->isDirect = isDirect;
+
+    if (!isDirect) {
+        // messages received on another thread than the object's are queued to it through the relay
+        listener->relay.reset(new PacketListenerRelay);
+        connect(listener->relay.get(), &PacketListenerRelay::messageReceived, object,
+                [object, function](QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
+            function(object, message, node);
+        }, Qt::QueuedConnection);
+    }
+
+    QMutexLocker locker(&_listenerRegistrationLock);
+
+    Listener* previous = listenerForType(type);
+    if (previous && previous->function) {
         qCWarning(networking) << "Registering a packet listener for packet type" << type
             << "that will remove a previously registered listener";
     }
-    
+
     // add the mapping
-    _messageListenerMap[type] = { QPointer<QObject>(object), slot, deliverPending };
+    _listeners[(uint8_t) type].store(listener.get());
+    _allListeners.push_back(std::move(listener));
+
+    if (previous) {
+        retireListener(previous);
+    }
+
+    return true;
 }
 
 void PacketReceiver::unregisterListener(QObject* listener) {
     Q_ASSERT_X(listener, "PacketReceiver::unregisterListener", "No listener to unregister");
-    
+
+    std::vector<Listener*> removedListeners;
+
     {
-        QMutexLocker packetListenerLocker(&_packetListenerLock);
-        
-        // clear any registrations for this listener in _messageListenerMap
-        auto it = _messageListenerMap.begin();
-        
-        while (it != _messageListenerMap.end()) {
-            if (it.value().object == listener) {
-                it = _messageListenerMap.erase(it);
-            } else {
-                ++it;
+        QMutexLocker locker(&_listenerRegistrationLock);
+
+        // clear any registrations for this listener from the dispatch table
+        for (auto& entry : _listeners) {
+            Listener* registered = entry.load();
+            if (registered && registered->object == listener) {
+                entry.store(nullptr);
+                removedListeners.push_back(registered);
             }
         }
+
+        for (auto removed : removedListeners) {
+            retireListener(removed);
+        }
     }
-    
-    QMutexLocker directConnectSetLocker(&_directConnectSetMutex);
-    _directlyConnectedObjects.remove(listener);
+
+    // the listener is likely about to be destroyed, so wait for any message still being handed to it
+    // unless that message is being handed to it by this thread - the listener is unregistering from its own call,
+    // and the records are then freed once that dispatch unwinds
+    auto currentThread = QThread::currentThreadId();
+    {
+        // counted before checking, so that a dispatch that finishes after the check knows to wake us
+        QMutexLocker locker(&_listenerDispatchedLock);
+        ++_numWaitingForDispatch;
+        for (auto removed : removedListeners) {
+            while (removed->numDispatching.load() > 0 && removed->dispatchingThread.load() != currentThread) {
+                _listenerDispatched.wait(&_listenerDispatchedLock);
+            }
+        }
+        --_numWaitingForDispatch;
+    }
+
+    freeRetiredListeners();
+}
+
+void PacketReceiver::retireListener(Listener* listener) {
+    auto it = std::find_if(_allListeners.begin(), _allListeners.end(),
+                           [listener](const std::unique_ptr<Listener>& owned) { return owned.get() == listener; });
+
+    if (it != _allListeners.end()) {
+        _retiredListeners.push_back(std::move(*it));
+        _allListeners.erase(it);
+        _hasRetiredListeners = true;
+    }
+}
+
+void PacketReceiver::freeRetiredListeners() {
+    QMutexLocker locker(&_listenerRegistrationLock);
+
+    // every retired listener was out of the table before this lock was taken, so if no message is being
+    // dispatched now, none can still be holding one
+    if (_numDispatching.load() == 0) {
+        _retiredListeners.clear();
+        _hasRetiredListeners = false;
+    }
+}
+
+void PacketReceiver::setMessageSizeHint(PacketType type, MessageSizeHint hint) {
+    QMutexLocker locker(&_listenerRegistrationLock);
+
+    // like listeners, hints are read without a lock and so are kept until the PacketReceiver goes
+    std::unique_ptr<MessageSizeHint> storedHint { new MessageSizeHint(std::move(hint)) };
+    _messageSizeHints[(uint8_t) type].store(storedHint.get());
+    _allMessageSizeHints.push_back(std::move(storedHint));
 }
 
 void PacketReceiver::handleVerifiedPacket(std::unique_ptr<udt::Packet> packet) {
@@ -206,8 +326,6 @@ void PacketReceiver::handleVerifiedPacket(std::unique_ptr<udt::Packet> packet) {
         return;
     }
     
-    auto nodeList = DependencyManager::get<LimitedNodeList>();
-    
     // setup an NLPacket from the packet we were passed
     auto nlPacket = NLPacket::fromBase(std::move(packet));
     auto receivedMessage = QSharedPointer<ReceivedMessage>::create(*nlPacket);
@@ -232,6 +350,12 @@ void PacketReceiver::handleVerifiedMessagePacket(std::unique_ptr<udt::Packet> pa
         // Create message
         message = QSharedPointer<ReceivedMessage>::create(*nlPacket);
         if (!message->isComplete()) {
+            // size the buffer for the whole message now if we can tell how big it is, before a listener sees it
+            auto sizeHint = _messageSizeHints[(uint8_t) message->getType()].load();
+            if (sizeHint) {
+                message->reserve((*sizeHint)(*message));
+            }
+
             _pendingMessages[key] = message;
         }
         handleVerifiedMessage(message, true);
@@ -257,111 +381,99 @@ void PacketReceiver::handleMessageFailure(HifiSockAddr from, udt::Packet::Messag
 }
 
 void PacketReceiver::handleVerifiedMessage(QSharedPointer<ReceivedMessage> receivedMessage, bool justReceived) {
-    auto nodeList = DependencyManager::get<LimitedNodeList>();
-    
+    // counted before reading the table, so that a listener taken out of it isn't freed under us
+    ++_numDispatching;
+
+    dispatchMessage(receivedMessage, justReceived);
+
+    if (--_numDispatching == 0 && _hasRetiredListeners) {
+        freeRetiredListeners();
+    }
+}
+
+void PacketReceiver::dispatchMessage(const QSharedPointer<ReceivedMessage>& receivedMessage, bool justReceived) {
+    PacketType packetType = receivedMessage->getType();
+    Listener* listener = listenerForType(packetType);
+
+    if (!listener) {
+        QMutexLocker locker(&_listenerRegistrationLock);
+
+        // check again now that nothing can be registering
+        if (!listenerForType(packetType)) {
+            qCWarning(networking) << "No listener found for packet type" << packetType;
+
+            // insert a placeholder listener so we don't print this again
+            std::unique_ptr<Listener> placeholder { new Listener };
+            placeholder->takesNode = false;
+            placeholder->deliverPending = false;
+            placeholder->isDirect = false;
+
+            _listeners[(uint8_t) packetType].store(placeholder.get());
+            _allListeners.push_back(std::move(placeholder));
+        }
+        return;
+    }
+
+    if (!listener->function) {
+        return;
+    }
+
+    if ((listener->deliverPending && !justReceived) || (!listener->deliverPending && !receivedMessage->isComplete())) {
+        return;
+    }
+
+    // mark the listener as in use before checking it is still registered, so that unregistering it waits for us
+    listener->dispatchingThread = QThread::currentThreadId();
+    ++listener->numDispatching;
+
+    if (listenerForType(packetType) == listener) {
+        dispatchToListener(*listener, receivedMessage, packetType);
+    }
+
+    if (--listener->numDispatching == 0 && _numWaitingForDispatch.load() > 0) {
+        QMutexLocker locker(&_listenerDispatchedLock);
+        _listenerDispatched.wakeAll();
+    }
+}
+
+void PacketReceiver::dispatchToListener(Listener& listener, const QSharedPointer<ReceivedMessage>& receivedMessage,
+                                        PacketType packetType) {
+    QObject* object = listener.object.data();
+
+    if (!object) {
+        qCDebug(networking).nospace() << "Listener for packet " << packetType
+            << " has been destroyed. Removing from listener map.";
+
+        QMutexLocker locker(&_listenerRegistrationLock);
+        if (listenerForType(packetType) == &listener) {
+            _listeners[(uint8_t) packetType].store(nullptr);
+            retireListener(&listener);
+        }
+        return;
+    }
+
     SharedNodePointer matchingNode;
-    
+
     if (!receivedMessage->getSourceID().isNull()) {
-        matchingNode = nodeList->nodeWithUUID(receivedMessage->getSourceID());
+        matchingNode = DependencyManager::get<LimitedNodeList>()->nodeWithUUID(receivedMessage->getSourceID());
     }
-    
-    QMutexLocker packetListenerLocker(&_packetListenerLock);
-    
-    bool listenerIsDead = false;
-    
-    auto it = _messageListenerMap.find(receivedMessage->getType());
-            
-    if (it != _messageListenerMap.end() && it->method.isValid()) {
-         
-        auto listener = it.value();
 
-        if ((listener.deliverPending && !justReceived) || (!listener.deliverPending && !receivedMessage->isComplete())) {
+    if (matchingNode) {
+        emit dataReceived(matchingNode->getType(), receivedMessage->getSize());
+        matchingNode->recordBytesReceived(receivedMessage->getSize());
+    } else {
+        emit dataReceived(NodeType::Unassigned, receivedMessage->getSize());
+
+        if (listener.takesNode) {
+            qCDebug(networking).nospace() << "Error delivering packet " << packetType << " to listener "
+                << object << "::" << listener.name << " - no node matches its source";
             return;
         }
-    
-        if (listener.object) {
-            
-            bool success = false;
-
-            Qt::ConnectionType connectionType;
-            // check if this is a directly connected listener
-            {
-                QMutexLocker directConnectLocker(&_directConnectSetMutex);
- 
-                connectionType = _directlyConnectedObjects.contains(listener.object) ? Qt::DirectConnection : Qt::AutoConnection;
-            }
-            
-            PacketType packetType = receivedMessage->getType();
-            
-            if (matchingNode) {
-                emit dataReceived(matchingNode->getType(), receivedMessage->getSize());
-                matchingNode->recordBytesReceived(receivedMessage->getSize());
-
-                QMetaMethod metaMethod = listener.method;
-                
-                static const QByteArray QSHAREDPOINTER_NODE_NORMALIZED = QMetaObject::normalizedType("QSharedPointer<Node>");
-                static const QByteArray SHARED_NODE_NORMALIZED = QMetaObject::normalizedType("SharedNodePointer");
-                
-                // one final check on the QPointer before we go to invoke
-                if (listener.object) {
-                    if (metaMethod.parameterTypes().contains(SHARED_NODE_NORMALIZED)) {
-                        success = metaMethod.invoke(listener.object,
-                                                    connectionType,
-                                                    Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage),
-                                                    Q_ARG(SharedNodePointer, matchingNode));
-                        
-                    } else if (metaMethod.parameterTypes().contains(QSHAREDPOINTER_NODE_NORMALIZED)) {
-                        success = metaMethod.invoke(listener.object,
-                                                    connectionType,
-                                                    Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage),
-                                                    Q_ARG(QSharedPointer<Node>, matchingNode));
-                        
-                    } else {
-                        success = metaMethod.invoke(listener.object,
-                                                    connectionType,
-                                                    Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage));
-                    }
-                } else {
-                    listenerIsDead = true;
-                }
-            } else {
-                // qDebug() << "Got verified unsourced packet list: " << QString(nlPacketList->getMessage());
-                emit dataReceived(NodeType::Unassigned, receivedMessage->getSize());
-                
-                // one final check on the QPointer before we invoke
-                if (listener.object) {
-                    success = listener.method.invoke(listener.object,
-                                                     Q_ARG(QSharedPointer<ReceivedMessage>, receivedMessage));
-                } else {
-                    listenerIsDead = true;
-                }
-                
-            }
-            
-            if (!success) {
-                qCDebug(networking).nospace() << "Error delivering packet " << packetType << " to listener "
-                    << listener.object << "::" << qPrintable(listener.method.methodSignature());
-            }
-            
-        } else {
-            listenerIsDead = true;
-        }
-        
-        if (listenerIsDead) {
-            qCDebug(networking).nospace() << "Listener for packet " << receivedMessage->getType()
-                << " has been destroyed. Removing from listener map.";
-            it = _messageListenerMap.erase(it);
-            
-            // if it exists, remove the listener from _directlyConnectedObjects
-            {
-                QMutexLocker directConnectLocker(&_directConnectSetMutex);
-                _directlyConnectedObjects.remove(listener.object);
-            }
-        }
-    } else if (it == _messageListenerMap.end()) {
-        qCWarning(networking) << "No listener found for packet type" << receivedMessage->getType();
-        
-        // insert a dummy listener so we don't print this again
-        _messageListenerMap.insert(receivedMessage->getType(), { nullptr, QMetaMethod(), false });
+    }
+
+    if (listener.isDirect || object->thread() == QThread::currentThread()) {
+        listener.function(object, receivedMessage, matchingNode);
+    } else {
+        emit listener.relay->messageReceived(receivedMessage, matchingNode);
     }
 }
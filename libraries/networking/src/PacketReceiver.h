@@ -13,18 +13,24 @@
 #ifndef hifi_PacketReceiver_h
 #define hifi_PacketReceiver_h
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
 #include <QtCore/QMap>
 #include <QtCore/QMetaMethod>
 #include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 #include <QtCore/QObject>
 #include <QtCore/QPointer>
 #include <QtCore/QSet>
 
 #include "NLPacket.h"
 #include "NLPacketList.h"
+#include "Node.h"
 #include "ReceivedMessage.h"
 #include "udt/PacketHeaders.h"
 
@@ -40,6 +46,13 @@ namespace std {
     };
 }
 
+// Carries a message across to the thread of a listener that was registered with a function rather than a slot
+class PacketListenerRelay : public QObject {
+    Q_OBJECT
+signals:
+    void messageReceived(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
+};
+
 class PacketReceiver : public QObject {
     Q_OBJECT
 public:
@@ -62,7 +75,25 @@ public:
     // for the message is received.
     bool registerListener(PacketType type, QObject* listener, const char* slot, bool deliverPending = false);
     bool registerListenerForTypes(PacketTypeList types, QObject* listener, const char* slot);
+
+    // Typed versions of registerListener, resolved to a plain call to the method once here rather than looked up
+    // and invoked through Qt for every message. The method is called directly when the listener lives on the thread
+    // that receives packets, and queued to the thread of the listener otherwise.
+    template <typename T>
+    bool registerListener(PacketType type, T* listener,
+                          void (T::*method)(QSharedPointer<ReceivedMessage>, SharedNodePointer),
+                          bool deliverPending = false);
+    template <typename T>
+    bool registerListener(PacketType type, T* listener, void (T::*method)(QSharedPointer<ReceivedMessage>),
+                          bool deliverPending = false);
+
     void unregisterListener(QObject* listener);
+
+    // A function that tells from the first packet of a message that arrives in many packets how big the whole
+    // message will be, or 0 if it can't. The message is then received into one buffer of that size, which a
+    // listener that sets deliverPending can read from as the message arrives.
+    using MessageSizeHint = std::function<qint64(const ReceivedMessage& firstPart)>;
+    void setMessageSizeHint(PacketType type, MessageSizeHint hint);
     
     void handleVerifiedPacket(std::unique_ptr<udt::Packet> packet);
     void handleVerifiedMessagePacket(std::unique_ptr<udt::Packet> message);
@@ -72,34 +103,110 @@ signals:
     void dataReceived(quint8 channelType, int bytes);
     
 private:
+    using ListenerFunction =
+        std::function<void(QObject*, const QSharedPointer<ReceivedMessage>&, const SharedNodePointer&)>;
+
     struct Listener {
         QPointer<QObject> object;
-        QMetaMethod method;
+        ListenerFunction function; // empty for the placeholder that marks a type we have warned has no listener
+        QByteArray name;
+        bool takesNode;
         bool deliverPending;
+        bool isDirect;
+
+        // queues the function to the thread of the object, for a listener that isn't called directly
+        std::unique_ptr<PacketListenerRelay> relay;
+
+        // the messages being delivered to this listener right now, which unregistering waits for
+        std::atomic<int> numDispatching { 0 };
+
+        // the thread delivering them, so that a listener unregistering from its own call doesn't wait on itself
+        // messages are delivered from the one thread that receives them, so there is never more than one
+        std::atomic<Qt::HANDLE> dispatchingThread { nullptr };
     };
 
+    // one slot for each possible PacketType
+    using ListenerTable = std::array<std::atomic<Listener*>, 1 << (8 * sizeof(PacketType))>;
+
     void handleVerifiedMessage(QSharedPointer<ReceivedMessage> message, bool justReceived);
+    void dispatchMessage(const QSharedPointer<ReceivedMessage>& message, bool justReceived);
+    void dispatchToListener(Listener& listener, const QSharedPointer<ReceivedMessage>& message, PacketType type);
 
     // these are brutal hacks for now - ideally GenericThread / ReceivedPacketProcessor
     // should be changed to have a true event loop and be able to handle our QMetaMethod::invoke
     void registerDirectListenerForTypes(PacketTypeList types, QObject* listener, const char* slot);
     void registerDirectListener(PacketType type, QObject* listener, const char* slot);
 
+    bool registerListener(PacketType type, QObject* listener, const char* slot, bool deliverPending, bool isDirect);
+    bool registerListenerForTypes(PacketTypeList types, QObject* listener, const char* slot, bool isDirect);
+
     QMetaMethod matchingMethodForListener(PacketType type, QObject* object, const char* slot) const;
-    void registerVerifiedListener(PacketType type, QObject* listener, const QMetaMethod& slot, bool deliverPending = false);
+    void registerVerifiedListener(PacketType type, QObject* listener, const QMetaMethod& slot,
+                                  bool deliverPending, bool isDirect);
+    bool registerListenerFunction(PacketType type, QObject* listener, ListenerFunction function, QByteArray name,
+                                  bool takesNode, bool deliverPending, bool isDirect);
+
+    Listener* listenerForType(PacketType type) { return _listeners[(uint8_t) type].load(); }
+
+    // moves a listener that is no longer in the table out of _allListeners, to be freed once no message is
+    // being dispatched - must be called with the registration lock held
+    void retireListener(Listener* listener);
+    void freeRetiredListeners();
+
+    // the dispatch table is read without a lock, so a listener taken out of it is only freed once every message
+    // that could have read it from the table has been dispatched
+    QMutex _listenerRegistrationLock;
+    ListenerTable _listeners;
+    std::vector<std::unique_ptr<Listener>> _allListeners;
+    std::vector<std::unique_ptr<Listener>> _retiredListeners;
+    std::atomic<bool> _hasRetiredListeners { false };
+
+    // the messages being dispatched right now, counted before the table is read
+    std::atomic<int> _numDispatching { 0 };
+
+    // woken when a listener's last message is delivered, while anyone is unregistering and waiting for that
+    QMutex _listenerDispatchedLock;
+    QWaitCondition _listenerDispatched;
+    std::atomic<int> _numWaitingForDispatch { 0 };
+
+    std::array<std::atomic<MessageSizeHint*>, 1 << (8 * sizeof(PacketType))> _messageSizeHints;
+    std::vector<std::unique_ptr<MessageSizeHint>> _allMessageSizeHints;
 
-    QMutex _packetListenerLock;
-    QHash<PacketType, Listener> _messageListenerMap;
     int _inPacketCount = 0;
     int _inByteCount = 0;
     bool _shouldDropPackets = false;
-    QMutex _directConnectSetMutex;
-    QSet<QObject*> _directlyConnectedObjects;
 
     std::unordered_map<std::pair<HifiSockAddr, udt::Packet::MessageNumber>, QSharedPointer<ReceivedMessage>> _pendingMessages;
     
     friend class EntityEditPacketSender;
     friend class OctreePacketProcessor;
+    friend class PacketReceiverTests;
 };
 
+template <typename T>
+bool PacketReceiver::registerListener(PacketType type, T* listener,
+                                      void (T::*method)(QSharedPointer<ReceivedMessage>, SharedNodePointer),
+                                      bool deliverPending) {
+    Q_ASSERT_X(!NON_SOURCED_PACKETS.contains(type), "PacketReceiver::registerListener",
+               "A listener for a non-sourced packet type can't take the sending node");
+
+    auto function = [method](QObject* object, const QSharedPointer<ReceivedMessage>& message,
+                             const SharedNodePointer& node) {
+        (static_cast<T*>(object)->*method)(message, node);
+    };
+    return registerListenerFunction(type, listener, function, T::staticMetaObject.className(),
+                                    true, deliverPending, false);
+}
+
+template <typename T>
+bool PacketReceiver::registerListener(PacketType type, T* listener, void (T::*method)(QSharedPointer<ReceivedMessage>),
+                                      bool deliverPending) {
+    auto function = [method](QObject* object, const QSharedPointer<ReceivedMessage>& message,
+                             const SharedNodePointer& node) {
+        (static_cast<T*>(object)->*method)(message);
+    };
+    return registerListenerFunction(type, listener, function, T::staticMetaObject.className(),
+                                    false, deliverPending, false);
+}
+
 #endif // hifi_PacketReceiver_h
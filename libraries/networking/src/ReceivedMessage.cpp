@@ -12,6 +12,8 @@
 
 #include "ReceivedMessage.h"
 
+#include <algorithm>
+
 #include "QSharedPointer"
 
 static int receivedMessageMetaTypeId = qRegisterMetaType<ReceivedMessage*>("ReceivedMessage*");
@@ -22,6 +24,7 @@ static const int HEAD_DATA_SIZE = 512;
 ReceivedMessage::ReceivedMessage(const NLPacketList& packetList)
     : _data(packetList.getMessage()),
       _headData(_data.mid(0, HEAD_DATA_SIZE)),
+      _size(_data.size()),
       _numPackets(packetList.getNumPackets()),
       _sourceID(packetList.getSourceID()),
       _packetType(packetList.getType()),
@@ -34,6 +37,7 @@ ReceivedMessage::ReceivedMessage(const NLPacketList& packetList)
 ReceivedMessage::ReceivedMessage(NLPacket& packet)
     : _data(packet.readAll()),
       _headData(_data.mid(0, HEAD_DATA_SIZE)),
+      _size(_data.size()),
       _numPackets(1),
       _sourceID(packet.getSourceID()),
       _packetType(packet.getType()),
@@ -58,7 +62,16 @@ void ReceivedMessage::appendPacket(NLPacket& packet) {
 
     ++_numPackets;
 
+    qint64 newSize = _size + packet.getPayloadSize();
+    if (newSize > _data.capacity()) {
+        // nothing was reserved, or too little - grow geometrically so that a message of unknown size
+        // is only moved a logarithmic number of times
+        _data.reserve((int) std::max(newSize, (qint64) _data.capacity() * 2));
+    }
+
+    // append in place, and only then count the bytes as received for readers on other threads
     _data.append(packet.getPayload(), packet.getPayloadSize());
+    _size = newSize;
 
     if (_numPackets % EMIT_PROGRESS_EVERY_X_PACKETS == 0) {
         emit progress();
@@ -70,6 +83,12 @@ void ReceivedMessage::appendPacket(NLPacket& packet) {
     }
 }
 
+void ReceivedMessage::reserve(qint64 size) {
+    if (size > _data.capacity()) {
+        _data.reserve((int) size);
+    }
+}
+
 qint64 ReceivedMessage::peek(char* data, qint64 size) {
     memcpy(data, _data.constData() + _position, size);
     return size;
@@ -110,7 +129,9 @@ QByteArray ReceivedMessage::readAll() {
 QString ReceivedMessage::readString() {
     uint32_t size;
     readPrimitive(&size);
-    //Q_ASSERT(size <= _size - _position);
+
+    // the size comes off the wire, so never read past the end of the message
+    size = (uint32_t)std::min<qint64>(size, getBytesLeftToRead());
     auto string = QString::fromUtf8(_data.constData() + _position, size);
     _position += size;
     return string;
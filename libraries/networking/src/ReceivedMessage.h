@@ -35,6 +35,11 @@ public:
 
     void appendPacket(NLPacket& packet);
 
+    // Make room for a message of this many bytes in one buffer, so that its packets are appended without moving it.
+    // This is done on the receiving thread before the message is handed to a listener. While the message fits, a
+    // listener that gets it pending can read the part received so far, up to getSize(), as the rest arrives.
+    void reserve(qint64 size);
+
     bool failed() const { return _failed; }
     bool isComplete() const { return _isComplete; }
 
@@ -46,9 +51,10 @@ public:
     // Get the number of packets that were used to send this message
     qint64 getNumPackets() const { return _numPackets; }
 
-    qint64 getSize() const { return _data.size(); }
+    // Get the number of bytes received so far, which is the whole message once it is complete
+    qint64 getSize() const { return _size; }
 
-    qint64 getBytesLeftToRead() const { return _data.size() -  _position; }
+    qint64 getBytesLeftToRead() const { return _size - _position; }
 
     void seek(qint64 position) { _position = position; }
 
@@ -88,6 +94,7 @@ private:
     QByteArray _data;
     QByteArray _headData;
 
+    std::atomic<qint64> _size { 0 };
     std::atomic<qint64> _position { 0 };
     std::atomic<qint64> _numPackets { 0 };
 
@@ -40,6 +40,11 @@ public:
     };
 
     QByteArray getData() { return _data; }
+
+    /// What has arrived of the resource so far, which is all of it once the request has finished. A partial result
+    /// is not copied, so it is only valid until the request is finished or destroyed, and it is only known to be
+    /// intact once the request finishes successfully.
+    virtual QByteArray getAvailableData() const { return _state == Finished ? _data : QByteArray(); }
     State getState() const { return _state; }
     Result getResult() const { return _result; }
     QUrl getUrl() const { return _url; }
@@ -52,6 +57,10 @@ public slots:
 
 signals:
     void progress(qint64 bytesReceived, qint64 bytesTotal);
+
+    /// More of the resource can be read from getAvailableData(), for requests that can hand it out as it arrives
+    void dataAvailable(qint64 bytesAvailable);
+
     void finished();
 
 protected:
@@ -0,0 +1,92 @@
+//
+//  SipHash.cpp
+//  libraries/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SipHash.h"
+
+static inline uint64_t rotl(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+// the algorithm is defined on little-endian words, whatever the byte order of the machine
+static inline uint64_t readLittleEndian64(const uint8_t* p) {
+    return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24)
+        | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+static inline void writeLittleEndian64(uint64_t x, char* p) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (char)(x >> (8 * i));
+    }
+}
+
+#define SIPROUND                                                    \
+    do {                                                            \
+        v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);   \
+        v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;                      \
+        v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;                      \
+        v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);   \
+    } while (0)
+
+void sipHash128(uint64_t k0, uint64_t k1, const char* data, size_t size, char* hash) {
+    uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ k1 ^ 0xee;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = in + (size - (size % 8));
+
+    for (; in != end; in += 8) {
+        uint64_t m = readLittleEndian64(in);
+        v3 ^= m;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= m;
+    }
+
+    // the last block holds the remaining bytes, and the low byte of the size in its top byte
+    uint64_t b = ((uint64_t)size) << 56;
+    switch (size % 8) {
+        case 7: b |= ((uint64_t)in[6]) << 48;
+            // fall through
+        case 6: b |= ((uint64_t)in[5]) << 40;
+            // fall through
+        case 5: b |= ((uint64_t)in[4]) << 32;
+            // fall through
+        case 4: b |= ((uint64_t)in[3]) << 24;
+            // fall through
+        case 3: b |= ((uint64_t)in[2]) << 16;
+            // fall through
+        case 2: b |= ((uint64_t)in[1]) << 8;
+            // fall through
+        case 1: b |= ((uint64_t)in[0]);
+            // fall through
+        default: break;
+    }
+
+    v3 ^= b;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= b;
+
+    v2 ^= 0xee;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    writeLittleEndian64(v0 ^ v1 ^ v2 ^ v3, hash);
+
+    v1 ^= 0xdd;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    writeLittleEndian64(v0 ^ v1 ^ v2 ^ v3, hash + 8);
+}
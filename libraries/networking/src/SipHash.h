@@ -0,0 +1,24 @@
+//
+//  SipHash.h
+//  libraries/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SipHash_h
+#define hifi_SipHash_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+const int NUM_BYTES_SIPHASH_128 = 16;
+
+/// SipHash-2-4 with its 128-bit output, keyed with the two 64-bit halves of a 128-bit key.
+/// It is a MAC built for short messages, so it is much faster than a general purpose hash over a packet,
+/// and it never allocates - the result is written to the NUM_BYTES_SIPHASH_128 bytes at hash.
+void sipHash128(uint64_t k0, uint64_t k1, const char* data, size_t size, char* hash);
+
+#endif // hifi_SipHash_h
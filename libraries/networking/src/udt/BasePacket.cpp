@@ -11,6 +11,8 @@
 
 #include "BasePacket.h"
 
+#include "PacketBufferPool.h"
+
 using namespace udt;
 
 const qint64 BasePacket::PACKET_WRITE_ERROR = -1;
@@ -75,6 +77,17 @@ BasePacket::BasePacket(std::unique_ptr<char[]> data, qint64 size, const HifiSock
     
 }
 
+BasePacket::~BasePacket() {
+    releaseBuffer();
+}
+
+void BasePacket::releaseBuffer() {
+    if (_isFromBufferPool) {
+        PacketBufferPool::getInstance().release(std::move(_packet));
+        _isFromBufferPool = false;
+    }
+}
+
 BasePacket::BasePacket(const BasePacket& other) :
     QIODevice()
 {
@@ -82,6 +95,9 @@ BasePacket::BasePacket(const BasePacket& other) :
 }
 
 BasePacket& BasePacket::operator=(const BasePacket& other) {
+    // a copy always gets memory of its own
+    releaseBuffer();
+    
     _packetSize = other._packetSize;
     _packet = std::unique_ptr<char[]>(new char[_packetSize]);
     memcpy(_packet.get(), other._packet.get(), _packetSize);
@@ -107,9 +123,14 @@ BasePacket::BasePacket(BasePacket&& other) {
 }
 
 BasePacket& BasePacket::operator=(BasePacket&& other) {
+    releaseBuffer();
+    
     _packetSize = other._packetSize;
     _packet = std::move(other._packet);
     
+    _isFromBufferPool = other._isFromBufferPool;
+    other._isFromBufferPool = false;
+    
     _payloadStart = other._payloadStart;
     _payloadCapacity = other._payloadCapacity;
     
@@ -32,6 +32,8 @@ public:
     static std::unique_ptr<BasePacket> fromReceivedPacket(std::unique_ptr<char[]> data, qint64 size,
                                                           const HifiSockAddr& senderSockAddr);
     
+    virtual ~BasePacket();
+    
     // Current level's header size
     static int localHeaderSize();
     // Cumulated size of all the headers
@@ -65,6 +67,10 @@ public:
     qint64 bytesLeftToRead() const { return _payloadSize - pos(); }
     qint64 bytesAvailableForWrite() const { return _payloadCapacity - pos(); }
     
+    // Marks the packet's memory as a buffer from the PacketBufferPool, which it is given back to when the packet is done with it
+    void setIsFromBufferPool(bool isFromBufferPool) { _isFromBufferPool = isFromBufferPool; }
+    bool isFromBufferPool() const { return _isFromBufferPool; }
+    
     HifiSockAddr& getSenderSockAddr() { return _senderSockAddr; }
     const HifiSockAddr& getSenderSockAddr() const { return _senderSockAddr; }
     
@@ -99,8 +105,11 @@ protected:
     
     void adjustPayloadStartAndCapacity(qint64 headerSize, bool shouldDecreasePayloadSize = false);
     
+    void releaseBuffer();
+    
     qint64 _packetSize = 0;        // Total size of the allocated memory
     std::unique_ptr<char[]> _packet; // Allocated memory
+    bool _isFromBufferPool = false; // _packet is a buffer to give back to the PacketBufferPool
     
     char* _payloadStart = nullptr; // Start of the payload
     qint64 _payloadCapacity = 0;          // Total capacity of the payload
@@ -11,7 +11,6 @@
 
 #include "Connection.h"
 
-#include <QtCore/QThread>
 
 #include <NumericalConstants.h>
 
@@ -57,21 +56,13 @@ Connection::~Connection() {
 }
 
 void Connection::stopSendQueue() {
-    if (auto sendQueue = _sendQueue.release()) {
-        // grab the send queue thread so we can wait on it
-        QThread* sendQueueThread = sendQueue->thread();
-        
-        // tell the send queue to stop and be deleted
-        
-        sendQueue->stop();
-        sendQueue->deleteLater();
+    if (_sendQueue) {
+        // tell the send queue to stop, and delete it - which waits for the scheduler if it is sending right now
+        _sendQueue->stop();
+        _sendQueue.reset();
         
         // since we're stopping the send queue we should consider our handshake ACK not receieved
         _hasReceivedHandshakeACK = false;
-        
-        // wait on the send queue thread so we know the send queue is gone
-        sendQueueThread->quit();
-        sendQueueThread->wait();
     }
 }
 
@@ -931,23 +922,31 @@ void PendingReceivedMessage::enqueuePacket(std::unique_ptr<Packet> packet) {
         _numPackets = packet->getMessagePartNumber() + 1;
     }
 
-    // Insert into the packets list in sorted order. Because we generally expect to receive packets in order, begin
-    // searching from the end of the list.
     auto messagePartNumber = packet->getMessagePartNumber();
-    auto it = std::find_if(_packets.rbegin(), _packets.rend(),
-        [&](const std::unique_ptr<Packet>& value) { return messagePartNumber >= value->getMessagePartNumber(); });
+    if (messagePartNumber < _nextPartNumber) {
+        qCDebug(networking) << "PendingReceivedMessage::enqueuePacket: This is a duplicate packet";
+        return;
+    }
 
-    if (it != _packets.rend() && ((*it)->getMessagePartNumber() == messagePartNumber)) {
+    // put the packet in its place in the window of parts after the next one - a sender never has more than
+    // a flow window of packets in flight, so a part further ahead than that did not come from a well-behaved one
+    size_t index = messagePartNumber - _nextPartNumber;
+    if (index >= (size_t)udt::MAX_PACKETS_IN_FLIGHT) {
+        qCDebug(networking) << "PendingReceivedMessage::enqueuePacket: Dropping part" << messagePartNumber
+            << "which is too far ahead of part" << _nextPartNumber;
+        return;
+    } else if (index >= _packets.size()) {
+        _packets.resize(index + 1);
+    } else if (_packets[index]) {
         qCDebug(networking) << "PendingReceivedMessage::enqueuePacket: This is a duplicate packet";
         return;
     }
-    
-    _packets.insert(it.base(), std::move(packet));
+
+    _packets[index] = std::move(packet);
 }
 
 bool PendingReceivedMessage::hasAvailablePackets() const {
-    return _packets.size() > 0
-        && _nextPartNumber == _packets.front()->getMessagePartNumber();
+    return _packets.size() > 0 && _packets.front();
 }
 
 std::unique_ptr<Packet> PendingReceivedMessage::removeNextPacket() {
@@ -12,6 +12,7 @@
 #ifndef hifi_Connection_h
 #define hifi_Connection_h
 
+#include <deque>
 #include <list>
 #include <memory>
 
@@ -37,13 +38,15 @@ class Socket;
 class PendingReceivedMessage {
 public:
     void enqueuePacket(std::unique_ptr<Packet> packet);
-    bool isComplete() const { return _hasLastPacket && _numPackets == _packets.size(); }
+    bool isComplete() const { return _hasLastPacket && _nextPartNumber == _numPackets; }
     bool hasAvailablePackets() const;
     std::unique_ptr<Packet> removeNextPacket();
-    
-    std::list<std::unique_ptr<Packet>> _packets;
 
 private:
+    // the packets from the next part on, at their part number less _nextPartNumber - with a gap for each
+    // part that hasn't arrived yet, which is usually none since packets generally arrive in order
+    std::deque<std::unique_ptr<Packet>> _packets;
+
     bool _hasLastPacket { false };
     Packet::MessagePartNumber _nextPartNumber = 0;
     unsigned int _numPackets { 0 };
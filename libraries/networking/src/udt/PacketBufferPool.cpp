@@ -0,0 +1,66 @@
+//
+//  PacketBufferPool.cpp
+//  libraries/networking/src/udt
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketBufferPool.h"
+
+using namespace udt;
+
+PacketBufferPool& PacketBufferPool::getInstance() {
+    // never destroyed, since packets can still be giving buffers back while static objects are torn down at exit
+    static PacketBufferPool* instance = new PacketBufferPool();
+    return *instance;
+}
+
+PacketBufferPool::Buffer PacketBufferPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_freeBuffers.empty()) {
+            Buffer buffer = std::move(_freeBuffers.back());
+            _freeBuffers.pop_back();
+            return buffer;
+        }
+    }
+
+    return Buffer(new char[BUFFER_SIZE]);
+}
+
+void PacketBufferPool::acquire(std::vector<Buffer>& buffers, size_t numBuffers) {
+    if (buffers.size() >= numBuffers) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (buffers.size() < numBuffers && !_freeBuffers.empty()) {
+            buffers.push_back(std::move(_freeBuffers.back()));
+            _freeBuffers.pop_back();
+        }
+    }
+
+    while (buffers.size() < numBuffers) {
+        buffers.emplace_back(new char[BUFFER_SIZE]);
+    }
+}
+
+void PacketBufferPool::release(Buffer buffer) {
+    if (!buffer) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_freeBuffers.size() < MAX_FREE_BUFFERS) {
+        _freeBuffers.push_back(std::move(buffer));
+    }
+}
+
+size_t PacketBufferPool::getNumFreeBuffers() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _freeBuffers.size();
+}
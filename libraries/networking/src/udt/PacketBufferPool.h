@@ -0,0 +1,55 @@
+//
+//  PacketBufferPool.h
+//  libraries/networking/src/udt
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_PacketBufferPool_h
+#define hifi_PacketBufferPool_h
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Constants.h"
+
+namespace udt {
+
+/// Recycles the MAX_PACKET_SIZE buffers that datagrams are received into, so that the Socket does not allocate
+/// for every datagram. A BasePacket that adopts one of these buffers gives it back here when it is destroyed.
+class PacketBufferPool {
+public:
+    using Buffer = std::unique_ptr<char[]>;
+
+    static const int BUFFER_SIZE = MAX_PACKET_SIZE;
+
+    static PacketBufferPool& getInstance();
+
+    Buffer acquire();
+
+    // tops buffers up to numBuffers, leaving any buffers already in it alone
+    void acquire(std::vector<Buffer>& buffers, size_t numBuffers);
+
+    void release(Buffer buffer);
+
+    size_t getNumFreeBuffers() const;
+
+private:
+    PacketBufferPool() {}
+
+    // buffers beyond this are freed rather than kept, so a burst of traffic doesn't hold on to its memory forever
+    static const size_t MAX_FREE_BUFFERS = 4096;
+
+    mutable std::mutex _mutex;
+    std::vector<Buffer> _freeBuffers;
+};
+
+} // namespace udt
+
+#endif // hifi_PacketBufferPool_h
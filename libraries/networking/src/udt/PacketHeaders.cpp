@@ -43,6 +43,10 @@ const QSet<PacketType> RELIABLE_PACKETS = QSet<PacketType>();
 PacketVersion versionForPacketType(PacketType packetType) {
     switch (packetType) {
         case PacketType::DomainList:
+            // only what changed since the list the node has
+            return 20;
+        case PacketType::DomainListRequest:
+            // with the version of the list the node has
             return 18;
         case PacketType::EntityAdd:
         case PacketType::EntityEdit:
@@ -53,14 +57,19 @@ PacketVersion versionForPacketType(PacketType packetType) {
             return static_cast<PacketVersion>(AvatarMixerPacketVersion::AvatarEntities);
         case PacketType::ICEServerHeartbeat:
             return 18; // ICE Server Heartbeat signing
+        case PacketType::MicrophoneAudioNoEcho:
+        case PacketType::MicrophoneAudioWithEcho:
+        case PacketType::SilentAudioFrame:
+        case PacketType::MixedAudio:
+            return static_cast<PacketVersion>(AudioVersion::CodecNameInAudioPackets);
         case PacketType::AssetGetInfo:
         case PacketType::AssetGet:
         case PacketType::AssetUpload:
             // Removal of extension from Asset requests
             return 18;
         case PacketType::DomainConnectRequest:
-            // addition of referring hostname information
-            return 18;
+            // only what changed since the list the node has
+            return 20;
         default:
             return 17;
     }
@@ -94,13 +94,17 @@ public:
         ICEServerHeartbeatDenied,
         AssetMappingOperation,
         AssetMappingOperationReply,
-        ICEServerHeartbeatACK
+        ICEServerHeartbeatACK,
+        NegotiateAudioFormat,
+        SelectedAudioFormat,
+        ViewFrustum
     };
 };
 
 using PacketType = PacketTypeEnum::Value;
 
-const int NUM_BYTES_MD5_HASH = 16;
+// the verification hash is a 128-bit SipHash-2-4 of the payload, keyed with the connection secret
+const int NUM_BYTES_VERIFICATION_HASH = 16;
 
 typedef char PacketVersion;
 
@@ -173,6 +177,10 @@ const PacketVersion VERSION_ATMOSPHERE_REMOVED = 56;
 const PacketVersion VERSION_LIGHT_HAS_FALLOFF_RADIUS = 57;
 const PacketVersion VERSION_ENTITIES_NO_FLY_ZONES = 58;
 
+enum class AudioVersion : PacketVersion {
+    CodecNameInAudioPackets = 18
+};
+
 enum class AvatarMixerPacketVersion : PacketVersion {
     TranslationSupport = 17,
     SoftAttachmentSupport,
@@ -15,10 +15,7 @@
 #include <random>
 #include <thread>
 
-#include <QtCore/QCoreApplication>
 #include <QtCore/QDateTime>
-#include <QtCore/QJsonObject>
-#include <QtCore/QThread>
 
 #include <LogHandler.h>
 #include <NumericalConstants.h>
@@ -28,54 +25,34 @@
 #include "ControlPacket.h"
 #include "Packet.h"
 #include "PacketList.h"
-#include "../UserActivityLogger.h"
 #include "Socket.h"
 
 using namespace udt;
 using namespace std::chrono;
 
-template <typename Mutex1, typename Mutex2>
-class DoubleLock {
-public:
-    using Lock = std::unique_lock<DoubleLock<Mutex1, Mutex2>>;
-    
-    DoubleLock(Mutex1& mutex1, Mutex2& mutex2) : _mutex1(mutex1), _mutex2(mutex2) { }
-    
-    DoubleLock(const DoubleLock&) = delete;
-    DoubleLock& operator=(const DoubleLock&) = delete;
-    
-    // Either locks all the mutexes or none of them
-    bool try_lock() { return (std::try_lock(_mutex1, _mutex2) == -1); }
-    
-    // Locks all the mutexes
-    void lock() { std::lock(_mutex1, _mutex2); }
-    
-     // Undefined behavior if not locked
-    void unlock() { _mutex1.unlock(); _mutex2.unlock(); }
-    
-private:
-    Mutex1& _mutex1;
-    Mutex2& _mutex2;
-};
+// sending is mostly waiting on deadlines, so a few threads keep up with hundreds of connections
+static const int MIN_SEND_THREADS = 2;
+static const int MAX_SEND_THREADS = 4;
+
+DeadlineScheduler& SendQueue::getScheduler() {
+    // never destroyed, since queues can outlive any point at which it could be
+    static DeadlineScheduler* scheduler = [] {
+        int numThreads = std::min(std::max(MIN_SEND_THREADS, (int) std::thread::hardware_concurrency() / 2),
+                                  MAX_SEND_THREADS);
+        qCDebug(networking) << "SendQueues are sending with" << numThreads << "threads";
+        return new DeadlineScheduler(numThreads);
+    }();
+    return *scheduler;
+}
 
 std::unique_ptr<SendQueue> SendQueue::create(Socket* socket, HifiSockAddr destination) {
     Q_ASSERT_X(socket, "SendQueue::create", "Must be called with a valid Socket*");
     
     auto queue = std::unique_ptr<SendQueue>(new SendQueue(socket, destination));
 
-    // Setup queue private thread
-    QThread* thread = new QThread;
-    thread->setObjectName("Networking: SendQueue " + destination.objectName()); // Name thread for easier debug
-    
-    connect(thread, &QThread::started, queue.get(), &SendQueue::run);
-    
-    connect(queue.get(), &QObject::destroyed, thread, &QThread::quit); // Thread auto cleanup
-    connect(thread, &QThread::finished, thread, &QThread::deleteLater); // Thread auto cleanup
-    
-    // Move queue to private thread and start it
-    queue->moveToThread(thread);
-    
-    thread->start();
+    // hand the queue to the scheduler, and have it start on the handshake
+    getScheduler().add(queue.get());
+    queue->wake();
     
     return queue;
 }
@@ -99,35 +76,27 @@ SendQueue::SendQueue(Socket* socket, HifiSockAddr dest) :
     _lastACKSequenceNumber = uint32_t(_currentSequenceNumber) - 1;
 }
 
+SendQueue::~SendQueue() {
+    // waits for the scheduler to be done with us if it is running us right now
+    getScheduler().remove(this);
+}
+
 void SendQueue::queuePacket(std::unique_ptr<Packet> packet) {
     _packets.queuePacket(std::move(packet));
     
-    // call notify_one on the condition_variable_any in case the send thread is sleeping waiting for packets
-    _emptyCondition.notify_one();
-    
-    if (!this->thread()->isRunning() && _state == State::NotStarted) {
-        this->thread()->start();
-    }
+    // wake up in case we're waiting for packets
+    wake();
 }
 
 void SendQueue::queuePacketList(std::unique_ptr<PacketList> packetList) {
     _packets.queuePacketList(std::move(packetList));
     
-    // call notify_one on the condition_variable_any in case the send thread is sleeping waiting for packets
-    _emptyCondition.notify_one();
-    
-    if (!this->thread()->isRunning() && _state == State::NotStarted) {
-        this->thread()->start();
-    }
+    // wake up in case we're waiting for packets
+    wake();
 }
 
 void SendQueue::stop() {
-    
     _state = State::Stopped;
-    
-    // Notify all conditions in case we're waiting somewhere
-    _handshakeACKCondition.notify_one();
-    _emptyCondition.notify_one();
 }
     
 int SendQueue::sendPacket(const Packet& packet) {
@@ -160,8 +129,8 @@ void SendQueue::ack(SequenceNumber ack) {
     
     _lastACKSequenceNumber = (uint32_t) ack;
 
-    // call notify_one on the condition_variable_any in case the send thread is sleeping with a full congestion window
-    _emptyCondition.notify_one();
+    // wake up in case we're waiting with a full congestion window
+    wake();
 }
 
 void SendQueue::nak(SequenceNumber start, SequenceNumber end) {
@@ -173,8 +142,8 @@ void SendQueue::nak(SequenceNumber start, SequenceNumber end) {
         _naks.insert(start, end);
     }
     
-    // call notify_one on the condition_variable_any in case the send thread is sleeping waiting for losses to re-send
-    _emptyCondition.notify_one();
+    // wake up in case we're waiting for losses to re-send
+    wake();
 }
 
 void SendQueue::overrideNAKListFromPacket(ControlPacket& packet) {
@@ -198,34 +167,24 @@ void SendQueue::overrideNAKListFromPacket(ControlPacket& packet) {
         }
     }
     
-    // call notify_one on the condition_variable_any in case the send thread is sleeping waiting for losses to re-send
-    _emptyCondition.notify_one();
+    // wake up in case we're waiting for losses to re-send
+    wake();
 }
 
 void SendQueue::sendHandshake() {
-    std::unique_lock<std::mutex> handshakeLock { _handshakeMutex };
-    if (!_hasReceivedHandshakeACK) {
-        // we haven't received a handshake ACK from the client, send another now
-        auto handshakePacket = ControlPacket::create(ControlPacket::Handshake, sizeof(SequenceNumber));
+    // we haven't received a handshake ACK from the client, send another now
+    auto handshakePacket = ControlPacket::create(ControlPacket::Handshake, sizeof(SequenceNumber));
 
-        handshakePacket->writePrimitive(_initialSequenceNumber);
-        _socket->writeBasePacket(*handshakePacket, _destination);
-        
-        // we wait for the ACK or the re-send interval to expire
-        static const auto HANDSHAKE_RESEND_INTERVAL = std::chrono::milliseconds(100);
-        _handshakeACKCondition.wait_for(handshakeLock, HANDSHAKE_RESEND_INTERVAL);
-    }
+    handshakePacket->writePrimitive(_initialSequenceNumber);
+    _socket->writeBasePacket(*handshakePacket, _destination);
 }
 
 void SendQueue::handshakeACK(SequenceNumber initialSequenceNumber) {
     if (initialSequenceNumber == _initialSequenceNumber) {
-        {
-            std::lock_guard<std::mutex> locker { _handshakeMutex };
-            _hasReceivedHandshakeACK = true;
-        }
+        _hasReceivedHandshakeACK = true;
 
-        // Notify on the handshake ACK condition
-        _handshakeACKCondition.notify_one();
+        // wake up to start sending
+        wake();
     }
 }
 
@@ -272,111 +231,137 @@ bool SendQueue::sendNewPacketAndAddToSentList(std::unique_ptr<Packet> newPacket,
     }
 }
 
-void SendQueue::run() {
+SendQueue::TimePoint SendQueue::processSends(TimePoint now) {
     if (_state == State::Stopped) {
-        // we've already been asked to stop before we even got a chance to start
-        // don't start now
-#ifdef UDT_CONNECTION_DEBUG
-        qDebug() << "SendQueue asked to run after being told to stop. Will not run.";
-#endif
-        return;
-    } else if (_state == State::Running) {
-#ifdef UDT_CONNECTION_DEBUG
-        qDebug() << "SendQueue asked to run but is already running (according to state). Will not re-run.";
-#endif
-        return;
+        return DeadlineScheduler::NEVER;
     }
     
-    _state = State::Running;
+    if (_state == State::NotStarted) {
+        _state = State::Running;
+        _nextHandshakeTimestamp = now;
+    }
     
-    // Wait for handshake to be complete
-    while (_state == State::Running && !_hasReceivedHandshakeACK) {
-        sendHandshake();
-
-        // Keep processing events
-        QCoreApplication::sendPostedEvents(this);
-        
-        // Once we're here we've either received the handshake ACK or it's going to be time to re-send a handshake.
-        // Either way let's continue processing - no packets will be sent if no handshake ACK has been received.
+    if (!_hasReceivedHandshakeACK) {
+        // no packets will be sent until we have received the handshake ACK
+        return processHandshake(now);
+    }
+    
+    bool attemptedToSendPacket = maybeResendPacket();
+    
+    // if we didn't find a packet to re-send AND we think we can fit a new packet on the wire
+    // (this is according to the current flow window size) then we send out a new packet
+    auto newPacketCount = 0;
+    if (!attemptedToSendPacket) {
+        newPacketCount = maybeSendNewPacket();
+        attemptedToSendPacket = (newPacketCount > 0);
     }
+    
+    if (_state != State::Running || hasTimedOut()) {
+        return DeadlineScheduler::NEVER;
+    }
+    
+    if (attemptedToSendPacket) {
+        _idleTimeout = TimePoint();
+    } else {
+        bool shouldSendNow = false;
+        auto wakeTime = processIdle(now, shouldSendNow);
+        if (!shouldSendNow) {
+            return wakeTime;
+        }
+    }
+    
+    if (_nextPacketTimestamp == TimePoint()) {
+        // we're just starting to send, or starting again after waiting with nothing to send
+        _nextPacketTimestamp = now;
+    }
+    
+    // push the next packet timestamp forwards by the current packet send period
+    auto nextPacketDelta = std::chrono::microseconds((newPacketCount == 2 ? 2 : 1) * _packetSendPeriod);
+    _nextPacketTimestamp += nextPacketDelta;
+    
+    // we use _nextPacketTimestamp so that we don't fall behind, not to force long waits
+    // we'll never allow _nextPacketTimestamp to make us wait for more than nextPacketDelta
+    if (_nextPacketTimestamp > now + nextPacketDelta) {
+        _nextPacketTimestamp = now + nextPacketDelta;
+    }
+    
+    return _nextPacketTimestamp;
+}
 
-    // Keep an HRC to know when the next packet should have been
-    auto nextPacketTimestamp = p_high_resolution_clock::now();
+SendQueue::TimePoint SendQueue::processHandshake(TimePoint now) {
+    static const auto HANDSHAKE_RESEND_INTERVAL = std::chrono::milliseconds(100);
+    
+    if (now >= _nextHandshakeTimestamp) {
+        sendHandshake();
+        _nextHandshakeTimestamp = now + HANDSHAKE_RESEND_INTERVAL;
+    }
+    
+    // the handshake ACK wakes us up before this if it comes in
+    return _nextHandshakeTimestamp;
+}
 
-    while (_state == State::Running) {
-        bool attemptedToSendPacket = maybeResendPacket();
+SendQueue::TimePoint SendQueue::processIdle(TimePoint now, bool& shouldSendNow) {
+    bool hasNothingToSend;
+    {
+        std::lock(_packets.getLock(), _naksLock);
+        std::lock_guard<std::recursive_mutex> packetsLocker(_packets.getLock(), std::adopt_lock);
+        std::lock_guard<std::mutex> naksLocker(_naksLock, std::adopt_lock);
+        hasNothingToSend = (_packets.isEmpty() || isFlowWindowFull()) && _naks.isEmpty();
+    }
+    
+    if (!hasNothingToSend) {
+        // something came in since we looked, keep the packets paced
+        _idleTimeout = TimePoint();
+        shouldSendNow = true;
+        return now;
+    }
+    
+    // pacing starts over once we have something to send again
+    _nextPacketTimestamp = TimePoint();
+    
+    // we are woken up before the timeout by new packets, ACKs and NAKs - each wake starts the wait over
+    bool isWaitOver = _idleTimeout != TimePoint() && now >= _idleTimeout;
+    
+    if (uint32_t(_lastACKSequenceNumber) == uint32_t(_currentSequenceNumber)) {
+        // we've sent the client as much data as we have (and they've ACKed it)
+        // either wait for new data to send or 5 seconds before cleaning up the queue
+        static const auto EMPTY_QUEUES_INACTIVE_TIMEOUT = std::chrono::seconds(5);
         
-        // if we didn't find a packet to re-send AND we think we can fit a new packet on the wire
-        // (this is according to the current flow window size) then we send out a new packet
-        auto newPacketCount = 0;
-        if (!attemptedToSendPacket) {
-            newPacketCount = maybeSendNewPacket();
-            attemptedToSendPacket = (newPacketCount > 0);
+        if (isWaitOver) {
+#ifdef UDT_CONNECTION_DEBUG
+            qCDebug(networking) << "SendQueue to" << _destination << "has been empty for"
+                << EMPTY_QUEUES_INACTIVE_TIMEOUT.count()
+                << "seconds and receiver has ACKed all packets."
+                << "The queue is now inactive and will be stopped.";
+#endif
+            
+            deactivate();
+            return DeadlineScheduler::NEVER;
         }
         
-        // since we're a while loop, give the thread a chance to process events
-        QCoreApplication::sendPostedEvents(this);
-        
-        // we just processed events so check now if we were just told to stop
-        // If the send queue has been innactive, skip the sleep for
-        // Either _isRunning will have been set to false and we'll break
-        // Or something happened and we'll keep going
-        if (_state != State::Running || isInactive(attemptedToSendPacket)) {
-            return;
-        }
-
-        // push the next packet timestamp forwards by the current packet send period
-        auto nextPacketDelta = (newPacketCount == 2 ? 2 : 1) * _packetSendPeriod;
-        nextPacketTimestamp += std::chrono::microseconds(nextPacketDelta);
-
-        // sleep as long as we need for next packet send, if we can
-        auto now = p_high_resolution_clock::now();
-
-        auto timeToSleep = duration_cast<microseconds>(nextPacketTimestamp - now);
-
-        // we use nextPacketTimestamp so that we don't fall behind, not to force long sleeps
-        // we'll never allow nextPacketTimestamp to force us to sleep for more than nextPacketDelta
-        // so cap it to that value
-        if (timeToSleep > std::chrono::microseconds(nextPacketDelta)) {
-            // reset the nextPacketTimestamp so that it is correct next time we come around
-            nextPacketTimestamp = now + std::chrono::microseconds(nextPacketDelta);
-
-            timeToSleep = std::chrono::microseconds(nextPacketDelta);
-        }
-
-        // we're seeing SendQueues sleep for a long period of time here,
-        // which can lock the NodeList if it's attempting to clear connections
-        // for now we guard this by capping the time this thread and sleep for
-
-        const microseconds MAX_SEND_QUEUE_SLEEP_USECS { 2000000 };
-        if (timeToSleep > MAX_SEND_QUEUE_SLEEP_USECS) {
-            qWarning() << "udt::SendQueue wanted to sleep for" << timeToSleep.count() << "microseconds";
-            qWarning() << "Capping sleep to" << MAX_SEND_QUEUE_SLEEP_USECS.count();
-            qWarning() << "PSP:" << _packetSendPeriod << "NPD:" << nextPacketDelta
-                << "NPT:" << nextPacketTimestamp.time_since_epoch().count()
-                << "NOW:" << now.time_since_epoch().count();
-
-            // alright, we're in a weird state
-            // we want to know why this is happening so we can implement a better fix than this guard
-            // send some details up to the API (if the user allows us) that indicate how we could such a large timeToSleep
-            static const QString SEND_QUEUE_LONG_SLEEP_ACTION = "sendqueue-sleep";
-
-            // setup a json object with the details we want
-            QJsonObject longSleepObject;
-            longSleepObject["timeToSleep"] = qint64(timeToSleep.count());
-            longSleepObject["packetSendPeriod"] = _packetSendPeriod.load();
-            longSleepObject["nextPacketDelta"] = nextPacketDelta;
-            longSleepObject["nextPacketTimestamp"] = qint64(nextPacketTimestamp.time_since_epoch().count());
-            longSleepObject["then"] = qint64(now.time_since_epoch().count());
-
-            // hopefully send this event using the user activity logger
-            UserActivityLogger::getInstance().logAction(SEND_QUEUE_LONG_SLEEP_ACTION, longSleepObject);
-
-            timeToSleep = MAX_SEND_QUEUE_SLEEP_USECS;
+        _idleTimeout = now + EMPTY_QUEUES_INACTIVE_TIMEOUT;
+    } else {
+        // We think the client is still waiting for data (based on the sequence number gap)
+        // Let's wait either for a response from the client or until the estimated timeout
+        // (plus the sync interval to allow the client to respond) has elapsed
+        if (isWaitOver && SequenceNumber(_lastACKSequenceNumber) < _currentSequenceNumber) {
+            // after a timeout if we still have sent packets that the client hasn't ACKed we
+            // add them to the loss list, and go re-send them
+            {
+                std::lock_guard<std::mutex> nakLocker(_naksLock);
+                _naks.append(SequenceNumber(_lastACKSequenceNumber) + 1, _currentSequenceNumber);
+            }
+            
+            emit timeout();
+            
+            _idleTimeout = TimePoint();
+            return now;
         }
-
-        std::this_thread::sleep_for(timeToSleep);
+        
+        _idleTimeout = now + std::chrono::microseconds(_estimatedTimeout + _syncInterval);
     }
+    
+    return _idleTimeout;
 }
 
 int SendQueue::maybeSendNewPacket() {
@@ -508,9 +493,7 @@ bool SendQueue::maybeResendPacket() {
     return false;
 }
 
-bool SendQueue::isInactive(bool attemptedToSendPacket) {
-    // check for connection timeout first
-
+bool SendQueue::hasTimedOut() {
     // that will be the case if we have had 16 timeouts since hearing back from the client, and it has been
     // at least 5 seconds
     static const int NUM_TIMEOUTS_BEFORE_INACTIVE = 16;
@@ -533,74 +516,12 @@ bool SendQueue::isInactive(bool attemptedToSendPacket) {
         deactivate();
         return true;
     }
-
-    if (!attemptedToSendPacket) {
-        // During our processing above we didn't send any packets
-        
-        // If that is still the case we should use a condition_variable_any to sleep until we have data to handle.
-        // To confirm that the queue of packets and the NAKs list are still both empty we'll need to use the DoubleLock
-        using DoubleLock = DoubleLock<std::recursive_mutex, std::mutex>;
-        DoubleLock doubleLock(_packets.getLock(), _naksLock);
-        DoubleLock::Lock locker(doubleLock, std::try_to_lock);
-        
-        if (locker.owns_lock() && (_packets.isEmpty() || isFlowWindowFull()) && _naks.isEmpty()) {
-            // The packets queue and loss list mutexes are now both locked and they're both empty
-            
-            if (uint32_t(_lastACKSequenceNumber) == uint32_t(_currentSequenceNumber)) {
-                // we've sent the client as much data as we have (and they've ACKed it)
-                // either wait for new data to send or 5 seconds before cleaning up the queue
-                static const auto EMPTY_QUEUES_INACTIVE_TIMEOUT = std::chrono::seconds(5);
-                
-                // use our condition_variable_any to wait
-                auto cvStatus = _emptyCondition.wait_for(locker, EMPTY_QUEUES_INACTIVE_TIMEOUT);
-                
-                if (cvStatus == std::cv_status::timeout && (_packets.isEmpty() || isFlowWindowFull()) && _naks.isEmpty()) {
-#ifdef UDT_CONNECTION_DEBUG
-                    qCDebug(networking) << "SendQueue to" << _destination << "has been empty for"
-                        << EMPTY_QUEUES_INACTIVE_TIMEOUT.count()
-                        << "seconds and receiver has ACKed all packets."
-                        << "The queue is now inactive and will be stopped.";
-#endif
-
-                    // we have the lock again - Make sure to unlock it
-                    locker.unlock();
-                    
-                    // Deactivate queue
-                    deactivate();
-                    return true;
-                }
-
-            } else {
-                // We think the client is still waiting for data (based on the sequence number gap)
-                // Let's wait either for a response from the client or until the estimated timeout
-                // (plus the sync interval to allow the client to respond) has elapsed
-                auto waitDuration = std::chrono::microseconds(_estimatedTimeout + _syncInterval);
-                
-                // use our condition_variable_any to wait
-                auto cvStatus = _emptyCondition.wait_for(locker, waitDuration);
-                
-                if (cvStatus == std::cv_status::timeout && (_packets.isEmpty() || isFlowWindowFull()) && _naks.isEmpty()
-                    && SequenceNumber(_lastACKSequenceNumber) < _currentSequenceNumber) {
-                    // after a timeout if we still have sent packets that the client hasn't ACKed we
-                    // add them to the loss list
-                    
-                    // Note that thanks to the DoubleLock we have the _naksLock right now
-                    _naks.append(SequenceNumber(_lastACKSequenceNumber) + 1, _currentSequenceNumber);
-
-                    // we have the lock again - time to unlock it
-                    locker.unlock();
-                    
-                    emit timeout();
-                }
-            }
-        }
-    }
     
     return false;
 }
 
 void SendQueue::deactivate() {
-    // this queue is inactive - emit that signal and stop the while
+    // this queue is inactive - emit that signal and stop being scheduled
     emit queueInactive();
     
     _state = State::Stopped;
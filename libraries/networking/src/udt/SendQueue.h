@@ -13,7 +13,6 @@
 #define hifi_SendQueue_h
 
 #include <atomic>
-#include <condition_variable>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -23,6 +22,7 @@
 #include <QtCore/QObject>
 #include <QtCore/QReadWriteLock>
 
+#include <DeadlineScheduler.h>
 #include <PortableHighResolutionClock.h>
 
 #include "../HifiSockAddr.h"
@@ -40,7 +40,9 @@ class Packet;
 class PacketList;
 class Socket;
     
-class SendQueue : public QObject {
+/// Paces the reliable packets of a Connection onto the wire, re-sending what the receiver reports lost. SendQueues
+/// have no threads of their own - one DeadlineScheduler for the process runs each of them when its next send is due.
+class SendQueue : public QObject, public DeadlineScheduler::Task {
     Q_OBJECT
     
 public:
@@ -51,6 +53,7 @@ public:
     };
     
     static std::unique_ptr<SendQueue> create(Socket* socket, HifiSockAddr destination);
+    ~SendQueue();
     
     void queuePacket(std::unique_ptr<Packet> packet);
     void queuePacketList(std::unique_ptr<PacketList> packetList);
@@ -82,13 +85,24 @@ signals:
     void shortCircuitLoss(quint32 sequenceNumber);
     void timeout();
     
-private slots:
-    void run();
-    
 private:
+    using TimePoint = DeadlineScheduler::TimePoint;
+    
+
     SendQueue(Socket* socket, HifiSockAddr dest);
     SendQueue(SendQueue& other) = delete;
     SendQueue(SendQueue&& other) = delete;
+
+    // the scheduler that runs every SendQueue of the process
+    static DeadlineScheduler& getScheduler();
+    
+    // does whatever is due for the queue, and returns when it next needs to be run - called by the scheduler
+    TimePoint runScheduledTask(TimePoint deadline, TimePoint now) override { return processSends(now); }
+    TimePoint processSends(TimePoint now);
+    TimePoint processHandshake(TimePoint now);
+    TimePoint processIdle(TimePoint now, bool& shouldSendNow);
+    
+    void wake() { getScheduler().wake(this); }
     
     void sendHandshake();
     
@@ -98,7 +112,7 @@ private:
     int maybeSendNewPacket(); // Figures out what packet to send next
     bool maybeResendPacket(); // Determines whether to resend a packet and which one
     
-    bool isInactive(bool attemptedToSendPacket);
+    bool hasTimedOut(); // deactivates the queue if the receiver has stopped responding
     void deactivate(); // makes the queue inactive and cleans it up
 
     bool isFlowWindowFull() const;
@@ -134,11 +148,11 @@ private:
     using PacketResendPair = std::pair<uint8_t, std::unique_ptr<Packet>>; // Number of resend + packet ptr
     std::unordered_map<SequenceNumber, PacketResendPair> _sentPackets; // Packets waiting for ACK.
     
-    std::mutex _handshakeMutex; // Protects the handshake ACK condition_variable
     std::atomic<bool> _hasReceivedHandshakeACK { false }; // flag for receipt of handshake ACK from client
-    std::condition_variable _handshakeACKCondition;
+    TimePoint _nextHandshakeTimestamp; // when to re-send the handshake if it still hasn't been ACKed
     
-    std::condition_variable_any _emptyCondition;
+    TimePoint _nextPacketTimestamp; // when the next packet should go out, paced by the packet send period
+    TimePoint _idleTimeout; // when there is nothing to send, when to give up waiting for data or an ACK
 };
     
 }
@@ -11,6 +11,16 @@
 
 #include "Socket.h"
 
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include <QtCore/QSocketNotifier>
 #include <QtCore/QThread>
 
 #include <LogHandler.h>
@@ -21,6 +31,7 @@
 #include "Packet.h"
 #include "../NLPacket.h"
 #include "../NLPacketList.h"
+#include "PacketBufferPool.h"
 #include "PacketList.h"
 
 using namespace udt;
@@ -29,7 +40,10 @@ Socket::Socket(QObject* parent) :
     QObject(parent),
     _synTimer(new QTimer(this))
 {
+#if !defined(Q_OS_LINUX)
+    // on Linux we are told about datagrams by our own notifier, set up once the socket is bound
     connect(&_udpSocket, &QUdpSocket::readyRead, this, &Socket::readPendingDatagrams);
+#endif
     
     // make sure our synchronization method is called every SYN interval
     connect(_synTimer, &QTimer::timeout, this, &Socket::rateControlSync);
@@ -51,6 +65,8 @@ void Socket::bind(const QHostAddress& address, quint16 port) {
     auto sd = _udpSocket.socketDescriptor();
     int val = IP_PMTUDISC_DONT;
     setsockopt(sd, IPPROTO_IP, IP_MTU_DISCOVER, &val, sizeof(val));
+
+    setupReadNotifier();
 #elif defined(Q_OS_WINDOWS)
     auto sd = _udpSocket.socketDescriptor();
     int val = 0; // false
@@ -61,6 +77,12 @@ void Socket::bind(const QHostAddress& address, quint16 port) {
 void Socket::rebind() {
     quint16 oldPort = _udpSocket.localPort();
     
+#if defined(Q_OS_LINUX)
+    // the notifier must not outlive the descriptor it watches
+    delete _readNotifier;
+    _readNotifier = nullptr;
+#endif
+    
     _udpSocket.close();
     bind(QHostAddress::AnyIPv4, oldPort);
 }
@@ -172,6 +194,111 @@ void Socket::writeReliablePacketList(PacketList* packetList, const HifiSockAddr&
     findOrCreateConnection(sockAddr).sendReliablePacketList(std::unique_ptr<PacketList>(packetList));
 }
 
+qint64 Socket::writePacketBatch(PacketBatch& batch) {
+    qint64 totalBytesSent = 0;
+
+    for (auto& batchedPacket : batch) {
+        Q_ASSERT_X(!batchedPacket.packet->isReliable(), "Socket::writePacketBatch", "Cannot send a reliable packet unreliably");
+
+        // write the correct sequence number to the Packet here
+        batchedPacket.packet->writeSequenceNumber(++_unreliableSequenceNumbers[batchedPacket.sockAddr]);
+    }
+
+    size_t nextIndex = 0;
+
+#if defined(Q_OS_LINUX)
+    while (_isBatchedSendEnabled && nextIndex < batch.size()) {
+        int bytesSent = writeBatchedDatagrams(batch, nextIndex);
+        if (bytesSent < 0) {
+            break;
+        }
+        totalBytesSent += bytesSent;
+    }
+#endif
+
+    // whatever couldn't be written in a batch is written one datagram at a time
+    for (; nextIndex < batch.size(); ++nextIndex) {
+        auto& packet = *batch[nextIndex].packet;
+        totalBytesSent += std::max(writeDatagram(packet.getData(), packet.getDataSize(), batch[nextIndex].sockAddr), (qint64) 0);
+    }
+
+    batch.clear();
+
+    return totalBytesSent;
+}
+
+#if defined(Q_OS_LINUX)
+
+int Socket::writeBatchedDatagrams(PacketBatch& batch, size_t& nextIndex) {
+    mmsghdr messages[SEND_BATCH_SIZE];
+    iovec bufferVectors[SEND_BATCH_SIZE];
+    sockaddr_in destinations[SEND_BATCH_SIZE];
+
+    int numMessages = 0;
+    for (size_t i = nextIndex; i < batch.size() && numMessages < SEND_BATCH_SIZE; ++i) {
+        auto& packet = *batch[i].packet;
+        auto& sockAddr = batch[i].sockAddr;
+
+        if (sockAddr.getAddress().protocol() != QAbstractSocket::IPv4Protocol) {
+            // the node socket is IPv4 - leave this and the rest of the batch to the QUdpSocket
+            break;
+        }
+
+        memset(&destinations[numMessages], 0, sizeof(sockaddr_in));
+        destinations[numMessages].sin_family = AF_INET;
+        destinations[numMessages].sin_addr.s_addr = htonl(sockAddr.getAddress().toIPv4Address());
+        destinations[numMessages].sin_port = htons(sockAddr.getPort());
+
+        bufferVectors[numMessages].iov_base = packet.getData();
+        bufferVectors[numMessages].iov_len = packet.getDataSize();
+
+        memset(&messages[numMessages], 0, sizeof(mmsghdr));
+        messages[numMessages].msg_hdr.msg_name = &destinations[numMessages];
+        messages[numMessages].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[numMessages].msg_hdr.msg_iov = &bufferVectors[numMessages];
+        messages[numMessages].msg_hdr.msg_iovlen = 1;
+
+        ++numMessages;
+    }
+
+    if (numMessages == 0) {
+        return -1;
+    }
+
+    int numSent = sendmmsg(_udpSocket.socketDescriptor(), messages, numMessages, 0);
+    ++_numWriteSystemCalls;
+
+    if (numSent <= 0) {
+        if (numSent < 0 && errno == ENOSYS) {
+            // this kernel has no sendmmsg - write through the QUdpSocket from now on
+            qCDebug(networking) << "sendmmsg is not available, falling back to writing one datagram at a time";
+            _isBatchedSendEnabled = false;
+        }
+
+        // let the QUdpSocket have a go at the rest, and report why it fails if it does
+        return -1;
+    }
+
+    int bytesSent = 0;
+    for (int i = 0; i < numSent; ++i) {
+        bytesSent += messages[i].msg_len;
+    }
+
+    _numDatagramsWritten += numSent;
+    nextIndex += numSent;
+
+    return bytesSent;
+}
+
+#endif
+
+Socket::WriteStats Socket::sampleWriteStats() {
+    WriteStats stats;
+    stats.datagrams = _numDatagramsWritten.exchange(0);
+    stats.systemCalls = _numWriteSystemCalls.exchange(0);
+    return stats;
+}
+
 qint64 Socket::writeDatagram(const char* data, qint64 size, const HifiSockAddr& sockAddr) {
     return writeDatagram(QByteArray::fromRawData(data, size), sockAddr);
 }
@@ -179,6 +306,7 @@ qint64 Socket::writeDatagram(const char* data, qint64 size, const HifiSockAddr&
 qint64 Socket::writeDatagram(const QByteArray& datagram, const HifiSockAddr& sockAddr) {
     
     qint64 bytesWritten = _udpSocket.writeDatagram(datagram, sockAddr.getAddress(), sockAddr.getPort());
+    ++_numWriteSystemCalls;
     
     if (bytesWritten < 0) {
         // when saturating a link this isn't an uncommon message - suppress it so it doesn't bomb the debug
@@ -187,6 +315,8 @@ qint64 Socket::writeDatagram(const QByteArray& datagram, const HifiSockAddr& soc
             = LogHandler::getInstance().addRepeatedMessageRegex(WRITE_ERROR_REGEX);
         
         qCDebug(networking) << "Socket::writeDatagram" << _udpSocket.error() << "-" << qPrintable(_udpSocket.errorString());
+    } else {
+        ++_numDatagramsWritten;
     }
     
     return bytesWritten;
@@ -249,72 +379,186 @@ void Socket::messageFailed(Connection* connection, Packet::MessageNumber message
 }
 
 void Socket::readPendingDatagrams() {
+#if defined(Q_OS_LINUX)
+    if (_isBatchedReceiveEnabled) {
+        readBatchedDatagrams();
+        return;
+    }
+#endif
+
     int packetSizeWithHeader = -1;
     while ((packetSizeWithHeader = _udpSocket.pendingDatagramSize()) != -1) {
-        // setup a HifiSockAddr to read into
-        HifiSockAddr senderSockAddr;
-        
-        // setup a buffer to read the packet into
-        auto buffer = std::unique_ptr<char[]>(new char[packetSizeWithHeader]);
-       
-        // pull the datagram
-        auto sizeRead = _udpSocket.readDatagram(buffer.get(), packetSizeWithHeader,
-                                                senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
-
-        if (sizeRead <= 0) {
-            // we either didn't pull anything for this packet or there was an error reading (this seems to trigger
-            // on windows even if there's not a packet available)
-            continue;
+        readDatagramThroughSocket(packetSizeWithHeader);
+    }
+}
+
+void Socket::readDatagramThroughSocket(int packetSizeWithHeader) {
+    // setup a HifiSockAddr to read into
+    HifiSockAddr senderSockAddr;
+    
+    // setup a buffer to read the packet into - from the pool unless the datagram is too big for it
+    bool isFromBufferPool = packetSizeWithHeader <= PacketBufferPool::BUFFER_SIZE;
+    auto buffer = isFromBufferPool
+        ? PacketBufferPool::getInstance().acquire()
+        : std::unique_ptr<char[]>(new char[packetSizeWithHeader]);
+    int bufferSize = isFromBufferPool ? PacketBufferPool::BUFFER_SIZE : packetSizeWithHeader;
+   
+    // pull the datagram
+    auto sizeRead = _udpSocket.readDatagram(buffer.get(), bufferSize,
+                                            senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
+
+    if (sizeRead <= 0) {
+        // we either didn't pull anything for this packet or there was an error reading (this seems to trigger
+        // on windows even if there's not a packet available)
+        if (isFromBufferPool) {
+            PacketBufferPool::getInstance().release(std::move(buffer));
         }
-        
-        auto it = _unfilteredHandlers.find(senderSockAddr);
-        
-        if (it != _unfilteredHandlers.end()) {
-            // we have a registered unfiltered handler for this HifiSockAddr - call that and return
-            if (it->second) {
-                auto basePacket = BasePacket::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
-                it->second(std::move(basePacket));
+        return;
+    }
+    
+    processDatagram(std::move(buffer), sizeRead, isFromBufferPool, senderSockAddr);
+}
+
+#if defined(Q_OS_LINUX)
+
+void Socket::setupReadNotifier() {
+    // recvmmsg reads from the descriptor behind the QUdpSocket's back, so we can't rely on the QUdpSocket to tell us
+    // about datagrams - it turns its own read notifications off each time it reports them, until a datagram is read
+    // through it. Our notifier stays on for as long as there is something to read, whichever way we read it.
+    // The QUdpSocket's readyRead isn't connected on Linux, so its notifier reports once and then stays quiet.
+    delete _readNotifier;
+    _readNotifier = nullptr;
+
+    if (_udpSocket.socketDescriptor() < 0) {
+        // the bind failed, so there is nothing to watch
+        return;
+    }
+
+    _readNotifier = new QSocketNotifier(_udpSocket.socketDescriptor(), QSocketNotifier::Read, this);
+    connect(_readNotifier, &QSocketNotifier::activated, this, &Socket::readPendingDatagrams);
+}
+
+void Socket::readBatchedDatagrams() {
+    auto& bufferPool = PacketBufferPool::getInstance();
+    int socketDescriptor = _udpSocket.socketDescriptor();
+
+    mmsghdr messages[RECEIVE_BATCH_SIZE];
+    iovec bufferVectors[RECEIVE_BATCH_SIZE];
+    sockaddr_storage senderAddresses[RECEIVE_BATCH_SIZE];
+
+    while (true) {
+        // the buffers the last batch handed off to packets are replaced from the pool, the rest are reused
+        bufferPool.acquire(_receiveBuffers, RECEIVE_BATCH_SIZE);
+
+        for (int i = 0; i < RECEIVE_BATCH_SIZE; ++i) {
+            bufferVectors[i].iov_base = _receiveBuffers[i].get();
+            bufferVectors[i].iov_len = PacketBufferPool::BUFFER_SIZE;
+
+            memset(&messages[i], 0, sizeof(mmsghdr));
+            messages[i].msg_hdr.msg_name = &senderAddresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+            messages[i].msg_hdr.msg_iov = &bufferVectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int numReceived = recvmmsg(socketDescriptor, messages, RECEIVE_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+
+        if (numReceived < 0) {
+            if (errno == ENOSYS) {
+                // this kernel has no recvmmsg - read through the QUdpSocket from now on
+                qCDebug(networking) << "recvmmsg is not available, falling back to reading one datagram at a time";
+                _isBatchedReceiveEnabled = false;
+                _receiveBuffers.clear();
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                qCDebug(networking) << "recvmmsg failed with error" << errno;
             }
-            
-            continue;
+            break;
+        }
+
+        for (int i = 0; i < numReceived; ++i) {
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                // bigger than any packet we send, so this isn't for us - the buffer is kept for the next batch
+                ++_numTruncatedDatagrams;
+
+                static const QString TRUNCATED_REGEX = "^Dropped a datagram from .* bigger than";
+                static QString repeatedMessage = LogHandler::getInstance().addRepeatedMessageRegex(TRUNCATED_REGEX);
+
+                HifiSockAddr senderSockAddr(reinterpret_cast<const sockaddr*>(&senderAddresses[i]));
+                qCDebug(networking) << "Dropped a datagram from" << senderSockAddr << "bigger than"
+                    << PacketBufferPool::BUFFER_SIZE << "bytes -" << _numTruncatedDatagrams << "so far";
+                continue;
+            }
+
+            HifiSockAddr senderSockAddr(reinterpret_cast<const sockaddr*>(&senderAddresses[i]));
+            processDatagram(std::move(_receiveBuffers[i]), messages[i].msg_len, true, senderSockAddr);
+        }
+
+        // drop the buffers that were handed off, so they are topped up for the next batch
+        _receiveBuffers.erase(std::remove(_receiveBuffers.begin(), _receiveBuffers.end(), nullptr), _receiveBuffers.end());
+
+        if (numReceived < RECEIVE_BATCH_SIZE) {
+            // the socket is drained
+            break;
+        }
+    }
+}
+
+#endif
+
+void Socket::processDatagram(std::unique_ptr<char[]> buffer, int packetSizeWithHeader, bool isFromBufferPool,
+                             const HifiSockAddr& senderSockAddr) {
+    auto it = _unfilteredHandlers.find(senderSockAddr);
+    
+    if (it != _unfilteredHandlers.end()) {
+        // we have a registered unfiltered handler for this HifiSockAddr - call that and return
+        if (it->second) {
+            auto basePacket = BasePacket::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
+            basePacket->setIsFromBufferPool(isFromBufferPool);
+            it->second(std::move(basePacket));
+        } else if (isFromBufferPool) {
+            PacketBufferPool::getInstance().release(std::move(buffer));
         }
         
-        // check if this was a control packet or a data packet
-        bool isControlPacket = *reinterpret_cast<uint32_t*>(buffer.get()) & CONTROL_BIT_MASK;
+        return;
+    }
+    
+    // check if this was a control packet or a data packet
+    bool isControlPacket = *reinterpret_cast<uint32_t*>(buffer.get()) & CONTROL_BIT_MASK;
+    
+    if (isControlPacket) {
+        // setup a control packet from the data we just read
+        auto controlPacket = ControlPacket::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
+        controlPacket->setIsFromBufferPool(isFromBufferPool);
         
-        if (isControlPacket) {
-            // setup a control packet from the data we just read
-            auto controlPacket = ControlPacket::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
-            
-            // move this control packet to the matching connection
-            auto& connection = findOrCreateConnection(senderSockAddr);
-            connection.processControl(move(controlPacket));
-            
-        } else {
-            // setup a Packet from the data we just read
-            auto packet = Packet::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
-            
-            // call our verification operator to see if this packet is verified
-            if (!_packetFilterOperator || _packetFilterOperator(*packet)) {
-                if (packet->isReliable()) {
-                    // if this was a reliable packet then signal the matching connection with the sequence number
-                    auto& connection = findOrCreateConnection(senderSockAddr);
-
-                    if (!connection.processReceivedSequenceNumber(packet->getSequenceNumber(),
-                                                                  packet->getDataSize(),
-                                                                  packet->getPayloadSize())) {
-                        // the connection indicated that we should not continue processing this packet
-                        continue;
-                    }
+        // move this control packet to the matching connection
+        auto& connection = findOrCreateConnection(senderSockAddr);
+        connection.processControl(move(controlPacket));
+        
+    } else {
+        // setup a Packet from the data we just read
+        auto packet = Packet::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
+        packet->setIsFromBufferPool(isFromBufferPool);
+        
+        // call our verification operator to see if this packet is verified
+        if (!_packetFilterOperator || _packetFilterOperator(*packet)) {
+            if (packet->isReliable()) {
+                // if this was a reliable packet then signal the matching connection with the sequence number
+                auto& connection = findOrCreateConnection(senderSockAddr);
+
+                if (!connection.processReceivedSequenceNumber(packet->getSequenceNumber(),
+                                                              packet->getDataSize(),
+                                                              packet->getPayloadSize())) {
+                    // the connection indicated that we should not continue processing this packet
+                    return;
                 }
+            }
 
-                if (packet->isPartOfMessage()) {
-                    auto& connection = findOrCreateConnection(senderSockAddr);
-                    connection.queueReceivedMessagePacket(std::move(packet));
-                } else if (_packetHandler) {
-                    // call the verified packet callback to let it handle this packet
-                    _packetHandler(std::move(packet));
-                }
+            if (packet->isPartOfMessage()) {
+                auto& connection = findOrCreateConnection(senderSockAddr);
+                connection.queueReceivedMessagePacket(std::move(packet));
+            } else if (_packetHandler) {
+                // call the verified packet callback to let it handle this packet
+                _packetHandler(std::move(packet));
             }
         }
     }
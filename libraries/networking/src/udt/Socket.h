@@ -14,8 +14,10 @@
 #ifndef hifi_Socket_h
 #define hifi_Socket_h
 
+#include <atomic>
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include <QtCore/QObject>
 #include <QtCore/QTimer>
@@ -27,6 +29,7 @@
 
 //#define UDT_CONNECTION_DEBUG
 
+class QSocketNotifier;
 class UDTTest;
 
 namespace udt {
@@ -43,11 +46,26 @@ using PacketHandler = std::function<void(std::unique_ptr<Packet>)>;
 using MessageHandler = std::function<void(std::unique_ptr<Packet>)>;
 using MessageFailureHandler = std::function<void(HifiSockAddr, udt::Packet::MessageNumber)>;
 
+// an unreliable packet waiting in a PacketBatch, and where it is going
+struct BatchedPacket {
+    std::unique_ptr<Packet> packet;
+    HifiSockAddr sockAddr;
+};
+
+// unreliable packets that are written together, with as few system calls as the platform allows
+using PacketBatch = std::vector<BatchedPacket>;
+
 class Socket : public QObject {
     Q_OBJECT
 public:
     using StatsVector = std::vector<std::pair<HifiSockAddr, ConnectionStats::Stats>>;
     
+    // what has been written to the socket since the last sample
+    struct WriteStats {
+        int datagrams { 0 };
+        int systemCalls { 0 };
+    };
+    
     Socket(QObject* object = 0);
     
     quint16 localPort() const { return _udpSocket.localPort(); }
@@ -57,6 +75,7 @@ public:
     qint64 writePacket(const Packet& packet, const HifiSockAddr& sockAddr);
     qint64 writePacket(std::unique_ptr<Packet> packet, const HifiSockAddr& sockAddr);
     qint64 writePacketList(std::unique_ptr<PacketList> packetList, const HifiSockAddr& sockAddr);
+    qint64 writePacketBatch(PacketBatch& batch); // writes and clears the batch
     qint64 writeDatagram(const char* data, qint64 size, const HifiSockAddr& sockAddr);
     qint64 writeDatagram(const QByteArray& datagram, const HifiSockAddr& sockAddr);
     
@@ -71,6 +90,13 @@ public:
     void addUnfilteredHandler(const HifiSockAddr& senderSockAddr, BasePacketHandler handler)
         { _unfilteredHandlers[senderSockAddr] = handler; }
     
+    // on Linux datagrams are drained from the socket in batches with recvmmsg - this falls back to reading them one at a time
+    void setBatchedReceiveEnabled(bool enabled) { _isBatchedReceiveEnabled = enabled; }
+    bool isBatchedReceiveEnabled() const { return _isBatchedReceiveEnabled; }
+    
+    // datagrams dropped since they didn't fit in a receive buffer, and so can't be one of our packets
+    int getNumTruncatedDatagrams() const { return _numTruncatedDatagrams; }
+    
     void setCongestionControlFactory(std::unique_ptr<CongestionControlVirtualFactory> ccFactory);
     void setConnectionMaxBandwidth(int maxBandwidth);
 
@@ -78,6 +104,7 @@ public:
     void messageFailed(Connection* connection, Packet::MessageNumber messageNumber);
     
     StatsVector sampleStatsForAllConnections();
+    WriteStats sampleWriteStats();
 
 public slots:
     void cleanupConnection(HifiSockAddr sockAddr);
@@ -92,6 +119,14 @@ private slots:
 
 private:
     void setSystemBufferSizes();
+    void readDatagramThroughSocket(int packetSizeWithHeader);
+#if defined(Q_OS_LINUX)
+    void setupReadNotifier();
+    void readBatchedDatagrams();
+    int writeBatchedDatagrams(PacketBatch& batch, size_t& nextIndex);
+#endif
+    void processDatagram(std::unique_ptr<char[]> buffer, int packetSizeWithHeader, bool isFromBufferPool,
+                         const HifiSockAddr& senderSockAddr);
     Connection& findOrCreateConnection(const HifiSockAddr& sockAddr);
    
     // privatized methods used by UDTTest - they are private since they must be called on the Socket thread
@@ -118,6 +153,22 @@ private:
 
     int _maxBandwidth { -1 };
     
+#if defined(Q_OS_LINUX)
+    static const int RECEIVE_BATCH_SIZE = 64;
+    static const int SEND_BATCH_SIZE = 64;
+    QSocketNotifier* _readNotifier { nullptr }; // a child, so that it moves threads with us
+    bool _isBatchedReceiveEnabled { true };
+    bool _isBatchedSendEnabled { true };
+#else
+    bool _isBatchedReceiveEnabled { false };
+#endif
+    std::vector<std::unique_ptr<char[]>> _receiveBuffers; // the buffers the next batch is received into
+    int _numTruncatedDatagrams { 0 };
+    
+    // written from the send queue threads as well as our own
+    std::atomic<int> _numDatagramsWritten { 0 };
+    std::atomic<int> _numWriteSystemCalls { 0 };
+    
     std::unique_ptr<CongestionControlVirtualFactory> _ccFactory { new CongestionControlFactory<DefaultCC>() };
     
     friend UDTTest;
@@ -13,6 +13,7 @@
 #define _USE_MATH_DEFINES
 #endif
 
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <cmath>
@@ -29,6 +30,8 @@
 #include <QVector>
 #include <QFile>
 #include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
 #include <QFileInfo>
 #include <QString>
 
@@ -50,7 +53,15 @@
 #include "OctreeLogging.h"
 
 
-QVector<QString> PERSIST_EXTENSIONS = {"svo", "json", "json.gz"};
+QVector<QString> PERSIST_EXTENSIONS = {"svo", "json", "json.gz", "bin"};
+
+// A binary snapshot is a header followed by one record per item of the tree's description, each record being
+// the item in Qt's binary JSON format. Records are padded to 4 bytes, so they can be read in place from the
+// memory mapped file. Qt's binary JSON is little-endian, so the header and record sizes are written that way too.
+static const quint32 BINARY_SNAPSHOT_MAGIC = 0x48464f53; // "HFOS"
+static const quint32 BINARY_SNAPSHOT_VERSION = 1;
+static const qint64 BINARY_SNAPSHOT_HEADER_BYTES = 4 * sizeof(quint32) + 16; // the header fields, then the PersistID
+static const qint64 BINARY_SNAPSHOT_ALIGNMENT = 4;
 
 Octree::Octree(bool shouldReaverage) :
     _rootElement(NULL),
@@ -624,9 +635,113 @@ void Octree::eraseAllOctreeElements(bool createNewRoot) {
         _rootElement.reset(); // this will recurse and delete all children
     }
 
+    {
+        // nothing recorded against the old elements means anything anymore
+        QMutexLocker locker(&_changeLogMutex);
+        _changeLog.clear();
+        _changeLogFloor = ++_changeSequence;
+    }
+
     _isDirty = true;
 }
 
+const size_t Octree::MAX_CHANGE_LOG_ENTRIES = 10000;
+const size_t Octree::MAX_CHANGED_SUBTREES = 256;
+
+void Octree::setTrackElementChanges(bool trackElementChanges) {
+    QMutexLocker locker(&_changeLogMutex);
+    if (trackElementChanges != _trackElementChanges) {
+        _trackElementChanges = trackElementChanges;
+        _changeLog.clear();
+        _changeLogFloor = ++_changeSequence;
+    }
+}
+
+void Octree::recordElementChange(OctreeElementPointer element) {
+    if (!element) {
+        return;
+    }
+
+    QMutexLocker locker(&_changeLogMutex);
+    if (!_trackElementChanges) {
+        return;
+    }
+
+    ++_changeSequence;
+
+    // the same element is often edited several times in a row, bumping its entry keeps the log in order
+    if (!_changeLog.empty() && _changeLog.back().element.lock() == element) {
+        _changeLog.back().sequence = _changeSequence;
+        return;
+    }
+
+    _changeLog.push_back({ _changeSequence, element });
+    if (_changeLog.size() > MAX_CHANGE_LOG_ENTRIES) {
+        _changeLogFloor = _changeLog.front().sequence;
+        _changeLog.pop_front();
+    }
+}
+
+quint64 Octree::getChangeSequence() const {
+    QMutexLocker locker(&_changeLogMutex);
+    return _changeSequence;
+}
+
+bool Octree::getChangedSubtreesSince(quint64 sequence, std::vector<OctreeElementPointer>& subtrees) const {
+    std::vector<OctreeElementPointer> changedElements;
+    {
+        QMutexLocker locker(&_changeLogMutex);
+        if (!_trackElementChanges || sequence < _changeLogFloor) {
+            return false;
+        }
+        for (auto it = _changeLog.rbegin(); it != _changeLog.rend() && it->sequence > sequence; ++it) {
+            // elements that have since been pruned have no contents left to send
+            if (auto element = it->element.lock()) {
+                changedElements.push_back(element);
+            }
+        }
+    }
+
+    if (changedElements.size() > MAX_CHANGED_SUBTREES) {
+        return false;
+    }
+
+    // an element's own data is written by its parent, so that is where the encode has to start
+    std::vector<OctreeElementPointer> parents;
+    for (auto& element : changedElements) {
+        OctreeElementPointer parent;
+        if (element == _rootElement) {
+            parent = _rootElement;
+        } else if (nodeForOctalCode(_rootElement, element->getOctalCode(), &parent) != element) {
+            continue; // no longer attached to this tree
+        }
+        if (parent && std::find(parents.begin(), parents.end(), parent) == parents.end()) {
+            parents.push_back(parent);
+        }
+    }
+
+    // encoding a subtree covers everything below it, so drop any parent that is inside another one
+    std::sort(parents.begin(), parents.end(), [](const OctreeElementPointer& a, const OctreeElementPointer& b) {
+        return a->getLevel() < b->getLevel();
+    });
+
+    subtrees.clear();
+    for (auto& parent : parents) {
+        bool isCovered = false;
+        for (auto& subtree : subtrees) {
+            if (isAncestorOf(subtree->getOctalCode(), parent->getOctalCode())) {
+                isCovered = true;
+                break;
+            }
+        }
+        if (!isCovered) {
+            subtrees.push_back(parent);
+        }
+    }
+
+    return true;
+}
+
 // Note: this is an expensive call. Don't call it unless you really need to reaverage the entire tree (from startElement)
 void Octree::reaverageOctreeElements(OctreeElementPointer startElement) {
     if (!startElement) {
@@ -1622,11 +1737,16 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElementPointer element,
 
 bool Octree::readFromFile(const char* fileName) {
     QString qFileName = findMostRecentFileExtension(fileName, PERSIST_EXTENSIONS);
+    _persistID = QUuid();
 
     if (qFileName.endsWith(".json.gz")) {
         return readJSONFromGzippedFile(qFileName);
     }
 
+    if (qFileName.endsWith(".bin")) {
+        return readFromBinaryFile(qFileName);
+    }
+
     QFile file(qFileName);
 
     if (!file.open(QIODevice::ReadOnly)) {
@@ -1669,6 +1789,90 @@ bool Octree::readJSONFromGzippedFile(QString qFileName) {
     return readJSONFromStream(-1, jsonStream);
 }
 
+bool Octree::readFromBinaryFile(const QString& qFileName) {
+    QFile file(qFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Cannot open binary snapshot for reading: " << qFileName;
+        return false;
+    }
+
+    qint64 fileSize = file.size();
+    const uchar* fileData = file.map(0, fileSize);
+    if (!fileData) {
+        qCritical() << "Cannot map binary snapshot: " << qFileName;
+        return false;
+    }
+
+    QByteArray headerData = QByteArray::fromRawData(reinterpret_cast<const char*>(fileData),
+                                                    (int)std::min(fileSize, BINARY_SNAPSHOT_HEADER_BYTES));
+    QDataStream headerStream(headerData);
+    headerStream.setByteOrder(QDataStream::LittleEndian);
+    quint32 magic = 0;
+    quint32 formatVersion = 0;
+    quint32 bitstreamVersion = 0; // the "Version" of a JSON file, kept for the converter
+    quint32 numItems = 0;
+    QUuid persistID;
+    headerStream >> magic >> formatVersion >> bitstreamVersion >> numItems >> persistID;
+
+    if (headerStream.status() != QDataStream::Ok || magic != BINARY_SNAPSHOT_MAGIC) {
+        qCritical() << "File is not a binary snapshot: " << qFileName;
+        return false;
+    }
+    if (formatVersion == 0 || formatVersion > BINARY_SNAPSHOT_VERSION) {
+        qCritical() << "Binary snapshot" << qFileName << "is version" << formatVersion
+            << "but this can only read versions 1 to" << BINARY_SNAPSHOT_VERSION;
+        return false;
+    }
+    _persistID = persistID;
+
+    qCDebug(octree) << "Loading binary snapshot" << qFileName << "with" << numItems << "items...";
+
+    // each item is decoded straight out of the mapped file as the tree asks for it
+    qint64 offset = BINARY_SNAPSHOT_HEADER_BYTES;
+    quint32 itemsRead = 0;
+    bool isTruncated = false;
+    bool isCorrupt = false;
+    bool success = readFromItems([&](QVariantMap& itemDescription) {
+        if (itemsRead == numItems) {
+            return false;
+        }
+
+        if (offset + (qint64)sizeof(quint32) > fileSize) {
+            isTruncated = true;
+            return false;
+        }
+        qint64 recordSize = qFromLittleEndian<quint32>(fileData + offset);
+        offset += sizeof(quint32);
+        if (recordSize > fileSize - offset) {
+            isTruncated = true;
+            return false;
+        }
+
+        QJsonDocument record = QJsonDocument::fromRawData(reinterpret_cast<const char*>(fileData + offset),
+                                                          (int)recordSize, QJsonDocument::Validate);
+        if (record.isNull()) {
+            isCorrupt = true;
+            return false;
+        }
+        offset += (recordSize + BINARY_SNAPSHOT_ALIGNMENT - 1) & ~(BINARY_SNAPSHOT_ALIGNMENT - 1);
+        itemsRead++;
+
+        // this copies the item out of the mapped file, so nothing is left pointing into it
+        itemDescription = record.object().toVariantMap();
+        return true;
+    });
+
+    if (isTruncated) {
+        qCritical() << "Binary snapshot" << qFileName << "ends after" << itemsRead << "of" << numItems << "items";
+        return false;
+    }
+    if (isCorrupt) {
+        qCritical() << "Binary snapshot" << qFileName << "has an unreadable record after" << itemsRead << "items";
+        return false;
+    }
+    return success;
+}
+
 bool Octree::readFromURL(const QString& urlString) {
     auto request = std::unique_ptr<ResourceRequest>(ResourceManager::createResourceRequest(this, urlString));
 
@@ -1863,6 +2067,7 @@ bool Octree::readJSONFromStream(unsigned long streamLength, QDataStream& inputSt
     QJsonDocument asDocument = QJsonDocument::fromJson(jsonBuffer);
     QVariant asVariant = asDocument.toVariant();
     QVariantMap asMap = asVariant.toMap();
+    _persistID = QUuid(asMap["PersistID"].toString());
     readFromMap(asMap);
     delete[] rawData;
     return true;
@@ -1880,6 +2085,8 @@ void Octree::writeToFile(const char* fileName, OctreeElementPointer element, QSt
         writeToJSONFile(cFileName, element);
     } else if (persistAsFileType == "json.gz") {
         writeToJSONFile(cFileName, element, true);
+    } else if (persistAsFileType == "bin") {
+        writeToBinaryFile(cFileName, element);
     } else {
         qCDebug(octree) << "unable to write octree to file of type" << persistAsFileType;
     }
@@ -1890,6 +2097,15 @@ void Octree::writeToJSONFile(const char* fileName, OctreeElementPointer element,
 
     qCDebug(octree, "Saving JSON SVO to file %s...", fileName);
 
+    if (!writeToJSONDescription(entityDescription, element)) {
+        qCritical("Failed to convert Entities to QVariantMap while saving to json.");
+        return;
+    }
+
+    writeJSONDescriptionToFile(entityDescription, fileName, doGzip);
+}
+
+bool Octree::writeToJSONDescription(QVariantMap& entityDescription, OctreeElementPointer element) {
     OctreeElementPointer top;
     if (element) {
         top = element;
@@ -1902,13 +2118,15 @@ void Octree::writeToJSONFile(const char* fileName, OctreeElementPointer element,
     PacketVersion expectedVersion = versionForPacketType(expectedType);
     entityDescription["Version"] = (int) expectedVersion;
 
-    // store the entity data
-    bool entityDescriptionSuccess = writeToMap(entityDescription, top, true, true);
-    if (!entityDescriptionSuccess) {
-        qCritical("Failed to convert Entities to QVariantMap while saving to json.");
-        return;
+    if (!_persistID.isNull()) {
+        entityDescription["PersistID"] = _persistID.toString();
     }
 
+    // store the entity data
+    return writeToMap(entityDescription, top, true, true);
+}
+
+bool Octree::writeJSONDescriptionToFile(const QVariantMap& entityDescription, const QString& fileName, bool doGzip) {
     // convert the QVariantMap to JSON
     QByteArray jsonData = QJsonDocument::fromVariant(entityDescription).toJson();
     QByteArray jsonDataForFile;
@@ -1916,18 +2134,67 @@ void Octree::writeToJSONFile(const char* fileName, OctreeElementPointer element,
     if (doGzip) {
         if (!gzip(jsonData, jsonDataForFile, -1)) {
             qCritical("unable to gzip data while saving to json.");
-            return;
+            return false;
         }
     } else {
         jsonDataForFile = jsonData;
     }
 
     QFile persistFile(fileName);
-    if (persistFile.open(QIODevice::WriteOnly)) {
-        persistFile.write(jsonDataForFile);
-    } else {
+    if (!persistFile.open(QIODevice::WriteOnly) || persistFile.write(jsonDataForFile) != jsonDataForFile.size()) {
         qCritical("Could not write to JSON description of entities.");
+        return false;
+    }
+    return true;
+}
+
+void Octree::writeToBinaryFile(const char* fileName, OctreeElementPointer element) {
+    QVariantMap entityDescription;
+
+    qCDebug(octree, "Saving binary snapshot to file %s...", fileName);
+
+    if (!writeToJSONDescription(entityDescription, element)) {
+        qCritical("Failed to convert Entities to QVariantMap while saving binary snapshot.");
+        return;
     }
+
+    writeBinaryDescriptionToFile(entityDescription, fileName);
+}
+
+bool Octree::writeBinaryDescriptionToFile(const QVariantMap& entityDescription, const QString& fileName) {
+    QFile persistFile(fileName);
+    if (!persistFile.open(QIODevice::WriteOnly)) {
+        qCritical() << "Could not open binary snapshot for writing:" << fileName;
+        return false;
+    }
+
+    QVariantList items = entityDescription["Entities"].toList();
+
+    QDataStream headerStream(&persistFile);
+    headerStream.setByteOrder(QDataStream::LittleEndian);
+    headerStream << BINARY_SNAPSHOT_MAGIC << BINARY_SNAPSHOT_VERSION << (quint32)entityDescription["Version"].toInt()
+        << (quint32)items.size() << QUuid(entityDescription["PersistID"].toString());
+
+    static const char PADDING[BINARY_SNAPSHOT_ALIGNMENT] = { 0 };
+    bool success = headerStream.status() == QDataStream::Ok;
+
+    foreach (const QVariant& item, items) {
+        if (!success) {
+            break;
+        }
+        QByteArray record = QJsonDocument(QJsonObject::fromVariantMap(item.toMap())).toBinaryData();
+        quint32 recordSize = qToLittleEndian((quint32)record.size());
+        int paddingSize = (BINARY_SNAPSHOT_ALIGNMENT - record.size() % BINARY_SNAPSHOT_ALIGNMENT) % BINARY_SNAPSHOT_ALIGNMENT;
+
+        success = persistFile.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize)) == sizeof(recordSize)
+            && persistFile.write(record) == record.size()
+            && persistFile.write(PADDING, paddingSize) == paddingSize;
+    }
+
+    if (!success) {
+        qCritical() << "Could not write binary snapshot:" << fileName;
+    }
+    return success;
 }
 
 void Octree::writeToSVOFile(const char* fileName, OctreeElementPointer element) {
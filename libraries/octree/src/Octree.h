@@ -12,11 +12,16 @@
 #ifndef hifi_Octree_h
 #define hifi_Octree_h
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QUuid>
 
 #include <shared/ReadWriteLockable.h>
 #include <SimpleMovingAverage.h>
@@ -272,6 +277,38 @@ public:
     void clearDirtyBit() { _isDirty = false; }
     void setDirtyBit() { _isDirty = true; }
 
+    // The change log remembers which elements had their own contents edited, in edit sequence order, so that
+    // a server can re-encode just those for viewers whose view hasn't moved. Trees opt in by enabling tracking
+    // and calling recordElementChange() wherever they edit an element's contents.
+    static const size_t MAX_CHANGE_LOG_ENTRIES;
+    static const size_t MAX_CHANGED_SUBTREES;
+
+    void setTrackElementChanges(bool trackElementChanges);
+    void recordElementChange(OctreeElementPointer element);
+    quint64 getChangeSequence() const;
+
+    /// Collects the subtrees that have to be encoded to deliver every change recorded after sequence. Must be
+    /// called with the tree locked for reading. Returns false if the log doesn't reach back that far, or if so
+    /// much has changed that a full traversal would be cheaper.
+    bool getChangedSubtreesSince(quint64 sequence, std::vector<OctreeElementPointer>& subtrees) const;
+
+    // Journaled persistence. A tree that supports it remembers which of its items were edited between calls to
+    // writeJournalChanges(), so that a persister can append just those edits to a journal instead of saving
+    // the whole tree every time.
+    virtual void setJournalChanges(bool journalChanges) { }
+
+    /// Appends a record of every edit since the last call to changes, and forgets them. Must be called with the
+    /// tree locked for reading. Returns false if the tree doesn't journal, or lost track of its edits and has to
+    /// be saved in full.
+    virtual bool writeJournalChanges(QVariantList& changes) { return false; }
+
+    /// Applies records written by writeJournalChanges(). Must be called with the tree locked for writing.
+    virtual bool readJournalChanges(const QVariantList& changes) { return false; }
+
+    // identifies the save the tree was last read from or written to, so a journal can tell if it extends that save
+    QUuid getPersistID() const { return _persistID; }
+    void setPersistID(const QUuid& persistID) { _persistID = persistID; }
+
     // output hints from the encode process
     typedef enum {
         Lock,
@@ -301,6 +338,10 @@ public:
     // Octree exporters
     void writeToFile(const char* filename, OctreeElementPointer element = NULL, QString persistAsFileType = "svo");
     void writeToJSONFile(const char* filename, OctreeElementPointer element = NULL, bool doGzip = false);
+    bool writeToJSONDescription(QVariantMap& description, OctreeElementPointer element = NULL);
+    static bool writeJSONDescriptionToFile(const QVariantMap& description, const QString& fileName, bool doGzip);
+    void writeToBinaryFile(const char* filename, OctreeElementPointer element = NULL);
+    static bool writeBinaryDescriptionToFile(const QVariantMap& description, const QString& fileName);
     void writeToSVOFile(const char* filename, OctreeElementPointer element = NULL);
     virtual bool writeToMap(QVariantMap& entityDescription, OctreeElementPointer element, bool skipDefaultValues,
                             bool skipThoseWithBadParents) = 0;
@@ -313,6 +354,11 @@ public:
     bool readJSONFromStream(unsigned long streamLength, QDataStream& inputStream);
     bool readJSONFromGzippedFile(QString qFileName);
     virtual bool readFromMap(QVariantMap& entityDescription) = 0;
+    bool readFromBinaryFile(const QString& qFileName);
+
+    /// Reads the items of a description, such as entities, one at a time until readNextItem returns false, so that
+    /// a file can be read without building the whole description first. Returns false if the tree can't do this.
+    virtual bool readFromItems(const std::function<bool(QVariantMap&)>& readNextItem) { return false; }
 
     unsigned long getOctreeElementsCount();
 
@@ -381,6 +427,19 @@ protected:
 
     bool _isViewing;
     bool _isServer;
+
+    struct ElementChange {
+        quint64 sequence;
+        OctreeElementWeakPointer element;
+    };
+
+    mutable QMutex _changeLogMutex;
+    bool _trackElementChanges { false };
+    std::deque<ElementChange> _changeLog;
+    quint64 _changeSequence { 0 };
+    quint64 _changeLogFloor { 0 }; // every change after this sequence is still in _changeLog
+
+    QUuid _persistID;
 };
 
 #endif // hifi_Octree_h
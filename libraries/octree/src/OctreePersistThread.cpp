@@ -9,6 +9,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
@@ -16,14 +17,17 @@
 #include <fstream>
 #include <time.h>
 
+#include <QDataStream>
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QTemporaryFile>
 
 #include <NumericalConstants.h>
 #include <PerfStat.h>
@@ -34,6 +38,13 @@
 
 const int OctreePersistThread::DEFAULT_PERSIST_INTERVAL = 1000 * 30; // every 30 seconds
 
+static const QString JOURNAL_EXTENSION = ".journal";
+static const quint32 JOURNAL_MAGIC = 0x4a524e4c; // "JRNL"
+static const quint32 JOURNAL_VERSION = 1;
+
+// the full file is rewritten once the journal has grown past the file it extends, or this, whichever is larger
+static const qint64 MIN_COMPACTED_JOURNAL_BYTES = 1024 * 1024;
+
 OctreePersistThread::OctreePersistThread(OctreePointer tree, const QString& filename, int persistInterval,
                                          bool wantBackup, const QJsonObject& settings, bool debugTimestampNow,
                                          QString persistAsFileType) :
@@ -46,7 +57,9 @@ OctreePersistThread::OctreePersistThread(OctreePointer tree, const QString& file
     _wantBackup(wantBackup),
     _debugTimestampNow(debugTimestampNow),
     _lastTimeDebug(0),
-    _persistAsFileType(persistAsFileType)
+    _persistAsFileType(persistAsFileType),
+    _wantJournal(persistAsFileType == "json" || persistAsFileType == "json.gz" || persistAsFileType == "bin"),
+    _snapshotBytes(0)
 {
     parseSettings(settings);
 
@@ -60,6 +73,8 @@ QString OctreePersistThread::getPersistFileMimeType() const {
         return "application/json";
     } if (_persistAsFileType == "json.gz") {
         return "application/zip";
+    } if (_persistAsFileType == "bin") {
+        return "application/octet-stream";
     }
     return "";
 }
@@ -138,6 +153,8 @@ bool OctreePersistThread::process() {
         qCDebug(octree) << "loading Octrees from file: " << _filename << "...";
 
         bool persistantFileRead;
+        bool journalReplayed = false;
+        QString loadedFileName;
 
         _tree->withWriteLock([&] {
             PerformanceWarning warn(true, "Loading Octree File", true);
@@ -160,8 +177,16 @@ bool OctreePersistThread::process() {
                 qCDebug(octree) << "Loading Octree... lock file removed:" << lockFileName;
             }
 
+            // the file is loaded from whichever format was saved last
+            loadedFileName = findMostRecentFileExtension(_filename, PERSIST_EXTENSIONS);
             persistantFileRead = _tree->readFromFile(qPrintable(_filename.toLocal8Bit()));
             _tree->pruneTree();
+
+            if (_wantJournal) {
+                // the edits made after the file was last saved in full
+                journalReplayed = replayJournal(loadedFileName);
+                _tree->setJournalChanges(true);
+            }
         });
 
         quint64 loadDone = usecTimestampNow();
@@ -198,6 +223,17 @@ bool OctreePersistThread::process() {
         // want an uninitialized value for this, so we set it to the current time (startup of the server)
         time(&_lastPersistTime);
 
+        if (_wantJournal) {
+            if (journalReplayed && loadedFileName == _filename) {
+                _snapshotBytes = QFileInfo(_filename).size();
+                resetJournal(true);
+            } else {
+                // there is no journal that extends what was loaded, so journaling starts over from a new full save
+                _tree->setDirtyBit();
+                persist();
+            }
+        }
+
         emit loadCompleted();
     }
 
@@ -242,6 +278,12 @@ void OctreePersistThread::aboutToFinish() {
 }
 
 QByteArray OctreePersistThread::getPersistFileContents() const {
+    // with journaling the file on disk lacks the edits journaled since it was last written in full,
+    // so the contents are written from the tree instead
+    if (_wantJournal) {
+        return writeTreeContents();
+    }
+
     QByteArray fileContents;
     QFile file(_filename);
     if (file.open(QIODevice::ReadOnly)) {
@@ -250,18 +292,55 @@ QByteArray OctreePersistThread::getPersistFileContents() const {
     return fileContents;
 }
 
+QByteArray OctreePersistThread::writeTreeContents() const {
+    QVariantMap entityDescription;
+    bool described = false;
+    _tree->withReadLock([&] {
+        described = _tree->writeToJSONDescription(entityDescription);
+    });
+
+    QTemporaryFile contentsFile;
+    if (!described || !contentsFile.open()) {
+        return QByteArray();
+    }
+    contentsFile.close();
+
+    bool written = false;
+    if (_persistAsFileType == "bin") {
+        written = Octree::writeBinaryDescriptionToFile(entityDescription, contentsFile.fileName());
+    } else {
+        written = Octree::writeJSONDescriptionToFile(entityDescription, contentsFile.fileName(),
+                                                     _persistAsFileType == "json.gz");
+    }
+
+    // reopening a closed QTemporaryFile opens the same file again, without truncating it
+    if (!written || !contentsFile.open()) {
+        return QByteArray();
+    }
+    return contentsFile.readAll();
+}
+
 void OctreePersistThread::persist() {
     if (_tree->isDirty() && _initialLoadComplete) {
 
+        // a backup copies the full file, so the journal is only appended to when none is due
+        if (_wantJournal && !isBackupDue() && appendToJournal()) {
+            return;
+        }
+
         _tree->withWriteLock([&] {
             qCDebug(octree) << "pruning Octree before saving...";
             _tree->pruneTree();
             qCDebug(octree) << "DONE pruning Octree before saving...";
         });
 
-        qCDebug(octree) << "persist operation calling backup...";
-        backup(); // handle backup if requested        
-        qCDebug(octree) << "persist operation DONE with backup...";
+        // with journaling the file on disk lacks the edits journaled since it was last written in full,
+        // so it is backed up after it has been rewritten rather than before
+        if (!_wantJournal) {
+            qCDebug(octree) << "persist operation calling backup...";
+            backup(); // handle backup if requested
+            qCDebug(octree) << "persist operation DONE with backup...";
+        }
 
 
         // create our "lock" file to indicate we're saving.
@@ -270,9 +349,17 @@ void OctreePersistThread::persist() {
         if(lockFile.is_open()) {
             qCDebug(octree) << "saving Octree lock file created at:" << lockFileName;
 
-            _tree->writeToFile(qPrintable(_filename), NULL, _persistAsFileType);
+            if (_wantJournal) {
+                if (writeSnapshot()) {
+                    qCDebug(octree) << "persist operation calling backup...";
+                    backup(); // handle backup if requested
+                    qCDebug(octree) << "persist operation DONE with backup...";
+                }
+            } else {
+                _tree->writeToFile(qPrintable(_filename), NULL, _persistAsFileType);
+                _tree->clearDirtyBit(); // tree is clean after saving
+            }
             time(&_lastPersistTime);
-            _tree->clearDirtyBit(); // tree is clean after saving
             qCDebug(octree) << "DONE saving Octree to file...";
 
             lockFile.close();
@@ -283,6 +370,158 @@ void OctreePersistThread::persist() {
     }
 }
 
+bool OctreePersistThread::appendToJournal() {
+    // replaying a journal that has outgrown the file it extends costs more than a full save
+    if (!_journalFile.isOpen() || _journalFile.size() > std::max(MIN_COMPACTED_JOURNAL_BYTES, _snapshotBytes)) {
+        return false;
+    }
+
+    QVariantList changes;
+    bool journaled = false;
+    _tree->withReadLock([&] {
+        journaled = _tree->writeJournalChanges(changes);
+        if (journaled) {
+            _tree->clearDirtyBit();
+        }
+    });
+
+    if (!journaled) {
+        return false;
+    }
+    if (changes.isEmpty()) {
+        return true;
+    }
+
+    // each persist is one record, so a record cut short by a crash can be told apart and dropped as a whole
+    QByteArray recordData = QJsonDocument::fromVariant(changes).toJson(QJsonDocument::Compact);
+    QDataStream journalStream(&_journalFile);
+    journalStream << recordData << qChecksum(recordData.constData(), recordData.size());
+
+    if (journalStream.status() != QDataStream::Ok || !_journalFile.flush()) {
+        qCritical() << "Could not append to journal" << _journalFile.fileName() << "-- saving in full instead.";
+        _journalFile.close();
+        return false;
+    }
+
+    qCDebug(octree) << "journaled" << changes.size() << "changes to" << _journalFile.fileName();
+    return true;
+}
+
+bool OctreePersistThread::writeSnapshot() {
+    QVariantMap entityDescription;
+    bool described = false;
+
+    _tree->withReadLock([&] {
+        // the journal starts over from this save, so the edits it would have recorded are dropped
+        QVariantList changes;
+        _tree->writeJournalChanges(changes);
+
+        _tree->setPersistID(QUuid::createUuid());
+        described = _tree->writeToJSONDescription(entityDescription);
+        if (described) {
+            _tree->clearDirtyBit();
+        }
+    });
+
+    // the description is a copy of the tree's entities, so converting, compressing and writing it doesn't
+    // keep edits waiting on the tree
+    bool written = false;
+    if (described) {
+        if (_persistAsFileType == "bin") {
+            written = Octree::writeBinaryDescriptionToFile(entityDescription, _filename);
+        } else {
+            written = Octree::writeJSONDescriptionToFile(entityDescription, _filename, _persistAsFileType == "json.gz");
+        }
+    }
+    if (!written) {
+        qCritical() << "Could not save" << _filename << "-- will try again next persist.";
+        _tree->setDirtyBit();
+        _journalFile.close(); // the next persist has to save in full
+        return false;
+    }
+
+    _snapshotBytes = QFileInfo(_filename).size();
+    resetJournal(false);
+    return true;
+}
+
+bool OctreePersistThread::replayJournal(const QString& loadedFileName) {
+    QFile journalFile(loadedFileName + JOURNAL_EXTENSION);
+    if (!journalFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream journalStream(&journalFile);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QUuid persistID;
+    journalStream >> magic >> version >> persistID;
+
+    if (journalStream.status() != QDataStream::Ok || magic != JOURNAL_MAGIC || version != JOURNAL_VERSION) {
+        qCDebug(octree) << "Ignoring unreadable journal" << journalFile.fileName();
+        return false;
+    }
+
+    // a journal left behind by a crash between writing a full save and starting the journal over, or one that
+    // extends a save that was replaced by a backup, doesn't apply to what was loaded
+    if (persistID.isNull() || persistID != _tree->getPersistID()) {
+        qCDebug(octree) << "Ignoring journal" << journalFile.fileName() << "which doesn't extend" << loadedFileName;
+        return false;
+    }
+
+    int recordsReplayed = 0;
+    int changesReplayed = 0;
+    while (!journalStream.atEnd()) {
+        QByteArray recordData;
+        quint16 checksum = 0;
+        journalStream >> recordData >> checksum;
+
+        if (journalStream.status() != QDataStream::Ok || checksum != qChecksum(recordData.constData(), recordData.size())) {
+            qCDebug(octree) << "Journal" << journalFile.fileName() << "ends with an incomplete record, which was dropped";
+            return false;
+        }
+
+        QVariantList changes = QJsonDocument::fromJson(recordData).toVariant().toList();
+        _tree->readJournalChanges(changes);
+
+        recordsReplayed++;
+        changesReplayed += changes.size();
+    }
+
+    qCDebug(octree) << "Replayed" << changesReplayed << "changes in" << recordsReplayed << "records from journal"
+        << journalFile.fileName();
+    return true;
+}
+
+void OctreePersistThread::resetJournal(bool append) {
+    _journalFile.close();
+    _journalFile.setFileName(_filename + JOURNAL_EXTENSION);
+
+    QIODevice::OpenMode openMode = QIODevice::WriteOnly | (append ? QIODevice::Append : QIODevice::Truncate);
+    if (!_journalFile.open(openMode)) {
+        qCritical() << "Could not open journal" << _journalFile.fileName() << "-- every persist will save in full.";
+        return;
+    }
+
+    if (!append) {
+        QDataStream journalStream(&_journalFile);
+        journalStream << JOURNAL_MAGIC << JOURNAL_VERSION << _tree->getPersistID();
+        _journalFile.flush();
+    }
+}
+
+bool OctreePersistThread::isBackupDue() const {
+    if (_wantBackup) {
+        quint64 now = usecTimestampNow();
+        foreach (const BackupRule& rule, _backupRules) {
+            if (rule.maxBackupVersions > 0 && now - rule.lastBackup > (quint64)rule.interval * USECS_PER_SECOND) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 void OctreePersistThread::restoreFromMostRecentBackup() {
     qCDebug(octree) << "Restoring from most recent backup...";
     
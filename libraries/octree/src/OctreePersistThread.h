@@ -14,6 +14,7 @@
 #ifndef hifi_OctreePersistThread_h
 #define hifi_OctreePersistThread_h
 
+#include <QFile>
 #include <QString>
 #include <GenericThread.h>
 #include "Octree.h"
@@ -54,12 +55,18 @@ protected:
     virtual bool process();
 
     void persist();
+    bool appendToJournal();
+    bool writeSnapshot();
+    bool replayJournal(const QString& loadedFileName);
+    void resetJournal(bool append);
+    bool isBackupDue() const;
     void backup();
     void rollOldBackupVersions(const BackupRule& rule);
     void restoreFromMostRecentBackup();
     bool getMostRecentBackup(const QString& format, QString& mostRecentBackupFileName, QDateTime& mostRecentBackupTime);
     quint64 getMostRecentBackupTimeInUsecs(const QString& format);
     void parseSettings(const QJsonObject& settings);
+    QByteArray writeTreeContents() const;
 
 private:
     OctreePointer _tree;
@@ -78,6 +85,12 @@ private:
     quint64 _lastTimeDebug;
 
     QString _persistAsFileType;
+
+    // saves are journaled: each persist appends the edits since the last one to the journal, and the
+    // full file is only rewritten once the journal has grown, a backup is due, or the tree can't journal
+    bool _wantJournal;
+    QFile _journalFile;
+    qint64 _snapshotBytes;
 };
 
 #endif // hifi_OctreePersistThread_h
@@ -155,6 +155,7 @@ public:
     quint64 getTotalInternal() const { return _totalInternal; }
     quint64 getTotalLeaves() const { return _totalLeaves; }
     quint64 getTotalEncodeTime() const { return _totalEncodeTime; }
+    quint64 getTraversed() const { return _traversed; }
     quint64 getElapsedTime() const { return _elapsed; }
 
     quint64 getLastFullElapsedTime() const { return _lastFullElapsed; }
@@ -0,0 +1,102 @@
+//
+//  CPUDetect.h
+//  libraries/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_CPUDetect_h
+#define hifi_CPUDetect_h
+
+//
+// Detect AVX/AVX2 support, for runtime dispatch to code compiled in src/avx and src/avx2
+//
+// Unlike CPUIdent this works on every platform, and also checks that the OS saves the AVX registers.
+//
+
+#if defined(_MSC_VER)
+
+#include <intrin.h>
+
+static inline bool cpuSupportsAVX() {
+    int info[4];
+    int mask = (1 << 27) | (1 << 28);   // OSXSAVE and AVX
+
+    __cpuidex(info, 0x1, 0);
+
+    bool result = false;
+    if ((info[2] & mask) == mask) {
+
+        if ((_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) == 0x6) {
+            result = true;
+        }
+    }
+    return result;
+}
+
+static inline bool cpuSupportsAVX2() {
+    int info[4];
+    int mask = (1 << 5);    // AVX2
+
+    bool result = false;
+    if (cpuSupportsAVX()) {
+
+        __cpuidex(info, 0x7, 0);
+
+        if ((info[1] & mask) == mask) {
+            result = true;
+        }
+    }
+    return result;
+}
+
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+
+#include <cpuid.h>
+
+static inline bool cpuSupportsAVX() {
+    unsigned int eax, ebx, ecx, edx;
+    unsigned int mask = (1 << 27) | (1 << 28);   // OSXSAVE and AVX
+
+    bool result = false;
+    if (__get_cpuid(0x1, &eax, &ebx, &ecx, &edx) && ((ecx & mask) == mask)) {
+
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        if ((eax & 0x6) == 0x6) {
+            result = true;
+        }
+    }
+    return result;
+}
+
+static inline bool cpuSupportsAVX2() {
+    unsigned int eax, ebx, ecx, edx;
+    unsigned int mask = (1 << 5);   // AVX2
+
+    bool result = false;
+    if (cpuSupportsAVX() && __get_cpuid_max(0, nullptr) >= 0x7) {
+
+        __cpuid_count(0x7, 0, eax, ebx, ecx, edx);
+        if ((ebx & mask) == mask) {
+            result = true;
+        }
+    }
+    return result;
+}
+
+#else
+
+static inline bool cpuSupportsAVX() {
+    return false;
+}
+
+static inline bool cpuSupportsAVX2() {
+    return false;
+}
+
+#endif
+
+#endif // hifi_CPUDetect_h
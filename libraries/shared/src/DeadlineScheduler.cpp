@@ -0,0 +1,164 @@
+//
+//  DeadlineScheduler.cpp
+//  libraries/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "DeadlineScheduler.h"
+
+const DeadlineScheduler::TimePoint DeadlineScheduler::NEVER = DeadlineScheduler::TimePoint::max();
+
+DeadlineScheduler::DeadlineScheduler(int numThreads) :
+    _statsStart(Clock::now().time_since_epoch().count())
+{
+    for (int i = 0; i < numThreads; ++i) {
+        _threads.emplace_back(&DeadlineScheduler::schedulerThread, this);
+    }
+}
+
+DeadlineScheduler::~DeadlineScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _deadlineCondition.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void DeadlineScheduler::add(Task* task, TimePoint firstDeadline) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Registration registration;
+    registration.id = _nextID++;
+    auto it = _tasks.emplace(task, registration).first;
+
+    if (firstDeadline != NEVER) {
+        schedule(task, it->second, firstDeadline);
+    }
+}
+
+void DeadlineScheduler::remove(Task* task) {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto it = _tasks.find(task);
+    if (it == _tasks.end()) {
+        return;
+    }
+
+    _runningCondition.wait(lock, [&]{ return !it->second.isRunning; });
+
+    // its deadlines are skipped from now on, since they no longer match a registration
+    _tasks.erase(it);
+}
+
+void DeadlineScheduler::wake(Task* task) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _tasks.find(task);
+    if (it == _tasks.end()) {
+        return;
+    }
+
+    if (it->second.isRunning) {
+        it->second.isWakeRequested = true;
+    } else {
+        schedule(task, it->second, Clock::now());
+    }
+}
+
+float DeadlineScheduler::getUtilization() const {
+    auto elapsed = Clock::now() - TimePoint(Clock::duration(_statsStart.load()));
+    auto elapsedUsecs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    if (elapsedUsecs <= 0 || _threads.empty()) {
+        return 0.0f;
+    }
+    return (float)_busyUsecs / ((float)elapsedUsecs * (float)_threads.size());
+}
+
+float DeadlineScheduler::getAverageRunUsecs() const {
+    uint64_t runs = _runs;
+    return runs > 0 ? (float)_busyUsecs / (float)runs : 0.0f;
+}
+
+void DeadlineScheduler::resetStats() {
+    _statsStart = Clock::now().time_since_epoch().count();
+    _busyUsecs = 0;
+    _runs = 0;
+}
+
+void DeadlineScheduler::schedule(Task* task, Registration& registration, TimePoint deadline) {
+    if (deadline >= registration.deadline) {
+        // it is already due by then
+        return;
+    }
+
+    registration.deadline = deadline;
+    _deadlines.push({ deadline, task, registration.id });
+
+    // a thread may be waiting on a later deadline
+    _deadlineCondition.notify_one();
+}
+
+void DeadlineScheduler::schedulerThread() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_isStopping) {
+        if (_deadlines.empty()) {
+            _deadlineCondition.wait(lock);
+            continue;
+        }
+
+        Deadline next = _deadlines.top();
+
+        auto it = _tasks.find(next.task);
+        if (it == _tasks.end() || it->second.id != next.id || it->second.deadline != next.time
+            || it->second.isRunning) {
+            // stale - the task was removed, or its deadline has moved since this was pushed
+            _deadlines.pop();
+            continue;
+        }
+
+        auto now = Clock::now();
+        if (next.time > now) {
+            _deadlineCondition.wait_until(lock, next.time);
+            continue;
+        }
+
+        _deadlines.pop();
+
+        Registration& registration = it->second;
+        registration.deadline = NEVER;
+        registration.isRunning = true;
+        registration.isWakeRequested = false;
+
+        lock.unlock();
+
+        TimePoint nextDeadline = next.task->runScheduledTask(next.time, now);
+
+        auto end = Clock::now();
+        _busyUsecs += std::chrono::duration_cast<std::chrono::microseconds>(end - now).count();
+        _runs++;
+
+        lock.lock();
+
+        // remove waits for a running task, so the registration is still ours
+        registration.isRunning = false;
+        if (registration.isWakeRequested) {
+            registration.isWakeRequested = false;
+            nextDeadline = std::min(nextDeadline, end);
+        }
+
+        if (nextDeadline != NEVER) {
+            schedule(next.task, registration, nextDeadline);
+        }
+
+        _runningCondition.notify_all();
+    }
+}
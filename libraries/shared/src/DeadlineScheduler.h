@@ -0,0 +1,106 @@
+//
+//  DeadlineScheduler.h
+//  libraries/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_DeadlineScheduler_h
+#define hifi_DeadlineScheduler_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "PortableHighResolutionClock.h"
+
+/// Runs many tasks on a small, fixed pool of threads. Each task is run when the deadline it asked for comes up, or
+/// as soon as it is woken, and the task whose deadline is the oldest always goes next. A task is only ever run by
+/// one thread at a time.
+class DeadlineScheduler {
+public:
+    using Clock = p_high_resolution_clock;
+    using TimePoint = Clock::time_point;
+
+    // a task that asks for this is only run again once it is woken
+    static const TimePoint NEVER;
+
+    class Task {
+    public:
+        virtual ~Task() {}
+
+        /// does whatever is due, and returns when the task next needs to run
+        /// deadline is when this run was due, now is when it started
+        virtual TimePoint runScheduledTask(TimePoint deadline, TimePoint now) = 0;
+    };
+
+    DeadlineScheduler(int numThreads);
+
+    // every task must have been removed by the time the scheduler is destroyed
+    ~DeadlineScheduler();
+
+    void add(Task* task, TimePoint firstDeadline = NEVER);
+
+    // once this returns the task is not being run, and never will be again
+    // a task must not remove itself from its own run, since this waits for that run to be over
+    void remove(Task* task);
+
+    // runs the task as soon as a thread is free, or right after its current run if it is running now
+    void wake(Task* task);
+
+    int getNumThreads() const { return (int) _threads.size(); }
+
+    /// Fraction of the threads' time spent running tasks since the stats were last reset
+    float getUtilization() const;
+    uint64_t getRuns() const { return _runs; }
+    float getAverageRunUsecs() const;
+    void resetStats();
+
+private:
+    struct Registration {
+        uint64_t id;
+        TimePoint deadline { NEVER };
+        bool isRunning { false };
+        bool isWakeRequested { false };
+    };
+
+    struct Deadline {
+        TimePoint time;
+        Task* task;
+        uint64_t id;
+
+        // the earliest deadline goes on top
+        bool operator<(const Deadline& other) const { return time > other.time; }
+    };
+
+    void schedule(Task* task, Registration& registration, TimePoint deadline);
+    void schedulerThread();
+
+    std::mutex _mutex;
+    std::condition_variable _deadlineCondition; // a new deadline is up first, or we are stopping
+    std::condition_variable _runningCondition; // a task finished a run
+
+    std::unordered_map<Task*, Registration> _tasks;
+
+    // deadlines that were moved or belong to removed tasks are left here, and skipped when they come up
+    std::priority_queue<Deadline> _deadlines;
+
+    uint64_t _nextID { 0 };
+    bool _isStopping { false };
+
+    std::vector<std::thread> _threads;
+
+    std::atomic<TimePoint::rep> _statsStart;
+    std::atomic<uint64_t> _busyUsecs { 0 };
+    std::atomic<uint64_t> _runs { 0 };
+};
+
+#endif // hifi_DeadlineScheduler_h
@@ -0,0 +1,101 @@
+//
+//  FrameWorkerPool.cpp
+//  libraries/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FrameWorkerPool.h"
+
+#include <algorithm>
+
+FrameWorkerPool::~FrameWorkerPool() {
+    stop();
+}
+
+int FrameWorkerPool::resolveNumThreads(int numThreads) {
+    if (numThreads <= 0) {
+        return std::max(1, (int) std::thread::hardware_concurrency());
+    }
+    return numThreads;
+}
+
+void FrameWorkerPool::start(int numThreads) {
+    stop();
+
+    _numThreads = resolveNumThreads(numThreads);
+
+    // a single thread runs frames on the calling thread, so only spin up threads if we have more than one
+    if (_numThreads > 1) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = false;
+
+        // threads started after a restart must wait for the next frame, not take the last one as theirs
+        for (int i = 0; i < _numThreads; ++i) {
+            _threads.emplace_back(&FrameWorkerPool::workerThread, this, i, _frame);
+        }
+    }
+}
+
+void FrameWorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _frameCondition.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+    _numThreads = 0;
+}
+
+void FrameWorkerPool::runFrame(const FrameFunction& frameFunction) {
+    if (_threads.empty()) {
+        if (_numThreads > 0) {
+            frameFunction(0);
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    // wake up the threads for this frame
+    _frameFunction = &frameFunction;
+    _numThreadsRunning = (int) _threads.size();
+    ++_frame;
+    _frameCondition.notify_all();
+
+    // and wait for all of them to have finished with it
+    _doneCondition.wait(lock, [&]{ return _numThreadsRunning == 0; });
+    _frameFunction = nullptr;
+}
+
+void FrameWorkerPool::workerThread(int threadIndex, int lastFrame) {
+    while (true) {
+        const FrameFunction* frameFunction;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _frameCondition.wait(lock, [&]{ return _isStopping || _frame != lastFrame; });
+
+            if (_isStopping) {
+                return;
+            }
+
+            lastFrame = _frame;
+            frameFunction = _frameFunction;
+        }
+
+        (*frameFunction)(threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_numThreadsRunning;
+        }
+        _doneCondition.notify_one();
+    }
+}
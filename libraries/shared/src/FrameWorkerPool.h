@@ -0,0 +1,56 @@
+//
+//  FrameWorkerPool.h
+//  libraries/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FrameWorkerPool_h
+#define hifi_FrameWorkerPool_h
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A fixed set of threads that each run the same function once per frame, for servers that split the work of a
+/// frame between workers. With a single thread the function runs on the calling thread instead.
+class FrameWorkerPool {
+public:
+    /// called once per frame on every thread, with the index of that thread
+    using FrameFunction = std::function<void(int threadIndex)>;
+
+    ~FrameWorkerPool();
+
+    /// 0 resolves to one thread per hardware thread
+    static int resolveNumThreads(int numThreads);
+
+    /// must not be called while a frame is running
+    void start(int numThreads);
+    void stop();
+
+    int numThreads() const { return _numThreads; }
+
+    /// runs the function on every thread, blocking until all of them are done with it
+    void runFrame(const FrameFunction& frameFunction);
+
+private:
+    void workerThread(int threadIndex, int lastFrame);
+
+    int _numThreads { 0 };
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _frameCondition; // threads wait on this for the next frame
+    std::condition_variable _doneCondition; // runFrame waits on this for the threads to finish a frame
+    int _frame { 0 };
+    int _numThreadsRunning { 0 };
+    bool _isStopping { false };
+    const FrameFunction* _frameFunction { nullptr };
+};
+
+#endif // hifi_FrameWorkerPool_h
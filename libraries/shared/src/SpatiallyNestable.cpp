@@ -16,6 +16,7 @@
 
 const float defaultAACubeSize = 1.0f;
 const int maxParentingChain = 30;
+const quint16 noParentJoint = (quint16)-1;
 
 SpatiallyNestable::SpatiallyNestable(NestableType nestableType, QUuid id) :
     _nestableType(nestableType),
@@ -49,12 +50,17 @@ const QUuid SpatiallyNestable::getParentID() const {
 }
 
 void SpatiallyNestable::setParentID(const QUuid& parentID) {
+    bool changed = false;
     _idLock.withWriteLock([&] {
         if (_parentID != parentID) {
             _parentID = parentID;
             _parentKnowsMe = false;
+            changed = true;
         }
     });
+    if (changed) {
+        markWorldTransformsDirty();
+    }
 }
 
 Transform SpatiallyNestable::getParentTransform(bool& success, int depth) const {
@@ -131,7 +137,10 @@ void SpatiallyNestable::forgetChild(SpatiallyNestablePointer newChild) const {
 }
 
 void SpatiallyNestable::setParentJointIndex(quint16 parentJointIndex) {
-    _parentJointIndex = parentJointIndex;
+    if (_parentJointIndex != parentJointIndex) {
+        _parentJointIndex = parentJointIndex;
+        markWorldTransformsDirty();
+    }
 }
 
 glm::vec3 SpatiallyNestable::worldToLocal(const glm::vec3& position,
@@ -319,6 +328,7 @@ void SpatiallyNestable::setPosition(const glm::vec3& position, bool& success, bo
         Transform::mult(myWorldTransform, parentTransform, _transform);
         myWorldTransform.setTranslation(position);
         Transform::inverseMult(_transform, parentTransform, myWorldTransform);
+        markWorldTransformDirty();
     });
     if (success) {
         locationChanged(tellPhysics);
@@ -369,6 +379,7 @@ void SpatiallyNestable::setOrientation(const glm::quat& orientation, bool& succe
         Transform::mult(myWorldTransform, parentTransform, _transform);
         myWorldTransform.setRotation(orientation);
         Transform::inverseMult(_transform, parentTransform, myWorldTransform);
+        markWorldTransformDirty();
     });
     if (success) {
         locationChanged(tellPhysics);
@@ -505,14 +516,81 @@ glm::vec3 SpatiallyNestable::getParentAngularVelocity(bool& success) const {
 
 const Transform SpatiallyNestable::getTransform(bool& success, int depth) const {
     Transform result;
+    bool isCached = false;
+    quint32 generation = 0;
+    _transformLock.withReadLock([&] {
+        // a transform that was relative to a parent which has since been deleted is no good
+        if (_worldTransformCached && !(_worldTransformHasParent && _parent.expired())) {
+            result = _worldTransform;
+            isCached = true;
+        }
+        generation = _worldTransformGeneration;
+    });
+    if (isCached) {
+        success = true;
+        return result;
+    }
+
     // return a world-space transform for this object's location
     Transform parentTransform = getParentTransform(success, depth);
+    bool hasParent = false;
+    if (success && canCacheWorldTransform(hasParent)) {
+        _transformLock.withWriteLock([&] {
+            Transform::mult(result, parentTransform, _transform);
+            if (generation == _worldTransformGeneration) {
+                _worldTransform = result;
+                _worldTransformCached = true;
+                _worldTransformHasParent = hasParent;
+            }
+        });
+    } else {
+        _transformLock.withReadLock([&] {
+            Transform::mult(result, parentTransform, _transform);
+        });
+    }
+    return result;
+}
+
+bool SpatiallyNestable::hasCachedWorldTransform() const {
+    bool result = false;
     _transformLock.withReadLock([&] {
-        Transform::mult(result, parentTransform, _transform);
+        result = _worldTransformCached;
     });
     return result;
 }
 
+bool SpatiallyNestable::canCacheWorldTransform(bool& hasParent) const {
+    // called once the parent transform has been found, so the parent pointer is up-to-date
+    SpatiallyNestablePointer parent = _parent.lock();
+    hasParent = (bool)parent;
+    if (!parent) {
+        return true;
+    }
+
+    // the parent's joints may move without anyone being told
+    if (_parentJointIndex != noParentJoint && !parent->locationChangedTracksJoints()) {
+        return false;
+    }
+
+    return parent->hasCachedWorldTransform();
+}
+
+void SpatiallyNestable::markWorldTransformDirty() const {
+    _worldTransformCached = false;
+    _worldTransformGeneration++;
+}
+
+void SpatiallyNestable::markWorldTransformsDirty() {
+    _transformLock.withWriteLock([&] {
+        markWorldTransformDirty();
+    });
+    forEachDescendant([&](SpatiallyNestablePointer descendant) {
+        descendant->_transformLock.withWriteLock([&] {
+            descendant->markWorldTransformDirty();
+        });
+    });
+}
+
 const Transform SpatiallyNestable::getTransform(int jointIndex, bool& success, int depth) const {
     // this returns the world-space transform for this object.  It finds its parent's transform (which may
     // cause this object's parent to query its parent, etc) and multiplies this object's local transform onto it.
@@ -552,6 +630,7 @@ void SpatiallyNestable::setTransform(const Transform& transform, bool& success)
     Transform parentTransform = getParentTransform(success);
     _transformLock.withWriteLock([&] {
         Transform::inverseMult(_transform, parentTransform, transform);
+        markWorldTransformDirty();
     });
     if (success) {
         locationChanged();
@@ -581,6 +660,7 @@ void SpatiallyNestable::setScale(const glm::vec3& scale) {
     // TODO: scale
     _transformLock.withWriteLock([&] {
         _transform.setScale(scale);
+        markWorldTransformDirty();
     });
     dimensionsChanged();
 }
@@ -601,6 +681,7 @@ void SpatiallyNestable::setLocalTransform(const Transform& transform) {
     }
     _transformLock.withWriteLock([&] {
         _transform = transform;
+        markWorldTransformDirty();
     });
     locationChanged();
 }
@@ -621,6 +702,7 @@ void SpatiallyNestable::setLocalPosition(const glm::vec3& position, bool tellPhy
     }
     _transformLock.withWriteLock([&] {
         _transform.setTranslation(position);
+        markWorldTransformDirty();
     });
     locationChanged(tellPhysics);
 }
@@ -641,6 +723,7 @@ void SpatiallyNestable::setLocalOrientation(const glm::quat& orientation) {
     }
     _transformLock.withWriteLock([&] {
         _transform.setRotation(orientation);
+        markWorldTransformDirty();
     });
     locationChanged();
 }
@@ -691,6 +774,7 @@ void SpatiallyNestable::setLocalScale(const glm::vec3& scale) {
     // TODO: scale
     _transformLock.withWriteLock([&] {
         _transform.setScale(scale);
+        markWorldTransformDirty();
     });
     dimensionsChanged();
 }
@@ -755,6 +839,10 @@ void SpatiallyNestable::forEachDescendant(std::function<void(SpatiallyNestablePo
 }
 
 void SpatiallyNestable::locationChanged(bool tellPhysics) {
+    // this is also how a move reaches the world transforms cached by the descendants
+    _transformLock.withWriteLock([&] {
+        markWorldTransformDirty();
+    });
     forEachChild([&](SpatiallyNestablePointer object) {
         object->locationChanged(tellPhysics);
     });
@@ -892,6 +980,7 @@ void SpatiallyNestable::setLocalTransformAndVelocities(
     // transform
     _transformLock.withWriteLock([&] {
         _transform = localTransform;
+        markWorldTransformDirty();
     });
     // linear velocity
     _velocityLock.withWriteLock([&] {
@@ -169,6 +169,13 @@ protected:
     virtual void locationChanged(bool tellPhysics = true); // called when a this object's location has changed
     virtual void dimensionsChanged() { } // called when a this object's dimensions have changed
 
+    // true if locationChanged() is called whenever this object's joints move, which lets children that are attached
+    // to a joint keep their world transforms cached in between
+    virtual bool locationChangedTracksJoints() const { return false; }
+
+    // drops the cached world transforms of this object and all of its descendants
+    void markWorldTransformsDirty();
+
     // _queryAACube is used to decide where something lives in the octree
     mutable AACube _queryAACube;
     mutable bool _queryAACubeSet { false };
@@ -185,6 +192,18 @@ private:
     glm::vec3 _angularVelocity;
     mutable bool _parentKnowsMe { false };
     bool _isDead { false };
+
+    void markWorldTransformDirty() const; // _transformLock must be held for writing
+    bool hasCachedWorldTransform() const;
+    bool canCacheWorldTransform(bool& hasParent) const;
+
+    // the world transform is cached under _transformLock until this object or one of its ancestors moves.  the
+    // generation goes up each time the cache is dropped, so that a transform computed from an ancestor that moved
+    // in the meantime is not stored.
+    mutable Transform _worldTransform;
+    mutable bool _worldTransformCached { false };
+    mutable bool _worldTransformHasParent { false };
+    mutable quint32 _worldTransformGeneration { 0 };
 };
 
 
@@ -669,3 +669,68 @@ void ViewFrustum::invalidate() {
     }
     _centerSphereRadius = -1.0e6f; // -10^6 should be negative enough
 }
+
+QByteArray ViewFrustum::toByteArray() const {
+    static const int LARGE_ENOUGH = 1024;
+    QByteArray viewFrustumDataByteArray(LARGE_ENOUGH, 0);
+    unsigned char* destinationBuffer = reinterpret_cast<unsigned char*>(viewFrustumDataByteArray.data());
+    unsigned char* startPosition = destinationBuffer;
+
+    // camera details
+    memcpy(destinationBuffer, &_position, sizeof(_position));
+    destinationBuffer += sizeof(_position);
+    destinationBuffer += packOrientationQuatToBytes(destinationBuffer, _orientation);
+
+    // lens details
+    destinationBuffer += packFloatAngleToTwoByte(destinationBuffer, _fieldOfView);
+    destinationBuffer += packFloatRatioToTwoByte(destinationBuffer, _aspectRatio);
+    destinationBuffer += packClipValueToTwoByte(destinationBuffer, _nearClip);
+    destinationBuffer += packClipValueToTwoByte(destinationBuffer, _farClip);
+    memcpy(destinationBuffer, &_centerSphereRadius, sizeof(_centerSphereRadius));
+    destinationBuffer += sizeof(_centerSphereRadius);
+
+    return viewFrustumDataByteArray.left(destinationBuffer - startPosition);
+}
+
+int ViewFrustum::fromByteArray(const QByteArray& input) {
+    // position, packed orientation, four packed lens values and the center radius
+    const int MIN_BYTES = sizeof(glm::vec3) + 4 * sizeof(uint16_t) + 4 * sizeof(uint16_t) + sizeof(float);
+    if (input.size() < MIN_BYTES) {
+        return 0;
+    }
+
+    const unsigned char* startPosition = reinterpret_cast<const unsigned char*>(input.constData());
+    const unsigned char* sourceBuffer = startPosition;
+
+    // camera details
+    glm::vec3 cameraPosition;
+    glm::quat cameraOrientation;
+    float cameraCenterRadius;
+    memcpy(&cameraPosition, sourceBuffer, sizeof(cameraPosition));
+    sourceBuffer += sizeof(cameraPosition);
+    sourceBuffer += unpackOrientationQuatFromBytes(sourceBuffer, cameraOrientation);
+
+    // lens details
+    float cameraFov;
+    float cameraAspectRatio;
+    float cameraNearClip;
+    float cameraFarClip;
+    sourceBuffer += unpackFloatAngleFromTwoByte(reinterpret_cast<const uint16_t*>(sourceBuffer), &cameraFov);
+    sourceBuffer += unpackFloatRatioFromTwoByte(sourceBuffer, cameraAspectRatio);
+    sourceBuffer += unpackClipValueFromTwoByte(sourceBuffer, cameraNearClip);
+    sourceBuffer += unpackClipValueFromTwoByte(sourceBuffer, cameraFarClip);
+    memcpy(&cameraCenterRadius, sourceBuffer, sizeof(cameraCenterRadius));
+    sourceBuffer += sizeof(cameraCenterRadius);
+
+    setPosition(cameraPosition);
+    setOrientation(cameraOrientation);
+    setCenterRadius(cameraCenterRadius);
+
+    // only take the lens if it makes a valid projection
+    if (0.0f != cameraAspectRatio && 0.0f != cameraNearClip && 0.0f != cameraFarClip && cameraNearClip != cameraFarClip) {
+        setProjection(glm::perspective(glm::radians(cameraFov), cameraAspectRatio, cameraNearClip, cameraFarClip));
+        calculate();
+    }
+
+    return sourceBuffer - startPosition;
+}
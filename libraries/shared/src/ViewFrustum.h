@@ -136,6 +136,10 @@ public:
     const ::Plane* getPlanes() const { return _planes; }
 
     void invalidate(); // causes all reasonable intersection tests to fail
+
+    // the camera and lens of the frustum, packed to be sent to a server that wants to know what we can see
+    QByteArray toByteArray() const;
+    int fromByteArray(const QByteArray& input);
 private:
     glm::mat4 _view;
     glm::mat4 _projection;
@@ -0,0 +1,121 @@
+//
+//  AudioCodecTests.cpp
+//  tests/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioCodecTests.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <ADPCMCodec.h>
+#include <AudioConstants.h>
+#include <NumericalConstants.h>
+
+QTEST_MAIN(AudioCodecTests)
+
+// a stereo network frame of two tones, left and right at different frequencies
+static QByteArray stereoTestFrame(int frameIndex) {
+    QByteArray frame(AudioConstants::NETWORK_FRAME_BYTES_STEREO, 0);
+    int16_t* samples = reinterpret_cast<int16_t*>(frame.data());
+
+    const float AMPLITUDE = 8000.0f;
+    for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL; ++i) {
+        float t = (float)(frameIndex * AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL + i) / AudioConstants::SAMPLE_RATE;
+        samples[2 * i] = (int16_t)(AMPLITUDE * sinf(TWO_PI * 440.0f * t));
+        samples[2 * i + 1] = (int16_t)(AMPLITUDE * sinf(TWO_PI * 660.0f * t));
+    }
+
+    return frame;
+}
+
+void AudioCodecTests::selectCodecTest() {
+    QStringList names = AudioCodecs::getCodecNames();
+    QVERIFY(names.contains(ADPCMCodec::NAME));
+    QCOMPARE(names.last(), AudioCodecs::PCM_CODEC_NAME);
+
+    // the first preferred codec that was offered wins
+    auto codec = AudioCodecs::selectCodec({ ADPCMCodec::NAME, AudioCodecs::PCM_CODEC_NAME },
+                                          { AudioCodecs::PCM_CODEC_NAME, ADPCMCodec::NAME });
+    QCOMPARE(codec->getName(), ADPCMCodec::NAME);
+
+    // nothing in common, or nothing we know, is PCM
+    codec = AudioCodecs::selectCodec({ ADPCMCodec::NAME }, { "not-a-codec" });
+    QCOMPARE(codec->getName(), AudioCodecs::PCM_CODEC_NAME);
+    QVERIFY(!codec->createEncoder());
+    QVERIFY(!codec->createDecoder());
+}
+
+void AudioCodecTests::roundTripTest() {
+    auto codec = AudioCodecs::getCodec(ADPCMCodec::NAME);
+    QVERIFY(codec);
+
+    auto encoder = codec->createEncoder();
+    auto decoder = codec->createDecoder();
+
+    const int NUM_FRAMES = 10;
+    for (int frameIndex = 0; frameIndex < NUM_FRAMES; ++frameIndex) {
+        QByteArray frame = stereoTestFrame(frameIndex);
+
+        QByteArray encoded;
+        encoder->encode(frame, 2, encoded);
+        QVERIFY(encoded.size() < frame.size() / 3);
+        QCOMPARE(decoder->getNumDecodedSamples(encoded), AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+
+        QByteArray decoded;
+        QVERIFY(decoder->decode(encoded, decoded));
+        QCOMPARE(decoded.size(), frame.size());
+
+        // once the step size has adapted the error should be well below the signal
+        const int16_t* original = reinterpret_cast<const int16_t*>(frame.constData());
+        const int16_t* result = reinterpret_cast<const int16_t*>(decoded.constData());
+
+        double signalPower = 0.0;
+        double errorPower = 0.0;
+        for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_STEREO; ++i) {
+            double error = original[i] - result[i];
+            signalPower += (double)original[i] * original[i];
+            errorPower += error * error;
+        }
+
+        if (frameIndex > 0) {
+            const double MIN_SNR_DB = 30.0;
+            QVERIFY(10.0 * log10(signalPower / std::max(errorPower, 1.0)) > MIN_SNR_DB);
+        }
+    }
+
+    // raw frames are never read as encoded ones, so frames sent before a switch still play
+    QCOMPARE(decoder->getNumDecodedSamples(stereoTestFrame(0)), 0);
+    QCOMPARE(decoder->getNumDecodedSamples(QByteArray(AudioConstants::NETWORK_FRAME_BYTES_PER_CHANNEL, 1)), 0);
+}
+
+void AudioCodecTests::encodeBenchmark() {
+    auto encoder = AudioCodecs::getCodec(ADPCMCodec::NAME)->createEncoder();
+    QByteArray frame = stereoTestFrame(0);
+    QByteArray encoded;
+
+    QBENCHMARK {
+        encoder->encode(frame, 2, encoded);
+    }
+
+    qDebug() << "Frame deadline is" << AudioConstants::NETWORK_FRAME_USECS << "usecs, for every listener of the mixer";
+}
+
+void AudioCodecTests::decodeBenchmark() {
+    auto codec = AudioCodecs::getCodec(ADPCMCodec::NAME);
+    auto encoder = codec->createEncoder();
+    auto decoder = codec->createDecoder();
+
+    QByteArray encoded;
+    encoder->encode(stereoTestFrame(0), 2, encoded);
+    QByteArray decoded;
+
+    QBENCHMARK {
+        decoder->decode(encoded, decoded);
+    }
+}
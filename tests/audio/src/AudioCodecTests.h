@@ -0,0 +1,30 @@
+//
+//  AudioCodecTests.h
+//  tests/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioCodecTests_h
+#define hifi_AudioCodecTests_h
+
+#include <QtTest/QtTest>
+
+class AudioCodecTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test that codecs are selected in the preferred order, falling back to PCM
+    void selectCodecTest();
+
+    // Test that an encoded frame decodes close to the original, and raw PCM is never mistaken for one
+    void roundTripTest();
+
+    // Benchmark encoding and decoding a stereo mix frame, which has to fit in the mixer's frame deadline
+    void encodeBenchmark();
+    void decodeBenchmark();
+};
+
+#endif // hifi_AudioCodecTests_h
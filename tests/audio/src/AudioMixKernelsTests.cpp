@@ -0,0 +1,198 @@
+//
+//  AudioMixKernelsTests.cpp
+//  tests/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AudioMixKernelsTests.h"
+
+#include <AudioConstants.h>
+#include <AudioMixKernels.h>
+
+QTEST_MAIN(AudioMixKernelsTests)
+
+using namespace AudioMixKernels;
+
+Q_DECLARE_METATYPE(AudioMixKernels::Implementation)
+
+static const Implementation ALL_IMPLEMENTATIONS[] = {
+    Implementation::Portable, Implementation::SSE2, Implementation::AVX2
+};
+
+static const char* nameForImplementation(Implementation implementation) {
+    switch (implementation) {
+        case Implementation::SSE2:
+            return "SSE2";
+        case Implementation::AVX2:
+            return "AVX2";
+        default:
+            return "Portable";
+    }
+}
+
+// a frame of samples in [-2.0, 2.0), so that the mix has some samples to saturate
+static void fillFrame(float* samples, int numSamples) {
+    for (int i = 0; i < numSamples; ++i) {
+        samples[i] = (float)((i * 7919) % 4001 - 2000) / 1000.0f;
+    }
+}
+
+void AudioMixKernelsTests::cleanup() {
+    setImplementation(getBestImplementation());
+}
+
+void AudioMixKernelsTests::addImplementationRows() {
+    QTest::addColumn<Implementation>("implementation");
+
+    for (auto implementation : ALL_IMPLEMENTATIONS) {
+        if (setImplementation(implementation)) {
+            QTest::newRow(nameForImplementation(implementation)) << implementation;
+        }
+    }
+
+    setImplementation(getBestImplementation());
+}
+
+void AudioMixKernelsTests::matchesPortableTest() {
+    // an odd count, so that the remainder past the vector width is covered too
+    const int NUM_SAMPLES = AudioConstants::NETWORK_FRAME_SAMPLES_STEREO + 3;
+
+    float source[NUM_SAMPLES];
+    fillFrame(source, NUM_SAMPLES);
+
+    int16_t sourceInt16[NUM_SAMPLES];
+    for (int i = 0; i < NUM_SAMPLES; ++i) {
+        sourceInt16[i] = (int16_t)(source[i] * 16000.0f);
+    }
+
+    float expectedMix[2 * NUM_SAMPLES] = {};
+    float expectedConverted[NUM_SAMPLES];
+    int16_t expectedSaturated[NUM_SAMPLES];
+
+    QVERIFY(setImplementation(Implementation::Portable));
+    accumulate(source, expectedMix, 0.5f, NUM_SAMPLES);
+    accumulateMonoToStereo(source, expectedMix, 0.25f, NUM_SAMPLES);
+    convertToFloat(sourceInt16, expectedConverted, NUM_SAMPLES);
+    bool expectedNonZero = saturateToInt16(source, expectedSaturated, NUM_SAMPLES);
+
+    for (auto implementation : ALL_IMPLEMENTATIONS) {
+        if (!setImplementation(implementation)) {
+            continue;
+        }
+
+        float mix[2 * NUM_SAMPLES] = {};
+        float converted[NUM_SAMPLES];
+        int16_t saturated[NUM_SAMPLES];
+
+        accumulate(source, mix, 0.5f, NUM_SAMPLES);
+        accumulateMonoToStereo(source, mix, 0.25f, NUM_SAMPLES);
+        convertToFloat(sourceInt16, converted, NUM_SAMPLES);
+        bool nonZero = saturateToInt16(source, saturated, NUM_SAMPLES);
+
+        QVERIFY(memcmp(mix, expectedMix, sizeof(mix)) == 0);
+        QVERIFY(memcmp(converted, expectedConverted, sizeof(converted)) == 0);
+        QVERIFY(memcmp(saturated, expectedSaturated, sizeof(saturated)) == 0);
+        QCOMPARE(nonZero, expectedNonZero);
+    }
+}
+
+void AudioMixKernelsTests::saturateTest() {
+    const int NUM_SAMPLES = AudioConstants::NETWORK_FRAME_SAMPLES_STEREO;
+
+    for (auto implementation : ALL_IMPLEMENTATIONS) {
+        if (!setImplementation(implementation)) {
+            continue;
+        }
+
+        float mix[NUM_SAMPLES] = {};
+        int16_t output[NUM_SAMPLES];
+
+        QVERIFY(!saturateToInt16(mix, output, NUM_SAMPLES));
+
+        // samples this close to zero truncate to silence
+        mix[NUM_SAMPLES / 2] = 0.5f / AudioConstants::MAX_SAMPLE_VALUE;
+        QVERIFY(!saturateToInt16(mix, output, NUM_SAMPLES));
+
+        mix[1] = 4.0f;
+        mix[2] = -4.0f;
+        mix[NUM_SAMPLES - 1] = 0.5f;
+        QVERIFY(saturateToInt16(mix, output, NUM_SAMPLES));
+        QCOMPARE((int)output[1], AudioConstants::MAX_SAMPLE_VALUE);
+        QCOMPARE((int)output[2], AudioConstants::MIN_SAMPLE_VALUE);
+        QCOMPARE((int)output[NUM_SAMPLES - 1], AudioConstants::MAX_SAMPLE_VALUE / 2);
+    }
+}
+
+void AudioMixKernelsTests::accumulateBenchmark_data() {
+    addImplementationRows();
+}
+
+void AudioMixKernelsTests::accumulateBenchmark() {
+    QFETCH(Implementation, implementation);
+    QVERIFY(setImplementation(implementation));
+
+    float source[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    float mix[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO] = {};
+    fillFrame(source, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+
+    QBENCHMARK {
+        accumulate(source, mix, 0.5f, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+    }
+}
+
+void AudioMixKernelsTests::accumulateMonoToStereoBenchmark_data() {
+    addImplementationRows();
+}
+
+void AudioMixKernelsTests::accumulateMonoToStereoBenchmark() {
+    QFETCH(Implementation, implementation);
+    QVERIFY(setImplementation(implementation));
+
+    float source[AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL];
+    float mix[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO] = {};
+    fillFrame(source, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+
+    QBENCHMARK {
+        accumulateMonoToStereo(source, mix, 0.5f, AudioConstants::NETWORK_FRAME_SAMPLES_PER_CHANNEL);
+    }
+}
+
+void AudioMixKernelsTests::convertToFloatBenchmark_data() {
+    addImplementationRows();
+}
+
+void AudioMixKernelsTests::convertToFloatBenchmark() {
+    QFETCH(Implementation, implementation);
+    QVERIFY(setImplementation(implementation));
+
+    int16_t source[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    float output[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    for (int i = 0; i < AudioConstants::NETWORK_FRAME_SAMPLES_STEREO; ++i) {
+        source[i] = (int16_t)(i * 127);
+    }
+
+    QBENCHMARK {
+        convertToFloat(source, output, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+    }
+}
+
+void AudioMixKernelsTests::saturateToInt16Benchmark_data() {
+    addImplementationRows();
+}
+
+void AudioMixKernelsTests::saturateToInt16Benchmark() {
+    QFETCH(Implementation, implementation);
+    QVERIFY(setImplementation(implementation));
+
+    float mix[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    int16_t output[AudioConstants::NETWORK_FRAME_SAMPLES_STEREO];
+    fillFrame(mix, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+
+    QBENCHMARK {
+        saturateToInt16(mix, output, AudioConstants::NETWORK_FRAME_SAMPLES_STEREO);
+    }
+}
@@ -0,0 +1,41 @@
+//
+//  AudioMixKernelsTests.h
+//  tests/audio/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioMixKernelsTests_h
+#define hifi_AudioMixKernelsTests_h
+
+#include <QtTest/QtTest>
+
+class AudioMixKernelsTests : public QObject {
+    Q_OBJECT
+private slots:
+    void cleanup();
+
+    // Test that every implementation this CPU can run gives the same samples as the portable one
+    void matchesPortableTest();
+
+    // Test that saturation clamps and reports silent frames
+    void saturateTest();
+
+    // Benchmark each kernel on a network frame, for each implementation this CPU can run
+    void accumulateBenchmark_data();
+    void accumulateBenchmark();
+    void accumulateMonoToStereoBenchmark_data();
+    void accumulateMonoToStereoBenchmark();
+    void convertToFloatBenchmark_data();
+    void convertToFloatBenchmark();
+    void saturateToInt16Benchmark_data();
+    void saturateToInt16Benchmark();
+
+private:
+    void addImplementationRows();
+};
+
+#endif // hifi_AudioMixKernelsTests_h
@@ -14,11 +14,14 @@
 #include <QElapsedTimer>
 #include <QLoggingCategory>
 #include <QDir>
+#include <QJsonDocument>
 #include <ByteCountCoding.h>
 
 #include <BoxEntityItem.h>
 #include <EntityItemProperties.h>
+#include <EntityTree.h>
 #include <Octree.h>
+#include <ParticleEffectEntityItem.h>
 #include <PathUtils.h>
 
 const QString& getTestResourceDir() {
@@ -135,6 +138,119 @@ void testPropertyFlags() {
     testPropertyFlags(0xFFFF);
 }
 
+const int PERSIST_BENCHMARK_ENTITIES = 100000;
+const int PERSIST_BENCHMARK_EDITS = 1000;
+
+EntityTreePointer createPersistBenchmarkTree() {
+    EntityTreePointer tree = EntityTreePointer(new EntityTree(true));
+    tree->createRootElement();
+    tree->setIsServer(true);
+    return tree;
+}
+
+// times a full save and load of a large persist file, against journaling and replaying a batch of edits to it
+void benchmarkPersist() {
+    QString fileName = QDir::temp().absoluteFilePath("entities-test-persist.json.gz");
+    QString binaryFileName = QDir::temp().absoluteFilePath("entities-test-persist.bin");
+
+    EntityTreePointer tree = createPersistBenchmarkTree();
+    QVector<EntityItemID> entityIDs;
+    for (int i = 0; i < PERSIST_BENCHMARK_ENTITIES; ++i) {
+        EntityItemProperties properties;
+        properties.setType(EntityTypes::Box);
+        properties.setPosition(glm::vec3(i % 100, (i / 100) % 100, i / 10000));
+        EntityItemID entityID(QUuid::createUuid());
+        tree->addEntity(entityID, properties);
+        entityIDs << entityID;
+    }
+
+    StopWatch stopWatch;
+    stopWatch.start();
+    tree->writeToFile(qPrintable(fileName), NULL, "json.gz");
+    stopWatch.stop();
+    qDebug() << "full save of" << PERSIST_BENCHMARK_ENTITIES << "entities:" << stopWatch.getLast() << "usecs";
+
+    stopWatch.start();
+    tree->writeToFile(qPrintable(binaryFileName), NULL, "bin");
+    stopWatch.stop();
+    qDebug() << "binary snapshot of" << PERSIST_BENCHMARK_ENTITIES << "entities:" << stopWatch.getLast() << "usecs";
+
+    tree->setJournalChanges(true);
+    for (int i = 0; i < PERSIST_BENCHMARK_EDITS; ++i) {
+        EntityItemProperties properties;
+        properties.setPosition(glm::vec3(i % 100, 200.0f, 0.0f));
+        tree->updateEntity(entityIDs[i * (PERSIST_BENCHMARK_ENTITIES / PERSIST_BENCHMARK_EDITS)], properties);
+    }
+
+    QVariantList changes;
+    stopWatch.start();
+    tree->writeJournalChanges(changes);
+    QByteArray journalRecord = QJsonDocument::fromVariant(changes).toJson(QJsonDocument::Compact);
+    stopWatch.stop();
+    qDebug() << "journal of" << changes.size() << "edits:" << stopWatch.getLast() << "usecs" << journalRecord.size() << "bytes";
+
+    EntityTreePointer loadedTree = createPersistBenchmarkTree();
+    stopWatch.start();
+    loadedTree->readJSONFromGzippedFile(fileName);
+    stopWatch.stop();
+    qDebug() << "load of" << PERSIST_BENCHMARK_ENTITIES << "entities:" << stopWatch.getLast() << "usecs";
+
+    EntityTreePointer binaryLoadedTree = createPersistBenchmarkTree();
+    stopWatch.start();
+    binaryLoadedTree->readFromBinaryFile(binaryFileName);
+    stopWatch.stop();
+    qDebug() << "binary snapshot load of" << PERSIST_BENCHMARK_ENTITIES << "entities:" << stopWatch.getLast() << "usecs";
+
+    stopWatch.start();
+    loadedTree->readJournalChanges(QJsonDocument::fromJson(journalRecord).toVariant().toList());
+    stopWatch.stop();
+    qDebug() << "replay of" << changes.size() << "journaled edits:" << stopWatch.getLast() << "usecs";
+
+    QFile::remove(fileName);
+    QFile::remove(binaryFileName);
+}
+
+const int PARTICLE_BENCHMARK_EMITTERS = 50;
+const quint32 PARTICLE_BENCHMARK_MAX_PARTICLES = 5000;
+const int PARTICLE_BENCHMARK_FRAMES = 600;
+const quint64 PARTICLE_BENCHMARK_FRAME_USECS = USECS_PER_SECOND / 60;
+
+// times the simulation of a scene full of emitters that are all at their particle limit, without rendering
+void benchmarkParticles() {
+    std::vector<std::shared_ptr<ParticleEffectEntityItem>> emitters;
+    for (int i = 0; i < PARTICLE_BENCHMARK_EMITTERS; ++i) {
+        auto emitter = std::static_pointer_cast<ParticleEffectEntityItem>(
+            ParticleEffectEntityItem::factory(EntityItemID(QUuid::createUuid()), EntityItemProperties()));
+        emitter->setMaxParticles(PARTICLE_BENCHMARK_MAX_PARTICLES);
+        emitter->setLifespan(3.0f);
+        emitter->setEmitRate(2.0f * PARTICLE_BENCHMARK_MAX_PARTICLES / 3.0f);
+        emitter->setEmitSpeed(1.0f);
+        emitter->setSpeedSpread(0.5f);
+        emitter->setPolarFinish(PI);
+        emitter->setEmitAcceleration(glm::vec3(0.0f, -9.8f, 0.0f));
+        emitter->setAccelerationSpread(glm::vec3(0.5f));
+        emitters.push_back(emitter);
+    }
+
+    quint64 now = usecTimestampNow();
+    StopWatch stopWatch;
+    stopWatch.start();
+    for (int frame = 0; frame < PARTICLE_BENCHMARK_FRAMES; ++frame) {
+        now += PARTICLE_BENCHMARK_FRAME_USECS;
+        for (auto& emitter : emitters) {
+            emitter->update(now);
+        }
+    }
+    stopWatch.stop();
+
+    quint64 numParticles = 0;
+    for (auto& emitter : emitters) {
+        numParticles += emitter->getNumParticles();
+    }
+    qDebug() << PARTICLE_BENCHMARK_FRAMES << "frames of" << PARTICLE_BENCHMARK_EMITTERS << "emitters with"
+        << numParticles << "particles:" << stopWatch.getLast() / PARTICLE_BENCHMARK_FRAMES << "usecs per frame";
+}
+
 int main(int argc, char** argv) {
     QCoreApplication app(argc, argv);
     {
@@ -152,6 +268,13 @@ int main(int argc, char** argv) {
     }
     DependencyManager::set<NodeList>(NodeType::Unassigned);
 
+    // the benchmarks write large temporary files and take a while, so they only run when asked for
+    const QString BENCHMARK_OPTION = "--benchmark";
+    if (app.arguments().contains(BENCHMARK_OPTION)) {
+        benchmarkPersist();
+        benchmarkParticles();
+    }
+
     QFile file(getTestResourceDir() + "packet.bin");
     if (!file.open(QIODevice::ReadOnly)) return -1;
     QByteArray packet = file.readAll();
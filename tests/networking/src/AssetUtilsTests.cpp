@@ -0,0 +1,44 @@
+//
+//  AssetUtilsTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AssetUtilsTests.h"
+
+#include <limits>
+
+#include <AssetUtils.h>
+
+QTEST_MAIN(AssetUtilsTests)
+
+static const qint64 ASSET_SIZE = 100;
+
+void AssetUtilsTests::byteRangeTest_data() {
+    QTest::addColumn<qint64>("start");
+    QTest::addColumn<qint64>("end");
+    QTest::addColumn<bool>("isValid");
+
+    QTest::newRow("Whole asset") << (qint64)0 << ASSET_SIZE << true;
+    QTest::newRow("Middle") << (qint64)10 << (qint64)20 << true;
+    QTest::newRow("Last byte") << ASSET_SIZE - 1 << ASSET_SIZE << true;
+    QTest::newRow("Empty") << (qint64)10 << (qint64)10 << false;
+    QTest::newRow("Reversed") << (qint64)20 << (qint64)10 << false;
+    QTest::newRow("Negative start") << (qint64)-10 << (qint64)10 << false;
+    QTest::newRow("Most negative start") << std::numeric_limits<qint64>::min() << (qint64)10 << false;
+    QTest::newRow("Negative end") << (qint64)-20 << (qint64)-10 << false;
+    QTest::newRow("Past the end") << (qint64)10 << ASSET_SIZE + 1 << false;
+    QTest::newRow("Start past the end") << ASSET_SIZE << ASSET_SIZE + 10 << false;
+}
+
+void AssetUtilsTests::byteRangeTest() {
+    QFETCH(qint64, start);
+    QFETCH(qint64, end);
+    QFETCH(bool, isValid);
+
+    QCOMPARE(isValidByteRange(start, end, ASSET_SIZE), isValid);
+}
@@ -0,0 +1,26 @@
+//
+//  AssetUtilsTests.h
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AssetUtilsTests_h
+#define hifi_AssetUtilsTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+class AssetUtilsTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test that only byte ranges inside the asset are served, whatever a client puts in its AssetGet
+    void byteRangeTest_data();
+    void byteRangeTest();
+};
+
+#endif // hifi_AssetUtilsTests_h
@@ -0,0 +1,172 @@
+//
+//  PacketReceiverTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketReceiverTests.h"
+
+#include <PacketReceiver.h>
+
+QTEST_MAIN(PacketReceiverTests)
+
+static const int NUM_BENCHMARK_MESSAGES = 10000;
+
+// a type that doesn't need a source, so that delivering it doesn't look up a node
+static const PacketType TEST_PACKET_TYPE = PacketType::ICEPing;
+
+static bool registerTestListener(PacketReceiver& receiver, TestPacketListener& listener, bool isTyped) {
+    if (isTyped) {
+        return receiver.registerListener(TEST_PACKET_TYPE, &listener, &TestPacketListener::handlePacket);
+    } else {
+        return receiver.registerListener(TEST_PACKET_TYPE, &listener, "handlePacket");
+    }
+}
+
+static std::unique_ptr<udt::Packet> createTestPacket() {
+    auto packet = NLPacket::create(TEST_PACKET_TYPE);
+    packet->writePrimitive((quint32) 0);
+    return packet;
+}
+
+void PacketReceiverTests::addListenerRows() {
+    QTest::addColumn<bool>("isTyped");
+
+    QTest::newRow("slot") << false;
+    QTest::newRow("method") << true;
+}
+
+void PacketReceiverTests::deliveryTest_data() {
+    addListenerRows();
+}
+
+void PacketReceiverTests::deliveryTest() {
+    QFETCH(bool, isTyped);
+
+    PacketReceiver receiver;
+    TestPacketListener listener;
+    QVERIFY(registerTestListener(receiver, listener, isTyped));
+
+    receiver.handleVerifiedPacket(createTestPacket());
+    receiver.handleVerifiedPacket(createTestPacket());
+    QCOMPARE(listener.numReceived, 2);
+
+    receiver.unregisterListener(&listener);
+    receiver.handleVerifiedPacket(createTestPacket());
+    QCOMPARE(listener.numReceived, 2);
+}
+
+void PacketReceiverTests::unregisterDuringDispatchTest_data() {
+    addListenerRows();
+}
+
+void PacketReceiverTests::unregisterDuringDispatchTest() {
+    QFETCH(bool, isTyped);
+
+    PacketReceiver receiver;
+    TestPacketListener listener;
+    QVERIFY(registerTestListener(receiver, listener, isTyped));
+
+    // the listener unregisters from its own call, which must not wait for that call to be over
+    listener.unregisterFrom = &receiver;
+    receiver.handleVerifiedPacket(createTestPacket());
+    QCOMPARE(listener.numReceived, 1);
+
+    // and its record is gone once the message has been dispatched
+    QVERIFY(receiver._allListeners.empty());
+    QVERIFY(receiver._retiredListeners.empty());
+
+    receiver.handleVerifiedPacket(createTestPacket());
+    QCOMPARE(listener.numReceived, 1);
+}
+
+void PacketReceiverTests::reassemblyTest_data() {
+    QTest::addColumn<bool>("hasSizeHint");
+
+    QTest::newRow("unknown size") << false;
+    QTest::newRow("size hint") << true;
+}
+
+void PacketReceiverTests::reassemblyTest() {
+    QFETCH(bool, hasSizeHint);
+
+    static const int NUM_PARTS = 50;
+    static const int PART_SIZE = 1000;
+
+    PacketReceiver receiver;
+    TestPacketListener listener;
+    QVERIFY(receiver.registerListener(TEST_PACKET_TYPE, &listener, &TestPacketListener::handlePacket, true));
+
+    if (hasSizeHint) {
+        receiver.setMessageSizeHint(TEST_PACKET_TYPE, [](const ReceivedMessage& firstPart) {
+            return (qint64) NUM_PARTS * PART_SIZE;
+        });
+    }
+
+    const char* firstBuffer = nullptr;
+
+    for (int part = 0; part < NUM_PARTS; ++part) {
+        auto packet = NLPacket::create(TEST_PACKET_TYPE, -1, true, true);
+        auto position = part == 0 ? udt::Packet::PacketPosition::FIRST
+            : (part == NUM_PARTS - 1 ? udt::Packet::PacketPosition::LAST : udt::Packet::PacketPosition::MIDDLE);
+        packet->writeMessageNumber(1, position, part);
+
+        QByteArray payload(PART_SIZE, (char) part);
+        packet->write(payload);
+
+        receiver.handleVerifiedMessagePacket(std::move(packet));
+
+        // the listener gets the message once, as soon as its first packet arrives
+        QCOMPARE(listener.numReceived, 1);
+        QCOMPARE(listener.lastMessage->getSize(), (qint64) (part + 1) * PART_SIZE);
+
+        if (part == 0) {
+            firstBuffer = listener.lastMessage->getRawMessage();
+        }
+    }
+
+    auto message = listener.lastMessage;
+    QVERIFY(message->isComplete());
+    QCOMPARE(message->getNumPackets(), (qint64) NUM_PARTS);
+
+    for (int part = 0; part < NUM_PARTS; ++part) {
+        QCOMPARE(message->getRawMessage()[part * PART_SIZE], (char) part);
+        QCOMPARE(message->getRawMessage()[(part + 1) * PART_SIZE - 1], (char) part);
+    }
+
+    if (hasSizeHint) {
+        QCOMPARE(message->getRawMessage(), firstBuffer);
+    }
+}
+
+void PacketReceiverTests::dispatchBenchmark_data() {
+    addListenerRows();
+}
+
+void PacketReceiverTests::dispatchBenchmark() {
+    QFETCH(bool, isTyped);
+
+    PacketReceiver receiver;
+    TestPacketListener listener;
+    QVERIFY(registerTestListener(receiver, listener, isTyped));
+
+    // build the messages up front so that only dispatching them is measured
+    auto packet = NLPacket::fromBase(createTestPacket());
+    std::vector<QSharedPointer<ReceivedMessage>> messages;
+    for (int i = 0; i < NUM_BENCHMARK_MESSAGES; ++i) {
+        messages.push_back(QSharedPointer<ReceivedMessage>::create(*packet));
+    }
+
+    int numDispatched = 0;
+    QBENCHMARK {
+        for (auto& message : messages) {
+            receiver.handleVerifiedMessage(message, true);
+        }
+        numDispatched += NUM_BENCHMARK_MESSAGES;
+    }
+    QCOMPARE(listener.numReceived, numDispatched);
+}
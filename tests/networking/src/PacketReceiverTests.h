@@ -0,0 +1,63 @@
+//
+//  PacketReceiverTests.h
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketReceiverTests_h
+#define hifi_PacketReceiverTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+#include <PacketReceiver.h>
+#include <ReceivedMessage.h>
+
+class TestPacketListener : public QObject {
+    Q_OBJECT
+public:
+    int numReceived { 0 };
+    QSharedPointer<ReceivedMessage> lastMessage;
+
+    // if set, the listener unregisters itself from this receiver when it gets a message
+    PacketReceiver* unregisterFrom { nullptr };
+
+public slots:
+    void handlePacket(QSharedPointer<ReceivedMessage> message) {
+        ++numReceived;
+        lastMessage = message;
+        if (unregisterFrom) {
+            unregisterFrom->unregisterListener(this);
+        }
+    }
+};
+
+class PacketReceiverTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test that listeners registered with a slot and with a method both get their messages, until unregistered
+    void deliveryTest_data();
+    void deliveryTest();
+
+    // Test that a listener can unregister itself while a message is being handed to it
+    void unregisterDuringDispatchTest_data();
+    void unregisterDuringDispatchTest();
+
+    // Test that a message sent in many packets arrives whole, in one buffer that doesn't move if its size is hinted
+    void reassemblyTest_data();
+    void reassemblyTest();
+
+    // Benchmark the messages per second dispatched to a listener registered with a slot and with a method
+    void dispatchBenchmark_data();
+    void dispatchBenchmark();
+
+private:
+    void addListenerRows();
+};
+
+#endif // hifi_PacketReceiverTests_h
@@ -0,0 +1,116 @@
+//
+//  PacketVerificationTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketVerificationTests.h"
+
+#include <QtCore/QCryptographicHash>
+
+#include <NLPacket.h>
+#include <SipHash.h>
+
+QTEST_MAIN(PacketVerificationTests)
+
+static const int NUM_BENCHMARK_PACKETS = 1000;
+
+static std::unique_ptr<NLPacket> createSignedPacket(const QUuid& connectionSecret, int payloadSize) {
+    auto packet = NLPacket::create(PacketType::AvatarData);
+    for (int i = 0; i < payloadSize; ++i) {
+        char byte = (char) i;
+        packet->write(&byte, 1);
+    }
+
+    packet->writeSourceID(QUuid::createUuid());
+    packet->writeVerificationHashGivenSecret(connectionSecret);
+
+    return packet;
+}
+
+static bool hashMatches(const udt::Packet& packet, const QUuid& connectionSecret) {
+    char expectedHash[NUM_BYTES_VERIFICATION_HASH];
+    NLPacket::hashForPacketAndSecret(packet, connectionSecret, expectedHash);
+    return memcmp(NLPacket::verificationHashInHeader(packet), expectedHash, NUM_BYTES_VERIFICATION_HASH) == 0;
+}
+
+// how packets were verified before, for comparison
+static bool md5HashMatches(const udt::Packet& packet, const QUuid& connectionSecret) {
+    int offset = NLPacket::totalHeaderSize(PacketType::AvatarData, packet.isPartOfMessage());
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(packet.getData() + offset, packet.getDataSize() - offset);
+    hash.addData(connectionSecret.toRfc4122());
+
+    return hash.result() == QByteArray(NLPacket::verificationHashInHeader(packet), NUM_BYTES_VERIFICATION_HASH);
+}
+
+void PacketVerificationTests::sipHashTest() {
+    // the key and the messages are the bytes 0, 1, 2, ... as in the SipHash reference vectors
+    char message[64];
+    for (int i = 0; i < (int) sizeof(message); ++i) {
+        message[i] = (char) i;
+    }
+    uint64_t k0 = 0x0706050403020100ULL;
+    uint64_t k1 = 0x0f0e0d0c0b0a0908ULL;
+
+    struct Vector {
+        int size;
+        const char* hash;
+    };
+    const Vector VECTORS[] = {
+        { 0, "a3817f04ba25a8e66df67214c7550293" },
+        { 1, "da87c1d86b99af44347659119b22fc45" },
+        { 15, "5493e99933b0a8117e08ec0f97cfc3d9" },
+        { 63, "5150d1772f50834a503e069a973fbd7c" }
+    };
+
+    for (const auto& vector : VECTORS) {
+        char hash[NUM_BYTES_SIPHASH_128];
+        sipHash128(k0, k1, message, vector.size, hash);
+        QCOMPARE(QByteArray(hash, NUM_BYTES_SIPHASH_128).toHex(), QByteArray(vector.hash));
+    }
+}
+
+void PacketVerificationTests::verificationTest() {
+    QUuid connectionSecret = QUuid::createUuid();
+    auto packet = createSignedPacket(connectionSecret, 200);
+
+    QVERIFY(hashMatches(*packet, connectionSecret));
+    QVERIFY(!hashMatches(*packet, QUuid::createUuid()));
+
+    // change the last byte of the payload
+    packet->getData()[packet->getDataSize() - 1] ^= 1;
+    QVERIFY(!hashMatches(*packet, connectionSecret));
+}
+
+void PacketVerificationTests::verifyBenchmark_data() {
+    QTest::addColumn<bool>("isMD5");
+    QTest::addColumn<int>("payloadSize");
+
+    QTest::newRow("MD5 small") << true << 64;
+    QTest::newRow("SipHash small") << false << 64;
+    QTest::newRow("MD5 full") << true << (int) NLPacket::maxPayloadSize(PacketType::AvatarData);
+    QTest::newRow("SipHash full") << false << (int) NLPacket::maxPayloadSize(PacketType::AvatarData);
+}
+
+void PacketVerificationTests::verifyBenchmark() {
+    QFETCH(bool, isMD5);
+    QFETCH(int, payloadSize);
+
+    QUuid connectionSecret = QUuid::createUuid();
+    auto packet = createSignedPacket(connectionSecret, payloadSize);
+
+    // the MD5 rows check against a hash that isn't in the header, which costs the same
+    int numMatches = 0;
+    QBENCHMARK {
+        for (int i = 0; i < NUM_BENCHMARK_PACKETS; ++i) {
+            numMatches += isMD5 ? md5HashMatches(*packet, connectionSecret) : hashMatches(*packet, connectionSecret);
+        }
+    }
+    QCOMPARE(numMatches > 0, !isMD5);
+}
@@ -0,0 +1,32 @@
+//
+//  PacketVerificationTests.h
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketVerificationTests_h
+#define hifi_PacketVerificationTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+class PacketVerificationTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test the SipHash implementation against the reference vectors
+    void sipHashTest();
+
+    // Test that a packet verifies with its own secret, and not with another secret or once it is changed
+    void verificationTest();
+
+    // Benchmark the bytes per second verified with the MD5 hash that was replaced, and with SipHash
+    void verifyBenchmark_data();
+    void verifyBenchmark();
+};
+
+#endif // hifi_PacketVerificationTests_h
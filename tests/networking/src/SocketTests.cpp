@@ -0,0 +1,223 @@
+//
+//  SocketTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SocketTests.h"
+
+#include <QtCore/QElapsedTimer>
+
+#include <udt/Packet.h>
+#include <udt/PacketBufferPool.h>
+#include <udt/Socket.h>
+
+QTEST_MAIN(SocketTests)
+
+using namespace udt;
+
+// datagrams are sent in bursts that fit in the receive buffer, so the benchmark measures reads rather than drops
+static const int DATAGRAMS_PER_BURST = 64;
+static const int PAYLOAD_SIZE = 100;
+static const qint64 RECEIVE_TIMEOUT_MSECS = 5000;
+
+static std::unique_ptr<Packet> createTestPacket(int index) {
+    auto packet = Packet::create(PAYLOAD_SIZE);
+    for (int j = 0; j < PAYLOAD_SIZE; ++j) {
+        packet->writePrimitive((char)(index + j));
+    }
+    return packet;
+}
+
+// a receiving socket and a sending socket on loopback
+class LoopbackSockets {
+public:
+    LoopbackSockets(bool isBatchedReceiveEnabled) {
+        receiver.bind(QHostAddress::LocalHost);
+        receiver.setBatchedReceiveEnabled(isBatchedReceiveEnabled);
+        receiver.setPacketHandler([this](std::unique_ptr<Packet> packet) {
+            if (keepPackets) {
+                packets.push_back(std::move(packet));
+            }
+            ++numReceived;
+        });
+
+        sender.bind(QHostAddress::LocalHost);
+        receiverSockAddr = HifiSockAddr(QHostAddress::LocalHost, receiver.localPort());
+    }
+
+    // sends a burst one packet at a time and waits for all of it to arrive
+    bool sendBurst(int numDatagrams) {
+        int expectedReceived = numReceived + numDatagrams;
+        for (int i = 0; i < numDatagrams; ++i) {
+            sender.writePacket(*createTestPacket(i), receiverSockAddr);
+        }
+        return waitForReceived(expectedReceived);
+    }
+
+    // sends a burst as one batch and waits for all of it to arrive
+    bool sendBatch(int numDatagrams) {
+        int expectedReceived = numReceived + numDatagrams;
+        PacketBatch batch;
+        for (int i = 0; i < numDatagrams; ++i) {
+            batch.push_back({ createTestPacket(i), receiverSockAddr });
+        }
+        return sender.writePacketBatch(batch) > 0 && batch.empty() && waitForReceived(expectedReceived);
+    }
+
+    bool waitForReceived(int expectedReceived) {
+        QElapsedTimer timer;
+        timer.start();
+        while (numReceived < expectedReceived && timer.elapsed() < RECEIVE_TIMEOUT_MSECS) {
+            QCoreApplication::processEvents();
+        }
+        return numReceived == expectedReceived;
+    }
+
+    Socket receiver;
+    Socket sender;
+    HifiSockAddr receiverSockAddr;
+
+    bool keepPackets { false };
+    std::vector<std::unique_ptr<Packet>> packets;
+    int numReceived { 0 };
+};
+
+void SocketTests::addReceiveRows() {
+    QTest::addColumn<bool>("isBatchedReceiveEnabled");
+
+    QTest::newRow("Unbatched") << false;
+#if defined(Q_OS_LINUX)
+    QTest::newRow("Batched") << true;
+#endif
+}
+
+void SocketTests::receiveTest_data() {
+    addReceiveRows();
+}
+
+void SocketTests::receiveTest() {
+    QFETCH(bool, isBatchedReceiveEnabled);
+
+    LoopbackSockets sockets(isBatchedReceiveEnabled);
+    sockets.keepPackets = true;
+
+    // more than one batch, so that the receiver has to come back for the rest
+    const int NUM_DATAGRAMS = DATAGRAMS_PER_BURST + DATAGRAMS_PER_BURST / 2;
+    QVERIFY(sockets.sendBurst(NUM_DATAGRAMS));
+    QCOMPARE((int)sockets.packets.size(), NUM_DATAGRAMS);
+
+    // loopback keeps the datagrams in order
+    for (int i = 0; i < NUM_DATAGRAMS; ++i) {
+        auto& packet = sockets.packets[i];
+        QCOMPARE(packet->getPayloadSize(), (qint64)PAYLOAD_SIZE);
+        QCOMPARE(packet->getSenderSockAddr().getPort(), sockets.sender.localPort());
+
+        for (int j = 0; j < PAYLOAD_SIZE; ++j) {
+            QCOMPARE(packet->getPayload()[j], (char)(i + j));
+        }
+    }
+}
+
+void SocketTests::truncatedDatagramTest() {
+#if defined(Q_OS_LINUX)
+    LoopbackSockets sockets(true);
+
+    QByteArray oversizedDatagram(PacketBufferPool::BUFFER_SIZE + PAYLOAD_SIZE, 0);
+    QVERIFY(sockets.sender.writeDatagram(oversizedDatagram, sockets.receiverSockAddr) > 0);
+
+    // the packets after it still get through, without anything else to wake the receiver
+    QVERIFY(sockets.sendBurst(DATAGRAMS_PER_BURST));
+    QCOMPARE(sockets.receiver.getNumTruncatedDatagrams(), 1);
+#else
+    QSKIP("Only a batched receive reads into buffers of a fixed size");
+#endif
+}
+
+void SocketTests::bufferPoolTest() {
+    auto& bufferPool = PacketBufferPool::getInstance();
+
+    LoopbackSockets sockets(false);
+    sockets.keepPackets = true;
+    QVERIFY(sockets.sendBurst(DATAGRAMS_PER_BURST));
+
+    for (auto& packet : sockets.packets) {
+        QVERIFY(packet->isFromBufferPool());
+    }
+
+    // moving a packet moves its buffer, copying one does not share it
+    size_t numFreeBuffers = bufferPool.getNumFreeBuffers();
+    auto copy = Packet::createCopy(*sockets.packets.front());
+    QVERIFY(!copy->isFromBufferPool());
+    copy.reset();
+    QCOMPARE(bufferPool.getNumFreeBuffers(), numFreeBuffers);
+
+    sockets.packets.clear();
+    QCOMPARE(bufferPool.getNumFreeBuffers(), numFreeBuffers + DATAGRAMS_PER_BURST);
+}
+
+void SocketTests::batchSendTest() {
+    LoopbackSockets sockets(false);
+    sockets.keepPackets = true;
+
+    const int NUM_DATAGRAMS = DATAGRAMS_PER_BURST;
+    sockets.sender.sampleWriteStats();
+    QVERIFY(sockets.sendBatch(NUM_DATAGRAMS));
+
+    auto writeStats = sockets.sender.sampleWriteStats();
+    QCOMPARE(writeStats.datagrams, NUM_DATAGRAMS);
+#if defined(Q_OS_LINUX)
+    QCOMPARE(writeStats.systemCalls, 1);
+#else
+    QCOMPARE(writeStats.systemCalls, NUM_DATAGRAMS);
+#endif
+    QCOMPARE((int)sockets.packets.size(), NUM_DATAGRAMS);
+
+    for (int i = 0; i < NUM_DATAGRAMS; ++i) {
+        auto& packet = sockets.packets[i];
+        QCOMPARE(packet->getPayloadSize(), (qint64)PAYLOAD_SIZE);
+        QCOMPARE(packet->getSequenceNumber(), SequenceNumber(i + 1));
+        QCOMPARE(packet->getPayload()[PAYLOAD_SIZE - 1], (char)(i + PAYLOAD_SIZE - 1));
+    }
+}
+
+void SocketTests::receiveBenchmark_data() {
+    addReceiveRows();
+}
+
+void SocketTests::receiveBenchmark() {
+    QFETCH(bool, isBatchedReceiveEnabled);
+
+    LoopbackSockets sockets(isBatchedReceiveEnabled);
+
+    const int NUM_BURSTS = 16;
+    QBENCHMARK {
+        for (int i = 0; i < NUM_BURSTS; ++i) {
+            QVERIFY(sockets.sendBurst(DATAGRAMS_PER_BURST));
+        }
+    }
+}
+
+void SocketTests::sendBenchmark_data() {
+    QTest::addColumn<bool>("isBatched");
+
+    QTest::newRow("One at a time") << false;
+    QTest::newRow("Batched") << true;
+}
+
+void SocketTests::sendBenchmark() {
+    QFETCH(bool, isBatched);
+
+    LoopbackSockets sockets(false);
+
+    const int NUM_BURSTS = 16;
+    QBENCHMARK {
+        for (int i = 0; i < NUM_BURSTS; ++i) {
+            QVERIFY(isBatched ? sockets.sendBatch(DATAGRAMS_PER_BURST) : sockets.sendBurst(DATAGRAMS_PER_BURST));
+        }
+    }
+}
@@ -0,0 +1,46 @@
+//
+//  SocketTests.h
+//  tests/networking/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SocketTests_h
+#define hifi_SocketTests_h
+
+#pragma once
+
+#include <QtTest/QtTest>
+
+class SocketTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test that every datagram sent over loopback arrives intact, with batched receives on and off
+    void receiveTest_data();
+    void receiveTest();
+
+    // Test that a datagram too big for a batched receive is counted and dropped, and reading carries on after it
+    void truncatedDatagramTest();
+
+    // Test that received packets give their buffers back to the pool
+    void bufferPoolTest();
+
+    // Test that a batch of packets arrives intact, and on Linux goes out in a system call per batch
+    void batchSendTest();
+
+    // Benchmark loopback throughput, with batched receives on and off
+    void receiveBenchmark_data();
+    void receiveBenchmark();
+
+    // Benchmark loopback throughput, sending a packet at a time and in batches
+    void sendBenchmark_data();
+    void sendBenchmark();
+
+private:
+    void addReceiveRows();
+};
+
+#endif // hifi_SocketTests_h
@@ -18,6 +18,7 @@
 #include <EntityItem.h>
 #include <EntityTree.h>
 #include <EntityTreeElement.h>
+#include <OctalCode.h>
 #include <Octree.h>
 #include <OctreeConstants.h>
 #include <PropertyFlags.h>
@@ -827,3 +828,135 @@ void OctreeTests::elementAddChildTests() {
         }
     }
 }
+
+// an element a sixteenth of the root's size, at the given cell of the grid of such elements
+static OctreeElementPointer getGridElement(EntityTreePointer tree, int x, int y, int z) {
+    const float GRID_DIVISIONS = 16.0f;
+    float size = tree->getRoot()->getScale() / GRID_DIVISIONS;
+    glm::vec3 center = tree->getRoot()->getAACube().getCorner() + (glm::vec3(x, y, z) + 0.5f) * size;
+    return tree->getOrCreateChildElementAt(center.x, center.y, center.z, size);
+}
+
+static OctreeElementPointer getParent(EntityTreePointer tree, OctreeElementPointer element) {
+    OctreeElementPointer parent = tree->getRoot();
+    while (parent && !parent->isParentOf(element)) {
+        OctreeElementPointer next;
+        for (int i = 0; i < NUMBER_OF_CHILDREN && !next; i++) {
+            auto child = parent->getChildAtIndex(i);
+            if (child && isAncestorOf(child->getOctalCode(), element->getOctalCode())) {
+                next = child;
+            }
+        }
+        parent = next;
+    }
+    return parent;
+}
+
+void OctreeTests::changedSubtreesTests() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+
+    auto element = getGridElement(tree, 0, 0, 0);
+    auto sibling = getGridElement(tree, 1, 0, 0);
+    auto farElement = getGridElement(tree, 15, 15, 15);
+    QCOMPARE(getParent(tree, element), getParent(tree, sibling));
+
+    std::vector<OctreeElementPointer> subtrees;
+
+    // nothing is logged until tracking is on, and a tree that isn't tracking can't say what changed
+    tree->recordElementChange(element);
+    quint64 sequence = tree->getChangeSequence();
+    tree->withReadLock([&] {
+        QVERIFY(!tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+
+    tree->setTrackElementChanges(true);
+    sequence = tree->getChangeSequence();
+
+    tree->withReadLock([&] {
+        QVERIFY(tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+    QVERIFY(subtrees.empty());
+
+    // an element's data is written by its parent, so that is the subtree to encode, once for both siblings
+    tree->recordElementChange(element);
+    tree->recordElementChange(sibling);
+    tree->recordElementChange(farElement);
+    tree->withReadLock([&] {
+        QVERIFY(tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+    QCOMPARE(subtrees.size(), (size_t)2);
+    QVERIFY(std::find(subtrees.begin(), subtrees.end(), getParent(tree, element)) != subtrees.end());
+    QVERIFY(std::find(subtrees.begin(), subtrees.end(), getParent(tree, farElement)) != subtrees.end());
+
+    // only the changes after the given sequence are returned
+    quint64 laterSequence = tree->getChangeSequence();
+    tree->recordElementChange(farElement);
+    tree->withReadLock([&] {
+        QVERIFY(tree->getChangedSubtreesSince(laterSequence, subtrees));
+    });
+    QCOMPARE(subtrees.size(), (size_t)1);
+    QCOMPARE(subtrees.front(), getParent(tree, farElement));
+
+    // a subtree inside another one that is encoded anyway is dropped
+    auto ancestor = getParent(tree, getParent(tree, element));
+    tree->recordElementChange(ancestor);
+    tree->withReadLock([&] {
+        QVERIFY(tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+    QCOMPARE(subtrees.size(), (size_t)2);
+    QVERIFY(std::find(subtrees.begin(), subtrees.end(), getParent(tree, ancestor)) != subtrees.end());
+    QVERIFY(std::find(subtrees.begin(), subtrees.end(), getParent(tree, farElement)) != subtrees.end());
+
+    // and erasing the tree forgets everything recorded against its old elements
+    tree->eraseAllOctreeElements();
+    tree->withReadLock([&] {
+        QVERIFY(!tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+}
+
+void OctreeTests::changeLogOverflowTests() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    tree->setTrackElementChanges(true);
+
+    auto element = getGridElement(tree, 0, 0, 0);
+    auto otherElement = getGridElement(tree, 15, 15, 15);
+    std::vector<OctreeElementPointer> subtrees;
+
+    // repeated edits of one element share an entry, so they never fill the log
+    quint64 sequence = tree->getChangeSequence();
+    for (size_t i = 0; i <= Octree::MAX_CHANGE_LOG_ENTRIES; ++i) {
+        tree->recordElementChange(element);
+    }
+    tree->withReadLock([&] {
+        QVERIFY(tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+    QCOMPARE(subtrees.size(), (size_t)1);
+
+    // once the log has dropped entries, a viewer from before them has to get a full traversal
+    sequence = tree->getChangeSequence();
+    for (size_t i = 0; i <= Octree::MAX_CHANGE_LOG_ENTRIES; ++i) {
+        tree->recordElementChange(i % 2 ? element : otherElement);
+    }
+    tree->withReadLock([&] {
+        QVERIFY(!tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+
+    // while a viewer that is only a little behind still gets the changed subtrees
+    tree->withReadLock([&] {
+        QVERIFY(tree->getChangedSubtreesSince(tree->getChangeSequence() - 2, subtrees));
+    });
+    QCOMPARE(subtrees.size(), (size_t)2);
+
+    // and so many changed elements that a traversal from the root is cheaper also gives up
+    sequence = tree->getChangeSequence();
+    for (size_t i = 0; i <= Octree::MAX_CHANGED_SUBTREES; ++i) {
+        const int GRID_DIVISIONS = 16;
+        tree->recordElementChange(getGridElement(tree, i % GRID_DIVISIONS, (i / GRID_DIVISIONS) % GRID_DIVISIONS,
+                                                 i / (GRID_DIVISIONS * GRID_DIVISIONS)));
+    }
+    tree->withReadLock([&] {
+        QVERIFY(!tree->getChangedSubtreesSince(sequence, subtrees));
+    });
+}
@@ -27,6 +27,10 @@ private slots:
 
     void elementAddChildTests();
 
+    // Test that the change log hands back the subtrees holding recorded edits, and gives up when it can't
+    void changedSubtreesTests();
+    void changeLogOverflowTests();
+
     // TODO: Break these into separate test functions
 };
 
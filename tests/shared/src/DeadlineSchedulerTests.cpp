@@ -0,0 +1,146 @@
+//
+//  DeadlineSchedulerTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "DeadlineSchedulerTests.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <DeadlineScheduler.h>
+
+QTEST_MAIN(DeadlineSchedulerTests)
+
+using namespace std::chrono;
+
+static const int NUM_THREADS = 2;
+static const auto INTERVAL = milliseconds(10);
+
+// generous, so that a loaded machine does not fail the tests
+static const auto TIMEOUT = seconds(5);
+
+template <typename Predicate>
+static bool waitFor(Predicate predicate) {
+    auto end = steady_clock::now() + TIMEOUT;
+    while (!predicate()) {
+        if (steady_clock::now() > end) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+class TestTask : public DeadlineScheduler::Task {
+public:
+    DeadlineScheduler::TimePoint runScheduledTask(DeadlineScheduler::TimePoint deadline,
+                                                  DeadlineScheduler::TimePoint now) override {
+        isRunning = true;
+        ++numRuns;
+        wasEarly = wasEarly || now < deadline;
+
+        while (isHeld) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+
+        isRunning = false;
+        return isRepeating ? deadline + INTERVAL : DeadlineScheduler::NEVER;
+    }
+
+    std::atomic<int> numRuns { 0 };
+    std::atomic<bool> isRunning { false };
+    std::atomic<bool> wasEarly { false };
+
+    // keeps the task in its run until cleared
+    std::atomic<bool> isHeld { false };
+
+    std::atomic<bool> isRepeating { false };
+};
+
+void DeadlineSchedulerTests::addTest() {
+    static const int NUM_RUNS = 5;
+
+    // the task outlives the scheduler's threads, even when a check fails before it is removed
+    TestTask task;
+    DeadlineScheduler scheduler(NUM_THREADS);
+    QCOMPARE(scheduler.getNumThreads(), NUM_THREADS);
+
+    task.isRepeating = true;
+
+    auto start = DeadlineScheduler::Clock::now();
+    scheduler.add(&task, start + INTERVAL);
+
+    QVERIFY(waitFor([&] { return task.numRuns >= NUM_RUNS; }));
+    scheduler.remove(&task);
+
+    // runs are never early, so the runs so far took at least an interval each
+    QVERIFY(!task.wasEarly);
+    QVERIFY(DeadlineScheduler::Clock::now() - start >= NUM_RUNS * INTERVAL);
+    QVERIFY(scheduler.getRuns() >= (uint64_t)NUM_RUNS);
+}
+
+void DeadlineSchedulerTests::wakeTest() {
+    TestTask task;
+    DeadlineScheduler scheduler(NUM_THREADS);
+    scheduler.add(&task);
+
+    // with no deadline it only runs once woken
+    std::this_thread::sleep_for(5 * INTERVAL);
+    QCOMPARE(task.numRuns.load(), 0);
+
+    task.isHeld = true;
+    scheduler.wake(&task);
+    QVERIFY(waitFor([&] { return task.isRunning.load(); }));
+
+    // a wake during the run is not lost, the task runs again once that run is over
+    scheduler.wake(&task);
+    task.isHeld = false;
+    QVERIFY(waitFor([&] { return task.numRuns == 2; }));
+
+    // and only once, since it asked for no deadline
+    std::this_thread::sleep_for(5 * INTERVAL);
+    QCOMPARE(task.numRuns.load(), 2);
+
+    scheduler.remove(&task);
+}
+
+void DeadlineSchedulerTests::removeWhileRunningTest() {
+    TestTask task;
+    DeadlineScheduler scheduler(NUM_THREADS);
+    task.isRepeating = true;
+    task.isHeld = true;
+    scheduler.add(&task, DeadlineScheduler::Clock::now());
+    QVERIFY(waitFor([&] { return task.isRunning.load(); }));
+
+    std::atomic<bool> isRemoved { false };
+    std::thread remover([&] {
+        scheduler.remove(&task);
+        isRemoved = true;
+    });
+
+    // remove is stuck until the run is over
+    std::this_thread::sleep_for(5 * INTERVAL);
+    bool wasRemovedDuringRun = isRemoved;
+
+    task.isHeld = false;
+    remover.join();
+    QVERIFY(!wasRemovedDuringRun);
+    QVERIFY(!task.isRunning);
+
+    // the deadline it returned from its last run is dropped
+    int numRuns = task.numRuns;
+    std::this_thread::sleep_for(5 * INTERVAL);
+    QCOMPARE(task.numRuns.load(), numRuns);
+
+    // and waking it does nothing
+    scheduler.wake(&task);
+    std::this_thread::sleep_for(5 * INTERVAL);
+    QCOMPARE(task.numRuns.load(), numRuns);
+}
@@ -0,0 +1,30 @@
+//
+//  DeadlineSchedulerTests.h
+//  tests/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_DeadlineSchedulerTests_h
+#define hifi_DeadlineSchedulerTests_h
+
+#include <QtTest/QtTest>
+
+class DeadlineSchedulerTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    // Test that an added task runs at its first deadline, and then at every deadline it asks for
+    void addTest();
+
+    // Test that a task waiting on no deadline runs once woken, and runs again if woken during a run
+    void wakeTest();
+
+    // Test that removing a running task waits for its run to be over, and that it never runs again
+    void removeWhileRunningTest();
+};
+
+#endif // hifi_DeadlineSchedulerTests_h
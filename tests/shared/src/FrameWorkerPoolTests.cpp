@@ -0,0 +1,80 @@
+//
+//  FrameWorkerPoolTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FrameWorkerPoolTests.h"
+
+#include <atomic>
+
+#include <FrameWorkerPool.h>
+
+QTEST_MAIN(FrameWorkerPoolTests)
+
+static const int NUM_FRAMES = 100;
+
+void FrameWorkerPoolTests::runFrameTest_data() {
+    QTest::addColumn<int>("numThreads");
+
+    QTest::newRow("one thread") << 1;
+    QTest::newRow("four threads") << 4;
+}
+
+void FrameWorkerPoolTests::runFrameTest() {
+    QFETCH(int, numThreads);
+
+    FrameWorkerPool pool;
+    pool.start(numThreads);
+    QCOMPARE(pool.numThreads(), numThreads);
+
+    std::vector<std::atomic<int>> runsPerThread(numThreads);
+    for (auto& runs : runsPerThread) {
+        runs = 0;
+    }
+
+    auto callingThread = std::this_thread::get_id();
+    std::atomic<bool> ranOnCaller { false };
+
+    for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+        pool.runFrame([&](int threadIndex) {
+            ++runsPerThread[threadIndex];
+            if (std::this_thread::get_id() == callingThread) {
+                ranOnCaller = true;
+            }
+        });
+
+        // runFrame only returns once every thread is done with the frame
+        for (auto& runs : runsPerThread) {
+            QCOMPARE(runs.load(), frame + 1);
+        }
+    }
+
+    QCOMPARE(ranOnCaller.load(), numThreads == 1);
+}
+
+void FrameWorkerPoolTests::restartTest() {
+    static const int NUM_THREADS = 4;
+
+    FrameWorkerPool pool;
+    pool.start(NUM_THREADS);
+
+    std::atomic<int> numRuns { 0 };
+    auto countRun = [&](int threadIndex) { ++numRuns; };
+
+    pool.runFrame(countRun);
+    QCOMPARE(numRuns.load(), NUM_THREADS);
+
+    pool.start(NUM_THREADS);
+
+    // give the new threads the chance to run a frame no one asked for
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    QCOMPARE(numRuns.load(), NUM_THREADS);
+
+    pool.runFrame(countRun);
+    QCOMPARE(numRuns.load(), 2 * NUM_THREADS);
+}
@@ -0,0 +1,28 @@
+//
+//  FrameWorkerPoolTests.h
+//  tests/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FrameWorkerPoolTests_h
+#define hifi_FrameWorkerPoolTests_h
+
+#include <QtTest/QtTest>
+
+class FrameWorkerPoolTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    // Test that every thread runs each frame exactly once, and that a single thread runs on the caller
+    void runFrameTest_data();
+    void runFrameTest();
+
+    // Test that threads started by a restart wait for the next frame instead of running the last one again
+    void restartTest();
+};
+
+#endif // hifi_FrameWorkerPoolTests_h
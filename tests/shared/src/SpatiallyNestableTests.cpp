@@ -0,0 +1,138 @@
+//
+//  SpatiallyNestableTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SpatiallyNestableTests.h"
+
+#include <vector>
+
+#include <QtCore/QHash>
+
+#include <DependencyManager.h>
+#include <NumericalConstants.h>
+#include <SpatiallyNestable.h>
+#include <SpatialParentFinder.h>
+
+#include <../GLMTestUtils.h>
+#include <../QTestExtensions.h>
+
+QTEST_MAIN(SpatiallyNestableTests)
+
+const float EPSILON = 0.001f;
+
+// 1000 chains, each 10 deep - as deep as attachment chains get, well inside the parenting limit
+const int NUM_CHAINS = 1000;
+const int CHAIN_DEPTH = 10;
+
+class TestNestable : public SpatiallyNestable {
+public:
+    TestNestable() : SpatiallyNestable(NestableType::Entity, QUuid::createUuid()) {
+        // like an entity that isn't attached to a joint
+        setParentJointIndex((quint16)-1);
+    }
+
+    virtual glm::quat getAbsoluteJointRotationInObjectFrame(int index) const override { return glm::quat(); }
+    virtual glm::vec3 getAbsoluteJointTranslationInObjectFrame(int index) const override { return glm::vec3(); }
+    virtual bool setAbsoluteJointRotationInObjectFrame(int index, const glm::quat& rotation) override { return false; }
+    virtual bool setAbsoluteJointTranslationInObjectFrame(int index, const glm::vec3& translation) override { return false; }
+};
+
+class TestParentFinder : public SpatialParentFinder {
+public:
+    virtual SpatiallyNestableWeakPointer find(QUuid parentID, bool& success, SpatialParentTree* entityTree = nullptr) const override {
+        success = true;
+        return _nestables.value(parentID);
+    }
+
+    SpatiallyNestablePointer create(SpatiallyNestablePointer parent) {
+        SpatiallyNestablePointer nestable = std::make_shared<TestNestable>();
+        _nestables[nestable->getID()] = nestable;
+        if (parent) {
+            nestable->setParentID(parent->getID());
+        }
+        return nestable;
+    }
+
+private:
+    QHash<QUuid, SpatiallyNestableWeakPointer> _nestables;
+};
+
+void SpatiallyNestableTests::initTestCase() {
+    DependencyManager::registerInheritance<SpatialParentFinder, TestParentFinder>();
+    DependencyManager::set<TestParentFinder>();
+}
+
+void SpatiallyNestableTests::worldTransformFollowsAncestors() {
+    auto finder = DependencyManager::get<TestParentFinder>();
+
+    auto root = finder->create(nullptr);
+    auto child = finder->create(root);
+    auto grandchild = finder->create(child);
+
+    root->setPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+    child->setLocalPosition(glm::vec3(0.0f, 1.0f, 0.0f));
+    grandchild->setLocalPosition(glm::vec3(0.0f, 0.0f, 1.0f));
+    QCOMPARE_WITH_ABS_ERROR(grandchild->getPosition(), glm::vec3(1.0f, 1.0f, 1.0f), EPSILON);
+
+    // the grandchild's transform is cached now, and has to be dropped when an ancestor moves
+    root->setPosition(glm::vec3(2.0f, 0.0f, 0.0f));
+    QCOMPARE_WITH_ABS_ERROR(grandchild->getPosition(), glm::vec3(2.0f, 1.0f, 1.0f), EPSILON);
+
+    child->setLocalOrientation(glm::angleAxis(PI / 2.0f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    QCOMPARE_WITH_ABS_ERROR(grandchild->getPosition(), glm::vec3(3.0f, 1.0f, 0.0f), EPSILON);
+
+    // and when one of them is reparented
+    child->setParentID(QUuid());
+    QCOMPARE_WITH_ABS_ERROR(grandchild->getPosition(), glm::vec3(1.0f, 1.0f, 0.0f), EPSILON);
+}
+
+void SpatiallyNestableTests::nestedPositionBenchmark_data() {
+    QTest::addColumn<bool>("moveRoots");
+
+    QTest::newRow("static") << false;
+    QTest::newRow("roots moving") << true;
+}
+
+void SpatiallyNestableTests::nestedPositionBenchmark() {
+    QFETCH(bool, moveRoots);
+
+    auto finder = DependencyManager::get<TestParentFinder>();
+
+    std::vector<SpatiallyNestablePointer> nestables;
+    std::vector<SpatiallyNestablePointer> roots;
+    nestables.reserve(NUM_CHAINS * CHAIN_DEPTH);
+    for (int i = 0; i < NUM_CHAINS; ++i) {
+        SpatiallyNestablePointer parent;
+        for (int j = 0; j < CHAIN_DEPTH; ++j) {
+            auto nestable = finder->create(parent);
+            nestable->setLocalPosition(glm::vec3(1.0f, 0.0f, 0.0f));
+            nestables.push_back(nestable);
+            parent = nestable;
+        }
+        roots.push_back(nestables[i * CHAIN_DEPTH]);
+    }
+
+    float step = 0.0f;
+    float sum = 0.0f;
+    QBENCHMARK {
+        if (moveRoots) {
+            step += 1.0f;
+            for (auto& root : roots) {
+                root->setPosition(glm::vec3(step, 0.0f, 0.0f));
+            }
+        }
+
+        // every object is asked, the way rendering and physics ask each of theirs
+        for (auto& nestable : nestables) {
+            sum += nestable->getPosition().x;
+        }
+    }
+
+    QVERIFY(sum > 0.0f);
+}
@@ -0,0 +1,25 @@
+//
+//  SpatiallyNestableTests.h
+//  tests/shared/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SpatiallyNestableTests_h
+#define hifi_SpatiallyNestableTests_h
+
+#include <QtTest/QtTest>
+
+class SpatiallyNestableTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void worldTransformFollowsAncestors();
+    void nestedPositionBenchmark_data();
+    void nestedPositionBenchmark();
+};
+
+#endif // hifi_SpatiallyNestableTests_h
@@ -0,0 +1,84 @@
+//
+//  main.cpp
+//  tools/entities-convert/src
+//
+//  Copyright 2016 High Fidelity, Inc.
+//
+//  Converts an entity server's persist file between the JSON and binary snapshot formats.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+
+#include <EntityTree.h>
+#include <NodeList.h>
+
+// reads exactly the file asked for, where Octree::readFromFile() would take a more recently saved format instead
+static bool readEntities(EntityTreePointer tree, const QString& fileName) {
+    if (fileName.endsWith(".bin")) {
+        return tree->readFromBinaryFile(fileName);
+    }
+    if (fileName.endsWith(".json.gz")) {
+        return tree->readJSONFromGzippedFile(fileName);
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Unable to open" << fileName;
+        return false;
+    }
+    QDataStream fileStream(&file);
+    return tree->readJSONFromStream(file.size(), fileStream);
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("entities-convert");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts entities between the .json, .json.gz and binary snapshot (.bin) formats.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("input", "The file to read entities from.");
+    parser.addPositionalArgument("output", "The file to write entities to, in the format of its extension.");
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 2) {
+        parser.showHelp(1);
+    }
+    QString inputFileName = arguments[0];
+    QString outputFileName = arguments[1];
+
+    QString outputFileType;
+    if (outputFileName.endsWith(".json.gz")) {
+        outputFileType = "json.gz";
+    } else if (outputFileName.endsWith(".json")) {
+        outputFileType = "json";
+    } else if (outputFileName.endsWith(".bin")) {
+        outputFileType = "bin";
+    } else {
+        qCritical() << "Output file" << outputFileName << "must end in .json, .json.gz or .bin";
+        return 1;
+    }
+
+    DependencyManager::set<NodeList>(NodeType::Unassigned);
+
+    EntityTreePointer tree = EntityTreePointer(new EntityTree(true));
+    tree->createRootElement();
+    tree->setIsServer(true);
+
+    if (!readEntities(tree, inputFileName)) {
+        qCritical() << "Could not read entities from" << inputFileName;
+        return 1;
+    }
+
+    tree->writeToFile(qPrintable(outputFileName), NULL, outputFileType);
+    qDebug() << "Converted" << inputFileName << "to" << outputFileName;
+    return 0;
+}